@@ -0,0 +1,247 @@
+/***********************************************************************************
+ *                                                                                 *
+ * Voreen - The Volume Rendering Engine                                            *
+ *                                                                                 *
+ * Copyright (C) 2005-2024 University of Muenster, Germany,                        *
+ * Department of Computer Science.                                                 *
+ * For a list of authors please refer to the file "CREDITS.txt".                   *
+ *                                                                                 *
+ * This file is part of the Voreen software package. Voreen is free software:      *
+ * you can redistribute it and/or modify it under the terms of the GNU General     *
+ * Public License version 2 as published by the Free Software Foundation.          *
+ *                                                                                 *
+ * Voreen is distributed in the hope that it will be useful, but WITHOUT ANY       *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR   *
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.      *
+ *                                                                                 *
+ * You should have received a copy of the GNU General Public License in the file   *
+ * "LICENSE.txt" along with this file. If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                                 *
+ * For non-commercial academic use see the license exception specified in the file *
+ * "LICENSE-academic.txt". To get information about commercial licensing please    *
+ * contact the authors.                                                            *
+ *                                                                                 *
+ ***********************************************************************************/
+
+#include "voreen/core/datastructures/volume/volume.h"
+#include "voreen/core/datastructures/volume/volumeatomic.h"
+#include "voreen/core/datastructures/volume/operators/volumeoperatorconnectedcomponents.h"
+
+#include "tgt/logmanager.h"
+
+#include <cstdlib>
+#include <deque>
+#include <limits>
+#include <random>
+#include <vector>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE ConnectedComponentsTests
+#include <boost/test/unit_test.hpp>
+
+using namespace voreen;
+using tgt::svec3;
+
+//-----------------------------------------------------------------------------
+// helper functions
+
+/// Foreground mask of a volume, x fastest.
+typedef std::vector<uint8_t> Mask;
+
+Mask createRandomMask(const svec3& dim, double density, unsigned int seed) {
+    std::mt19937 generator(seed);
+    std::bernoulli_distribution foreground(density);
+    Mask mask(tgt::hmul(dim));
+    for (size_t i=0; i<mask.size(); i++)
+        mask[i] = foreground(generator) ? 1 : 0;
+    return mask;
+}
+
+/**
+ * Reference labeling: Scans the volume and flood fills every unlabeled foreground voxel,
+ * such that labels are assigned in the scan order of the first voxel of each component.
+ */
+uint32_t floodFill(const Mask& mask, const svec3& dim, int connectivity, std::vector<uint32_t>& labels,
+                   std::vector<ConnectedComponentStatistics>& statistics)
+{
+    int maxDistance = connectivity == 6 ? 1 : (connectivity == 18 ? 2 : 3);
+    std::vector<tgt::ivec3> neighbors;
+    for (int z=-1; z<=1; z++) {
+        for (int y=-1; y<=1; y++) {
+            for (int x=-1; x<=1; x++) {
+                int distance = std::abs(x) + std::abs(y) + std::abs(z);
+                if (distance > 0 && distance <= maxDistance)
+                    neighbors.push_back(tgt::ivec3(x, y, z));
+            }
+        }
+    }
+
+    labels.assign(mask.size(), 0);
+    statistics.clear();
+    uint32_t numComponents = 0;
+    for (size_t start=0; start<mask.size(); start++) {
+        if (!mask[start] || labels[start])
+            continue;
+
+        numComponents++;
+        ConnectedComponentStatistics component;
+        tgt::dvec3 positionSum(0.0);
+        std::deque<size_t> queue(1, start);
+        labels[start] = numComponents;
+        while (!queue.empty()) {
+            size_t i = queue.front();
+            queue.pop_front();
+            svec3 pos(i % dim.x, (i / dim.x) % dim.y, i / (dim.x*dim.y));
+            component.numVoxels++;
+            component.llf = tgt::min(component.llf, pos);
+            component.urb = tgt::max(component.urb, pos);
+            positionSum += tgt::dvec3(pos);
+
+            for (size_t n=0; n<neighbors.size(); n++) {
+                tgt::ivec3 npos = tgt::ivec3(pos) + neighbors[n];
+                if (tgt::hor(tgt::lessThan(npos, tgt::ivec3::zero)) || tgt::hor(tgt::greaterThanEqual(npos, tgt::ivec3(dim))))
+                    continue;
+                size_t ni = (npos.z*dim.y + npos.y)*dim.x + npos.x;
+                if (mask[ni] && !labels[ni]) {
+                    labels[ni] = numComponents;
+                    queue.push_back(ni);
+                }
+            }
+        }
+        component.centroid = positionSum / static_cast<double>(component.numVoxels);
+        statistics.push_back(component);
+    }
+    return numComponents;
+}
+
+/// Labels the mask with ConnectedComponentLabeling and compares labels and statistics to the flood fill.
+void checkLabeling(const Mask& mask, const svec3& dim, int connectivity) {
+    BOOST_TEST_CONTEXT("connectivity " << connectivity) {
+        std::vector<uint32_t> expectedLabels;
+        std::vector<ConnectedComponentStatistics> expectedStatistics;
+        uint32_t expectedNumComponents = floodFill(mask, dim, connectivity, expectedLabels, expectedStatistics);
+
+        ConnectedComponentLabeling labeling(dim, connectivity);
+        BOOST_REQUIRE(labeling.getNumSlabs() > 1);
+
+        std::vector<uint32_t> labels(mask.size(), std::numeric_limits<uint32_t>::max());
+        auto isForeground = [&mask] (size_t i) { return mask[i] != 0; };
+        // slabs are independent, the order must not matter
+        for (size_t slab=labeling.getNumSlabs(); slab>0; slab--)
+            labeling.labelSlab(slab-1, labels.data(), isForeground);
+
+        std::vector<ConnectedComponentStatistics> statistics;
+        uint32_t numComponents = labeling.merge(labels.data(), false, &statistics);
+
+        BOOST_CHECK_EQUAL(numComponents, expectedNumComponents);
+        BOOST_CHECK(labels == expectedLabels);
+
+        BOOST_REQUIRE_EQUAL(statistics.size(), expectedStatistics.size());
+        for (size_t c=0; c<statistics.size(); c++) {
+            BOOST_CHECK_EQUAL(statistics[c].numVoxels, expectedStatistics[c].numVoxels);
+            BOOST_CHECK_EQUAL(statistics[c].llf, expectedStatistics[c].llf);
+            BOOST_CHECK_EQUAL(statistics[c].urb, expectedStatistics[c].urb);
+            BOOST_CHECK_SMALL(tgt::length(statistics[c].centroid - expectedStatistics[c].centroid), 1e-9);
+        }
+    }
+}
+
+struct GlobalFixture {
+    GlobalFixture() {
+        tgt::Singleton<tgt::LogManager>::init();
+    }
+    ~GlobalFixture() {
+        tgt::Singleton<tgt::LogManager>::deinit();
+    }
+};
+
+BOOST_GLOBAL_FIXTURE(GlobalFixture);
+
+//-----------------------------------------------------------------------------
+// test cases
+
+BOOST_AUTO_TEST_SUITE(ConnectedComponentLabelingTests)
+
+// Random volumes of several densities spanning multiple slabs, including the percolating case
+BOOST_AUTO_TEST_CASE(RandomVolumes) {
+    const svec3 dim(13, 11, 53);
+    const double densities[] = { 0.1, 0.3, 0.5 };
+    const int connectivities[] = { 6, 18, 26 };
+    for (size_t d=0; d<3; d++) {
+        Mask mask = createRandomMask(dim, densities[d], static_cast<unsigned int>(d + 1));
+        for (size_t c=0; c<3; c++)
+            checkLabeling(mask, dim, connectivities[c]);
+    }
+}
+
+// Diagonal line along z: connected only by the corners of its voxels, i.e., for 26 connectivity,
+// where the single component has to be merged across all slab boundaries.
+BOOST_AUTO_TEST_CASE(DiagonalLine) {
+    const svec3 dim(4, 4, 50);
+    Mask mask(tgt::hmul(dim), 0);
+    for (size_t z=0; z<dim.z; z++) {
+        size_t xy = 1 + z % 2;
+        mask[(z*dim.y + xy)*dim.x + xy] = 1;
+    }
+
+    for (int connectivity : { 6, 18, 26 })
+        checkLabeling(mask, dim, connectivity);
+
+    ConnectedComponentLabeling labeling(dim, 26);
+    std::vector<uint32_t> labels(mask.size());
+    for (size_t slab=0; slab<labeling.getNumSlabs(); slab++)
+        labeling.labelSlab(slab, labels.data(), [&mask] (size_t i) { return mask[i] != 0; });
+    std::vector<ConnectedComponentStatistics> statistics;
+    BOOST_CHECK_EQUAL(labeling.merge(labels.data(), false, &statistics), 1u);
+    BOOST_REQUIRE_EQUAL(statistics.size(), 1u);
+    BOOST_CHECK_EQUAL(statistics[0].llf, svec3(1, 1, 0));
+    BOOST_CHECK_EQUAL(statistics[0].urb, svec3(2, 2, dim.z-1));
+}
+
+// Checkerboard: every foreground voxel is a component of its own for 6 connectivity,
+// all of them are connected for 18 and 26 connectivity.
+BOOST_AUTO_TEST_CASE(Checkerboard) {
+    const svec3 dim(16, 16, 40);
+    Mask mask(tgt::hmul(dim));
+    for (size_t i=0; i<mask.size(); i++) {
+        svec3 pos(i % dim.x, (i / dim.x) % dim.y, i / (dim.x*dim.y));
+        mask[i] = (pos.x + pos.y + pos.z) % 2;
+    }
+
+    for (int connectivity : { 6, 18, 26 })
+        checkLabeling(mask, dim, connectivity);
+}
+
+// Labels are stretched over the uint32 range and the operator returns them as uint32 volume
+BOOST_AUTO_TEST_CASE(OperatorStretchedLabels) {
+    const svec3 dim(10, 12, 35);
+    Mask mask = createRandomMask(dim, 0.2, 42);
+
+    std::vector<uint32_t> expectedLabels;
+    std::vector<ConnectedComponentStatistics> expectedStatistics;
+    uint32_t numComponents = floodFill(mask, dim, 6, expectedLabels, expectedStatistics);
+    BOOST_REQUIRE(numComponents > 1);
+    const uint32_t stretchFactor = std::numeric_limits<uint32_t>::max() / numComponents;
+
+    VolumeRAM_UInt8* input = new VolumeRAM_UInt8(dim);
+    for (size_t i=0; i<mask.size(); i++)
+        input->voxel(i) = mask[i] ? 255 : 0;
+    Volume inputVolume(input, tgt::vec3::one, tgt::vec3::zero);
+
+    std::vector<ConnectedComponentStatistics> statistics;
+    VolumeOperatorConnectedComponentAnalysisGeneric<uint8_t> op;
+    std::unique_ptr<Volume> result(op.apply(&inputVolume, 6, true, 0, &statistics));
+    BOOST_REQUIRE(result);
+
+    const VolumeAtomic<uint32_t>* labels = dynamic_cast<const VolumeAtomic<uint32_t>*>(result->getRepresentation<VolumeRAM>());
+    BOOST_REQUIRE(labels);
+    BOOST_REQUIRE_EQUAL(labels->getDimensions(), dim);
+    for (size_t i=0; i<mask.size(); i++)
+        BOOST_CHECK_EQUAL(labels->voxel(i), expectedLabels[i] * stretchFactor);
+
+    BOOST_REQUIRE_EQUAL(statistics.size(), expectedStatistics.size());
+    for (size_t c=0; c<statistics.size(); c++)
+        BOOST_CHECK_EQUAL(statistics[c].numVoxels, expectedStatistics[c].numVoxels);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -38,6 +38,17 @@
 #include "voreen/core/network/processornetwork.h"
 #include "voreen/core/network/networkevaluator.h"
 #include "voreen/core/network/networkgraph.h"
+#include "voreen/core/ports/volumeport.h"
+#include "voreen/core/datastructures/volume/volume.h"
+#include "voreen/core/datastructures/volume/volumeatomic.h"
+#include "voreen/core/properties/boolproperty.h"
+
+#ifdef VRN_MODULE_BASE
+#include "modules/base/processors/volume/volumeinversion.h"
+#include "modules/base/processors/volume/volumemirror.h"
+#endif
+
+#include <boost/thread.hpp>
 
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE networkevaluatortest.cpp
@@ -83,6 +94,7 @@ public:
  * - is invalid
  * - is ready
  * - invalidates its outports on process()
+ * - is not thread-safe
  */
 class MockProcessor : public Processor {
 public:
@@ -91,16 +103,25 @@ public:
     {
         invalidate();
         ready = true;
+        threadSafe = false;
+        notifyStateChangeOnProcess = false;
     }
 
     virtual bool isReady() const {
         return ready;
     }
 
+    virtual bool isThreadSafe() const {
+        return threadSafe;
+    }
+
     virtual void process() {
+        processThread = boost::this_thread::get_id();
         const std::vector<Port*> outports = getOutports();
         for (size_t i=0; i<outports.size(); i++)
             outports.at(i)->invalidatePort();
+        if (notifyStateChangeOnProcess)
+            notifyStateChanged();
     }
 
     // workaround for linker error with precompiled headers and GCC 5
@@ -115,6 +136,9 @@ public:
     void setDescriptions() {}
 
     bool ready;
+    bool threadSafe;
+    bool notifyStateChangeOnProcess;
+    boost::thread::id processThread;    ///< thread that has run the last process() call
 };
 
 /// Processor with two outports
@@ -222,6 +246,45 @@ public:
     BasicPort loopOutport_;
 };
 
+/// Thread-safe processor that outputs a 4x2x1 uint8 volume with the voxel values 0..7
+class VolumeSourceProcessor : public MockProcessor {
+public:
+    VolumeSourceProcessor() :
+        MockProcessor(),
+        outport_(Port::OUTPORT, "volumeOutport")
+    {
+        addPort(outport_);
+        threadSafe = true;
+    }
+    Processor* create() const        { return new VolumeSourceProcessor(); }
+    std::string getClassName() const { return "VolumeSourceProcessor";     }
+
+    virtual void process() {
+        MockProcessor::process();
+        VolumeRAM_UInt8* volume = new VolumeRAM_UInt8(tgt::svec3(4, 2, 1));
+        for (size_t i=0; i<volume->getNumVoxels(); i++)
+            volume->voxel(i) = static_cast<uint8_t>(i);
+        outport_.setData(new Volume(volume, tgt::vec3(1.f), tgt::vec3(0.f)));
+    }
+
+    VolumePort outport_;
+};
+
+/// End processor with a volume inport
+class VolumeSinkProcessor : public MockProcessor {
+public:
+    VolumeSinkProcessor() :
+        MockProcessor(),
+        inport_(Port::INPORT, "volumeInport")
+    {
+        addPort(inport_);
+    }
+    Processor* create() const        { return new VolumeSinkProcessor(); }
+    std::string getClassName() const { return "VolumeSinkProcessor";     }
+
+    VolumePort inport_;
+};
+
 
 //
 // Test Fixtures
@@ -239,12 +302,25 @@ public:
         else
             loopIterations.push_back(-1);
     }
-    virtual void afterProcess(Processor* /*p*/) {}
+    virtual void afterProcess(Processor* p) {
+        afterProcessOrder.push_back(p);
+    }
 
     std::vector<Processor*> evalOrder;
+    std::vector<Processor*> afterProcessOrder;
     std::vector<int> loopIterations;
 };
 
+/// Records the threads on which the state change notifications of the observed processors are received.
+class StateChangeRecorder : public ProcessorObserver {
+public:
+    virtual void stateChanged(const Processor* /*processor*/) {
+        threads.push_back(boost::this_thread::get_id());
+    }
+
+    std::vector<boost::thread::id> threads;
+};
+
 // Global setup & tear down
 struct GlobalFixture {
     GlobalFixture() {
@@ -2420,5 +2496,117 @@ BOOST_AUTO_TEST_CASE(validProcessorEvaluation)
     BOOST_CHECK(endProcessor2->isValid());
 }
 
+// Checks concurrent evaluation of a split/merge network with thread-safe processors
+// Network = (StartProcessor->MiddleProcessor,MiddleProcessor2->EndProcessor;EndProcessor2)
+BOOST_AUTO_TEST_CASE(concurrentEvaluation)
+{
+    BOOST_CHECK(network->connectPorts(startProcessor->outport_, middleProcessor->inport_));
+    BOOST_CHECK(network->connectPorts(startProcessor->outport2_, middleProcessor2->inport_));
+    BOOST_CHECK(network->connectPorts(middleProcessor->outport_, endProcessor->inport_));
+    BOOST_CHECK(network->connectPorts(middleProcessor2->outport_, endProcessor->inport2_));
+
+    // endProcessor is not thread-safe and has to be processed on the evaluating thread
+    startProcessor->threadSafe = true;
+    middleProcessor->threadSafe = true;
+    middleProcessor2->threadSafe = true;
+    endProcessor2->threadSafe = true;
+    middleProcessor->notifyStateChangeOnProcess = true;
+    StateChangeRecorder stateChangeRec;
+    static_cast<Observable<ProcessorObserver>*>(middleProcessor)->addObserver(&stateChangeRec);
+
+    evaluator->setProcessorNetwork(network);
+    evaluator->setConcurrentProcessing(true, 2);
+    BOOST_CHECK(evalOrderRec->evalOrder.empty());
+
+    const boost::thread::id evaluatingThread = boost::this_thread::get_id();
+    evaluator->process();
+
+    // expected network evaluation:
+    // - all processors have been evaluated once in dependency order, observers have been notified before and after
+    // - notifications issued on worker threads have been received on the evaluating thread
+    BOOST_CHECK(evalOrderRec->evalOrder.size() == 5);
+    BOOST_CHECK(evalOrderRec->afterProcessOrder.size() == 5);
+    BOOST_CHECK(beforeInVector(evalOrderRec->evalOrder, startProcessor, middleProcessor));
+    BOOST_CHECK(beforeInVector(evalOrderRec->evalOrder, startProcessor, middleProcessor2));
+    BOOST_CHECK(beforeInVector(evalOrderRec->evalOrder, middleProcessor, endProcessor));
+    BOOST_CHECK(beforeInVector(evalOrderRec->evalOrder, middleProcessor2, endProcessor));
+    BOOST_CHECK(inVector(evalOrderRec->evalOrder, endProcessor2));
+
+    BOOST_CHECK(endProcessor->processThread == evaluatingThread);
+    BOOST_CHECK(stateChangeRec.threads.size() == 1);
+    BOOST_CHECK(std::count(stateChangeRec.threads.begin(), stateChangeRec.threads.end(), evaluatingThread) == (int)stateChangeRec.threads.size());
+
+    BOOST_CHECK(startProcessor->isValid());
+    BOOST_CHECK(middleProcessor->isValid());
+    BOOST_CHECK(middleProcessor2->isValid());
+    BOOST_CHECK(endProcessor->isValid());
+    BOOST_CHECK(endProcessor2->isValid());
+
+    // second evaluation reuses the worker threads and invalidates the successors of the start processor
+    startProcessor->invalidate();
+    evaluator->process();
+    BOOST_CHECK(evalOrderRec->evalOrder.size() == 9);
+    BOOST_CHECK(evalOrderRec->afterProcessOrder.size() == 9);
+    BOOST_CHECK(stateChangeRec.threads.size() == 2);
+    BOOST_CHECK(std::count(stateChangeRec.threads.begin(), stateChangeRec.threads.end(), evaluatingThread) == (int)stateChangeRec.threads.size());
+    BOOST_CHECK(middleProcessor->isValid());
+    BOOST_CHECK(endProcessor->isValid());
+
+    static_cast<Observable<ProcessorObserver>*>(middleProcessor)->removeObserver(&stateChangeRec);
+    evaluator->setConcurrentProcessing(false);
+}
+
+#ifdef VRN_MODULE_BASE
+// Checks concurrent evaluation of a volume pipeline with thread-safe volume filters
+// Network = (VolumeSource->VolumeInversion->VolumeMirror->VolumeSink)
+BOOST_AUTO_TEST_CASE(concurrentVolumeFilterEvaluation)
+{
+    VolumeSourceProcessor* source = new VolumeSourceProcessor();
+    VolumeInversion* inversion = new VolumeInversion();
+    VolumeMirror* mirror = new VolumeMirror();
+    VolumeSinkProcessor* sink = new VolumeSinkProcessor();
+    network->addProcessor(source, "VolumeSource");
+    network->addProcessor(inversion, "VolumeInversion");
+    network->addProcessor(mirror, "VolumeMirror");
+    network->addProcessor(sink, "VolumeSink");
+
+    BOOST_CHECK(network->connectPorts(source->getPort("volumeOutport"), inversion->getPort("volumehandle.input")));
+    BOOST_CHECK(network->connectPorts(inversion->getPort("volumehandle.output"), mirror->getPort("volumehandle.input")));
+    BOOST_CHECK(network->connectPorts(mirror->getPort("volumehandle.output"), sink->getPort("volumeInport")));
+
+    BOOST_CHECK(inversion->isThreadSafe());
+    BOOST_CHECK(mirror->isThreadSafe());
+
+    // results must be computed, not restored from the cache
+    static_cast<BoolProperty*>(inversion->getProperty("useCaching"))->set(false);
+    static_cast<BoolProperty*>(mirror->getProperty("useCaching"))->set(false);
+    static_cast<BoolProperty*>(mirror->getProperty("mirrorX"))->set(true);
+
+    evaluator->setProcessorNetwork(network);
+    evaluator->setConcurrentProcessing(true, 2);
+    evaluator->process();
+
+    BOOST_CHECK(beforeInVector(evalOrderRec->evalOrder, source, inversion));
+    BOOST_CHECK(beforeInVector(evalOrderRec->evalOrder, inversion, mirror));
+    BOOST_CHECK(beforeInVector(evalOrderRec->evalOrder, mirror, sink));
+    BOOST_CHECK(inversion->isValid());
+    BOOST_CHECK(mirror->isValid());
+    BOOST_CHECK(sink->isValid());
+
+    // expected: voxel (x,y) = max - input(3-x,y) = 7 - (4*y + 3-x)
+    const VolumeBase* result = sink->inport_.getData();
+    BOOST_REQUIRE(result);
+    const VolumeRAM_UInt8* resultRam = dynamic_cast<const VolumeRAM_UInt8*>(result->getRepresentation<VolumeRAM>());
+    BOOST_REQUIRE(resultRam);
+    BOOST_CHECK(resultRam->getDimensions() == tgt::svec3(4, 2, 1));
+    for (size_t y=0; y<2; y++) {
+        for (size_t x=0; x<4; x++)
+            BOOST_CHECK(resultRam->voxel(x, y, 0) == 7 - (4*y + 3-x));
+    }
+
+    evaluator->setConcurrentProcessing(false);
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END()
 
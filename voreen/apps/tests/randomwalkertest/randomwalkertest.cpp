@@ -0,0 +1,210 @@
+/***********************************************************************************
+ *                                                                                 *
+ * Voreen - The Volume Rendering Engine                                            *
+ *                                                                                 *
+ * Copyright (C) 2005-2024 University of Muenster, Germany,                        *
+ * Department of Computer Science.                                                 *
+ * For a list of authors please refer to the file "CREDITS.txt".                   *
+ *                                                                                 *
+ * This file is part of the Voreen software package. Voreen is free software:      *
+ * you can redistribute it and/or modify it under the terms of the GNU General     *
+ * Public License version 2 as published by the Free Software Foundation.          *
+ *                                                                                 *
+ * Voreen is distributed in the hope that it will be useful, but WITHOUT ANY       *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR   *
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.      *
+ *                                                                                 *
+ * You should have received a copy of the GNU General Public License in the file   *
+ * "LICENSE.txt" along with this file. If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                                 *
+ * For non-commercial academic use see the license exception specified in the file *
+ * "LICENSE-academic.txt". To get information about commercial licensing please    *
+ * contact the authors.                                                            *
+ *                                                                                 *
+ ***********************************************************************************/
+
+#include "modules/randomwalker/solver/randomwalkersolver.h"
+#include "modules/randomwalker/solver/randomwalkerseeds.h"
+#include "modules/randomwalker/solver/randomwalkerweights.h"
+
+#include "voreen/core/voreenapplication.h"
+#include "voreen/core/utils/commandlineparser.h"
+#include "voreen/core/utils/voreenblas/voreenblascpu.h"
+#include "voreen/core/datastructures/volume/volume.h"
+#include "voreen/core/datastructures/volume/volumeatomic.h"
+#include "voreen/core/io/progressreporter.h"
+
+#include "tgt/logmanager.h"
+
+#include <memory>
+#include <vector>
+
+using namespace voreen;
+
+/**
+ * Compares the solutions of the matrix-free (multigrid) random walker solver with those of the
+ * solver operating on the assembled EllpackMatrix for a noisy sphere phantom.
+ */
+
+const std::string loggerCat_ = "RandomWalkerTest";
+
+float ERROR_THRESH;
+
+class NullProgressReporter : public ProgressReporter {
+public:
+    virtual void setProgressMessage(const std::string&) {}
+    virtual std::string getProgressMessage() const { return ""; }
+};
+
+VolumeAtomic<float>* createPhantom(int dim);
+std::unique_ptr<RandomWalkerSolver> setupSolver(const Volume& volume, const VolumeAtomic<float>& phantom, std::unique_ptr<RandomWalkerWeights>& weights, bool matrixFree);
+bool compareSolutions(const RandomWalkerSolver& expected, const RandomWalkerSolver& actual);
+bool testMatrixFree(const Volume& volume, const VolumeAtomic<float>& phantom);
+bool testMatrixFreeInitialization(const Volume& volume, const VolumeAtomic<float>& phantom);
+
+int main(int argc, char* argv[]) {
+
+    VoreenApplication app("randomwalkertest", "RandomWalkerTest", "", argc, argv, VoreenApplication::APP_ALL);
+    int dim;
+    app.getCommandLineParser()->addOption("dim", dim, CommandLineParser::MainOption, "Edge length of the phantom volume", 32, "32");
+    app.getCommandLineParser()->addOption("errorThreshold", ERROR_THRESH, CommandLineParser::MainOption, "Maximum deviation of the probabilities of both solvers", 1e-3f, "1e-3f");
+    app.initialize();
+
+    if (dim < 8) {
+        LERROR("Invalid parameters");
+        return 1;
+    }
+
+    VolumeAtomic<float>* phantom = createPhantom(dim);
+    Volume volume(phantom->clone(), tgt::vec3(1.f), tgt::vec3(0.f));
+
+    int numFailed = 0;
+    if (!testMatrixFree(volume, *phantom))
+        numFailed++;
+    if (!testMatrixFreeInitialization(volume, *phantom))
+        numFailed++;
+    delete phantom;
+
+    if (numFailed == 0)
+        LINFO("All tests passed");
+    else
+        LERROR(numFailed << " test(s) failed");
+
+    app.deinitialize();
+    return numFailed == 0 ? 0 : 1;
+}
+
+VolumeAtomic<float>* createPhantom(int dim) {
+    // Sphere of intensity 1 on background 0 with deterministic noise
+    VolumeAtomic<float>* phantom = new VolumeAtomic<float>(tgt::svec3(dim));
+    const tgt::vec3 center(dim / 2.f);
+    const float radius = dim / 4.f;
+    for (int z=0; z<dim; z++) {
+        for (int y=0; y<dim; y++) {
+            for (int x=0; x<dim; x++) {
+                size_t i = (static_cast<size_t>(z)*dim + y)*dim + x;
+                float noise = static_cast<float>((i*7919) % 1000) / 1000.f - 0.5f;
+                float value = tgt::distance(tgt::vec3(x, y, z), center) < radius ? 1.f : 0.f;
+                phantom->voxel(i) = tgt::clamp(value + 0.2f*noise, 0.f, 1.f);
+            }
+        }
+    }
+    return phantom;
+}
+
+std::unique_ptr<RandomWalkerSolver> setupSolver(const Volume& volume, const VolumeAtomic<float>& phantom, std::unique_ptr<RandomWalkerWeights>& weights, bool matrixFree) {
+    const tgt::svec3 dim = phantom.getDimensions();
+
+    // foreground seeds in the center of the sphere, background seeds on the boundary of the volume
+    VolumeRAM_UInt8 foreground(dim);
+    VolumeRAM_UInt8 background(dim);
+    foreground.clear();
+    background.clear();
+    for (size_t z=0; z<dim.z; z++) {
+        for (size_t y=0; y<dim.y; y++) {
+            for (size_t x=0; x<dim.x; x++) {
+                tgt::svec3 pos(x, y, z);
+                if (tgt::hand(tgt::greaterThanEqual(pos, dim/size_t(2) - size_t(1))) && tgt::hand(tgt::lessThanEqual(pos, dim/size_t(2) + size_t(1))))
+                    foreground.voxel(pos) = 255;
+                else if (x == 0 || y == 0 || z == 0 || x == dim.x-1 || y == dim.y-1 || z == dim.z-1)
+                    background.voxel(pos) = 255;
+            }
+        }
+    }
+    RandomWalkerSeeds* seeds = new RandomWalkerTwoLabelSeeds(dim, PointSegmentListGeometryVec3(), PointSegmentListGeometryVec3(), &foreground, &background);
+
+    std::unique_ptr<VolumeAtomic<float>> weightVolume(phantom.clone());
+    std::unique_ptr<RandomWalkerEdgeWeight> weightFun(new RandomWalkerEdgeWeightIntensity(std::move(*weightVolume), tgt::vec2(0.f, 1.f), 100.f));
+    weights.reset(new RandomWalkerWeights(std::move(weightFun), tgt::ivec3(dim)));
+
+    std::unique_ptr<RandomWalkerSolver> solver(new RandomWalkerSolver(&volume, seeds, *weights));
+    NullProgressReporter progress;
+    solver->setupEquationSystem(progress, matrixFree);
+    return solver;
+}
+
+bool compareSolutions(const RandomWalkerSolver& expected, const RandomWalkerSolver& actual) {
+    float maxDeviation = 0.f;
+    for (size_t i=0; i<expected.getNumVoxels(); i++)
+        maxDeviation = std::max(maxDeviation, std::abs(expected.getProbabilityValue(i) - actual.getProbabilityValue(i)));
+
+    LINFO("Maximum deviation: " << maxDeviation);
+    return maxDeviation <= ERROR_THRESH;
+}
+
+bool testMatrixFree(const Volume& volume, const VolumeAtomic<float>& phantom) {
+    LINFO("Testing matrix-free against assembled system...");
+    try {
+        VoreenBlasCPU blas;
+        NullProgressReporter progress;
+        std::unique_ptr<RandomWalkerWeights> assembledWeights, matrixFreeWeights;
+
+        std::unique_ptr<RandomWalkerSolver> assembled = setupSolver(volume, phantom, assembledWeights, false);
+        int assembledIterations = assembled->solve(&blas, nullptr, VoreenBlas::Jacobi, 1e-6f, 10000, progress);
+
+        std::unique_ptr<RandomWalkerSolver> matrixFree = setupSolver(volume, phantom, matrixFreeWeights, true);
+        if (!matrixFree->isMatrixFree() || matrixFree->getSystemSize() != assembled->getSystemSize()) {
+            LERROR("Matrix-free system does not match the assembled system");
+            return false;
+        }
+        for (size_t i=0; i<volume.getNumVoxels(); i++) {
+            if (!assembled->isSeedPoint(i) && std::abs(assembled->getEdgeWeightSum(i) - matrixFree->getEdgeWeightSum(i)) > 1e-5f) {
+                LERROR("Diagonal entries of voxel " << i << " differ");
+                return false;
+            }
+        }
+        int matrixFreeIterations = matrixFree->solve(&blas, nullptr, VoreenBlas::Jacobi, 1e-6f, 10000, progress);
+        LINFO("Iterations: assembled " << assembledIterations << ", matrix-free " << matrixFreeIterations);
+
+        return compareSolutions(*assembled, *matrixFree);
+    }
+    catch (VoreenException& e) {
+        LERROR(e.what());
+        return false;
+    }
+}
+
+bool testMatrixFreeInitialization(const Volume& volume, const VolumeAtomic<float>& phantom) {
+    LINFO("Testing matrix-free system initialized with a previous solution...");
+    try {
+        VoreenBlasCPU blas;
+        NullProgressReporter progress;
+        std::unique_ptr<RandomWalkerWeights> assembledWeights, matrixFreeWeights;
+
+        std::unique_ptr<RandomWalkerSolver> assembled = setupSolver(volume, phantom, assembledWeights, false);
+        assembled->solve(&blas, nullptr, VoreenBlas::Jacobi, 1e-6f, 10000, progress);
+
+        // The initialization is indexed by equation for both representations.
+        std::vector<float> initialization(assembled->getSolution(), assembled->getSolution() + assembled->getSystemSize());
+
+        std::unique_ptr<RandomWalkerSolver> matrixFree = setupSolver(volume, phantom, matrixFreeWeights, true);
+        int iterations = matrixFree->solve(&blas, initialization.data(), VoreenBlas::Jacobi, 1e-5f, 10000, progress);
+        LINFO("Iterations: " << iterations);
+
+        return compareSolutions(*assembled, *matrixFree);
+    }
+    catch (VoreenException& e) {
+        LERROR(e.what());
+        return false;
+    }
+}
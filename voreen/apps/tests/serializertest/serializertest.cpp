@@ -29,7 +29,9 @@
 
 #include "voreen/core/io/serialization/serializable.h"
 #include "voreen/core/io/serialization/serialization.h"
+#include "voreen/core/io/serialization/binaryblobsidecar.h"
 #include "voreen/core/voreenapplication.h"
+#include "tgt/filesystem.h"
 #include "tgt/types.h"
 
 using namespace voreen;
@@ -1507,6 +1509,116 @@ void testBugAbstractSerializableNullPointerSerialization() {
     }
 }
 
+/**
+ * Writes a document containing the passed binary blobs, optionally to a new sidecar file.
+ *
+ * @return the name of the sidecar file, or an empty string
+ */
+template<typename SerializerType>
+std::string writeBinaryBlobDocument(const std::string& filename, const std::vector<unsigned char>& small,
+                                    const std::vector<uint32_t>& values, bool useSidecar)
+{
+    std::unique_ptr<BinaryBlobSidecarWriter> sidecar;
+    if (useSidecar)
+        sidecar.reset(new BinaryBlobSidecarWriter(BinaryBlobSidecar::createFilename(filename)));
+
+    SerializerType s;
+    Serializer serializer(s);
+    if (sidecar) {
+        serializer.serialize(BinaryBlobSidecar::DOCUMENT_KEY, tgt::FileSystem::fileName(sidecar->getFilename()));
+        serializer.setBinaryBlobSidecarWriter(sidecar.get());
+    }
+    serializer.serializeBinaryBlob("small", small);
+    serializer.serializeBinaryBlob("values", values);
+    if (sidecar)
+        sidecar->close();
+
+    std::ofstream stream(filename.c_str());
+    s.write(stream);
+    stream.close();
+    test(!stream.fail(), "document could not be written");
+
+    std::string sidecarFilename = sidecar ? sidecar->getFilename() : "";
+    BinaryBlobSidecar::deleteFiles(filename, sidecarFilename);
+    return sidecarFilename;
+}
+
+/**
+ * Reads the binary blobs written by writeBinaryBlobDocument and compares them to the passed ones.
+ */
+template<typename DeserializerType>
+void readBinaryBlobDocument(const std::string& filename, const std::string& expectedSidecarFilename,
+                            const std::vector<unsigned char>& small, const std::vector<uint32_t>& values)
+{
+    std::ifstream stream(filename.c_str());
+    DeserializerType d;
+    d.read(stream);
+    Deserializer deserializer(d);
+
+    std::string sidecarFilename = BinaryBlobSidecar::getReferencedFilename(deserializer, filename);
+    test(tgt::FileSystem::cleanupPath(sidecarFilename), tgt::FileSystem::cleanupPath(expectedSidecarFilename), "unexpected sidecar file");
+
+    std::unique_ptr<BinaryBlobSidecarReader> sidecar;
+    if (!sidecarFilename.empty()) {
+        sidecar.reset(new BinaryBlobSidecarReader(sidecarFilename));
+        deserializer.setBinaryBlobSidecarReader(sidecar.get());
+    }
+
+    std::vector<unsigned char> smallResult;
+    std::vector<uint32_t> valuesResult;
+    deserializer.deserializeBinaryBlob("small", smallResult);
+    deserializer.deserializeBinaryBlob("values", valuesResult);
+    test(smallResult == small, "small blob does not match");
+    test(valuesResult == values, "values blob does not match");
+}
+
+/**
+ * Tests round trips of binary blobs that are embedded into the document or stored in a sidecar file,
+ * and that a save replaces the sidecar file of the previous save.
+ */
+template<typename SerializerType, typename DeserializerType>
+void testBinaryBlobSidecar() {
+    const std::string filename = VoreenApplication::app()->getUniqueTmpFilePath(".xml");
+
+    std::vector<unsigned char> small;
+    small.push_back(1);
+    small.push_back(2);
+    small.push_back(3);
+    std::vector<uint32_t> values;
+    for (uint32_t i = 0; i < 1000; i++)
+        values.push_back(i * 2654435761u);
+
+    try {
+        // embedded blobs
+        test(writeBinaryBlobDocument<SerializerType>(filename, small, values, false).empty(), "sidecar file created");
+        readBinaryBlobDocument<DeserializerType>(filename, "", small, values);
+
+        // first save with sidecar
+        std::string firstSidecar = writeBinaryBlobDocument<SerializerType>(filename, small, values, true);
+        test(tgt::FileSystem::fileExists(firstSidecar), "sidecar file missing");
+        readBinaryBlobDocument<DeserializerType>(filename, firstSidecar, small, values);
+
+        // second save with sidecar replaces the first sidecar
+        small.push_back(4);
+        values.resize(500);
+        std::string secondSidecar = writeBinaryBlobDocument<SerializerType>(filename, small, values, true);
+        test(secondSidecar != firstSidecar, "sidecar file name has not changed");
+        test(!tgt::FileSystem::fileExists(firstSidecar), "sidecar file of previous save not deleted");
+        readBinaryBlobDocument<DeserializerType>(filename, secondSidecar, small, values);
+
+        // save without sidecar removes the previous sidecar
+        writeBinaryBlobDocument<SerializerType>(filename, small, values, false);
+        test(!tgt::FileSystem::fileExists(secondSidecar), "sidecar file of previous save not deleted");
+        readBinaryBlobDocument<DeserializerType>(filename, "", small, values);
+    }
+    catch (...) {
+        BinaryBlobSidecar::deleteFiles(filename);
+        tgt::FileSystem::deleteFile(filename);
+        throw;
+    }
+    tgt::FileSystem::deleteFile(filename);
+}
+
 void runXmlTests() {
     // Testing simple data serialization...
     runTest(testSimpleData<XmlSerializer, XmlDeserializer>, "simple data serialization");
@@ -1559,6 +1671,9 @@ void runXmlTests() {
 
     // Testing functionality of bug fixes...
     runTest(testBugAbstractSerializableNullPointerSerialization<XmlSerializer, XmlDeserializer>, "bug fix (serialization of AbstractSerializable 0 pointer)");
+
+    // Testing binary blobs stored in a sidecar file...
+    runTest(testBinaryBlobSidecar<XmlSerializer, XmlDeserializer>, "binary blob sidecar serialization");
 }
 
 void runJsonTests() {
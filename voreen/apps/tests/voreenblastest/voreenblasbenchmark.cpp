@@ -0,0 +1,213 @@
+/***********************************************************************************
+ *                                                                                 *
+ * Voreen - The Volume Rendering Engine                                            *
+ *                                                                                 *
+ * Copyright (C) 2005-2024 University of Muenster, Germany,                        *
+ * Department of Computer Science.                                                 *
+ * For a list of authors please refer to the file "CREDITS.txt".                   *
+ *                                                                                 *
+ * This file is part of the Voreen software package. Voreen is free software:      *
+ * you can redistribute it and/or modify it under the terms of the GNU General     *
+ * Public License version 2 as published by the Free Software Foundation.          *
+ *                                                                                 *
+ * Voreen is distributed in the hope that it will be useful, but WITHOUT ANY       *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR   *
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.      *
+ *                                                                                 *
+ * You should have received a copy of the GNU General Public License in the file   *
+ * "LICENSE.txt" along with this file. If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                                 *
+ * For non-commercial academic use see the license exception specified in the file *
+ * "LICENSE-academic.txt". To get information about commercial licensing please    *
+ * contact the authors.                                                            *
+ *                                                                                 *
+ ***********************************************************************************/
+
+#include "voreen/core/utils/voreenblas/voreenblascpu.h"
+#include "voreen/core/utils/voreenblas/voreenblaskernels.h"
+#ifdef VRN_MODULE_OPENMP
+#include "modules/openmp/include/voreenblasmp.h"
+#endif
+
+#include "voreen/core/voreenapplication.h"
+#include "voreen/core/utils/commandlineparser.h"
+
+#include "tgt/logmanager.h"
+
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <vector>
+
+using namespace voreen;
+
+/**
+ * Micro-benchmark of the CPU implementations of VoreenBlas.
+ *
+ * The operations are performed on the system matrix of a 7-point stencil on a cubic voxel grid,
+ * as set up by the random walker, and on vectors of the corresponding size. For each operation,
+ * the achieved floating point performance and the memory throughput (derived from the minimal
+ * amount of data that has to be transferred) are reported.
+ */
+
+const std::string loggerCat_ = "VoreenBlasBenchmark";
+
+int NUM_REPETITIONS;
+
+void createLaplacian(int dim, EllpackMatrix<float>& mat);
+void benchmark(const std::string& name, double flops, double bytes, std::function<void()> operation);
+void benchmarkBlas(const std::string& name, const VoreenBlas& blas, const EllpackMatrix<float>& mat);
+void benchmarkKernels(const EllpackMatrix<float>& mat);
+
+int main(int argc, char* argv[]) {
+
+    VoreenApplication app("voreenblasbenchmark", "VoreenBlasBenchmark", "", argc, argv, VoreenApplication::APP_ALL);
+    int dim;
+    app.getCommandLineParser()->addOption("dim", dim, CommandLineParser::MainOption, "Edge length of the voxel grid the system matrix is created for", 128, "128");
+    app.getCommandLineParser()->addOption("repetitions", NUM_REPETITIONS, CommandLineParser::MainOption, "Number of executions of each operation", 20, "20");
+    app.initialize();
+
+    if (dim < 2 || NUM_REPETITIONS < 1) {
+        LERROR("Invalid parameters");
+        return 1;
+    }
+
+    EllpackMatrix<float> mat(static_cast<size_t>(dim)*dim*dim, static_cast<size_t>(dim)*dim*dim, 7);
+    try {
+        mat.initializeBuffers();
+    }
+    catch (VoreenException& e) {
+        LERROR(e.what());
+        return 1;
+    }
+    createLaplacian(dim, mat);
+    LINFO("System matrix: " << dim << "^3 rows, " << mat.getNumColsPerRow() << " entries per row");
+
+    VoreenBlasKernels::InstructionSet supported = VoreenBlasKernels::getSupportedInstructionSet();
+    for (int i=VoreenBlasKernels::GENERIC; i<=supported; ++i) {
+        VoreenBlasKernels::setInstructionSet(static_cast<VoreenBlasKernels::InstructionSet>(i));
+        LINFO("");
+        LINFO("Instruction set: " << VoreenBlasKernels::getInstructionSetName(VoreenBlasKernels::getInstructionSet()));
+
+        benchmarkKernels(mat);
+        benchmarkBlas("VoreenBlasCPU", VoreenBlasCPU(), mat);
+#ifdef VRN_MODULE_OPENMP
+        benchmarkBlas("VoreenBlasMP", VoreenBlasMP(), mat);
+#endif
+    }
+
+    app.deinitialize();
+    return 0;
+}
+
+void createLaplacian(int dim, EllpackMatrix<float>& mat) {
+    // Edge weights vary between 0.5 and 1.5, the small regularization keeps the matrix positive definite.
+    const float epsilon = 1e-3f;
+    for (int z=0; z<dim; z++) {
+        for (int y=0; y<dim; y++) {
+            for (int x=0; x<dim; x++) {
+                size_t row = (static_cast<size_t>(z)*dim + y)*dim + x;
+                float diagonal = epsilon;
+
+                const tgt::ivec3 neighbors[6] = { tgt::ivec3(x-1, y, z), tgt::ivec3(x+1, y, z), tgt::ivec3(x, y-1, z),
+                                                  tgt::ivec3(x, y+1, z), tgt::ivec3(x, y, z-1), tgt::ivec3(x, y, z+1) };
+                for (int i=0; i<6; i++) {
+                    const tgt::ivec3& n = neighbors[i];
+                    if (tgt::hor(tgt::lessThan(n, tgt::ivec3(0))) || tgt::hor(tgt::greaterThanEqual(n, tgt::ivec3(dim))))
+                        continue;
+
+                    size_t col = (static_cast<size_t>(n.z)*dim + n.y)*dim + n.x;
+                    float weight = 0.5f + static_cast<float>((std::min(row, col)*7919 + std::max(row, col)) % 1000) / 1000.f;
+                    mat.setValue(row, col, -weight);
+                    diagonal += weight;
+                }
+                mat.setValue(row, row, diagonal);
+            }
+        }
+    }
+}
+
+void benchmark(const std::string& name, double flops, double bytes, std::function<void()> operation) {
+    // warm up
+    operation();
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i=0; i<NUM_REPETITIONS; i++)
+        operation();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / NUM_REPETITIONS;
+
+    LINFO(std::left << std::setw(40) << name << std::right << std::fixed << std::setprecision(3)
+          << std::setw(10) << seconds*1000.0 << " ms"
+          << std::setw(10) << flops / seconds * 1e-9 << " GFLOP/s"
+          << std::setw(10) << bytes / seconds * 1e-9 << " GB/s");
+}
+
+void benchmarkKernels(const EllpackMatrix<float>& mat) {
+    const size_t n = mat.getNumRows();
+    const double k = static_cast<double>(mat.getNumColsPerRow());
+    const double matrixBytes = n*k*(sizeof(float) + sizeof(size_t));
+
+    std::vector<float> p(n, 1.f), Ap(n), x(n, 0.f), r(n, 1.f), z(n), invDiag(n, 0.25f);
+
+    // p.Ap is read from the cache
+    benchmark("fused SpMV + dot", 2.0*n*k + 2.0*n, matrixBytes + 8.0*n, [&] () {
+        VoreenBlasKernels::spMVEll(mat, 0, n, p.data(), Ap.data(), p.data());
+    });
+
+    // x, r, p, Ap, invDiag read, x, r, z written
+    benchmark("fused AXPY + AXPY + Jacobi + dot", 7.0*n, 32.0*n, [&] () {
+        VoreenBlasKernels::updateResidual(0, n, 1e-6f, p.data(), Ap.data(), x.data(), r.data(), invDiag.data(), z.data());
+    });
+
+    benchmark("fused AXPY + AXPY + dot", 6.0*n, 24.0*n, [&] () {
+        VoreenBlasKernels::updateResidual(0, n, 1e-6f, p.data(), Ap.data(), x.data(), r.data(), nullptr, nullptr);
+    });
+
+    benchmark("search direction update", 2.0*n, 12.0*n, [&] () {
+        VoreenBlasKernels::updateDirection(0, n, 0.5f, z.data(), p.data());
+    });
+}
+
+void benchmarkBlas(const std::string& name, const VoreenBlas& blas, const EllpackMatrix<float>& mat) {
+    const size_t n = mat.getNumRows();
+    const double k = static_cast<double>(mat.getNumColsPerRow());
+    const double matrixBytes = n*k*(sizeof(float) + sizeof(size_t));
+
+    std::vector<float> x(n, 1.f), y(n, 2.f), result(n);
+
+    benchmark(name + "::sDOT", 2.0*n, 8.0*n, [&] () {
+        blas.sDOT(n, x.data(), y.data());
+    });
+
+    benchmark(name + "::sNRM2", 2.0*n, 4.0*n, [&] () {
+        blas.sNRM2(n, x.data());
+    });
+
+    benchmark(name + "::sAXPY", 2.0*n, 12.0*n, [&] () {
+        blas.sAXPY(n, x.data(), y.data(), 0.5f, result.data());
+    });
+
+    benchmark(name + "::sSpMVEll", 2.0*n*k, matrixBytes + 8.0*n, [&] () {
+        blas.sSpMVEll(mat, x.data(), result.data());
+    });
+
+    benchmark(name + "::sSpInnerProductEll", 2.0*n*k + 2.0*n, matrixBytes + 8.0*n, [&] () {
+        blas.sSpInnerProductEll(mat, x.data(), y.data());
+    });
+
+    // The solver performs a fixed number of iterations (threshold 0). The setup (e.g., the symmetry check of the matrix)
+    // is measured separately by a run without iterations and subtracted.
+    const int iterations = 10;
+    std::vector<float> rhs(n);
+    for (size_t i=0; i<n; i++)
+        rhs[i] = static_cast<float>(i % 17) - 8.f;
+
+    double seconds[2];
+    for (int run=0; run<2; run++) {
+        auto start = std::chrono::steady_clock::now();
+        blas.sSpConjGradEll(mat, rhs.data(), result.data(), nullptr, VoreenBlas::Jacobi, 0.f, run*iterations);
+        seconds[run] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    LINFO(std::left << std::setw(40) << (name + "::sSpConjGradEll") << std::right << std::fixed << std::setprecision(3)
+          << std::setw(10) << (seconds[1] - seconds[0])*1000.0 / iterations << " ms per iteration (Jacobi)");
+}
@@ -179,6 +179,10 @@ int main(int argc, char* argv[]) {
     cmdParser->addFlagOption("trigger-geometrysaves", triggerGeometrySaves, CommandLineParser::MainOption,
         "Trigger a \"save file\" event on all GeometrySave and TextSave processors after the network has been evaluated.");
 
+    bool concurrentProcessing = false;
+    cmdParser->addFlagOption("concurrent-processing", concurrentProcessing, CommandLineParser::MainOption,
+        "Evaluate independent processors of the network concurrently. Rendering processors are still evaluated sequentially.");
+
     std::string scriptFilename;
     std::vector<std::string> scriptArgs;
 #ifdef VRN_MODULE_PYTHON
@@ -251,6 +255,7 @@ int main(int argc, char* argv[]) {
 
     // create network evaluator
     networkEvaluator_ = new NetworkEvaluator(glMode);
+    networkEvaluator_->setConcurrentProcessing(concurrentProcessing);
     vrnApp.registerNetworkEvaluator(networkEvaluator_);
 
     // load and execute workspace, if specified
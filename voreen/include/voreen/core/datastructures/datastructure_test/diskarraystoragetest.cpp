@@ -39,6 +39,7 @@ namespace tgt{
 #include "diskarraystorage.h"
 
 #include <random>
+#include <thread>
 
 template<typename T>
 bool testBuilder(int maxElements, int numVectors, std::function<T()> random, std::default_random_engine& generator) {
@@ -128,11 +129,76 @@ bool testStore(int maxElements, int numVectors, std::function<T()> random, std::
     return true;
 }
 
+template<typename T>
+bool testConcurrentStore(int maxElements, int numVectors, std::function<T()> random, std::default_random_engine& generator) {
+    // Use a small first chunk so that ranges are skipped, early arrays exceed the chunk size and many chunks are created
+    ConcurrentDiskArrayStorage<T> storage("test.tmp", maxElements/2 + 1);
+    const int numThreads = 4;
+    std::vector<std::vector<T>> vectors;
+    std::vector<DiskArray<T>> arrays(numVectors);
+    std::vector<T> elements;
+    std::vector<size_t> elementPositions(numVectors);
+
+    std::uniform_int_distribution<int> dist(0,maxElements);
+
+    for(int i=0; i<numVectors; ++i) {
+        std::vector<T> vec;
+        for(int j=0; j<dist(generator); ++j) {
+            vec.push_back(random());
+        }
+        vectors.push_back(std::move(vec));
+        elements.push_back(random());
+    }
+
+    std::vector<std::thread> threads;
+    for(int t=0; t<numThreads; ++t) {
+        threads.emplace_back([&, t] () {
+            for(int i=t; i<numVectors; i+=numThreads) {
+                arrays[i] = storage.store(vectors[i]);
+                elementPositions[i] = storage.storeElement(elements[i]);
+            }
+        });
+    }
+    for(auto& thread : threads) {
+        thread.join();
+    }
+
+    for (size_t i = 0; i < vectors.size(); i++) {
+        const auto& vec = vectors[i];
+        const auto& arr = arrays[i];
+        if(vec.size() != arr.size()) {
+            std::cerr << "Fail!" << std::endl;
+            std::cerr << "Expected: Array size " << vec.size() << std::endl;
+            std::cerr << "Found   : Array size " << arr.size() << std::endl;
+            assert(false);
+            return false;
+        }
+        for(int j=0; j<vec.size(); ++j) {
+            if(vec[j] != arr[j]) {
+                std::cerr << "Fail at pos " << j << " in array " << i << "!" << std::endl;
+                std::cerr << "Expected: " << +vec[j] << std::endl;
+                std::cerr << "Found   : " << +arr[j] << std::endl;
+                assert(false);
+                return false;
+            }
+        }
+        if(elements[i] != storage[elementPositions[i]]) {
+            std::cerr << "Fail at element " << i << "!" << std::endl;
+            std::cerr << "Expected: " << +elements[i] << std::endl;
+            std::cerr << "Found   : " << +storage[elementPositions[i]] << std::endl;
+            assert(false);
+            return false;
+        }
+    }
+    return true;
+}
+
 template<typename T>
 bool test(int maxElements, int numVectors, std::function<T()> random, std::default_random_engine& generator) {
     bool res = true;
     res &= testBuilder(maxElements, numVectors, random, generator);
     res &= testStore(maxElements, numVectors, random, generator);
+    res &= testConcurrentStore(maxElements, numVectors, random, generator);
     return res;
 }
 
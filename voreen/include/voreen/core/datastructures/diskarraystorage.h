@@ -29,6 +29,10 @@
 #include <string>
 #include <vector>
 #include <fstream>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <boost/iostreams/device/mapped_file.hpp>
 #include "tgt/filesystem.h"
 
@@ -148,6 +152,82 @@ private:
     size_t physicalFileSize_;
 };
 
+/**
+ * Append-only variant of DiskArrayStorage that can be filled from multiple threads at once.
+ *
+ * Elements are stored in chunks, which are created on first use. Each chunk is twice as large as
+ * its predecessor, so small storages stay small while large ones need few chunks. Each chunk is backed
+ * by its own file which is grown to its final size and mapped exactly once, so existing data never moves
+ * and returned DiskArrays as well as references to stored elements stay valid while other threads keep
+ * appending. Writers reserve ranges by advancing an atomic cursor; a range never spans two chunks (the
+ * remainder of a chunk is skipped instead). Arrays that are larger than the current chunk are placed in
+ * a dedicated file.
+ */
+template<typename Element>
+class ConcurrentDiskArrayStorage {
+public:
+    /**
+     * @param firstChunkElements capacity of the first chunk. If 0, a first chunk of roughly
+     *        FIRST_CHUNK_BYTES is used.
+     */
+    ConcurrentDiskArrayStorage(const std::string& storagefilename, size_t firstChunkElements = 0);
+    ~ConcurrentDiskArrayStorage();
+
+    // Note: The store must live longer than the returned DiskArray!
+    // Threadsafe.
+    DiskArray<Element> store(const std::vector<Element>& elements);
+    DiskArray<Element> store(const DiskArray<Element>& elements);
+
+    // Only store a single Element and return the storage position with which it can be retrieved.
+    // Threadsafe.
+    size_t storeElement(const Element& elm);
+    size_t storeElement(Element&& elm);
+
+    // Number of reserved storage positions in the chunks. Note that positions at the end of
+    // chunks may be skipped, i.e., this is an upper bound for the number of stored elements.
+    size_t size() const;
+
+    // Only valid for positions returned by storeElement. May be used concurrently with storing.
+    const Element& operator[](size_t index) const;
+    Element& operator[](size_t index);
+
+    static const size_t FIRST_CHUNK_BYTES = 64 << 10;
+    static const size_t MAX_CHUNKS = 32;
+
+private:
+    struct Chunk {
+        std::atomic<boost::iostreams::mapped_file*> file_;
+        // Number of positions (from the chunk begin) that are actually used once the chunk is full
+        std::atomic<size_t> numUsed_;
+    };
+
+    template<typename Arr>
+    DiskArray<Element> store_internal(const Arr& array);
+
+    // Reserves numElements consecutive positions within one chunk. numElements must not exceed
+    // the capacity of the chunk containing the cursor at the time of the call.
+    size_t reserve(size_t numElements);
+    // Index of the chunk containing the specified storage position
+    size_t getChunkIndex(size_t position) const;
+    // First storage position of the specified chunk
+    size_t getChunkBegin(size_t chunkIndex) const;
+    size_t getChunkCapacity(size_t chunkIndex) const;
+    // Returns the mapping of the specified chunk, creating it if necessary
+    boost::iostreams::mapped_file* getChunkFile(size_t chunkIndex);
+    boost::iostreams::mapped_file* createFile(const std::string& fileName, size_t numElements) const;
+    void destroyFile(boost::iostreams::mapped_file* file, const std::string& fileName, size_t numElements) const;
+    std::string getChunkFileName(size_t chunkIndex) const;
+    std::string getLargeArrayFileName(size_t arrayIndex) const;
+
+    const std::string storagefilename_;
+    const size_t firstChunkElements_;
+    std::unique_ptr<Chunk[]> chunks_;
+    std::atomic<size_t> cursor_;
+
+    std::mutex mutex_; ///< guards the creation of chunks and largeArrays_
+    std::vector<std::pair<boost::iostreams::mapped_file*, size_t>> largeArrays_;
+};
+
 template<typename Element>
 class DiskArrayBuilder {
 public:
@@ -559,4 +639,214 @@ DiskArray<Element> DiskArrayBuilder<Element>::finalize() && {
     return DiskArray<Element>(&storage_.file_, begin_, end_);
 }
 
+/// Impl: ConcurrentDiskArrayStorage -------------------------------------------
+template<typename Element>
+ConcurrentDiskArrayStorage<Element>::ConcurrentDiskArrayStorage(const std::string& storagefilename, size_t firstChunkElements)
+    : storagefilename_(storagefilename)
+    , firstChunkElements_(firstChunkElements > 0 ? firstChunkElements : std::max<size_t>(1, FIRST_CHUNK_BYTES / sizeof(Element)))
+    , chunks_(new Chunk[MAX_CHUNKS])
+    , cursor_(0)
+    , mutex_()
+    , largeArrays_()
+{
+    for(size_t i=0; i<MAX_CHUNKS; ++i) {
+        chunks_[i].file_.store(nullptr);
+        chunks_[i].numUsed_.store(getChunkCapacity(i));
+    }
+}
+
+template<typename Element>
+ConcurrentDiskArrayStorage<Element>::~ConcurrentDiskArrayStorage() {
+    size_t numReserved = cursor_.load();
+    for(size_t i=0; i<MAX_CHUNKS; ++i) {
+        boost::iostreams::mapped_file* file = chunks_[i].file_.load();
+        if(file) {
+            tgtAssert(numReserved > getChunkBegin(i), "Chunk was created without reservation");
+            size_t numUsed = std::min(chunks_[i].numUsed_.load(), numReserved - getChunkBegin(i));
+            destroyFile(file, getChunkFileName(i), numUsed);
+        }
+    }
+    for(size_t i=0; i<largeArrays_.size(); ++i) {
+        destroyFile(largeArrays_[i].first, getLargeArrayFileName(i), largeArrays_[i].second);
+    }
+}
+
+template<typename Element>
+size_t ConcurrentDiskArrayStorage<Element>::getChunkIndex(size_t position) const {
+    // chunk k covers the positions [firstChunkElements_ * (2^k - 1), firstChunkElements_ * (2^(k+1) - 1))
+    size_t q = position / firstChunkElements_ + 1;
+    size_t chunkIndex = 0;
+    while(q >>= 1) {
+        ++chunkIndex;
+    }
+    return chunkIndex;
+}
+
+template<typename Element>
+size_t ConcurrentDiskArrayStorage<Element>::getChunkBegin(size_t chunkIndex) const {
+    return firstChunkElements_ * ((static_cast<size_t>(1) << chunkIndex) - 1);
+}
+
+template<typename Element>
+size_t ConcurrentDiskArrayStorage<Element>::getChunkCapacity(size_t chunkIndex) const {
+    return firstChunkElements_ << chunkIndex;
+}
+
+template<typename Element>
+std::string ConcurrentDiskArrayStorage<Element>::getChunkFileName(size_t chunkIndex) const {
+    return storagefilename_ + "." + std::to_string(chunkIndex);
+}
+
+template<typename Element>
+std::string ConcurrentDiskArrayStorage<Element>::getLargeArrayFileName(size_t arrayIndex) const {
+    return storagefilename_ + ".large" + std::to_string(arrayIndex);
+}
+
+template<typename Element>
+boost::iostreams::mapped_file* ConcurrentDiskArrayStorage<Element>::createFile(const std::string& fileName, size_t numElements) const {
+    growFile(fileName, numElements * sizeof(Element));
+
+    boost::iostreams::mapped_file_params openParams;
+    openParams.path = fileName;
+    openParams.mode = std::ios::in | std::ios::out;
+
+    boost::iostreams::mapped_file* file = new boost::iostreams::mapped_file(openParams);
+    tgtAssert(file->is_open(), "File not open");
+    return file;
+}
+
+template<typename Element>
+void ConcurrentDiskArrayStorage<Element>::destroyFile(boost::iostreams::mapped_file* file, const std::string& fileName, size_t numElements) const {
+    Element* data = reinterpret_cast<Element*>(file->data());
+    for(size_t i=0; i<numElements; ++i) {
+        // Call destructor explicitly, because the elements will be dropped now.
+        data[i].~Element();
+    }
+    file->close();
+    delete file;
+    tgt::FileSystem::deleteFile(fileName);
+}
+
+template<typename Element>
+size_t ConcurrentDiskArrayStorage<Element>::reserve(size_t numElements) {
+    size_t pos = cursor_.load();
+    tgtAssert(numElements > 0 && numElements <= getChunkCapacity(getChunkIndex(pos)), "Invalid number of elements");
+    size_t begin, end;
+    do {
+        // Skip the rest of the current chunk if the range does not fit in anymore. The cursor only
+        // advances and chunks only grow, so the range always fits into the following chunk.
+        size_t chunkEnd = getChunkBegin(getChunkIndex(pos) + 1);
+        begin = pos + numElements > chunkEnd ? chunkEnd : pos;
+        end = begin + numElements;
+    } while(!cursor_.compare_exchange_weak(pos, end));
+
+    if(begin != pos) {
+        // We are the (only) writer that closed the previous chunk: Remember its actual fill level.
+        size_t skippedChunk = getChunkIndex(pos);
+        if(skippedChunk < MAX_CHUNKS) {
+            chunks_[skippedChunk].numUsed_.store(pos - getChunkBegin(skippedChunk));
+        }
+    }
+    if(getChunkIndex(begin) >= MAX_CHUNKS) {
+        throw std::length_error("ConcurrentDiskArrayStorage: Maximum number of chunks exceeded");
+    }
+    return begin;
+}
+
+template<typename Element>
+boost::iostreams::mapped_file* ConcurrentDiskArrayStorage<Element>::getChunkFile(size_t chunkIndex) {
+    tgtAssert(chunkIndex < MAX_CHUNKS, "Invalid chunk index");
+    Chunk& chunk = chunks_[chunkIndex];
+    boost::iostreams::mapped_file* file = chunk.file_.load(std::memory_order_acquire);
+    if(!file) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        file = chunk.file_.load(std::memory_order_relaxed);
+        if(!file) {
+            file = createFile(getChunkFileName(chunkIndex), getChunkCapacity(chunkIndex));
+            chunk.file_.store(file, std::memory_order_release);
+        }
+    }
+    return file;
+}
+
+template<typename Element>
+DiskArray<Element> ConcurrentDiskArrayStorage<Element>::store(const std::vector<Element>& elements) {
+    return store_internal(elements);
+}
+
+template<typename Element>
+DiskArray<Element> ConcurrentDiskArrayStorage<Element>::store(const DiskArray<Element>& elements) {
+    return store_internal(elements);
+}
+
+template<typename Element>
+template<typename Arr>
+DiskArray<Element> ConcurrentDiskArrayStorage<Element>::store_internal(const Arr& array) {
+    if(array.empty()) {
+        return DiskArray<Element>(nullptr, 0, 0);
+    } else if(array.size() > getChunkCapacity(getChunkIndex(cursor_.load()))) {
+        boost::iostreams::mapped_file* file = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            file = createFile(getLargeArrayFileName(largeArrays_.size()), array.size());
+            largeArrays_.push_back(std::make_pair(file, array.size()));
+        }
+        std::uninitialized_copy(array.begin(), array.end(), reinterpret_cast<Element*>(file->data()));
+        return DiskArray<Element>(file, 0, array.size());
+    } else {
+        size_t begin = reserve(array.size());
+        size_t chunkIndex = getChunkIndex(begin);
+        size_t chunkBegin = begin - getChunkBegin(chunkIndex);
+
+        boost::iostreams::mapped_file* file = getChunkFile(chunkIndex);
+        std::uninitialized_copy(array.begin(), array.end(), reinterpret_cast<Element*>(file->data()) + chunkBegin);
+
+        return DiskArray<Element>(file, chunkBegin, chunkBegin + array.size());
+    }
+}
+
+template<typename Element>
+size_t ConcurrentDiskArrayStorage<Element>::storeElement(const Element& elm) {
+    return storeElement(std::move(Element(elm))); // We need to explicitly move here for MSVC.
+}
+
+template<typename Element>
+size_t ConcurrentDiskArrayStorage<Element>::storeElement(Element&& elm) {
+    size_t index = reserve(1);
+    size_t chunkIndex = getChunkIndex(index);
+    boost::iostreams::mapped_file* file = getChunkFile(chunkIndex);
+
+    //Move construct the new element in-place in its chunk.
+    new (reinterpret_cast<Element*>(file->data()) + (index - getChunkBegin(chunkIndex))) Element(std::move(elm));
+
+    return index;
+}
+
+template<typename Element>
+size_t ConcurrentDiskArrayStorage<Element>::size() const {
+    return cursor_.load();
+}
+
+template<typename Element>
+const Element& ConcurrentDiskArrayStorage<Element>::operator[](size_t index) const {
+    tgtAssert(index < cursor_.load(), "Invalid index");
+    size_t chunkIndex = getChunkIndex(index);
+    tgtAssert(chunkIndex < MAX_CHUNKS, "Invalid index");
+    const boost::iostreams::mapped_file* file = chunks_[chunkIndex].file_.load(std::memory_order_acquire);
+    tgtAssert(file, "Chunk not mapped");
+    const Element* data = reinterpret_cast<const Element*>(file->const_data());
+    return data[index - getChunkBegin(chunkIndex)];
+}
+
+template<typename Element>
+Element& ConcurrentDiskArrayStorage<Element>::operator[](size_t index) {
+    tgtAssert(index < cursor_.load(), "Invalid index");
+    size_t chunkIndex = getChunkIndex(index);
+    tgtAssert(chunkIndex < MAX_CHUNKS, "Invalid index");
+    boost::iostreams::mapped_file* file = chunks_[chunkIndex].file_.load(std::memory_order_acquire);
+    tgtAssert(file, "Chunk not mapped");
+    Element* data = reinterpret_cast<Element*>(file->data());
+    return data[index - getChunkBegin(chunkIndex)];
+}
+
 #endif
\ No newline at end of file
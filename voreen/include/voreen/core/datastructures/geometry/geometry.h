@@ -131,6 +131,14 @@ public:
      */
     virtual std::string getHash() const;
 
+    /**
+     * Returns an estimate of the main memory (in bytes) occupied by the geometry,
+     * which is used for limiting the memory cache.
+     *
+     * The default implementation returns 0, meaning that the size is unknown.
+     */
+    virtual size_t getMemorySize() const;
+
     /**
      * Indicates whether this geometry or parts of it are transparent.
      *
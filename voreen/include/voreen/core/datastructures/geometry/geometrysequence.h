@@ -71,6 +71,9 @@ public:
 
     virtual tgt::Bounds getBoundingBox(bool transformed = true) const;
 
+    /// Returns the sum of the sizes of the contained geometries, or 0 if any of them is unknown.
+    virtual size_t getMemorySize() const;
+
     virtual void serialize(Serializer& s) const;
     virtual void deserialize(Deserializer& s);
 private:
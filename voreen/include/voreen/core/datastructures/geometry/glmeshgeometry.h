@@ -301,6 +301,9 @@ public:
     /// Returns the bounding box in model or transformed coordinates. The BB is cached internally.
     virtual tgt::Bounds getBoundingBox(bool transformed = true) const;
 
+    /// Returns the size of the vertex and index buffers in main memory.
+    virtual size_t getMemorySize() const;
+
     virtual size_t getNumVertices() const;
     virtual size_t getNumIndices() const;
 
@@ -1148,6 +1151,11 @@ tgt::Bounds GlMeshGeometry<I, V>::getBoundingBox(bool transformed) const {
         return boundingBox_;
 }
 
+template <class I, class V>
+size_t GlMeshGeometry<I, V>::getMemorySize() const {
+    return sizeof(*this) + vertices_.capacity() * sizeof(VertexType) + indices_.capacity() * sizeof(I);
+}
+
 template <class I, class V>
 void GlMeshGeometry<I, V>::serialize(Serializer& s) const {
     GlMeshGeometryBase::serialize(s);
@@ -124,6 +124,10 @@ public:
             return bounds;
     }
 
+    virtual size_t getMemorySize() const {
+        return sizeof(*this) + points_.capacity() * sizeof(T);
+    }
+
     virtual void serialize(Serializer& s) const {
         s.serialize("points", points_);
         Geometry::serialize(s);
@@ -163,6 +163,13 @@ public:
             return bounds;
     }
 
+    virtual size_t getMemorySize() const {
+        size_t size = sizeof(*this) + segmentList_.capacity() * sizeof(std::vector<T>) + pointList_.capacity() * sizeof(T);
+        for (size_t i=0; i<segmentList_.size(); i++)
+            size += segmentList_[i].capacity() * sizeof(T);
+        return size;
+    }
+
     virtual void serialize(Serializer& s) const {
         s.serialize("segments", segmentList_);
         Geometry::serialize(s);
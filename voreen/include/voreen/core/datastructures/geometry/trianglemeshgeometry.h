@@ -158,6 +158,9 @@ public:
     /// Returns the bounding box in model or transformed coordinates. The BB is cached internally.
     virtual tgt::Bounds getBoundingBox(bool transformed = true) const;
 
+    /// Returns the size of the triangle list in main memory.
+    virtual size_t getMemorySize() const;
+
     /// Serializes the triangles as binary blob.
     virtual void serialize(Serializer& s) const;
 
@@ -311,6 +314,11 @@ tgt::Bounds TriangleMeshGeometry<V>::getBoundingBox(bool transformed) const {
         return boundingBox_;
 }
 
+template <class V>
+size_t TriangleMeshGeometry<V>::getMemorySize() const {
+    return sizeof(*this) + triangles_.capacity() * sizeof(TriangleType);
+}
+
 template <class V>
 void TriangleMeshGeometry<V>::serialize(Serializer& s) const {
     TriangleMeshGeometryBase::serialize(s);
@@ -104,6 +104,7 @@ void BrickPoolManagerQueue<T>::remove(BrickPoolManagerQueueNode<T>* node) {
     node->previous_->next_ = node->next_;
     node->next_->previous_ = node->previous_;
     delete node;
+    size_--;
 }
 
 template<class T>
@@ -32,6 +32,8 @@
 
 #include <vector>
 #include <string>
+#include <functional>
+#include <future>
 
 #include <boost/thread/mutex.hpp>
 #include "tgt/vector.h"
@@ -149,6 +151,24 @@ public:
      */
     virtual bool isBrickInRAM(uint64_t virtualMemoryAddress) const = 0;
 
+    /**
+     * Asynchronously loads the bricks stored at the passed virtual memory addresses into RAM.
+     * The bricks are loaded in the passed order by a pool of I/O threads, requests are served
+     * in the order of their submission. Bricks that are already in RAM are skipped.
+     *
+     * @param callback is called by an I/O thread after all bricks of the request have been processed. May be empty.
+     * @return future that becomes ready after all bricks of the request have been processed
+     *      or the request has been cancelled
+     */
+    std::shared_future<void> prefetchBricks(const std::vector<uint64_t>& virtualMemoryAddresses,
+                                            const std::function<void()>& callback = std::function<void()>()) const;
+
+    /**
+     * Discards all pending prefetch requests and waits until the bricks currently
+     * being loaded by the I/O threads have been loaded.
+     */
+    void cancelPrefetching() const;
+
     /**
      * Flushes all unwritten bricks to the disk, thereby making sure that the
      * entire brick pool is persistently stored.
@@ -189,12 +209,29 @@ public:
     virtual void deinitialize();
 
 protected:
+    /**
+     * Loads the brick stored at the passed address into RAM. Called by the I/O threads of prefetchBricks().
+     * The default implementation acquires and releases the brick without blocking, if it is not yet in RAM.
+     */
+    virtual void prefetchBrick(uint64_t virtualMemoryAddress) const;
+
     static const std::string loggerCat_;
 
 private:
+    /// I/O threads and request queue of prefetchBricks(), created on first use.
+    struct BrickPrefetcher;
+
+    /// Function of the I/O threads.
+    void processPrefetchRequests() const;
+
+    static const size_t NUM_PREFETCH_THREADS;
+
     size_t brickMemorySizeInByte_;  ///< number of bytes of one brick
 
     bool initialized_;              ///< true, if the manager has been initialized (by the octree)
+
+    mutable BrickPrefetcher* prefetcher_;
+    mutable boost::mutex prefetcherCreationMutex_;
 };
 
 //-------------------------------------------------------------------------------------------------
@@ -121,6 +121,7 @@ class VRN_CORE_API OctreeBrickPoolManagerDisk : public OctreeBrickPoolManagerBas
      */
     struct BufferEntry {
         bool isInRAM_;                               //<
+        bool isLoading_;                             //< flag, if the buffer is being read from disk (outside of the lock)
         bool mustBeSavedToDisk_;                     //< flag, if the buffer must be saved to disk
         char* data_;                                 //< pointer to the buffer data
         uint8_t inUse_;                              //< counter of handels using the buffer
@@ -129,6 +130,7 @@ class VRN_CORE_API OctreeBrickPoolManagerDisk : public OctreeBrickPoolManagerBas
 
         BufferEntry(size_t numberOfBricks, char* data, BrickPoolManagerQueueNode<size_t>* node)
             : isInRAM_(false)
+            , isLoading_(false)
             , mustBeSavedToDisk_(false)
             , data_(data)
             , inUse_(0)
@@ -143,6 +145,14 @@ class VRN_CORE_API OctreeBrickPoolManagerDisk : public OctreeBrickPoolManagerBas
     };
 
 public:
+    /**
+     * Codec used for storing the bricks in the buffer files.
+     */
+    enum BrickCompression {
+        COMPRESSION_NONE = 0,   ///< buffer files are plain copies of the RAM buffers
+        COMPRESSION_LZ4 = 1     ///< bricks are LZ4 compressed separately (requires the bigdataimageprocessing module)
+    };
+
     /** Constructor */
     OctreeBrickPoolManagerDisk(const size_t maxSingleBufferSize, const size_t ramLimit,
                                const std::string& brickPoolPath, const std::string& bufferFilePrefix = "");
@@ -156,6 +166,19 @@ public:
     /// Sets the maximum amount of RAM in bytes the brick pool manager is allowed to use.
     void setRAMLimit(size_t ramLimitInBytes);
 
+    /**
+     * Sets the codec used for the buffer files. Has to be called before the manager is initialized.
+     *
+     * @throw VoreenException if the codec is not supported by this build
+     */
+    void setBrickCompression(BrickCompression compression);
+
+    /// Returns the codec used for the buffer files.
+    BrickCompression getBrickCompression() const;
+
+    /// Returns whether the passed codec is available in this build.
+    static bool isBrickCompressionSupported(BrickCompression compression);
+
     //brick interaction
     bool isBrickInRAM(uint64_t virtualMemoryAddress) const;
 
@@ -198,16 +221,40 @@ private:
     /// Disk Interaction
     /**
      * Loads a single buffer from the disk.
+     * The buffer slot is reserved under the passed lock, which is released while the
+     * buffer file is read and decompressed and re-acquired to publish the buffer.
      * @note This function is not protected by a mutex.
      */
     BufferEntry* loadBufferFromDisk(size_t bufferID, bool blocking, boost::unique_lock<boost::mutex> &lock) const;
 
+    /**
+     * Reads (and decompresses) the passed buffer file into a newly allocated RAM buffer.
+     * @note Accesses no shared state except for constant members, so it may be called without the lock.
+     */
+    char* readBufferFile(const std::string& bufferFile) const;
+
     /**
      * Saves a single buffer to the disk.
      * @note This function is not protected by a mutex.
      */
     void saveBufferToDisk(const size_t bufferID) const;
 
+    /**
+     * Encodes a RAM buffer into the content of a compressed buffer file:
+     * An index of numBrickSlotsPerBuffer_+1 uint64_t file offsets is followed by the brick data.
+     * Bricks that do not shrink are stored uncompressed.
+     */
+    void compressBuffer(const char* data, std::vector<char>& fileContent) const;
+
+    /**
+     * Decodes the content of a compressed buffer file into a RAM buffer.
+     * @throw VoreenException if the file content is corrupt
+     */
+    void decompressBuffer(const std::vector<char>& fileContent, char* data) const;
+
+    /// Writes the passed data to the file of the buffer and marks the buffer as saved.
+    void writeBufferFile(size_t bufferID, const char* data, size_t numBytes) const;
+
     //--------------------
     //  members
     //--------------------
@@ -225,6 +272,7 @@ private:
     uint64_t nextVirtualMemoryAddress_;         //< virtual memory address of next allocated brick
 
     std::vector<std::string> bufferFiles_;      //< disk files storing the brick buffers
+    BrickCompression brickCompression_;         //< codec of the buffer files
 
     ///brick ram management
     mutable size_t numBuffersInRAM_;                               //<
@@ -92,6 +92,10 @@ public:
     virtual void initialize(size_t brickMemorySizeInByte);
     virtual void deinitialize();
 
+protected:
+    /// Touches the pages of the brick so that the OS reads them in ahead of the actual access.
+    virtual void prefetchBrick(uint64_t virtualMemoryAddress) const;
+
 private:
 
     std::string brickPoolPath_;                 //< directory where the buffer files are stored
@@ -153,6 +153,15 @@ protected:
     static const std::string loggerCat_;
 
 private:
+    /**
+     * Prefetches the bricks accessed by composeNodeTexture() in a lookahead window of bounded size,
+     * which is moved forward as the bricks are consumed.
+     */
+    class BrickPrefetchWindow;
+
+    /// Maximum number of bricks prefetched ahead of the brick currently composed by createVolume().
+    static const size_t PREFETCH_WINDOW_SIZE;
+
     void buildOctreeIteratively(const std::vector<const VolumeBase*>& volumes, bool octreeOptimization,
             uint16_t homogeneityThreshold, HalfSampleAggregateFunction halfSampleFn, size_t numThreads,
             ProgressReporter* progessReporter);
@@ -162,13 +171,23 @@ private:
         size_t& resultLevel, tgt::svec3& resultLlf, tgt::svec3& resultUrb) const;
 
     void composeNodeTexture(const VolumeOctreeNode* node, const tgt::svec3& nodeOffset, size_t curLevel, size_t targetLevel,
-        uint16_t* textureBuffer, const tgt::svec3& textureDim, clock_t timeLimit, tgt::Stopwatch& runtimeWatch, bool& complete) const;
+        uint16_t* textureBuffer, const tgt::svec3& textureDim, clock_t timeLimit, tgt::Stopwatch& runtimeWatch, bool& complete,
+        BrickPrefetchWindow& prefetchWindow) const;
 
     void composeNodeSliceTexture(SliceAlignment sliceAlignment, const VolumeOctreeNode* node,
         const tgt::svec3& nodeOffsetInTexture, size_t sliceIndexInNode, size_t curLevel, size_t targetLevel,
         uint16_t* textureBuffer, const tgt::svec3& textureDim, clock_t timeLimit, tgt::Stopwatch& runtimeWatch,
         bool& complete, const tgt::svec3 begin, const tgt::svec3 end) const;
 
+    /// Collects the addresses of the bricks that composeNodeTexture() will access at the target level.
+    void collectNodeBrickAddresses(const VolumeOctreeNode* node, size_t curLevel, size_t targetLevel,
+        std::vector<uint64_t>& brickAddresses) const;
+
+    /// Collects the addresses of the bricks that composeNodeSliceTexture() will access at the target level.
+    void collectNodeSliceBrickAddresses(SliceAlignment sliceAlignment, const VolumeOctreeNode* node,
+        const tgt::svec3& nodeOffsetInTexture, size_t sliceIndexInNode, size_t curLevel, size_t targetLevel,
+        const tgt::svec3& begin, const tgt::svec3& end, std::vector<uint64_t>& brickAddresses) const;
+
     // low-level helper functions
     template<class T>
     VolumeOctreeNode* createTreeNodeFromTexture(const tgt::svec3& llf, const tgt::svec3& urb,
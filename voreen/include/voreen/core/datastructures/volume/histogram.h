@@ -304,6 +304,16 @@ class Histogram1DGeneric : public HistogramGeneric<T, 1> {
         void addSample(T value) {
             HistogramGeneric<T, 1>::addSample(static_cast<double>(value));
         }
+
+        /// Adds the passed value count times.
+        void addSamples(T value, uint64_t count) {
+            HistogramGeneric<T, 1>::increaseBucket(HistogramGeneric<T, 1>::mapValueToBucket(value, 0), count);
+        }
+
+        /// Returns the index of the bucket the passed value is sorted into.
+        int getBucketIndex(T value) const {
+            return HistogramGeneric<T, 1>::mapValueToBucket(value, 0);
+        }
         T getMinValue() const {
             return HistogramGeneric<T, 1>::getMinValue(0);
         }
@@ -323,6 +333,15 @@ class VRN_CORE_API Histogram1D : public Histogram1DGeneric<float> {
 VRN_CORE_API Histogram1D createHistogram1DFromVolume(const VolumeBase* handle, size_t bucketCount, size_t channel = 0);
 VRN_CORE_API Histogram1D createHistogram1DFromVolume(const VolumeBase* handle, size_t bucketCount, float realWorldMin, float realWorldMax, size_t channel = 0);
 
+/**
+ * Adds the real world values of the specified channel of the passed RAM volume to the histogram.
+ * For VolumeAtomic volumes, a kernel specialized for the voxel type is used, which bins
+ * the voxels in parallel into per-thread histograms (if OpenMP is available).
+ *
+ * @note this function is an interruption point
+ */
+VRN_CORE_API void addVolumeToHistogram1D(Histogram1D& histogram, const VolumeRAM* volume, const RealWorldMapping& rwm, size_t channel = 0);
+
 
 //--------------------------------------------------------------------------
 
@@ -368,6 +387,9 @@ public:
      */
     virtual VolumeDerivedData* createFrom(const VolumeBase* handle) const;
 
+    /// @see VolumeDerivedData
+    virtual VolumeDerivedDataSweepAccumulator* createSweepAccumulator(const VolumeBase* handle) const;
+
     /// Returns the number of channel histograms stored in this derived data.
     size_t getNumChannels() const;
 
@@ -28,24 +28,184 @@
 
 #include "voreen/core/datastructures/volume/volumeoperator.h"
 
+#include <cstdint>
+#include <memory>
+#include <vector>
+
 namespace voreen {
 
-/// Computes connected component analysis and returns a volume (of type uint16) containing the component IDs at each voxel
+/// Properties of a single connected component, in voxel coordinates.
+struct VRN_CORE_API ConnectedComponentStatistics {
+    ConnectedComponentStatistics();
+
+    uint64_t numVoxels;
+    tgt::svec3 llf;         ///< lower left front corner of the bounding box (inclusive)
+    tgt::svec3 urb;         ///< upper right back corner of the bounding box (inclusive)
+    tgt::dvec3 centroid;    ///< mean voxel position
+};
+
+/**
+ * Type independent part of the block-parallel two-pass connected component labeling
+ * used by VolumeOperatorConnectedComponentAnalysisGeneric.
+ *
+ * The volume is split into slabs of slices which are labeled independently (and concurrently)
+ * using a union-find structure, yielding labels that are local to the slab. Afterwards, components
+ * touching across slab boundaries are merged by a second union-find structure over all slab labels.
+ * The final labels are consecutive and ordered by the first voxel of each component in scan order,
+ * i.e., they are identical to those of a sequential labeling.
+ */
+class VRN_CORE_API ConnectedComponentLabeling {
+public:
+    /**
+     * @param connectivity 6, 18 or 26
+     */
+    ConnectedComponentLabeling(const tgt::svec3& dim, int connectivity);
+
+    size_t getNumSlabs() const;
+
+    /**
+     * First pass: Labels the voxels of the passed slab by consecutive labels local to the slab
+     * (0 for background). May be called concurrently for different slabs.
+     *
+     * @param labels label array of the whole volume
+     * @param isForeground functor returning whether the voxel with the passed linear index is foreground
+     */
+    template<typename Foreground>
+    void labelSlab(size_t slab, uint32_t* labels, const Foreground& isForeground);
+
+    /**
+     * Second pass: Merges the components of all slabs and replaces the local by the final labels.
+     *
+     * @param stretchLabels if true, the labels are spread over the whole uint32 range
+     * @param statistics if not null, receives the statistics of each component (index = label - 1)
+     *
+     * @return the number of components
+     * @throws VoreenException if the number of components exceeds the uint32 range
+     */
+    uint32_t merge(uint32_t* labels, bool stretchLabels, std::vector<ConnectedComponentStatistics>* statistics = 0);
+
+private:
+    /// Returns the representative (the smallest label) of the passed label's set.
+    template<typename L>
+    static L findRoot(std::vector<L>& parent, L label);
+
+    /// Merges the sets of both labels and returns the representative of the merged set.
+    template<typename L>
+    static L unite(std::vector<L>& parent, L a, L b);
+
+    size_t index(size_t x, size_t y, size_t z) const {
+        return (z*dim_.y + y)*dim_.x + x;
+    }
+
+    tgt::svec3 dim_;
+    std::vector<tgt::ivec3> backwardNeighbors_; ///< neighbors that precede a voxel in scan order
+    std::vector<size_t> slabBegin_;             ///< first slice of each slab, followed by dim.z
+    std::vector<uint32_t> numSlabLabels_;
+
+    static const size_t SLAB_DEPTH;
+};
+
+template<typename L>
+L ConnectedComponentLabeling::findRoot(std::vector<L>& parent, L label) {
+    // Path halving
+    while (parent[label] != label) {
+        parent[label] = parent[parent[label]];
+        label = parent[label];
+    }
+    return label;
+}
+
+template<typename L>
+L ConnectedComponentLabeling::unite(std::vector<L>& parent, L a, L b) {
+    a = findRoot(parent, a);
+    b = findRoot(parent, b);
+    if (a < b) {
+        parent[b] = a;
+        return a;
+    }
+    parent[a] = b;
+    return b;
+}
+
+template<typename Foreground>
+void ConnectedComponentLabeling::labelSlab(size_t slab, uint32_t* labels, const Foreground& isForeground) {
+    const size_t zBegin = slabBegin_[slab];
+    const size_t zEnd = slabBegin_[slab + 1];
+
+    std::vector<uint32_t> parent(1, 0);
+    for (size_t z = zBegin; z < zEnd; z++) {
+        for (size_t y = 0; y < dim_.y; y++) {
+            for (size_t x = 0; x < dim_.x; x++) {
+                size_t i = index(x, y, z);
+                if (!isForeground(i)) {
+                    labels[i] = 0;
+                    continue;
+                }
+
+                uint32_t label = 0;
+                for (const tgt::ivec3& offset : backwardNeighbors_) {
+                    tgt::svec3 n(x + offset.x, y + offset.y, z + offset.z);
+                    // Negative offsets wrap around and fail the upper bounds check.
+                    if (n.x >= dim_.x || n.y >= dim_.y || n.z < zBegin || n.z >= zEnd)
+                        continue;
+
+                    uint32_t neighborLabel = labels[index(n.x, n.y, n.z)];
+                    if (neighborLabel != 0)
+                        label = label == 0 ? findRoot(parent, neighborLabel) : unite(parent, label, neighborLabel);
+                }
+
+                if (label == 0) {
+                    label = static_cast<uint32_t>(parent.size());
+                    parent.push_back(label);
+                }
+                labels[i] = label;
+            }
+        }
+    }
+
+    // Make the labels consecutive. Roots are the smallest label of their set and thus visited first.
+    std::vector<uint32_t> consecutive(parent.size(), 0);
+    uint32_t numLabels = 0;
+    for (uint32_t label = 1; label < parent.size(); label++) {
+        uint32_t root = findRoot(parent, label);
+        consecutive[label] = root == label ? ++numLabels : consecutive[root];
+    }
+
+    for (size_t i = index(0, 0, zBegin); i < index(0, 0, zEnd); i++) {
+        labels[i] = consecutive[labels[i]];
+    }
+    numSlabLabels_[slab] = numLabels;
+}
+
+//-------------------------------------------------------------------------------------------------
+
+/**
+ * Computes connected component analysis and returns a volume (of type uint32) containing the component IDs at each voxel.
+ * Voxels that are not 0 are considered foreground, the background is labeled 0.
+ */
 class VRN_CORE_API VolumeOperatorConnectedComponentAnalysisBase : public UnaryVolumeOperatorBase {
 public:
-    virtual Volume* apply(const VolumeBase* volume, int connectivity, bool stretchLabels, ProgressReporter* progressReporter = 0) const = 0;
+    /**
+     * @param connectivity 6, 18 or 26
+     * @param stretchLabels if true, the labels are spread over the whole value range (for visualization)
+     * @param statistics if not null, receives the statistics of each component (index = label - 1)
+     */
+    virtual Volume* apply(const VolumeBase* volume, int connectivity, bool stretchLabels, ProgressReporter* progressReporter = 0,
+                          std::vector<ConnectedComponentStatistics>* statistics = 0) const = 0;
 };
 
 template<typename T>
 class VolumeOperatorConnectedComponentAnalysisGeneric : public VolumeOperatorConnectedComponentAnalysisBase {
 public:
-    virtual Volume* apply(const VolumeBase* volume, int connectivity, bool stretchLabels, ProgressReporter* progressReporter = 0) const;
+    virtual Volume* apply(const VolumeBase* volume, int connectivity, bool stretchLabels, ProgressReporter* progressReporter = 0,
+                          std::vector<ConnectedComponentStatistics>* statistics = 0) const;
     //Implement isCompatible using a handy macro:
     IS_COMPATIBLE
 };
 
 template<typename T>
-Volume* VolumeOperatorConnectedComponentAnalysisGeneric<T>::apply(const VolumeBase* vb, int connectivity, bool stretchLabels, ProgressReporter* pR) const{
+Volume* VolumeOperatorConnectedComponentAnalysisGeneric<T>::apply(const VolumeBase* vb, int connectivity, bool stretchLabels, ProgressReporter* pR,
+                                                                  std::vector<ConnectedComponentStatistics>* statistics) const {
     const VolumeRAM* v = vb->getRepresentation<VolumeRAM>();
     if (!v)
         return 0;
@@ -56,53 +216,32 @@ Volume* VolumeOperatorConnectedComponentAnalysisGeneric<T>::apply(const VolumeBa
 
     tgt::svec3 dim = va->getDimensions();
 
-    VolumeAtomic<uint16_t>* marked = new VolumeAtomic<uint16_t>(dim, true);
-    memset(marked->getData(), 0, marked->getNumBytes());
-
-    std::vector<tgt::svec3> stack;
-    stack.reserve(va->getNumVoxels());
-
-    uint16_t label = 1;
-    VRN_FOR_EACH_VOXEL(idx, tgt::svec3::zero, dim){
-        if(marked->voxel(idx) == 0 && va->voxel(idx) != T(0)){
-            stack.push_back(idx);
-            marked->voxel(idx) = label;
-            while(!stack.empty()){
-                tgt::svec3 back = stack.back();
-                stack.pop_back();
-
-
-                for (tgt::ivec3 sub_idx = tgt::ivec3(-1,-1,-1); sub_idx.z < 2; ++sub_idx.z){
-                    for (sub_idx.y = -1; sub_idx.y < 2; ++sub_idx.y){
-                        for (sub_idx.x = -1; sub_idx.x < 2; ++sub_idx.x){
-                            long long x = back.x + sub_idx.x;
-                            long long y = back.y + sub_idx.y;
-                            long long z = back.z + sub_idx.z;
-
-                            tgt::svec3 index = tgt::clamp(tgt::svec3((size_t)x,(size_t)y,(size_t)z), tgt::svec3::zero, dim - tgt::svec3::one);
-                            if(sub_idx != tgt::ivec3::zero && marked->voxel(index) == 0 && va->voxel(index) != T(0)){
-                                stack.push_back(index);
-                                marked->voxel(index) = label;
-                            }
-                        }
-                    }
-                }
-            }
-            label++;
-        }
-    }
+    std::unique_ptr<VolumeAtomic<uint32_t>> marked(new VolumeAtomic<uint32_t>(dim, true));
+    uint32_t* labels = marked->voxel();
+    const T* data = va->voxel();
+    auto isForeground = [data] (size_t i) {
+        return data[i] != T(0);
+    };
 
-    label--;
-    if(stretchLabels){
-        VRN_FOR_EACH_VOXEL(idx, tgt::svec3::zero, dim){
-            marked->voxel(idx) = marked->voxel(idx)*static_cast<uint16_t>(65535.f/static_cast<float>(label));
-        }
+    ConnectedComponentLabeling labeling(dim, connectivity);
+    long numSlabs = static_cast<long>(labeling.getNumSlabs());
+
+#ifdef VRN_MODULE_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (long slab = 0; slab < numSlabs; slab++) {
+        labeling.labelSlab(static_cast<size_t>(slab), labels, isForeground);
     }
 
+    if (pR)
+        pR->setProgress(0.5f);
+
+    labeling.merge(labels, stretchLabels, statistics);
+
     if (pR)
         pR->setProgress(1.f);
 
-    return new Volume(marked, vb);
+    return new Volume(marked.release(), vb);
 }
 
 
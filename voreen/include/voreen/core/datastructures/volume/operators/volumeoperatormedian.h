@@ -28,8 +28,77 @@
 
 #include "voreen/core/datastructures/volume/volumeoperator.h"
 
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
 namespace voreen {
 
+/**
+ * Histogram over the bins [0, numBins) that keeps track of the median of its contents, i.e., the
+ * element at index count/2 of the sorted contents, while elements are added and removed.
+ * For the contents of a sliding window, the median only moves by few bins per step, so that
+ * updating it costs constant time on average instead of sorting the whole window.
+ */
+class SlidingHistogramMedian {
+public:
+    /**
+     * Minimum neighborhood size (in voxels) for which the median of 16 bit data is determined using
+     * a histogram. Below, the 65536 bins do not pay off against sorting the neighborhood.
+     * 8 bit histograms always pay off.
+     */
+    static const size_t MIN_NEIGHBORHOOD_SIZE_16BIT = 125;
+
+    SlidingHistogramMedian(size_t numBins)
+        : histogram_(numBins, 0)
+        , count_(0)
+        , median_(0)
+        , numBelowMedian_(0)
+    {
+    }
+
+    void add(size_t bin) {
+        histogram_[bin]++;
+        count_++;
+        if (bin < median_)
+            numBelowMedian_++;
+    }
+
+    void remove(size_t bin) {
+        tgtAssert(histogram_[bin] > 0, "bin is empty");
+        histogram_[bin]--;
+        count_--;
+        if (bin < median_)
+            numBelowMedian_--;
+    }
+
+    size_t getCount() const {
+        return count_;
+    }
+
+    /// Returns the bin of the median. The histogram must not be empty.
+    size_t getMedian() {
+        tgtAssert(count_ > 0, "histogram is empty");
+        const size_t rank = count_ / 2;
+        while (numBelowMedian_ > rank) {
+            median_--;
+            numBelowMedian_ -= histogram_[median_];
+        }
+        while (numBelowMedian_ + histogram_[median_] <= rank) {
+            numBelowMedian_ += histogram_[median_];
+            median_++;
+        }
+        return median_;
+    }
+
+private:
+    std::vector<size_t> histogram_;
+    size_t count_;
+    size_t median_;
+    size_t numBelowMedian_; ///< number of elements in the bins below median_
+};
+
 // Base class, defines interface for the operator (-> apply):
 class VRN_CORE_API VolumeOperatorMedianBase : public UnaryVolumeOperatorBase {
 public:
@@ -43,6 +112,13 @@ public:
     virtual Volume* apply(const VolumeBase* volume, int kernelSize = 3, ProgressReporter* progressReporter = 0) const;
     //Implement isCompatible using a handy macro:
     IS_COMPATIBLE
+
+private:
+    /// Integer types of up to 16 bits (see SlidingHistogramMedian::MIN_NEIGHBORHOOD_SIZE_16BIT): sliding histogram along x
+    void filter(const VolumeAtomic<T>* va, VolumeAtomic<T>* output, size_t halfKernelDim, ProgressReporter* progressReporter, std::true_type) const;
+
+    /// Other types: partial sorting of each neighborhood
+    void filter(const VolumeAtomic<T>* va, VolumeAtomic<T>* output, size_t halfKernelDim, ProgressReporter* progressReporter, std::false_type) const;
 };
 
 template<typename T>
@@ -58,8 +134,78 @@ Volume* VolumeOperatorMedianGeneric<T>::apply(const VolumeBase* vh, int kernelSi
     VolumeAtomic<T>* output = va->clone();
 
     size_t halfKernelDim = static_cast<size_t>(kernelSize / 2);
-    tgt::svec3 volDim = vh->getDimensions();
-    VRN_FOR_EACH_VOXEL_WITH_PROGRESS(pos, tgt::ivec3(0), volDim, progressReporter) {
+    size_t neighborhoodSize = (2*halfKernelDim+1) * (2*halfKernelDim+1) * (2*halfKernelDim+1);
+    typedef std::integral_constant<bool, std::is_integral<T>::value && sizeof(T) <= 2> HistogramSupported;
+    if (HistogramSupported::value && (sizeof(T) == 1 || neighborhoodSize >= SlidingHistogramMedian::MIN_NEIGHBORHOOD_SIZE_16BIT))
+        filter(va, output, halfKernelDim, progressReporter, HistogramSupported());
+    else
+        filter(va, output, halfKernelDim, progressReporter, std::false_type());
+
+    if (progressReporter)
+        progressReporter->setProgress(1.f);
+
+    return new Volume(output, vh);
+}
+
+template<typename T>
+void VolumeOperatorMedianGeneric<T>::filter(const VolumeAtomic<T>* va, VolumeAtomic<T>* output, size_t halfKernelDim, ProgressReporter* progressReporter, std::true_type) const {
+    tgt::svec3 volDim = va->getDimensions();
+    if (tgt::hmul(volDim) == 0)
+        return;
+
+    const size_t numBins = size_t(1) << (8*sizeof(T));
+    auto bin = [] (T value) {
+        return static_cast<size_t>(static_cast<int>(value) - static_cast<int>(std::numeric_limits<T>::min()));
+    };
+
+    // The histogram always holds the neighborhood of the current voxel. Moving to the next voxel in x
+    // direction removes and adds a single column of the (clipped) neighborhood.
+    SlidingHistogramMedian histogram(numBins);
+    tgt::svec3 lineStarts(1, volDim.y, volDim.z);
+    VRN_FOR_EACH_VOXEL_WITH_PROGRESS(pos, tgt::svec3::zero, lineStarts, progressReporter) {
+        size_t zmin = pos.z >= halfKernelDim ? pos.z - halfKernelDim : 0;
+        size_t zmax = std::min(pos.z+halfKernelDim, volDim.z-1);
+        size_t ymin = pos.y >= halfKernelDim ? pos.y - halfKernelDim : 0;
+        size_t ymax = std::min(pos.y+halfKernelDim, volDim.y-1);
+
+        auto updateColumn = [&] (size_t x, bool add) {
+            for (size_t z = zmin; z <= zmax; z++) {
+                for (size_t y = ymin; y <= ymax; y++) {
+                    size_t b = bin(va->voxel(x, y, z));
+                    if (add)
+                        histogram.add(b);
+                    else
+                        histogram.remove(b);
+                }
+            }
+        };
+
+        // Neighborhood of the first voxel of the line
+        size_t xmax = std::min(halfKernelDim, volDim.x-1);
+        for (size_t x = 0; x <= xmax; x++)
+            updateColumn(x, true);
+
+        for (size_t x = 0; x < volDim.x; x++) {
+            output->voxel(x, pos.y, pos.z) = static_cast<T>(static_cast<int>(histogram.getMedian()) + static_cast<int>(std::numeric_limits<T>::min()));
+
+            if (x >= halfKernelDim)
+                updateColumn(x - halfKernelDim, false);
+            if (x + halfKernelDim + 1 < volDim.x)
+                updateColumn(x + halfKernelDim + 1, true);
+        }
+
+        // Remove the remaining columns, such that the histogram is empty for the next line.
+        size_t xmin = volDim.x > halfKernelDim ? volDim.x - halfKernelDim : 0;
+        for (size_t x = xmin; x < volDim.x; x++)
+            updateColumn(x, false);
+    }
+}
+
+template<typename T>
+void VolumeOperatorMedianGeneric<T>::filter(const VolumeAtomic<T>* va, VolumeAtomic<T>* output, size_t halfKernelDim, ProgressReporter* progressReporter, std::false_type) const {
+    tgt::svec3 volDim = va->getDimensions();
+    std::vector<T> values;
+    VRN_FOR_EACH_VOXEL_WITH_PROGRESS(pos, tgt::svec3::zero, volDim, progressReporter) {
         size_t zmin = pos.z >= halfKernelDim ? pos.z - halfKernelDim : 0;
         size_t zmax = std::min(pos.z+halfKernelDim, volDim.z-1);
         size_t ymin = pos.y >= halfKernelDim ? pos.y - halfKernelDim : 0;
@@ -68,7 +214,7 @@ Volume* VolumeOperatorMedianGeneric<T>::apply(const VolumeBase* vh, int kernelSi
         size_t xmax = std::min(pos.x+halfKernelDim, volDim.x-1);
 
         tgt::svec3 npos;
-        std::vector<T> values;
+        values.clear();
         for (npos.z=zmin; npos.z<=zmax; npos.z++) {
             for (npos.y=ymin; npos.y<=ymax; npos.y++) {
                 for (npos.x=xmin; npos.x<=xmax; npos.x++) {
@@ -77,14 +223,9 @@ Volume* VolumeOperatorMedianGeneric<T>::apply(const VolumeBase* vh, int kernelSi
             }
         }
         size_t len = values.size();
-        nth_element(values.begin(), values.begin()+(len/2), values.end());
+        std::nth_element(values.begin(), values.begin()+(len/2), values.end());
         output->voxel(pos) = values[len / 2];
     }
-
-    if (progressReporter)
-        progressReporter->setProgress(1.f);
-
-    return new Volume(output, vh);
 }
 
 typedef UniversalUnaryVolumeOperatorGeneric<VolumeOperatorMedianBase> VolumeOperatorMedian;
@@ -28,8 +28,86 @@
 
 #include "voreen/core/datastructures/volume/volumeoperator.h"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 namespace voreen {
 
+/**
+ * Computes out[i] = op(in[i], ..., in[i + 2*radius]) for i in [0, n), i.e., the running minimum or
+ * maximum over windows of 2*radius+1 elements of a border-padded line, using the van Herk/Gil-Werman
+ * algorithm: The line is split into segments of the window size, for which prefix and suffix results
+ * are computed. Each window spans at most two segments, so that its result is op(suffix, prefix).
+ * This requires three applications of op per element, independent of the radius.
+ *
+ * @param in n + 2*radius input elements
+ * @param out n output elements
+ * @param prefix buffer of at least n + 2*radius elements
+ * @param suffix buffer of at least n + 2*radius elements
+ */
+template<typename T, typename Op>
+void vanHerkGilWermanFilter(const T* in, T* out, size_t n, size_t radius, Op op, T* prefix, T* suffix) {
+    const size_t window = 2*radius + 1;
+    const size_t length = n + 2*radius;
+    for (size_t begin = 0; begin < length; begin += window) {
+        size_t end = std::min(begin + window, length);
+        prefix[begin] = in[begin];
+        for (size_t i = begin + 1; i < end; i++)
+            prefix[i] = op(prefix[i-1], in[i]);
+        suffix[end-1] = in[end-1];
+        for (size_t i = end - 1; i > begin; i--)
+            suffix[i-1] = op(suffix[i], in[i-1]);
+    }
+    for (size_t i = 0; i < n; i++)
+        out[i] = op(suffix[i], prefix[i + 2*radius]);
+}
+
+/**
+ * Separable cube erosion/dilation: Applies op over windows of 2*halfKernelDim+1 voxels consecutively
+ * along x, y and z using vanHerkGilWermanFilter. The windows are clipped at the volume border, which
+ * for minimum and maximum is equivalent to replicating the border voxels.
+ */
+template<typename T, typename Op>
+VolumeAtomic<T>* applyCubeMorphology(const VolumeAtomic<T>* volume, size_t halfKernelDim, Op op, ProgressReporter* progressReporter) {
+    tgt::svec3 volDim = volume->getDimensions();
+    VolumeAtomic<T>* output = new VolumeAtomic<T>(volDim);
+    if (tgt::hmul(volDim) == 0)
+        return output;
+    std::unique_ptr<VolumeAtomic<T>> pong(new VolumeAtomic<T>(volDim));
+
+    // x-direction (volume -> output), y-direction (output -> pong), z-direction (pong -> output)
+    const VolumeAtomic<T>* source[3] = { volume, output, pong.get() };
+    VolumeAtomic<T>* target[3] = { output, pong.get(), output };
+
+    for (size_t axis = 0; axis < 3; axis++) {
+        const size_t n = volDim[axis];
+        const size_t stride = axis == 0 ? 1 : (axis == 1 ? volDim.x : volDim.x*volDim.y);
+        std::vector<T> line(n + 2*halfKernelDim), prefix(line.size()), suffix(line.size()), result(n);
+
+        tgt::svec3 lineStarts = volDim;
+        lineStarts[axis] = 1;
+        VRN_FOR_EACH_VOXEL_WITH_PROGRESS_SUB_TASK(pos, tgt::svec3::zero, lineStarts, progressReporter, axis/3.f, 1.f/3) {
+            const T* in = source[axis]->voxel() + VolumeAtomic<T>::calcPos(volDim, pos);
+            std::fill(line.begin(), line.begin() + halfKernelDim, in[0]);
+            for (size_t i = 0; i < n; i++)
+                line[halfKernelDim + i] = in[i*stride];
+            std::fill(line.begin() + halfKernelDim + n, line.end(), in[(n-1)*stride]);
+
+            vanHerkGilWermanFilter(line.data(), result.data(), n, halfKernelDim, op, prefix.data(), suffix.data());
+
+            T* out = target[axis]->voxel() + VolumeAtomic<T>::calcPos(volDim, pos);
+            for (size_t i = 0; i < n; i++)
+                out[i*stride] = result[i];
+        }
+    }
+
+    if (progressReporter)
+        progressReporter->setProgress(1.f);
+
+    return output;
+}
+
 // Base class, defines interface for the operator (-> apply):
 class VRN_CORE_API VolumeOperatorCubeErosionBase : public UnaryVolumeOperatorBase {
 public:
@@ -55,57 +133,9 @@ Volume* VolumeOperatorCubeErosionGeneric<T>::apply(const VolumeBase* vh, int ker
     if(!volume)
         return 0;
 
-    VolumeAtomic<T>* output = volume->clone();
-    VolumeAtomic<T>* pong = volume->clone();
-
     size_t halfKernelDim = static_cast<size_t>(kernelSize / 2);
-    tgt::svec3 volDim = volume->getDimensions();
-
-    // kernel is separable => consecutively apply 1D kernel along each axis instead of a 3D kernel
-
-    // x-direction (volumeVol -> outputVol)
-    VRN_FOR_EACH_VOXEL_WITH_PROGRESS_SUB_TASK(pos, tgt::ivec3(0), volDim, progressReporter, 0.f, 1.f/3) {
-        size_t xmin = pos.x >= halfKernelDim ? pos.x - halfKernelDim : 0;
-        size_t xmax = std::min(pos.x+halfKernelDim, volDim.x-1);
-
-        T val = volume->voxel(pos);
-        tgt::svec3 npos = pos;
-        for (npos.x=xmin; npos.x<=xmax; npos.x++) {
-            val = std::min(val, volume->voxel(npos));
-        }
-        output->voxel(pos) = val;
-    }
-
-    // y-direction (outputVol -> volumeVol)
-    VRN_FOR_EACH_VOXEL_WITH_PROGRESS_SUB_TASK(pos, tgt::ivec3(0), volDim, progressReporter, 1.f/3, 1.f/3) {
-        size_t ymin = pos.y >= halfKernelDim ? pos.y - halfKernelDim : 0;
-        size_t ymax = std::min(pos.y+halfKernelDim, volDim.y-1);
-
-        T val = output->voxel(pos);
-        tgt::svec3 npos = pos;
-        for (npos.y=ymin; npos.y<=ymax; npos.y++) {
-            val = std::min(val, output->voxel(npos));
-        }
-        pong->voxel(pos) = val;
-    }
-
-    // z-direction (volumeVol -> outputVol)
-    VRN_FOR_EACH_VOXEL_WITH_PROGRESS_SUB_TASK(pos, tgt::ivec3(0), volDim, progressReporter, 2.f/3, 1.f/3) {
-        size_t zmin = pos.z >= halfKernelDim ? pos.z - halfKernelDim : 0;
-        size_t zmax = std::min(pos.z+halfKernelDim, volDim.z-1);
-
-        T val = pong->voxel(pos);
-        tgt::svec3 npos = pos;
-        for (npos.z=zmin; npos.z<=zmax; npos.z++) {
-            val = std::min(val, pong->voxel(npos));
-        }
-        output->voxel(pos) = val;
-    }
-
-    if (progressReporter)
-        progressReporter->setProgress(1.f);
-
-    return new Volume(output, vh);
+    auto op = [] (T a, T b) { return std::min(a, b); };
+    return new Volume(applyCubeMorphology(volume, halfKernelDim, op, progressReporter), vh);
 }
 
 typedef UniversalUnaryVolumeOperatorGeneric<VolumeOperatorCubeErosionBase> VolumeOperatorCubeErosion;
@@ -210,57 +240,9 @@ Volume* VolumeOperatorCubeDilationGeneric<T>::apply(const VolumeBase* vh, int ke
     if(!volume)
         return 0;
 
-    VolumeAtomic<T>* output = volume->clone();
-    VolumeAtomic<T>* pong = volume->clone();
-
-    size_t halfKernelDim = kernelSize / 2;
-    tgt::svec3 volDim = volume->getDimensions();
-
-    // kernel is separable => consecutively apply 1D kernel along each axis instead of a 3D kernel
-
-    // x-direction (inputVol -> outputVol)
-    VRN_FOR_EACH_VOXEL_WITH_PROGRESS_SUB_TASK(pos, tgt::ivec3(0), volDim, progressReporter, 0.f, 1.f/3) {
-        size_t xmin = pos.x >= halfKernelDim ? pos.x - halfKernelDim : 0;
-        size_t xmax = std::min(pos.x+halfKernelDim, volDim.x-1);
-
-        T val = volume->voxel(pos);
-        tgt::svec3 npos = pos;
-        for (npos.x=xmin; npos.x<=xmax; npos.x++) {
-            val = std::max(val, volume->voxel(npos));
-        }
-        output->voxel(pos) = val;
-    }
-
-    // y-direction (outputVol -> inputVol)
-    VRN_FOR_EACH_VOXEL_WITH_PROGRESS_SUB_TASK(pos, tgt::ivec3(0), volDim, progressReporter, 1.f/3, 1.f/3) {
-        size_t ymin = pos.y >= halfKernelDim ? pos.y - halfKernelDim : 0;
-        size_t ymax = std::min(pos.y+halfKernelDim, volDim.y-1);
-
-        T val = output->voxel(pos);
-        tgt::svec3 npos = pos;
-        for (npos.y=ymin; npos.y<=ymax; npos.y++) {
-            val = std::max(val, output->voxel(npos));
-        }
-        pong->voxel(pos) = val;
-    }
-
-    // z-direction (inputVol -> outputVol)
-    VRN_FOR_EACH_VOXEL_WITH_PROGRESS_SUB_TASK(pos, tgt::ivec3(0), volDim, progressReporter, 2.f/3, 1.f/3) {
-        size_t zmin = pos.z >= halfKernelDim ? pos.z - halfKernelDim : 0;
-        size_t zmax = std::min(pos.z+halfKernelDim, volDim.z-1);
-
-        T val = pong->voxel(pos);
-        tgt::svec3 npos = pos;
-        for (npos.z=zmin; npos.z<=zmax; npos.z++) {
-            val = std::max(val, pong->voxel(npos));
-        }
-        output->voxel(pos) = val;
-    }
-
-    if (progressReporter)
-        progressReporter->setProgress(1.f);
-
-    return new Volume(output, vh);
+    size_t halfKernelDim = static_cast<size_t>(kernelSize / 2);
+    auto op = [] (T a, T b) { return std::max(a, b); };
+    return new Volume(applyCubeMorphology(volume, halfKernelDim, op, progressReporter), vh);
 }
 
 typedef UniversalUnaryVolumeOperatorGeneric<VolumeOperatorCubeDilationBase> VolumeOperatorCubeDilation;
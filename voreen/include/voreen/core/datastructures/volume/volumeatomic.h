@@ -114,8 +114,7 @@ public:
 
     /**
      * Returns the minimum value contained by the specified channel converted to float.
-     * This function chooses either a fast scalar implementation (if possible) or the
-     * slower parent method otherwise.
+     * The value is computed by a typed, multi-threaded pass over the channel data.
      */
     virtual float minNormalizedValue(size_t channel = 0) const;
 
@@ -129,8 +128,7 @@ public:
 
     /**
      * Returns the maximum value contained by the specified channel converted to float.
-     * This function chooses either a fast scalar implementation (if possible) or the
-     * slower parent method otherwise.
+     * The value is computed by a typed, multi-threaded pass over the channel data.
      */
     virtual float maxNormalizedValue(size_t channel = 0) const;
 
@@ -240,6 +238,19 @@ protected:
     // Helper method for non-scalar maximum float value
     float maxNormalizedImpl(size_t channel, IsScalar<false>) const;
 
+    // Helper method computing the cached min/max values for scalar volumes
+    void updateMinMax(IsScalar<true>) const;
+
+    // Helper method computing the cached min/max values for non-scalar volumes
+    void updateMinMax(IsScalar<false>) const;
+
+    /**
+     * Computes the minimum and maximum of the specified channel in a single pass over the
+     * raw data. The loop is free of virtual calls and runs multi-threaded, if OpenMP is available.
+     */
+    void computeChannelMinMax(size_t channel, typename VolumeElement<T>::BaseType& min,
+        typename VolumeElement<T>::BaseType& max) const;
+
     // Helper method for scalar maximum magnitude
     float maxNormalizedMagnitudeImpl(IsScalar<true>) const;
 
@@ -619,12 +630,8 @@ tgt::vec2 VolumeAtomic<T>::elementRange() const {
 
 template<class T>
 T VolumeAtomic<T>::min() const {
-    if (!minMaxValid_) {
-        auto minMax = std::minmax_element(data_, data_ + getNumVoxels());
-        minValue_ = *minMax.first;
-        maxValue_ = *minMax.second;
-        minMaxValid_ = true;
-    }
+    if (!minMaxValid_)
+        updateMinMax(IsScalar<std::numeric_limits<T>::is_specialized>());
 
     return minValue_;
 
@@ -632,26 +639,82 @@ T VolumeAtomic<T>::min() const {
 
 template<class T>
 T VolumeAtomic<T>::max() const {
-    if (!minMaxValid_) {
-        auto minMax = std::minmax_element(data_, data_ + getNumVoxels());
-        minValue_ = *minMax.first;
-        maxValue_ = *minMax.second;
-        minMaxValid_ = true;
-    }
+    if (!minMaxValid_)
+        updateMinMax(IsScalar<std::numeric_limits<T>::is_specialized>());
 
     return maxValue_;
 }
 
+template<class T>
+void VolumeAtomic<T>::updateMinMax(IsScalar<true>) const {
+    computeChannelMinMax(0, minValue_, maxValue_);
+    minMaxValid_ = true;
+}
+
+template<class T>
+void VolumeAtomic<T>::updateMinMax(IsScalar<false>) const {
+    auto minMax = std::minmax_element(data_, data_ + getNumVoxels());
+    minValue_ = *minMax.first;
+    maxValue_ = *minMax.second;
+    minMaxValid_ = true;
+}
+
+template<class T>
+void VolumeAtomic<T>::computeChannelMinMax(size_t channel, typename VolumeElement<T>::BaseType& min,
+    typename VolumeElement<T>::BaseType& max) const
+{
+    typedef typename VolumeElement<T>::BaseType Base;
+    tgtAssert(sizeof(T) % sizeof(Base) == 0, "voxel type is not composed of base type elements");
+
+    const int64_t numVoxels = static_cast<int64_t>(getNumVoxels());
+    if (numVoxels == 0) {
+        min = max = Base(0);
+        return;
+    }
+
+    // access the channel as strided array of the base type, so that the loop can be vectorized
+    const size_t stride = sizeof(T) / sizeof(Base);
+    const Base* values = reinterpret_cast<const Base*>(data_) + channel;
+    min = max = values[0];
+
+    #ifdef VRN_MODULE_OPENMP
+    #pragma omp parallel
+    #endif
+    {
+        Base localMin = values[0];
+        Base localMax = values[0];
+
+        #ifdef VRN_MODULE_OPENMP
+        #pragma omp for nowait
+        #endif
+        for (int64_t i = 0; i < numVoxels; i++) {
+            Base value = values[i*stride];
+            localMin = value < localMin ? value : localMin;
+            localMax = value > localMax ? value : localMax;
+        }
+
+        #ifdef VRN_MODULE_OPENMP
+        #pragma omp critical
+        #endif
+        {
+            min = localMin < min ? localMin : min;
+            max = localMax > max ? localMax : max;
+        }
+    }
+}
+
 // scalar (fast)
 template<typename T>
 float VolumeAtomic<T>::minNormalizedImpl(size_t /*channel*/, IsScalar<true>) const {
     return getTypeAsFloat(min());
 }
 
-// non-scalar (we have to use the slow way via getVoxelNormalized())
+// non-scalar (typed pass over the channel)
 template<typename T>
 float VolumeAtomic<T>::minNormalizedImpl(size_t channel, IsScalar<false>) const {
-    return VolumeRAM::minNormalizedValue(channel);
+    typename VolumeElement<T>::BaseType min, max;
+    computeChannelMinMax(channel, min, max);
+    return getTypeAsFloat(min);
 }
 
 template<class T>
@@ -666,10 +729,12 @@ float VolumeAtomic<T>::maxNormalizedImpl(size_t /*channel*/, IsScalar<true>) con
     return getTypeAsFloat(max());
 }
 
-// non-scalar (we have to use the slow way via getVoxelNormalized())
+// non-scalar (typed pass over the channel)
 template<typename T>
 float VolumeAtomic<T>::maxNormalizedImpl(size_t channel, IsScalar<false>) const {
-    return VolumeRAM::maxNormalizedValue(channel);
+    typename VolumeElement<T>::BaseType min, max;
+    computeChannelMinMax(channel, min, max);
+    return getTypeAsFloat(max);
 }
 
 template<class T>
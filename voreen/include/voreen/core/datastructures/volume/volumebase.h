@@ -405,10 +405,30 @@ protected:
     };
 
     friend class VolumeDecoratorIdentity; // this is necessary to allow the VolumeDecorator to access the protected member function getRepresentation(i)
+    friend class VolumeDerivedDataSweep; // attaches the by-products of a sweep to the swept volume
+
+    /// Returns whether a derived data item of the same type as the passed one is present.
+    bool hasDerivedDataOfType(const VolumeDerivedData* data) const;
+
+    /**
+     * Adds the passed derived data item, unless an item of the same type is already present,
+     * and notifies the observers. Returns whether it has been added.
+     */
+    bool addDerivedDataIfMissing(VolumeDerivedData* data) const;
 
     template<class T>
         void addDerivedDataInternal(T* data) const;
 
+    /**
+     * Adds the passed derived data item under the derived data lock.
+     * An existing item of the same type is replaced and deleted, if replaceExisting is true.
+     * Otherwise the passed item is not added. Returns whether it has been added.
+     */
+    bool addDerivedDataInternal(VolumeDerivedData* data, bool replaceExisting) const;
+
+    /// Enqueues the notification of the observers that derived data has become available.
+    void enqueueDerivedDataNotification() const;
+
     template<class T>
         void removeDerivedDataInternal() const;
 
@@ -710,12 +730,7 @@ void VolumeBase::derivedDataThreadFinished(VolumeDerivedDataThreadBase* ddt) con
     derivedDataThreads_.erase(ddt);
     derivedDataThreadMutex_.unlock();
 
-    // enqueue notification of observers
-    VoreenApplication::app()->getCommandQueue()->enqueue(this, LambdaFunctionCallback([this] {
-        std::vector<VolumeObserver*> observers = Observable<VolumeObserver>::getObservers();
-        for (size_t i = 0; i<observers.size(); ++i)
-            observers[i]->derivedDataThreadFinished(this);
-    }));
+    enqueueDerivedDataNotification();
 
     derivedDataThreadMutex_.lock();
     derivedDataThreadsFinished_.insert(ddt);
@@ -744,13 +759,7 @@ void VolumeBase::addDerivedDataInternal(T* data) const {
         throw std::invalid_argument("passed data item is not of type VolumeDerivedData");
     }
 
-    derivedDataMutex_.lock();
-
-    if (hasDerivedData<T>())
-        removeDerivedDataInternal<T>();
-
-    derivedData_.insert(static_cast<VolumeDerivedData*>(data));
-    derivedDataMutex_.unlock();
+    addDerivedDataInternal(static_cast<VolumeDerivedData*>(data), true);
 }
 
 template<class T>
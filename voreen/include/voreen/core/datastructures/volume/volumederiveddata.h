@@ -34,6 +34,7 @@
 namespace voreen {
 
 class VolumeBase;
+class VolumeDerivedDataSweepAccumulator;
 
 /**
  * Marker interface for data that is derived from a volume dataset,
@@ -59,6 +60,29 @@ public:
      */
     virtual VolumeDerivedData* createFrom(const VolumeBase* handle) const = 0;
 
+    /**
+     * Creates an accumulator that computes this type of derived data from
+     * the slabs of a single slice-wise sweep over the volume's disk representation.
+     * The default implementation returns null, i.e., the derived data does not
+     * support being computed during a sweep.
+     *
+     * @param handle the volume that is to be swept
+     * @return the accumulator (caller takes ownership), or null
+     *
+     * @see VolumeDerivedDataSweep
+     */
+    virtual VolumeDerivedDataSweepAccumulator* createSweepAccumulator(const VolumeBase* handle) const;
+
+    /**
+     * Returns whether this type of derived data is computed as a by-product
+     * whenever a sweep is performed for another derived data item.
+     * Types that are only needed on explicit request should return false.
+     * The default implementation returns true.
+     *
+     * @see VolumeDerivedDataSweep::addMissingDerivedData
+     */
+    virtual bool isSweepByproduct() const;
+
     virtual void serialize(Serializer& s) const = 0;
     virtual void deserialize(Deserializer& s) = 0;
 };
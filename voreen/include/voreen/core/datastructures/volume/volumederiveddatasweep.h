@@ -0,0 +1,138 @@
+/***********************************************************************************
+ *                                                                                 *
+ * Voreen - The Volume Rendering Engine                                            *
+ *                                                                                 *
+ * Copyright (C) 2005-2024 University of Muenster, Germany,                        *
+ * Department of Computer Science.                                                 *
+ * For a list of authors please refer to the file "CREDITS.txt".                   *
+ *                                                                                 *
+ * This file is part of the Voreen software package. Voreen is free software:      *
+ * you can redistribute it and/or modify it under the terms of the GNU General     *
+ * Public License version 2 as published by the Free Software Foundation.          *
+ *                                                                                 *
+ * Voreen is distributed in the hope that it will be useful, but WITHOUT ANY       *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR   *
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.      *
+ *                                                                                 *
+ * You should have received a copy of the GNU General Public License in the file   *
+ * "LICENSE.txt" along with this file. If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                                 *
+ * For non-commercial academic use see the license exception specified in the file *
+ * "LICENSE-academic.txt". To get information about commercial licensing please    *
+ * contact the authors.                                                            *
+ *                                                                                 *
+ ***********************************************************************************/
+
+#ifndef VRN_VOLUMEDERIVEDDATASWEEP_H
+#define VRN_VOLUMEDERIVEDDATASWEEP_H
+
+#include "voreen/core/voreencoreapi.h"
+
+#include <string>
+#include <vector>
+
+namespace voreen {
+
+class VolumeBase;
+class VolumeDisk;
+class VolumeRAM;
+class VolumeDerivedData;
+
+/**
+ * Incrementally computes a single derived data item from the slabs delivered
+ * by a VolumeDerivedDataSweep. The accumulators of a sweep are run concurrently,
+ * but each accumulator receives the slabs one after another in ascending z order.
+ *
+ * @see VolumeDerivedData::createSweepAccumulator
+ */
+class VRN_CORE_API VolumeDerivedDataSweepAccumulator {
+public:
+    virtual ~VolumeDerivedDataSweepAccumulator() {}
+
+    /**
+     * Processes a slab of consecutive z slices of the swept volume.
+     *
+     * @param slab RAM volume containing the slices [firstSlice, firstSlice + slab->getDimensions().z - 1]
+     * @param firstSlice z index of the first slice of the slab within the swept volume
+     */
+    virtual void processSlab(const VolumeRAM* slab, size_t firstSlice) = 0;
+
+    /**
+     * Creates the derived data item after all slabs have been processed.
+     *
+     * @return the derived data item (caller takes ownership), or null if it could not be computed
+     */
+    virtual VolumeDerivedData* finalize() = 0;
+};
+
+/**
+ * Computes multiple derived data items of a disk volume in a single pass:
+ * Each slab is loaded from the VolumeDisk representation only once and is then
+ * fed to all registered accumulators in parallel, while the next slab is already
+ * being loaded in the background.
+ */
+class VRN_CORE_API VolumeDerivedDataSweep {
+public:
+    /**
+     * @param volume the volume to sweep, must have a VolumeDisk representation
+     * @param maxSlabMemory maximum size of a single slab in bytes. At least one slice is loaded at a time.
+     */
+    VolumeDerivedDataSweep(const VolumeBase* volume, size_t maxSlabMemory = DEFAULT_MAX_SLAB_MEMORY);
+    ~VolumeDerivedDataSweep();
+
+    /**
+     * Registers the sweep accumulator of the passed derived data prototype.
+     *
+     * @return false, if the prototype does not support sweeps for this volume or has already been registered
+     */
+    bool addDerivedData(const VolumeDerivedData* prototype);
+
+    /**
+     * Registers the accumulators of all derived data types known to the application
+     * that support sweeps, are computed as by-products and are not yet present at the volume.
+     *
+     * @see VolumeDerivedData::isSweepByproduct
+     */
+    void addMissingDerivedData();
+
+    /// Returns the number of registered accumulators.
+    size_t getNumAccumulators() const;
+
+    /**
+     * Performs the sweep and finalizes all accumulators.
+     *
+     * @return the derived data items in order of registration (caller takes ownership). Items that could not be computed are null.
+     * @throw tgt::Exception if a slab could not be loaded from disk
+     * @throw any exception thrown by an accumulator, after all accumulators have processed the current slab
+     * @note this function is an interruption point
+     */
+    std::vector<VolumeDerivedData*> run();
+
+    /**
+     * Computes the derived data of the passed prototype from the volume's disk representation
+     * and, during the same sweep, all other missing derived data that supports sweeps.
+     * These by-products are attached to the volume.
+     *
+     * @return the derived data item of the prototype (caller takes ownership),
+     *      or null if it could not be computed
+     */
+    static VolumeDerivedData* computeWithByproducts(const VolumeBase* volume, const VolumeDerivedData* prototype);
+
+    static const size_t DEFAULT_MAX_SLAB_MEMORY;
+
+private:
+    VolumeRAM* loadSlab(size_t firstSlice) const;
+
+    const VolumeBase* volume_;
+    const VolumeDisk* volumeDisk_;
+    size_t slicesPerSlab_;
+
+    std::vector<std::string> classNames_;                           ///< class names of the registered prototypes
+    std::vector<VolumeDerivedDataSweepAccumulator*> accumulators_;  ///< owned by the sweep
+
+    static const std::string loggerCat_;
+};
+
+} // namespace voreen
+
+#endif
@@ -33,6 +33,14 @@
 #include "voreen/core/datastructures/volume/volumegl.h"
 
 #include <stdexcept>
+#include <memory>
+
+#include <boost/thread/mutex.hpp>
+
+namespace boost { namespace iostreams {
+class mapped_file_source;
+} }
+
 namespace voreen {
 
 /**
@@ -161,10 +169,33 @@ public:
     virtual VolumeRAM* loadBrick(const tgt::svec3& offset, const tgt::svec3& dimensions) const;
 
 protected:
+    /**
+     * Reads the brick into dest, merging rows that are contiguous in the file into single reads.
+     * The data is copied from a memory mapping of the file, if available, otherwise read from a stream.
+     */
+    void readBrick(const tgt::svec3& offset, const tgt::svec3& dimensions, char* dest) const;
+
+    /**
+     * Returns a pointer to the first voxel of the volume within the memory mapped file, which is
+     * kept mapped for the lifetime of this representation. Returns null if the file cannot be mapped.
+     *
+     * If the size or modification time of the file has changed since it was mapped, the file is
+     * mapped again, so that reads never touch pages beyond the end of a truncated file.
+     *
+     * @param mapping receives the mapping the returned pointer refers to. It must be kept while reading.
+     */
+    const char* getMappedData(std::shared_ptr<const boost::iostreams::mapped_file_source>& mapping) const;
+
     std::string filename_;
     int64_t offset_;
     bool swapEndian_;
 
+    mutable std::shared_ptr<const boost::iostreams::mapped_file_source> mappedFile_;
+    mutable uint64_t mappedFileSize_;   ///< size of the file when it was mapped
+    mutable time_t mappedFileTime_;     ///< modification time of the file when it was mapped
+    mutable bool mappingFailed_;
+    mutable boost::mutex mappingMutex_;
+
     static const std::string loggerCat_;
 };
 
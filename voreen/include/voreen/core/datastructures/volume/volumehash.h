@@ -68,6 +68,48 @@ protected:
     std::string hash_;
 };
 
+/**
+ * Content hash of the voxel data, computed by VoreenChunkedHash.
+ *
+ * In contrast to VolumeHash, the hash of a disk volume is derived from its voxel data
+ * instead of its file properties. The data is streamed slab by slab from disk and
+ * may be hashed together with other derived data. \sa VolumeDerivedDataSweep
+ *
+ * Since hashing the entire voxel data is expensive, the hash is only computed
+ * on request and not as a by-product of sweeps for other derived data.
+ */
+class VRN_CORE_API VolumeChunkedHash : public VolumeDerivedData {
+public:
+    /// Empty default constructor required by VolumeDerivedData interface.
+    VolumeChunkedHash();
+    VolumeChunkedHash(const std::string& hash);
+    virtual std::string getClassName() const { return "VolumeChunkedHash"; }
+
+    virtual VolumeDerivedData* create() const;
+
+    virtual VolumeDerivedData* createFrom(const VolumeBase* handle) const;
+
+    /// @see VolumeDerivedData
+    virtual VolumeDerivedDataSweepAccumulator* createSweepAccumulator(const VolumeBase* handle) const;
+
+    /// Returns false: the hash is only computed on request. @see VolumeDerivedData
+    virtual bool isSweepByproduct() const;
+
+    /// @see VolumeDerivedData
+    virtual void serialize(Serializer& s) const;
+
+    /// @see VolumeDerivedData
+    virtual void deserialize(Deserializer& s);
+
+    /// Returns the hash as hex string of 16 characters, or an empty string if it could not be computed.
+    std::string getHash() const {
+        return hash_;
+    }
+
+private:
+    std::string hash_;
+};
+
 } // namespace voreen
 
 #endif
@@ -51,6 +51,9 @@ public:
 
     virtual VolumeDerivedData* createFrom(const VolumeBase* handle) const;
 
+    /// @see VolumeDerivedData
+    virtual VolumeDerivedDataSweepAccumulator* createSweepAccumulator(const VolumeBase* handle) const;
+
     /// @see VolumeDerivedData
     virtual void serialize(Serializer& s) const;
 
@@ -46,6 +46,19 @@ public:
     virtual VolumeDerivedData* create() const;
     virtual VolumeDerivedData* createFrom(const VolumeBase* handle) const;
 
+    /// @see VolumeDerivedData
+    virtual VolumeDerivedDataSweepAccumulator* createSweepAccumulator(const VolumeBase* handle) const;
+
+    /// Returns the z index of the slice the preview of the passed volume is created from.
+    static size_t getPreviewSlice(const VolumeBase* handle);
+
+    /**
+     * Creates the preview of the passed volume from a RAM volume containing its preview slice.
+     *
+     * @param sliceZ z index of the preview slice within volumeRam
+     */
+    static VolumePreview* createFromSlice(const VolumeBase* handle, const VolumeRAM* volumeRam, size_t sliceZ);
+
     /// @see VolumeDerivedData
     virtual void serialize(Serializer& s) const;
 
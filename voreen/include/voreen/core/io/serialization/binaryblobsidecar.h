@@ -0,0 +1,149 @@
+/***********************************************************************************
+ *                                                                                 *
+ * Voreen - The Volume Rendering Engine                                            *
+ *                                                                                 *
+ * Copyright (C) 2005-2024 University of Muenster, Germany,                        *
+ * Department of Computer Science.                                                 *
+ * For a list of authors please refer to the file "CREDITS.txt".                   *
+ *                                                                                 *
+ * This file is part of the Voreen software package. Voreen is free software:      *
+ * you can redistribute it and/or modify it under the terms of the GNU General     *
+ * Public License version 2 as published by the Free Software Foundation.          *
+ *                                                                                 *
+ * Voreen is distributed in the hope that it will be useful, but WITHOUT ANY       *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR   *
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.      *
+ *                                                                                 *
+ * You should have received a copy of the GNU General Public License in the file   *
+ * "LICENSE.txt" along with this file. If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                                 *
+ * For non-commercial academic use see the license exception specified in the file *
+ * "LICENSE-academic.txt". To get information about commercial licensing please    *
+ * contact the authors.                                                            *
+ *                                                                                 *
+ ***********************************************************************************/
+
+#ifndef VRN_BINARYBLOBSIDECAR_H
+#define VRN_BINARYBLOBSIDECAR_H
+
+#include <string>
+#include <fstream>
+#include <memory>
+
+#include "voreen/core/voreencoreapi.h"
+
+namespace boost { namespace iostreams {
+    class mapped_file_source;
+} }
+
+namespace voreen {
+
+class Deserializer;
+
+/**
+ * Binary file stored alongside a serialized document, which holds the binary blobs of the document
+ * in native form instead of base64 encoded within the document. Each blob starts at an offset that is
+ * a multiple of ALIGNMENT; the document only references the blob by offset and length.
+ *
+ * Each save creates a sidecar file with a new name, which is recorded in the document under DOCUMENT_KEY.
+ * The sidecar of the previous save is only deleted after the new document has been moved into place,
+ * so a document always references a complete sidecar, even if saving is interrupted.
+ *
+ * @see Serializer::serializeBinaryBlob, Deserializer::deserializeBinaryBlob
+ */
+class VRN_CORE_API BinaryBlobSidecar {
+public:
+    /// Returns a new sidecar file name for the passed document file, which differs for each call.
+    static std::string createFilename(const std::string& documentFilename);
+
+    /**
+     * Returns the sidecar file referenced by the passed document, or an empty string
+     * if the document does not reference one.
+     *
+     * @param documentFilename the document file, the sidecar file is located next to it
+     */
+    static std::string getReferencedFilename(Deserializer& d, const std::string& documentFilename);
+
+    /**
+     * Deletes the sidecar files of the passed document file, except for the one that is to be kept.
+     * Failures are ignored.
+     */
+    static void deleteFiles(const std::string& documentFilename, const std::string& keepFilename = "");
+
+    /// Document key under which the name of the sidecar file is stored.
+    static const std::string DOCUMENT_KEY;
+
+    /// Alignment of the blobs within the sidecar file in bytes.
+    static const size_t ALIGNMENT;
+
+    /// Suffixes of the document keys referencing a blob within the sidecar file.
+    static const std::string OFFSET_KEY_SUFFIX;
+    static const std::string LENGTH_KEY_SUFFIX;
+};
+
+/**
+ * Appends binary blobs to a sidecar file.
+ */
+class VRN_CORE_API BinaryBlobSidecarWriter {
+public:
+    /**
+     * Creates (or truncates) the passed sidecar file.
+     *
+     * @throws SerializationException if the file could not be opened for writing
+     */
+    BinaryBlobSidecarWriter(const std::string& filename);
+    ~BinaryBlobSidecarWriter();
+
+    /**
+     * Appends the passed data to the sidecar file and returns its offset.
+     *
+     * @throws SerializationException if the data could not be written
+     */
+    size_t append(const unsigned char* data, size_t length);
+
+    /**
+     * Flushes and closes the sidecar file.
+     *
+     * @throws SerializationException if the data could not be written
+     */
+    void close();
+
+    const std::string& getFilename() const;
+
+private:
+    std::string filename_;
+    std::ofstream stream_;
+    size_t size_;
+};
+
+/**
+ * Provides the blobs of a sidecar file, which is memory mapped for reading.
+ */
+class VRN_CORE_API BinaryBlobSidecarReader {
+public:
+    /**
+     * Maps the passed sidecar file.
+     *
+     * @throws SerializationException if the file could not be mapped
+     */
+    BinaryBlobSidecarReader(const std::string& filename);
+    ~BinaryBlobSidecarReader();
+
+    /**
+     * Returns a pointer to the blob of the passed length at the passed offset, which is valid for the
+     * lifetime of the reader.
+     *
+     * @throws SerializationFormatException if the blob exceeds the sidecar file
+     */
+    const unsigned char* getData(size_t offset, size_t length) const;
+
+    const std::string& getFilename() const;
+
+private:
+    std::string filename_;
+    std::unique_ptr<boost::iostreams::mapped_file_source> file_;
+};
+
+} // namespace voreen
+
+#endif // VRN_BINARYBLOBSIDECAR_H
@@ -50,6 +50,7 @@ namespace voreen {
 
 class XmlDeserializer;
 class JsonDeserializer;
+class BinaryBlobSidecarReader;
 
 /**
  * This class can be understood as a superclass for all deserializers, without being
@@ -102,7 +103,20 @@ public:
     void optionalDeserialize(const std::string& key, T& data, const T& defaultValue);
 
     /**
-     * Deserialize binary from a base64 encoded string to inputBuffer, memory has to be reserved in advance.
+     * Sets the sidecar file binary blobs referenced by the document are read from.
+     *
+     * @see SerializerBase::setBinaryBlobSidecarReader
+     */
+    void setBinaryBlobSidecarReader(const BinaryBlobSidecarReader* reader);
+
+    /**
+     * Returns the sidecar file binary blobs are read from, or null if none has been set.
+     */
+    const BinaryBlobSidecarReader* getBinaryBlobSidecarReader() const;
+
+    /**
+     * Deserialize binary from a base64 encoded string or a sidecar reference to inputBuffer,
+     * memory has to be reserved in advance.
      */
     void deserializeBinaryBlob(const std::string& key, unsigned char* inputBuffer, size_t reservedMemory);
 
@@ -475,6 +489,15 @@ private:
         T& map,
         const std::string& valueKey = XmlSerializationConstants::VALUENODE,
         const std::string& keyKey = XmlSerializationConstants::KEYNODE);
+
+    /**
+     * Looks up the blob referenced by the given @c key in the sidecar file.
+     *
+     * @return @c false if no sidecar reader has been set or the document contains no sidecar reference for @c key
+     *
+     * @throws SerializationFormatException if the referenced blob exceeds the sidecar file
+     */
+    bool getSidecarBinaryBlob(const std::string& key, const unsigned char*& data, size_t& length);
 };
 } // namespace voreen
 
@@ -47,6 +47,7 @@ namespace voreen {
 
 class XmlSerializer;
 class JsonSerializer;
+class BinaryBlobSidecarWriter;
 
 /**
  * This class can be understood as a superclass for all serializers, without being
@@ -98,7 +99,20 @@ public:
     void optionalSerialize(const std::string& key, const T& data, const T& defaultValue);
 
     /**
-     * Serialize the given binary @c data as a base64 encoded string.
+     * Sets the sidecar file binary blobs are written to instead of being base64 encoded into the document.
+     *
+     * @see SerializerBase::setBinaryBlobSidecarWriter
+     */
+    void setBinaryBlobSidecarWriter(BinaryBlobSidecarWriter* writer);
+
+    /**
+     * Returns the sidecar file binary blobs are written to, or null if blobs are embedded into the document.
+     */
+    BinaryBlobSidecarWriter* getBinaryBlobSidecarWriter() const;
+
+    /**
+     * Serialize the given binary @c data as a base64 encoded string, or, if a sidecar writer
+     * has been set, as reference to the data appended to the sidecar file.
      */
     void serializeBinaryBlob(const std::string& key, const unsigned char* data, size_t length);
 
@@ -112,7 +126,7 @@ public:
     void serializeBinaryBlob(const std::string& key, const std::vector<T>& data);
 
     /**
-     * Serialize the given binary @c data vector as a base64 encoded string.
+     * Serialize the given binary @c data vector as a base64 encoded string or sidecar reference.
      */
     void serializeBinaryBlob(const std::string& key, const std::vector<unsigned char>& data);
 
@@ -33,6 +33,9 @@
 
 namespace voreen {
 
+class BinaryBlobSidecarWriter;
+class BinaryBlobSidecarReader;
+
 // Implements common functionality for Voreens deserializers and serializers.
 class VRN_CORE_API SerializerBase {
 public:
@@ -58,6 +61,31 @@ public:
      */
     bool getUsePointerContentSerialization() const;
 
+    /**
+     * Sets the sidecar file binary blobs are written to instead of being base64 encoded
+     * into the document. Pass null to embed blobs into the document (default).
+     *
+     * @note The writer is not owned by the serializer.
+     */
+    void setBinaryBlobSidecarWriter(BinaryBlobSidecarWriter* writer);
+
+    /**
+     * Returns the sidecar file binary blobs are written to, or null if blobs are embedded into the document.
+     */
+    BinaryBlobSidecarWriter* getBinaryBlobSidecarWriter() const;
+
+    /**
+     * Sets the sidecar file binary blobs that are referenced by the document are read from.
+     *
+     * @note The reader is not owned by the deserializer.
+     */
+    void setBinaryBlobSidecarReader(const BinaryBlobSidecarReader* reader);
+
+    /**
+     * Returns the sidecar file binary blobs are read from, or null if none has been set.
+     */
+    const BinaryBlobSidecarReader* getBinaryBlobSidecarReader() const;
+
     /**
      * Adds the given error @c message to the error list.
      *
@@ -138,6 +166,8 @@ public:
 protected:
     std::vector<std::string> errors_;
     bool usePointerContentSerialization_;
+    BinaryBlobSidecarWriter* binaryBlobSidecarWriter_;
+    const BinaryBlobSidecarReader* binaryBlobSidecarReader_;
 };
 
 
@@ -31,7 +31,9 @@
 #include "voreen/core/voreencoreapi.h"
 
 #include <boost/thread.hpp>
-#include <deque>
+#include <atomic>
+#include <unordered_map>
+#include <vector>
 
 namespace voreen {
 
@@ -41,8 +43,13 @@ class VolumeRAM;
 /**
  * This class provides basic memory management for volume data and its representations.
  * Each volume (i.e. VolumeBase object) has to be registered (which is managed transparently by the VolumeBase class constructor / destructor).
- * Once a representation of a Volume is requested, the memory manager checks the available memory and, if it is not sufficient, removes representations from other volumes using an LRU strategy.
+ * Once a representation of a Volume is requested, the memory manager checks the available memory and, if it is not sufficient, removes representations from other volumes.
+ * Eviction candidates are ranked by how long they have not been used, how much memory they occupy and how expensive it is to
+ * recreate the representation (e.g., re-reading it from disk is more expensive than deriving it from another in-memory representation).
  * The main memory and GPU memory / representations are thereby handled individually.
+ *
+ * The registered volumes are distributed over several shards, each with its own hash index, LRU list and mutex,
+ * so that registering volumes and tracking their use do not contend for the global memory manager mutex.
  */
 class VRN_CORE_API VolumeMemoryManager : public tgt::Singleton<VolumeMemoryManager> {
 public:
@@ -63,10 +70,37 @@ protected:
     struct VolumeEntity {
         VolumeBase* volume_;
         size_t numLockedUses_;
+        uint64_t lastUse_;          ///< value of the use counter at the most recent use of the volume
+
+        VolumeEntity* prev_;        ///< more recently used entity of the same shard
+        VolumeEntity* next_;        ///< less recently used entity of the same shard
 
         VolumeEntity(VolumeBase* volume);
     };
 
+    /**
+     * Part of the registered volumes, selected by the address of the volume.
+     * Index and LRU list of a shard may only be accessed while holding its mutex.
+     */
+    struct Shard {
+        boost::mutex mutex_;
+        std::unordered_map<const VolumeBase*, VolumeEntity*> index_;
+        VolumeEntity* head_;        ///< most recently used entity
+        VolumeEntity* tail_;        ///< least recently used entity
+
+        Shard();
+
+        void pushFront(VolumeEntity* entity);
+        void unlink(VolumeEntity* entity);
+    };
+
+    /// Snapshot of a registered volume used for ranking eviction candidates.
+    struct EvictionCandidate {
+        VolumeBase* volume_;
+        uint64_t lastUse_;
+        double score_;              ///< the higher, the earlier the representation is removed
+    };
+
     // VolumeBase and Volume have to call protected functions in MemoryManager and are therefore friend classes
     friend class VolumeBase;
     friend class Volume;
@@ -165,8 +199,29 @@ protected:
     /// internal method for finding a decorated volume in a hierarchy of VolumeDecorators
     const VolumeBase* getActualVolume(const VolumeBase* v);
 
-    /// internal method for retrieving an iterator to
-    std::deque<VolumeEntity>::iterator findRegisteredVolumeEntity(const VolumeBase*);
+    /// Returns the shard the passed volume is (or would be) registered in.
+    Shard& getShard(const VolumeBase* v) const;
+
+    /**
+     * Returns the volumes that currently hold a representation of type T (VolumeRAM or VolumeGL), not locked and
+     * different from the passed volume, ordered by decreasing eviction score.
+     */
+    template<class T>
+    std::vector<EvictionCandidate> getEvictionCandidates(const VolumeBase* excludedVolume) const;
+
+    /// Removes representations of type T from the candidates until the required memory is available.
+    template<class T>
+    bool evictRepresentations(size_t requiredMemory, const VolumeBase* excludedVolume);
+
+    /// Returns true, if the RAM representation of the passed volume is currently locked.
+    bool isLocked(const VolumeBase* v) const;
+
+    /// Returns the registered volumes (a snapshot, the volumes are guaranteed to stay alive only while holding vmmMutex_).
+    std::vector<VolumeBase*> getRegisteredVolumes() const;
+
+    /// Relative cost of recreating a representation of type T of the passed volume after removing it.
+    template<class T>
+    float getReloadCost(const VolumeBase* v) const;
 
     /**
      * Returns a pointer to the mutex of the memory manager, which is used in Volume and VolumeBase class.
@@ -177,7 +232,9 @@ protected:
 
     static const std::string loggerCat_;
 
-    std::deque<VolumeEntity> registeredVolumes_;  ///< the list of registered volumes in LRU order (front: most recently used, back: lest recently used)
+    static const size_t NUM_SHARDS = 16;
+    mutable Shard shards_[NUM_SHARDS];            ///< the registered volumes, each shard in LRU order
+    std::atomic<uint64_t> useCounter_;            ///< incremented on each use notification, serves as logical clock for the LRU ranking
 
     size_t availableMainMemory_;            ///< currently available main memory for volumes (in bytes)
     bool availableMainMemoryInvalid_;       ///< does the available main memory have to be recomputed?
@@ -128,6 +128,29 @@ public:
      */
     void process();
 
+    /**
+     * Enables or disables the concurrent evaluation of the network.
+     *
+     * In concurrent mode, process() runs processors whose inputs are available
+     * on a pool of worker threads, which is kept until concurrent processing is disabled.
+     * Only processors declaring themselves thread-safe (Processor::isThreadSafe) that neither
+     * render (RenderProcessor, RenderPorts) nor own a processor widget are run on the workers.
+     * All other processors are still evaluated on the calling thread, one after another.
+     * Observer notifications issued on a worker thread are sent on the calling thread after
+     * the processor has finished. Processors connected by property links are never run at
+     * the same time. Networks containing loop ports are always evaluated sequentially.
+     *
+     * Concurrent processing is disabled by default.
+     *
+     * @param numThreads number of worker threads. If 0, the number of hardware threads is used.
+     */
+    void setConcurrentProcessing(bool enabled, size_t numThreads = 0);
+
+    /**
+     * Returns whether concurrent evaluation of the network is enabled. \sa setConcurrentProcessing
+     */
+    bool isConcurrentProcessing() const;
+
     /**
      * Performs all necessary updates whenever the network has changed. Call this
      * method carefully and only if the NETWORK changed, not the connections. I.e.,
@@ -260,6 +283,64 @@ private:
         void warn(Processor* p, const std::string& message);
     };
 
+    /// Result of the evaluation of a single processor by executeProcessor().
+    enum ProcessingResult {
+        PROCESSING_DONE,
+        PROCESSING_PORTS_INVALIDATED    ///< beforeProcess() has invalidated the processor's ports
+    };
+
+    /// Result of an evaluation pass over the rendering order.
+    enum EvaluationResult {
+        EVALUATION_FINISHED,
+        EVALUATION_PORTS_INVALIDATED,   ///< a processor has invalidated its ports in beforeProcess()
+        EVALUATION_TOPOLOGY_CHANGED     ///< a processor has invalidated the network topology during processing
+    };
+
+    /// Job queue shared by the worker threads in concurrent mode.
+    struct ConcurrentEvaluationQueue;
+
+    /**
+     * Evaluates the processors in rendering order one after another.
+     *
+     * @param invalidatedProcessor set to the processor that has invalidated its ports,
+     *        if EVALUATION_PORTS_INVALIDATED is returned
+     */
+    EvaluationResult processSequentially(const std::vector<NetworkEvaluatorObserver*>& observers, Processor*& invalidatedProcessor);
+
+    /**
+     * Evaluates independent processors concurrently. \sa setConcurrentProcessing
+     *
+     * @param invalidatedProcessor set to the processor that has invalidated its ports,
+     *        if EVALUATION_PORTS_INVALIDATED is returned
+     */
+    EvaluationResult processConcurrently(const std::vector<NetworkEvaluatorObserver*>& observers, Processor*& invalidatedProcessor);
+
+    /// Returns true, if the current rendering order can be evaluated by processConcurrently().
+    bool canProcessConcurrently() const;
+
+    /**
+     * Prepares the passed processor for being processed: adjusts its properties to changed
+     * inputs, clears its outports if it is not ready, increments its loop iteration counters
+     * and notifies the observers.
+     *
+     * @return true, if the processor needs to be executed
+     */
+    bool prepareProcessor(Processor* processor, const std::vector<NetworkEvaluatorObserver*>& observers);
+
+    /**
+     * Runs beforeProcess(), process() and afterProcess() of the passed processor
+     * while holding its mutex. Exceptions thrown by the processor are logged.
+     *
+     * @param useGL if false, no OpenGL calls are made, which is required on worker threads
+     */
+    ProcessingResult executeProcessor(Processor* processor, bool useGL);
+
+    /// Returns true, if the processor has to be evaluated on the thread calling process().
+    bool requiresContextThread(Processor* processor) const;
+
+    /// Worker thread function of processConcurrently(). Defers the observer notifications of the processed jobs.
+    void processJobs(ConcurrentEvaluationQueue* queue);
+
     /**
      * Causes the member renderingOrder_ to be updated and defines a rendering order
      * for the processors in the current ProcessorNetwork according to the current
@@ -297,6 +378,15 @@ private:
      */
     bool glMode_;
 
+    /// Determines whether independent processors are evaluated concurrently. \sa setConcurrentProcessing
+    bool concurrentProcessing_;
+
+    /// Number of worker threads used in concurrent mode (0: number of hardware threads).
+    size_t numWorkerThreads_;
+
+    /// Worker threads and job queue of concurrent mode, created on first use.
+    ConcurrentEvaluationQueue* workerPool_;
+
     /**
      * If this member is set to true, the method <code>assignRenderTargets()</code>
      * will not attempt to assign the same target in multiple ports on processors
@@ -229,6 +229,8 @@ public:
      *      Is passed as document path to the XMLDeserializer. If an empty string is passed, the location
      *      of the workspace file is used as working directory.
      *
+     * @note If the workspace file references a binary blob sidecar file, it is memory mapped for the deserialization.
+     *
      * @throw SerializationException on serialization errors
      */
     void load(const std::string& filename, const std::string& workDir = "");
@@ -241,10 +243,15 @@ public:
      * @param workDir Absolute working directory of the workspace, used for absolute-to-relative path conversions.
      *      Is passed as document path to the XMLSerializer. If an empty string is passed, the output location
      *      of the workspace file is used as working directory.
+     * @param binaryBlobSidecar if true, binary data embedded into the workspace (e.g., meshes, histograms) is written
+     *      natively to a sidecar file next to the workspace file instead of being base64 encoded into the workspace file.
+     *      The sidecar file is named anew on each save; sidecar files of previous saves are deleted.
+     *
+     * @see BinaryBlobSidecar
      *
      * @throw SerializationException on serialization errors
      */
-    void save(const std::string& filename, bool overwrite = true, const std::string& workDir = "");
+    void save(const std::string& filename, bool overwrite = true, const std::string& workDir = "", bool binaryBlobSidecar = false);
 
     /**
      * Returns the errors that have occurred during serialization.
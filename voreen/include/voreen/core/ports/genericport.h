@@ -101,6 +101,24 @@ private:
     bool owned_;
 };
 
+/**
+ * Data of a GenericPort kept in RAM by the Cache.
+ *
+ * @see Port::detachDataForCache
+ */
+template<typename T>
+class CachedGenericPortData : public CachedPortData {
+public:
+    CachedGenericPortData(const T* data)
+        : data_(data)
+    {}
+    virtual ~CachedGenericPortData() {
+        delete data_;
+    }
+
+    const T* data_;     ///< null, if the ownership has been transferred back to the port
+};
+
 /**
  * @brief Template port class to store points to type T.
  *
@@ -134,6 +152,15 @@ public:
     /// Return whether or not the data is owned and will thus be deleted by the port (see setData).
     bool ownsData() const;
 
+    /// @see Port::detachDataForCache
+    virtual CachedPortData* detachDataForCache();
+
+    /// @see Port::restoreCachedData
+    virtual void restoreCachedData(const CachedPortData* data);
+
+    /// @see Port::reclaimCachedData
+    virtual bool reclaimCachedData(CachedPortData* data);
+
     /**
      * Get a pointer to the data of the port that is safe to use in a thread IF the thread is cancelled on invalidation of the port data.
      * For processing data independently of the evaluation of the network consider AsyncComputeProcessor or refer to it as a reference
@@ -378,6 +405,36 @@ bool GenericPort<T>::ownsData() const {
     return ownsData_;
 }
 
+template <typename T>
+CachedPortData* GenericPort<T>::detachDataForCache() {
+    tgtAssert(isOutport(), "called detachDataForCache on inport!");
+    if (!portData_ || !ownsData_)
+        return 0;
+
+    ownsData_ = false;
+    return new CachedGenericPortData<T>(portData_);
+}
+
+template <typename T>
+void GenericPort<T>::restoreCachedData(const CachedPortData* data) {
+    const CachedGenericPortData<T>* cachedData = dynamic_cast<const CachedGenericPortData<T>*>(data);
+    if (!cachedData || !cachedData->data_)
+        throw VoreenException("Cached data does not match port type");
+
+    setData(cachedData->data_, false);
+}
+
+template <typename T>
+bool GenericPort<T>::reclaimCachedData(CachedPortData* data) {
+    CachedGenericPortData<T>* cachedData = dynamic_cast<CachedGenericPortData<T>*>(data);
+    if (!cachedData || !cachedData->data_ || cachedData->data_ != portData_ || ownsData_)
+        return false;
+
+    ownsData_ = true;
+    cachedData->data_ = 0;
+    return true;
+}
+
 template <typename T>
 std::vector<PortDataPointer<T>> GenericPort<T>::getThreadSafeAllData() const {
     std::vector<PortDataPointer<T>> allDataThreadSafe;
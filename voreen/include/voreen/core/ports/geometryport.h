@@ -46,6 +46,12 @@ public:
     /// This port type supports caching.
     virtual bool supportsCaching() const;
 
+    /// Returns the memory size estimated by Geometry::getMemorySize.
+    virtual size_t getDataMemorySize() const;
+
+    /// Geometries of unknown memory size are not kept in the memory cache.
+    virtual CachedPortData* detachDataForCache();
+
     /**
      * Returns an hash of the stored Geometry retrieved
      * via Geometry::getHash.
@@ -86,6 +86,16 @@ public:
 template class VRN_CORE_API Observable<PortObserver>;
 #endif
 
+/**
+ * Port data kept in RAM by the in-memory tier of the Cache.
+ * Owns the data and deletes it on destruction.
+ *
+ * @see Port::detachDataForCache
+ */
+class VRN_CORE_API CachedPortData {
+public:
+    virtual ~CachedPortData() {}
+};
 
 /**
  * This class describes a port of a Processor. Processors are connected
@@ -370,6 +380,38 @@ public:
      */
     virtual void loadData(const std::string& path);
 
+    /**
+     * Hands the ownership of the port's data over to the returned object,
+     * while the port keeps providing the data. Used by the in-memory tier of the Cache.
+     *
+     * Returns null, if the port has no data, does not own its data,
+     * or if the port type does not support in-memory caching (default).
+     */
+    virtual CachedPortData* detachDataForCache();
+
+    /**
+     * Assigns data that has previously been detached by detachDataForCache()
+     * to the port without taking ownership of it.
+     *
+     * @throws VoreenException If the passed data does not match the port type
+     *      or in-memory caching is not supported.
+     */
+    virtual void restoreCachedData(const CachedPortData* data);
+
+    /**
+     * If the port still provides the passed cached data, it takes back the ownership
+     * of the data, which is then no longer deleted by the CachedPortData object.
+     *
+     * @return true, if the ownership has been transferred back to the port
+     */
+    virtual bool reclaimCachedData(CachedPortData* data);
+
+    /**
+     * Returns an estimate of the main memory (in bytes) occupied by the port's data.
+     * The default implementation returns 0.
+     */
+    virtual size_t getDataMemorySize() const;
+
     virtual void distributeEvent(tgt::Event* e);
 
     std::string getDescription() const;
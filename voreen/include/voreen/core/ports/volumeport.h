@@ -127,6 +127,9 @@ public:
     /// This port type supports caching.
     virtual bool supportsCaching() const;
 
+    /// Returns the memory size of the assigned volume's RAM representation (0 for volumes only present on disk).
+    virtual size_t getDataMemorySize() const;
+
     /**
      * Returns an MD5 hash of the stored volume,
      * or and empty string, if no volume is assigned.
@@ -226,6 +226,9 @@ protected:
     // Use this, if the subclass messes with property visibilities themselves
     // and notify AsyncComputeProcessor when the visibility changes.
     void savePropertyEnableStates();
+    // Returns true, if compute() is called within process() instead of on a background thread.
+    // Only then may a subclass report itself as thread safe (see Processor::isThreadSafe).
+    bool isSynchronousComputation() const;
 
 private:
 
@@ -546,6 +549,11 @@ void AsyncComputeProcessor<I,O>::savePropertyEnableStates() {
     });
 }
 
+template<class I, class O>
+bool AsyncComputeProcessor<I,O>::isSynchronousComputation() const {
+    return synchronousComputation_.get();
+}
+
 template<class I, class O>
 void AsyncComputeProcessor<I,O>::enableRunningState() {
     savePropertyEnableStates();
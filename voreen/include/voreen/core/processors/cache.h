@@ -28,14 +28,35 @@
 
 #include <vector>
 #include <string>
+#include <list>
+
+#include <boost/thread/mutex.hpp>
 
 #include "voreen/core/processors/processor.h"
 
 namespace voreen {
 
+class CachedPortData;
+
+/**
+ * Caches the outport data of a processor keyed by the hashes of its inport data and its property state.
+ *
+ * Results are persisted in the processor's cache directory. Additionally, recently produced results are
+ * kept in RAM (as long as they fit into VoreenApplication::getMemoryCacheLimit(), which is shared by all
+ * caches and enforced by a single LRU list), so that returning to a previous parameter configuration
+ * does not require deserialization.
+ * Only ports supporting in-memory caching (see Port::detachDataForCache) and owning their data are kept in RAM.
+ */
 class VRN_CORE_API Cache {
 public:
+    /// Hash used for identifying the volumes of volume inports.
+    enum VolumeHashType {
+        VOLUME_HASH_DEFAULT,    ///< VolumeBase::getHash(): MD5 of the RAM data, file properties of disk volumes
+        VOLUME_HASH_CHUNKED     ///< VolumeChunkedHash of the voxel data plus meta data hash
+    };
+
     Cache(Processor* proc);
+    ~Cache();
 
     void addInport(Port* inport);
     void addAllInports();
@@ -52,15 +73,27 @@ public:
     std::string getCurrentCacheDir();
     void clearCache();
 
+    /// Removes all results kept in RAM by this cache, the data currently assigned to the outports stays valid.
+    void clearMemoryCache();
+
+    void setVolumeHashType(VolumeHashType type) { volumeHashType_ = type; }
+    VolumeHashType getVolumeHashType() const { return volumeHashType_; }
+
     std::string getAllInportHashes();
     std::string getPropertyState();
     std::string getPropertyStateHash();
 
+    /// Key of the current inport and property state, relative to the processor's cache path.
+    std::string getCacheKey();
+
     bool store();
     bool restore();
 
     bool restoreOutportsFromDir(const std::string& dir);
     bool storeOutportsToDir(const std::string& dir);
+
+    bool restoreOutportsFromMemory(const std::string& key);
+    bool storeOutportsToMemory(const std::string& key);
 protected:
     std::string getInterfaceString();
     bool stringEqualsFileContent(std::string str, std::string fname);
@@ -72,13 +105,43 @@ protected:
     static const std::string loggerCat_;
 
 private:
+    /// Outport data of a single inport and property state kept in RAM.
+    struct MemoryCacheEntry {
+        Cache* cache_;                          ///< cache owning the entry
+        std::string key_;
+        std::vector<CachedPortData*> data_;     ///< one per outport, null for empty outports
+        uint64_t size_;                         ///< estimated memory size of the data (in bytes)
+    };
+
+    /// Hands the data back to the outports (of the owning cache's processor) still providing it and deletes the remaining data.
+    static void deleteMemoryCacheEntry(MemoryCacheEntry* entry);
+
+    /// Returns the in-memory entry of this cache stored for the passed key, end of the LRU list if there is none.
+    /// @note memoryCacheMutex_ has to be locked
+    std::list<MemoryCacheEntry*>::iterator findMemoryCacheEntry(const std::string& key);
+
+    /**
+     * Removes least recently used entries of all caches until their in-memory results fit into the passed limit
+     * and this cache holds at most MAX_MEMORY_CACHE_ENTRIES entries.
+     * @note memoryCacheMutex_ has to be locked
+     */
+    static void limitMemoryCache(uint64_t limit, Cache* cache);
+
     Processor* processor_;
     bool initialized_;
+    VolumeHashType volumeHashType_;
 
     std::vector<std::string> inports_;
     std::vector<std::string> outports_;
 
     std::vector<std::string> properties_;
+
+    static std::list<MemoryCacheEntry*> memoryCacheEntries_;    ///< in-memory entries of all caches, front: most recently used
+    static uint64_t memoryCacheSize_;                           ///< size of the in-memory entries of all caches (in bytes)
+    static boost::mutex memoryCacheMutex_;                      ///< guards the in-memory entries of all caches
+
+    /// Max number of in-memory entries per cache (limits the memory of port data without size estimate)
+    static const size_t MAX_MEMORY_CACHE_ENTRIES;
 };
 
 /// Cleans up the cache dir, will usually be called by VoreenApplication.
@@ -310,6 +310,18 @@ public:
      */
     virtual bool usesExpensiveComputation() const;
 
+    /**
+     * A derived class should return true, if its beforeProcess(), process() and afterProcess()
+     * may be run on a worker thread concurrently to other processors (see NetworkEvaluator::setConcurrentProcessing).
+     * This requires that these methods do not access shared global state, OpenGL, or the GUI, and that they
+     * modify only the processor's own properties. Invalidations and state changes are forwarded to the
+     * evaluating thread. Processors with a widget, property widgets, property links or progress bars
+     * other than their own properties are always processed on the evaluating thread.
+     *
+     * Returns false by default.
+     */
+    virtual bool isThreadSafe() const;
+
     /**
      * Delegates the passed progress value to all assigned progress bars.
      *
@@ -587,6 +599,35 @@ protected:
      */
     void deregisterWidget();
 
+    /**
+     * Observer notifications and network processing requests issued on a worker thread
+     * of the NetworkEvaluator, which are sent on the evaluating thread after the job has finished.
+     */
+    struct DeferredNotifications {
+        const Processor* processor_;                ///< processor executed by the worker thread
+        std::vector<Port*> invalidatedPorts_;       ///< inports of other processors, which may be accessed by other workers
+        std::vector<const Processor*> portsChanged_;
+        std::vector<const Processor*> stateChanged_;
+        bool scheduleNetworkProcessing_;
+
+        DeferredNotifications() : processor_(0), scheduleNetworkProcessing_(false) {}
+    };
+
+    /**
+     * Collects the notifications issued by processors on the calling thread in the passed object
+     * instead of sending them. If null is passed, notifications are sent directly again.
+     */
+    static void setDeferredNotifications(DeferredNotifications* notifications);
+
+    /**
+     * Returns true, if the invalidation of the passed inport has been deferred, since it belongs
+     * to another processor than the one executed on the calling worker thread. Called by Port::invalidatePort().
+     */
+    static bool deferPortInvalidation(Port* inport);
+
+    /// Sends the collected notifications. Has to be called on the evaluating thread.
+    static void sendDeferredNotifications(const DeferredNotifications& notifications);
+
     /// Name of the module the Processor's class belongs to.
     std::string moduleName_;
 
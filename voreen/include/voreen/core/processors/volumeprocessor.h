@@ -31,6 +31,7 @@
 
 #include "voreen/core/properties/boolproperty.h"
 #include "voreen/core/properties/buttonproperty.h"
+#include "voreen/core/properties/optionproperty.h"
 
 #include "voreen/core/processors/cache.h"
 
@@ -65,6 +66,7 @@ protected:
     virtual void afterProcess();
 
     BoolProperty useCaching_;
+    OptionProperty<Cache::VolumeHashType> volumeHashType_;  ///< hash identifying the input volumes in the cache
     ButtonProperty clearCache_;
 
     Cache cache_;
@@ -28,7 +28,10 @@
 
 #include "voreen/core/voreencoreapi.h"
 
+#include "tgt/types.h"
+
 #include <string>
+#include <vector>
 
 namespace voreen {
 
@@ -39,6 +42,39 @@ public:
 
     /// Compute md5 hash.
     static std::string getHash(const std::string& s);
+
+    /**
+     * Compute a fast, non-cryptographic 64 bit hash of the passed data.
+     * The data is split into chunks that are hashed in parallel. \sa VoreenChunkedHash
+     */
+    static std::string getChunkedHash(const void* data, size_t size);
+};
+
+/**
+ * Incrementally computes a non-cryptographic 64 bit hash of a byte stream:
+ * The stream is split into chunks of CHUNK_SIZE bytes, whose 64 bit digests
+ * (XXH64) are computed in parallel and combined afterwards. The result only depends
+ * on the byte stream, not on how it is partitioned into update() calls.
+ *
+ * @note since the chunk digests are 64 bit, so is the collision resistance of the result.
+ */
+class VRN_CORE_API VoreenChunkedHash {
+public:
+    VoreenChunkedHash();
+
+    /// Appends the passed data to the hashed stream.
+    void update(const void* data, size_t size);
+
+    /// Returns the hash of the data passed so far as hex string of 16 characters.
+    std::string getHash() const;
+
+    /// Size of the independently hashed chunks in bytes.
+    static const size_t CHUNK_SIZE;
+
+private:
+    std::vector<uint64_t> chunkDigests_;    ///< digests of all completed chunks
+    std::vector<unsigned char> pending_;    ///< data of the incomplete last chunk
+    uint64_t size_;                         ///< number of bytes passed so far
 };
 
 }  // namespace voreen
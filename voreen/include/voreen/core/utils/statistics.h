@@ -41,6 +41,13 @@ public:
      * @param collectSamples if set to true, samples are collected in order to calculate median, q1, q3. Default = true.
      */
     Statistics(bool collectSamples = true);
+
+    /**
+     * Restores statistics, which do not collect samples, from values previously queried
+     * from another Statistics object, e.g., after reading them from a file.
+     */
+    static Statistics fromSummary(size_t numSamples, float min, float max, float sum, float mean, float variance);
+
     void reset();
 
     void addSample(float v);
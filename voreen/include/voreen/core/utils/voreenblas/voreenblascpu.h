@@ -33,6 +33,10 @@ namespace voreen {
 
 /**
  * Basic CPU implementation of the Basic Linear Algebra Subprograms (BLAS).
+ *
+ * The operations are performed by the runtime dispatched SIMD kernels of VoreenBlasKernels.
+ * The conjugate gradient solvers use the fused kernels, which require three passes over
+ * the data per iteration.
  */
 class VRN_CORE_API VoreenBlasCPU : public VoreenBlas {
 
@@ -56,6 +60,10 @@ public:
         float* initial = 0, float threshold = 1e-4f, int maxIterations = 1000) const;
 
 private:
+    template<typename T>
+    int conjGradEll(const EllpackMatrix<T>& mat, const float* vec, float* result,
+        float* initial, ConjGradPreconditioner precond, float threshold, int maxIterations, ProgressReporter* progress) const;
+
     static const std::string loggerCat_; ///< category used in logging
 };
 
@@ -0,0 +1,112 @@
+/***********************************************************************************
+ *                                                                                 *
+ * Voreen - The Volume Rendering Engine                                            *
+ *                                                                                 *
+ * Copyright (C) 2005-2024 University of Muenster, Germany,                        *
+ * Department of Computer Science.                                                 *
+ * For a list of authors please refer to the file "CREDITS.txt".                   *
+ *                                                                                 *
+ * This file is part of the Voreen software package. Voreen is free software:      *
+ * you can redistribute it and/or modify it under the terms of the GNU General     *
+ * Public License version 2 as published by the Free Software Foundation.          *
+ *                                                                                 *
+ * Voreen is distributed in the hope that it will be useful, but WITHOUT ANY       *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR   *
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.      *
+ *                                                                                 *
+ * You should have received a copy of the GNU General Public License in the file   *
+ * "LICENSE.txt" along with this file. If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                                 *
+ * For non-commercial academic use see the license exception specified in the file *
+ * "LICENSE-academic.txt". To get information about commercial licensing please    *
+ * contact the authors.                                                            *
+ *                                                                                 *
+ ***********************************************************************************/
+
+#ifndef VRN_VOREENBLASKERNELS_H
+#define VRN_VOREENBLASKERNELS_H
+
+#include "voreen/core/utils/voreenblas/ellpackmatrix.h"
+#include "voreen/core/voreencoreapi.h"
+
+#include <string>
+
+namespace voreen {
+
+/**
+ * Vectorized building blocks of the CPU implementations of VoreenBlas.
+ *
+ * The vector kernels are available as portable scalar code as well as in AVX2 and AVX-512 variants.
+ * The variant to be used is selected at runtime according to the instruction sets supported
+ * by the CPU, so the binaries do not depend on the architecture they have been built on.
+ * The sparse matrix vector product is bound by the memory bandwidth and always uses scalar code.
+ *
+ * Besides the plain level 1 and 2 operations, the fused kernels of a (Jacobi preconditioned)
+ * conjugate gradient iteration are provided, which perform all vector updates of an iteration
+ * in a single pass over the data. Reductions are accumulated in double precision.
+ *
+ * All kernels process the index range [begin, end) only, so that parallel implementations
+ * can distribute cache-sized blocks among their threads.
+ */
+class VRN_CORE_API VoreenBlasKernels {
+public:
+
+    enum InstructionSet {
+        GENERIC,
+        AVX2,
+        AVX512
+    };
+
+    /// Returns the instruction set used by the kernels.
+    static InstructionSet getInstructionSet();
+
+    /// Returns the best instruction set supported by the CPU.
+    static InstructionSet getSupportedInstructionSet();
+
+    /**
+     * Selects the instruction set to be used by the kernels, e.g., for benchmarking.
+     * Instruction sets that are not supported by the CPU are replaced by the best supported one.
+     * Must not be called while kernels are executed by other threads.
+     */
+    static void setInstructionSet(InstructionSet instructionSet);
+
+    static std::string getInstructionSetName(InstructionSet instructionSet);
+
+    /// Returns sum(x[i]*y[i]).
+    static double dot(size_t begin, size_t end, const float* x, const float* y);
+
+    /// result[i] <= alpha*x[i] + y[i]. result may alias x or y.
+    static void axpy(size_t begin, size_t end, const float* x, const float* y, float alpha, float* result);
+
+    /**
+     * Multiplies the rows [begin, end) of the matrix with vec.
+     *
+     * @param result receives the product for the rows of the range, may be null
+     * @param dotVec if not null, the dot product of dotVec and the product is returned, 0 otherwise
+     */
+    static double spMVEll(const EllpackMatrix<float>& mat, size_t begin, size_t end, const float* vec, float* result, const float* dotVec);
+
+    /// @overload The matrix entries are scaled by 1/(2^15-1).
+    static double spMVEll(const EllpackMatrix<int16_t>& mat, size_t begin, size_t end, const float* vec, float* result, const float* dotVec);
+
+    /**
+     * Updates solution and residual of a conjugate gradient iteration and applies the Jacobi preconditioner:
+     *
+     * x <= x + alpha*p, r <= r - alpha*Ap, z <= invDiag*r
+     *
+     * @param invDiag inverse diagonal of the system matrix. If null, no preconditioner is applied and z is not written.
+     * @return dot(r, z) or dot(r, r), if no preconditioner is applied
+     */
+    static double updateResidual(size_t begin, size_t end, float alpha, const float* p, const float* Ap,
+                                 float* x, float* r, const float* invDiag, float* z);
+
+    /// Updates the search direction of a conjugate gradient iteration: p <= z + beta*p
+    static void updateDirection(size_t begin, size_t end, float beta, const float* z, float* p);
+
+private:
+    static const std::string loggerCat_;
+};
+
+} // namespace
+
+#endif
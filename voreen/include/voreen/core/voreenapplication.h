@@ -144,6 +144,9 @@ public:
     /// returns the state of the property with the same name
     bool getAskForSave() const;
 
+    /// returns the state of the property with the same name
+    bool getSaveBinaryBlobSidecar() const;
+
 
     /**
      * Sets the log level to be used for all loggers.
@@ -346,6 +349,9 @@ public:
     /// Returns the CPU RAM limit in bytes set for the entire application, which is used for volume and octree memory management.
     size_t getCpuRamLimit() const;
 
+    /// Returns the main memory (in bytes) that may be used by all processor caches for keeping results in RAM (0: disabled).
+    size_t getMemoryCacheLimit() const;
+
     /// Returns the GPU memory limit in bytes which is used for managing the GPU texture memory available for volumes in memory management
     size_t getGpuMemoryLimit() const;
 
@@ -726,6 +732,7 @@ private:
     BoolProperty useCaching_;
     IntProperty volumeCacheLimit_;
     IntProperty octreeCacheLimit_;
+    IntProperty memoryCacheLimit_;
     FileDialogProperty cachePath_;
     ButtonProperty resetCachePath_;
     ButtonProperty deleteCache_;
@@ -760,6 +767,7 @@ private:
     // not used directly by the VoreenApplication, but may be quried by an actual application (e.g. VoreenVE)
     BoolProperty showSplashScreen_;             //< if true, a splash screen should be shown on start up
     BoolProperty askForSave_;                   //< if true, the user should be asked, if he wants to save the modified workspace
+    BoolProperty saveBinaryBlobSidecar_;        //< if true, binary data of saved workspaces is written to a separate file (@see Workspace::save)
     //BoolProperty loadLastWorkspaceOnStartup_;   //< if true, the last loaded workspace should be restored
     BoolProperty showStartupWizard_; //< if true, shows the startup wizard, else creates an empty workspace
 
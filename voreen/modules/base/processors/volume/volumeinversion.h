@@ -46,6 +46,7 @@ public:
     virtual CodeState getCodeState() const    { return CODE_STATE_STABLE;   }
 
     virtual bool usesExpensiveComputation() const { return true; }
+    virtual bool isThreadSafe() const             { return true; }
 
 protected:
     virtual void setDescriptions() {
@@ -135,6 +135,10 @@ void processDispatch(const VolumeBase& input, std::unique_ptr<Volume>& output, c
     output = std::move(builder).finalize().toVolume();
 }
 
+bool LargeVolumeFormatConversion::isThreadSafe() const {
+    return isSynchronousComputation();
+}
+
 LargeVolumeFormatConversion::ComputeInput LargeVolumeFormatConversion::prepareComputeInput() {
     if(!enableProcessing_.get()) {
         return LargeVolumeFormatConversion::ComputeInput { "", "", nullptr };
@@ -63,6 +63,10 @@ bool VolumeArgMax::isReady() const {
     return inportVolume0_.isReady();
 }
 
+bool VolumeArgMax::isThreadSafe() const {
+    return isSynchronousComputation();
+}
+
 VolumeArgMax::ComputeInput VolumeArgMax::prepareComputeInput() {
     tgtAssert(inportVolume0_.hasData(), "no input volume 0");
 
@@ -59,6 +59,7 @@ public:
     virtual Processor::CodeState getCodeState() const   { return CODE_STATE_EXPERIMENTAL;  }
 
     virtual bool isReady() const;
+    virtual bool isThreadSafe() const;
 
     static const std::string loggerCat_; ///< category used in logging
 
@@ -202,6 +202,10 @@ void VolumeFilterList::deserialize(Deserializer& s) {
     inputOutputChannelCheck();
 }
 
+bool VolumeFilterList::isThreadSafe() const {
+    return isSynchronousComputation();
+}
+
 VolumeFilterListInput VolumeFilterList::prepareComputeInput() {
     if(!enabled_.get() || !hasConfiguredFilters()) {
         outport_.setData(inport_.getData(), false);
@@ -215,7 +219,8 @@ VolumeFilterListInput VolumeFilterList::prepareComputeInput() {
     auto inputVolPtr = inport_.getThreadSafeData();
     const VolumeBase& inputVolume = *inputVolPtr;
 
-    VolumeFilterStackBuilder builder(inputVolume);
+    // Each filter layer runs on its own thread, overlapping reading, filtering and writing the output.
+    VolumeFilterStackBuilder builder(inputVolume, true);
 
     SliceReaderMetaData metadata = SliceReaderMetaData::fromVolume(inputVolume);
     for(const InteractiveListProperty::Instance& instance : filterList_.getInstances()) {
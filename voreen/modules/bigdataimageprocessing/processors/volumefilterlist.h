@@ -78,6 +78,7 @@ public:
 
     virtual bool isReady() const;
     virtual bool isEndProcessor() const       { return true; }
+    virtual bool isThreadSafe() const;
 
     /** @see Property::serialize */
     virtual void serialize(Serializer& s) const;
@@ -107,6 +107,10 @@ VolumeResampleTransformation::VolumeResampleTransformation()
     setPropertyGroupGuiName("output", "Output Information");
 }
 
+bool VolumeResampleTransformation::isThreadSafe() const {
+    return isSynchronousComputation();
+}
+
 VolumeResampleTransformationInput VolumeResampleTransformation::prepareComputeInput() {
     const VolumeBase* inputPtr = inport_.getData();
     if(!inputPtr) {
@@ -122,6 +122,7 @@ public:
     std::string getCategory() const       { return "Volume Processing"; }
     CodeState getCodeState() const        { return CODE_STATE_TESTING; }
     virtual bool isReady() const;
+    virtual bool isThreadSafe() const;
 
     virtual ComputeInput prepareComputeInput();
     virtual ComputeOutput compute(ComputeInput input, ProgressReporter& progressReporter) const;
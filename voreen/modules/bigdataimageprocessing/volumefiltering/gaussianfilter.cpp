@@ -136,73 +136,59 @@ std::unique_ptr<VolumeRAM> GaussianFilter::getFilteredSlice(const CachingSliceRe
     tgtAssert(z >= 0 && z<src->getSignedDimensions().z, "Invalid z pos in slice request");
 
     const tgt::ivec3& dim = src->getSignedDimensions();
+    const tgt::ivec3& extent = neighborhoodDimensions_;
     VolumeFactory volumeFactory;
     std::string format = volumeFactory.getFormat(src->getMetaData().getBaseType(), numChannels_);
     std::unique_ptr<VolumeRAM> outputSlice(volumeFactory.create(format, tgt::svec3(dim.xy(), 1)));
-    std::unique_ptr<VolumeRAM> srcSlice(volumeFactory.create(format, tgt::svec3(dim.xy(), 1)));
 
-    // TODO: Memory access-wise, iterating the channels first is a quite inefficient operation.
-    //  Either use templates for this class or make this a nested loop inside those iterating voxels.
-    //  However, for the single-channel-case being implemented before, this means practically no difference.
-    for(size_t channel = 0; channel < numChannels_; channel++) {
+    // The separable passes operate on contiguous float rows: The z pass is evaluated for all rows
+    // required by the y pass (i.e., including a border of extent.y rows), the y and x passes are
+    // then applied row by row using a row buffer padded by extent.x voxels.
+    const int paddedDimY = dim.y + 2*extent.y;
+    const int paddedDimX = dim.x + 2*extent.x;
+    std::vector<float> zFiltered(static_cast<size_t>(paddedDimY)*dim.x);
 
-        SamplingStrategy<float>::Sampler getValueFromReader = [src, channel](const tgt::ivec3 &p) {
-            return src->getVoxelNormalized(p, channel);
-        };
+    for(size_t channel = 0; channel < numChannels_; channel++) {
 
         // z
         #pragma omp parallel for
-        for (int y = 0; y < dim.y; ++y) {
-            for (int x = 0; x < dim.x; ++x) {
-                float accumulator = 0;
-                for (int dz = -neighborhoodDimensions_.z; dz <= neighborhoodDimensions_.z; ++dz) {
-                    // Why does template parameter deduction fail here? We should be able to call .sample(...)
-                    accumulator += getKernelValZ(dz) *
-                                   samplingStrategy_.sample(tgt::ivec3(x, y, z + dz),
-                                                            dim, getValueFromReader);
+        for (int y = -extent.y; y < dim.y + extent.y; ++y) {
+            std::vector<float> row(dim.x);
+            float* accumulator = zFiltered.data() + static_cast<size_t>(y + extent.y)*dim.x;
+            std::fill(accumulator, accumulator + dim.x, 0.0f);
+            for (int dz = -extent.z; dz <= extent.z; ++dz) {
+                src->getPaddedRowNormalized(y, z + dz, channel, 0, samplingStrategy_, row.data());
+                const float weight = getKernelValZ(dz);
+                for (int x = 0; x < dim.x; ++x) {
+                    accumulator[x] += weight * row[x];
                 }
-                outputSlice->setVoxelNormalized(accumulator, tgt::svec3(x, y, 0), channel);
             }
         }
 
-        std::swap(outputSlice, srcSlice);
-        const VolumeRAM *srcSlicePtr = srcSlice.get();
-
-        SamplingStrategy<float>::Sampler getValueFromSrcSlice = [&srcSlicePtr, channel](const tgt::ivec3 &p) {
-            return srcSlicePtr->getVoxelNormalized(tgt::svec3(p), channel);
-        };
-
-        // y
+        // y and x
         #pragma omp parallel for
         for (int y = 0; y < dim.y; ++y) {
-            for (int x = 0; x < dim.x; ++x) {
-                float accumulator = 0;
-                for (int dy = -neighborhoodDimensions_.y; dy <= neighborhoodDimensions_.y; ++dy) {
-                    accumulator += getKernelValY(dy) *
-                                   samplingStrategy_.sample(tgt::ivec3(x, y + dy, 0),
-                                                            dim /* wrong in z, but doesn't matter */,
-                                                            getValueFromSrcSlice);
+            std::vector<float> paddedRow(paddedDimX);
+            float* yFiltered = paddedRow.data() + extent.x;
+            std::fill(yFiltered, yFiltered + dim.x, 0.0f);
+            for (int dy = -extent.y; dy <= extent.y; ++dy) {
+                const float* row = zFiltered.data() + static_cast<size_t>(y + dy + extent.y)*dim.x;
+                const float weight = getKernelValY(dy);
+                for (int x = 0; x < dim.x; ++x) {
+                    yFiltered[x] += weight * row[x];
                 }
-                outputSlice->setVoxelNormalized(accumulator, tgt::svec3(x, y, 0), channel);
             }
-        }
-
-        std::swap(outputSlice, srcSlice);
-        srcSlicePtr = srcSlice.get();
-
-        // x
-        #pragma omp parallel for
-        for (int y = 0; y < dim.y; ++y) {
-            for (int x = 0; x < dim.x; ++x) {
-                float accumulator = 0;
-                for (int dx = -neighborhoodDimensions_.x; dx <= neighborhoodDimensions_.x; ++dx) {
-                    accumulator += getKernelValX(dx) *
-                                   samplingStrategy_.sample(tgt::ivec3(x + dx, y, 0),
-                                                            dim /* wrong in z, but doesn't matter */,
-                                                            getValueFromSrcSlice);
+            fillRowBorder(yFiltered, dim.x, extent.x, samplingStrategy_);
+
+            std::vector<float> result(dim.x, 0.0f);
+            for (int dx = -extent.x; dx <= extent.x; ++dx) {
+                const float* row = yFiltered + dx;
+                const float weight = getKernelValX(dx);
+                for (int x = 0; x < dim.x; ++x) {
+                    result[x] += weight * row[x];
                 }
-                outputSlice->setVoxelNormalized(accumulator, tgt::svec3(x, y, 0), channel);
             }
+            writeSliceRowNormalized(outputSlice.get(), y, channel, result.data());
         }
     }
 
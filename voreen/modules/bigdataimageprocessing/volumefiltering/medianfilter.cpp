@@ -25,8 +25,64 @@
 
 #include "medianfilter.h"
 
+#include "voreen/core/datastructures/volume/operators/volumeoperatormedian.h"
+
+#include <cmath>
+
 namespace voreen {
 
+/**
+ * Median of the rows of a block for integer base types of up to 16 bits: The normalized values are
+ * mapped back to the integer values of the input volume, which serve as bins of a histogram of the
+ * neighborhood. Moving to the next voxel only removes and adds a single column of the neighborhood.
+ */
+template<typename T>
+static void getRowHistogram(const ParallelFilterBlock& block, int y, int z, const tgt::ivec3& extent, float* out) {
+    const float lowerBound = VolumeElement<T>::isSigned() ? -1.0f : 0.0f;
+    auto toBin = [lowerBound] (float value) {
+        value = tgt::clamp(value, lowerBound, 1.0f);
+        float scale = value >= 0.0f ? VolumeElement<T>::rangeMaxElement() : -VolumeElement<T>::rangeMinElement();
+        return static_cast<size_t>(std::lround(value*scale) - static_cast<long>(std::numeric_limits<T>::min()));
+    };
+
+    // Bins of the column of the neighborhood for each x position of the padded row.
+    const int numColumns = block.getDimX() + 2*extent.x;
+    const size_t columnSize = static_cast<size_t>(2*extent.y+1)*(2*extent.z+1);
+    std::vector<size_t> bins(numColumns*columnSize);
+    size_t offset = 0;
+    for(int dz = -extent.z; dz <= extent.z; ++dz) {
+        for(int dy = -extent.y; dy <= extent.y; ++dy) {
+            const float* row = block.getRow(y+dy, z+dz, 0) - extent.x;
+            for(int c = 0; c < numColumns; ++c) {
+                bins[c*columnSize + offset] = toBin(row[c]);
+            }
+            ++offset;
+        }
+    }
+
+    SlidingHistogramMedian histogram(size_t(1) << (8*sizeof(T)));
+    auto addColumn = [&] (int c) {
+        for(size_t i = c*columnSize; i < (c+1)*columnSize; ++i) {
+            histogram.add(bins[i]);
+        }
+    };
+    auto removeColumn = [&] (int c) {
+        for(size_t i = c*columnSize; i < (c+1)*columnSize; ++i) {
+            histogram.remove(bins[i]);
+        }
+    };
+
+    for(int c = 0; c < 2*extent.x; ++c) {
+        addColumn(c);
+    }
+    for(int x = 0; x < block.getDimX(); ++x) {
+        addColumn(x + 2*extent.x);
+        long median = static_cast<long>(histogram.getMedian()) + static_cast<long>(std::numeric_limits<T>::min());
+        out[x] = getTypeAsFloat(static_cast<T>(median));
+        removeColumn(x);
+    }
+}
+
 MedianFilter::MedianFilter(const tgt::ivec3& extent, const SamplingStrategy<ParallelFilterValue1D>& samplingStrategy)
     : ParallelVolumeFilter<ParallelFilterValue1D, ParallelFilterValue1D>(extent.z, samplingStrategy)
     , extent_(extent)
@@ -51,6 +107,50 @@ ParallelFilterValue1D MedianFilter::getValue(const Sample& sample, const tgt::iv
     return values[values.size()/2];
 }
 
+tgt::ivec2 MedianFilter::getBlockExtent() const {
+    return extent_.xy();
+}
+
+void MedianFilter::getRow(const ParallelFilterBlock& block, int y, int z, float* out, const SliceReaderMetaData& inputMetadata, const SliceReaderMetaData& outputMetaData) const {
+    // The histogram pays off for all 8 bit neighborhoods, but 16 bit histograms are only worth
+    // their size (and the search for the median within it) for larger neighborhoods. The threshold
+    // is shared with VolumeOperatorMedian.
+    const size_t neighborhoodSize = tgt::hmul(tgt::svec3(2*extent_+tgt::ivec3::one));
+    const std::string baseType = inputMetadata.getBaseType();
+    if(baseType == "uint8") {
+        getRowHistogram<uint8_t>(block, y, z, extent_, out);
+        return;
+    }
+    else if(baseType == "int8") {
+        getRowHistogram<int8_t>(block, y, z, extent_, out);
+        return;
+    }
+    else if(baseType == "uint16" && neighborhoodSize >= SlidingHistogramMedian::MIN_NEIGHBORHOOD_SIZE_16BIT) {
+        getRowHistogram<uint16_t>(block, y, z, extent_, out);
+        return;
+    }
+    else if(baseType == "int16" && neighborhoodSize >= SlidingHistogramMedian::MIN_NEIGHBORHOOD_SIZE_16BIT) {
+        getRowHistogram<int16_t>(block, y, z, extent_, out);
+        return;
+    }
+
+    std::vector<float> values(tgt::hmul(2*extent_+tgt::ivec3::one));
+    const size_t rowLength = 2*extent_.x+1;
+
+    for(int x = 0; x < block.getDimX(); ++x) {
+        // gather the neighborhood from contiguous row segments of the block
+        auto it = values.begin();
+        for(int dz = -extent_.z; dz <= extent_.z; ++dz) {
+            for(int dy = -extent_.y; dy <= extent_.y; ++dy) {
+                const float* row = block.getRow(y+dy, z+dz, 0) + x - extent_.x;
+                it = std::copy(row, row + rowLength, it);
+            }
+        }
+        std::nth_element(values.begin(), values.begin() + values.size()/2, values.end());
+        out[x] = values[values.size()/2];
+    }
+}
+
 SliceReaderMetaData MedianFilter::getMetaData(const SliceReaderMetaData& base) const {
     auto md = SliceReaderMetaData::fromBase(base);
     if(base.getMinMaxBounds()) {
@@ -35,6 +35,8 @@ public:
     MedianFilter(const tgt::ivec3& extent, const SamplingStrategy<ParallelFilterValue1D>& samplingStrategy);
     virtual ~MedianFilter();
     ParallelFilterValue1D getValue(const Sample& sample, const tgt::ivec3& pos, const SliceReaderMetaData& inputMetadata, const SliceReaderMetaData& outputMetaData) const;
+    virtual tgt::ivec2 getBlockExtent() const;
+    virtual void getRow(const ParallelFilterBlock& block, int y, int z, float* out, const SliceReaderMetaData& inputMetadata, const SliceReaderMetaData& outputMetaData) const;
     virtual SliceReaderMetaData getMetaData(const SliceReaderMetaData& base) const;
 private:
     tgt::ivec3 extent_;
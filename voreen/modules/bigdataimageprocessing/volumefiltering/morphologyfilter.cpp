@@ -27,6 +27,8 @@
 
 #include "slicereader.h"
 
+#include "voreen/core/datastructures/volume/operators/volumeoperatormorphology.h"
+
 namespace {
     static const auto DILATION_FUNC = [](float a, float b) { return std::max(a, b); };
     static const auto EROSION_FUNC  = [](float a, float b) { return std::min(a, b); };
@@ -78,61 +80,94 @@ MorphologyOperatorShape MorphologyFilter::getMorphologyOperatorShape() const {
     return shape_;
 }
 
-std::unique_ptr<VolumeRAM> MorphologyFilter::getFilteredSliceCubeMorphology(const CachingSliceReader* src, int z) const {
+template<typename Op>
+static void combineRows(float* target, const float* row, int length, Op op) {
+    for (int x = 0; x < length; ++x) {
+        target[x] = op(target[x], row[x]);
+    }
+}
 
+template<typename Op>
+static void filterCube(const CachingSliceReader* src, int z, const tgt::ivec3& extent, const SamplingStrategy<float>& samplingStrategy, VolumeRAM* outputSlice, Op op) {
     const tgt::ivec3& dim = src->getSignedDimensions();
-    std::string type = src->getMetaData().getBaseType();
-    std::unique_ptr<VolumeRAM> outputSlice(VolumeFactory().create(type, tgt::svec3(dim.xy(), 1)));
-    std::unique_ptr<VolumeRAM> srcSlice(VolumeFactory().create(type, tgt::svec3(dim.xy(), 1)));
 
-    SamplingStrategy<float>::Sampler getValueFromReader = [src](const tgt::ivec3& p) {
-        return src->getVoxelNormalized(p);
-    };
+    // The separable passes operate on contiguous float rows: The z pass is evaluated for all rows
+    // required by the y pass, the y and x passes are then applied row by row. Since the slices are
+    // streamed, the z pass combines all rows of the window, while the y and x passes require a
+    // constant number of operations per voxel independent of the extent.
+    std::vector<float> zFiltered(static_cast<size_t>(dim.y + 2*extent.y)*dim.x);
 
     // z
     #pragma omp parallel for
-    for (int y = 0; y < dim.y; ++y) {
-        for (int x = 0; x < dim.x; ++x) {
-            float value = samplingStrategy_.sample(tgt::ivec3(x, y, z), dim, getValueFromReader);
-            for (int dz = -extent_.z; dz <= extent_.z; ++dz) {
-               value = morphFunc_(value, samplingStrategy_.sample(tgt::ivec3(x, y, z + dz), dim, getValueFromReader));
-            }
-            outputSlice->setVoxelNormalized(value, tgt::svec3(x, y, 0));
+    for (int y = -extent.y; y < dim.y + extent.y; ++y) {
+        std::vector<float> row(dim.x);
+        float* value = zFiltered.data() + static_cast<size_t>(y + extent.y)*dim.x;
+        src->getPaddedRowNormalized(y, z, 0, 0, samplingStrategy, value);
+        for (int dz = -extent.z; dz <= extent.z; ++dz) {
+            src->getPaddedRowNormalized(y, z + dz, 0, 0, samplingStrategy, row.data());
+            combineRows(value, row.data(), dim.x, op);
         }
     }
 
-    std::swap(outputSlice, srcSlice);
-    const VolumeRAM* srcSlicePtr = srcSlice.get();
-
-    SamplingStrategy<float>::Sampler getValueFromSrcSlice = [&srcSlicePtr](const tgt::ivec3& p) {
-        return srcSlicePtr->getVoxelNormalized(tgt::svec3(p));
-    };
-
-    // y
+    // y: van Herk/Gil-Werman on whole rows. The rows of zFiltered are split into segments of the
+    // window size, for which prefix and suffix rows are computed.
+    const int numRows = dim.y + 2*extent.y;
+    const int window = 2*extent.y + 1;
+    std::vector<float> prefix(zFiltered.size());
+    std::vector<float> suffix(zFiltered.size());
     #pragma omp parallel for
-    for (int y = 0; y < dim.y; ++y) {
-        for (int x = 0; x < dim.x; ++x) {
-            float value = samplingStrategy_.sample(tgt::ivec3(x, y, 0), dim, getValueFromSrcSlice);
-            for (int dy = -extent_.y; dy <= extent_.y; ++dy) {
-                value = morphFunc_(value, samplingStrategy_.sample(tgt::ivec3(x, y + dy, 0), dim /* wrong in z, but doesn't matter */, getValueFromSrcSlice));
-            }
-            outputSlice->setVoxelNormalized(value, tgt::svec3(x, y, 0));
+    for (int begin = 0; begin < numRows; begin += window) {
+        const int end = std::min(begin + window, numRows);
+        float* prefixRow = prefix.data() + static_cast<size_t>(begin)*dim.x;
+        std::copy(zFiltered.data() + static_cast<size_t>(begin)*dim.x, zFiltered.data() + static_cast<size_t>(begin+1)*dim.x, prefixRow);
+        for (int r = begin + 1; r < end; ++r) {
+            float* row = prefix.data() + static_cast<size_t>(r)*dim.x;
+            std::copy(zFiltered.data() + static_cast<size_t>(r)*dim.x, zFiltered.data() + static_cast<size_t>(r+1)*dim.x, row);
+            combineRows(row, row - dim.x, dim.x, op);
+        }
+        float* suffixRow = suffix.data() + static_cast<size_t>(end-1)*dim.x;
+        std::copy(zFiltered.data() + static_cast<size_t>(end-1)*dim.x, zFiltered.data() + static_cast<size_t>(end)*dim.x, suffixRow);
+        for (int r = end - 2; r >= begin; --r) {
+            float* row = suffix.data() + static_cast<size_t>(r)*dim.x;
+            std::copy(zFiltered.data() + static_cast<size_t>(r)*dim.x, zFiltered.data() + static_cast<size_t>(r+1)*dim.x, row);
+            combineRows(row, row + dim.x, dim.x, op);
         }
     }
 
-    std::swap(outputSlice, srcSlice);
-    srcSlicePtr = srcSlice.get();
-
-    // x
+    // x: van Herk/Gil-Werman on each padded row
     #pragma omp parallel for
     for (int y = 0; y < dim.y; ++y) {
+        std::vector<float> paddedRow(dim.x + 2*extent.x);
+        float* yFiltered = paddedRow.data() + extent.x;
+        const float* suffixRow = suffix.data() + static_cast<size_t>(y)*dim.x;
+        const float* prefixRow = prefix.data() + static_cast<size_t>(y + 2*extent.y)*dim.x;
         for (int x = 0; x < dim.x; ++x) {
-            float value = samplingStrategy_.sample(tgt::ivec3(x, y, 0), dim, getValueFromSrcSlice);
-            for (int dx = -extent_.x; dx <= extent_.x; ++dx) {
-                value = morphFunc_(value, samplingStrategy_.sample(tgt::ivec3(x+dx, y, 0), dim, getValueFromSrcSlice));
-            }
-            outputSlice->setVoxelNormalized(value, tgt::svec3(x, y, 0));
+            yFiltered[x] = op(suffixRow[x], prefixRow[x]);
         }
+        fillRowBorder(yFiltered, dim.x, extent.x, samplingStrategy);
+
+        std::vector<float> result(dim.x), xPrefix(paddedRow.size()), xSuffix(paddedRow.size());
+        vanHerkGilWermanFilter(paddedRow.data(), result.data(), static_cast<size_t>(dim.x), static_cast<size_t>(extent.x), op, xPrefix.data(), xSuffix.data());
+        writeSliceRowNormalized(outputSlice, y, 0, result.data());
+    }
+}
+
+std::unique_ptr<VolumeRAM> MorphologyFilter::getFilteredSliceCubeMorphology(const CachingSliceReader* src, int z) const {
+
+    const tgt::ivec3& dim = src->getSignedDimensions();
+    std::string type = src->getMetaData().getBaseType();
+    std::unique_ptr<VolumeRAM> outputSlice(VolumeFactory().create(type, tgt::svec3(dim.xy(), 1)));
+
+    // Dispatch on the operator type here, so that the inner loops do not call morphFunc_ per voxel.
+    switch (type_) {
+    case DILATION_T:
+        filterCube(src, z, extent_, samplingStrategy_, outputSlice.get(), DILATION_FUNC);
+        break;
+    case EROSION_T:
+        filterCube(src, z, extent_, samplingStrategy_, outputSlice.get(), EROSION_FUNC);
+        break;
+    default:
+        tgtAssert(false, "Unimplemented morphology type");
     }
     return outputSlice;
 }
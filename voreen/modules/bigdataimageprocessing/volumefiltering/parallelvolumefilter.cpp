@@ -26,6 +26,61 @@
 #include "parallelvolumefilter.h"
 namespace voreen {
 
+// ParallelFilterBlock -----------------------------------------------------------------------
+
+ParallelFilterBlock::ParallelFilterBlock(int dimX, const tgt::ivec2& extent, int zExtent, size_t numChannels)
+    : dimX_(dimX)
+    , extent_(extent)
+    , zExtent_(zExtent)
+    , numChannels_(numChannels)
+    , yBegin_(0)
+    , numRows_(0)
+    , z_(0)
+    , data_()
+{
+    tgtAssert(extent_.x >= 0 && extent_.y >= 0 && zExtent_ >= 0, "Invalid extent");
+}
+
+void ParallelFilterBlock::fill(const CachingSliceReader* src, const std::vector<SamplingStrategy<float>>& channelStrategies, int yBegin, int yEnd, int z) {
+    tgtAssert(channelStrategies.size() == numChannels_, "Sampling strategy for each channel required");
+    tgtAssert(yBegin < yEnd, "Empty band");
+
+    yBegin_ = yBegin;
+    numRows_ = yEnd - yBegin + 2*extent_.y;
+    z_ = z;
+    data_.resize(numChannels_ * (2*zExtent_+1) * numRows_ * (dimX_ + 2*extent_.x));
+
+    for(size_t channel = 0; channel < numChannels_; ++channel) {
+        for(int dz = -zExtent_; dz <= zExtent_; ++dz) {
+            for(int y = yBegin - extent_.y; y < yEnd + extent_.y; ++y) {
+                src->getPaddedRowNormalized(y, z+dz, channel, extent_.x, channelStrategies[channel], getRow(y, z+dz, channel));
+            }
+        }
+    }
+}
+
+const float* ParallelFilterBlock::getRow(int y, int z, size_t channel) const {
+    tgtAssert(channel < numChannels_, "Invalid channel");
+    tgtAssert(std::abs(z - z_) <= zExtent_, "Invalid z");
+    tgtAssert(y >= yBegin_ - extent_.y && y < yBegin_ - extent_.y + numRows_, "Invalid y");
+
+    const size_t rowLength = dimX_ + 2*extent_.x;
+    const size_t rowIndex = (channel*(2*zExtent_+1) + (z - z_ + zExtent_)) * numRows_ + (y - yBegin_ + extent_.y);
+    return data_.data() + rowIndex*rowLength + extent_.x;
+}
+
+float* ParallelFilterBlock::getRow(int y, int z, size_t channel) {
+    return const_cast<float*>(static_cast<const ParallelFilterBlock*>(this)->getRow(y, z, channel));
+}
+
+int ParallelFilterBlock::getDimX() const {
+    return dimX_;
+}
+
+const tgt::ivec2& ParallelFilterBlock::getExtent() const {
+    return extent_;
+}
+
 // FilterValue -----------------------------------------------------------------------
 
 // Some specializations for FilterValue1D
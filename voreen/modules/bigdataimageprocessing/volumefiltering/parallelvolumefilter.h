@@ -54,6 +54,38 @@ typedef ParallelFilterValue<tgt::vec2> ParallelFilterValue2D;
 typedef ParallelFilterValue<tgt::vec3> ParallelFilterValue3D;
 typedef ParallelFilterValue<tgt::vec4> ParallelFilterValue4D;
 
+/**
+ * Border-padded neighborhood of a band of rows [yBegin, yEnd) of slice z that is passed to the
+ * block kernel of a ParallelVolumeFilter. For every channel, the rows [yBegin-extent.y, yEnd+extent.y)
+ * of the slices [z-zExtent, z+zExtent] are stored as contiguous float arrays with extent.x voxels of
+ * padding on both sides. Voxels outside of the volume are filled according to a sampling strategy.
+ */
+class ParallelFilterBlock {
+public:
+    ParallelFilterBlock(int dimX, const tgt::ivec2& extent, int zExtent, size_t numChannels);
+
+    // Fills the block with the neighborhood of rows [yBegin, yEnd) of slice z.
+    void fill(const CachingSliceReader* src, const std::vector<SamplingStrategy<float>>& channelStrategies, int yBegin, int yEnd, int z);
+
+    // Returns a pointer to voxel x = 0 of row (y, z). Valid indices are [-extent.x, dimX+extent.x).
+    const float* getRow(int y, int z, size_t channel) const;
+
+    int getDimX() const;
+    const tgt::ivec2& getExtent() const;
+
+private:
+    float* getRow(int y, int z, size_t channel);
+
+    const int dimX_;
+    const tgt::ivec2 extent_;
+    const int zExtent_;
+    const size_t numChannels_;
+    int yBegin_;
+    int numRows_; // including border
+    int z_;
+    std::vector<float> data_;
+};
+
 // Note. InputType and OutputType need to offer the interface of ParallelFilterValue
 template<typename InputType, typename OutputType>
 class ParallelVolumeFilter : public VolumeFilter {
@@ -66,12 +98,29 @@ public:
     typedef std::function<InputType(const tgt::ivec3& pos)> Sample;
     virtual OutputType getValue(const Sample& sample, const tgt::ivec3& pos, const SliceReaderMetaData& inputMetadata, const SliceReaderMetaData& outputMetaData) const = 0;
 
+    /**
+     * Extent in x and y of the neighborhood required by getRow. Filters that implement the block kernel
+     * return a non-negative extent, in which case getRow is used instead of getValue. (Default: (-1, -1))
+     */
+    virtual tgt::ivec2 getBlockExtent() const;
+
+    /**
+     * Block kernel: Computes row y of the filtered slice z from the padded neighborhood in block.
+     * Channel c of voxel x has to be written to out[c*block.getDimX() + x].
+     */
+    virtual void getRow(const ParallelFilterBlock& block, int y, int z, float* out, const SliceReaderMetaData& inputMetadata, const SliceReaderMetaData& outputMetaData) const;
+
     size_t getNumInputChannels() const;
     size_t getNumOutputChannels() const;
 
 private:
+    std::unique_ptr<VolumeRAM> getFilteredSliceBlockwise(const CachingSliceReader* src, int z, const tgt::ivec2& blockExtent) const;
+
     const SamplingStrategy<InputType> samplingStrategy_;
     const int zExtent_;
+
+    // Number of rows that are processed by a block kernel at once
+    static const int BLOCK_ROWS;
 };
 
 
@@ -88,10 +137,18 @@ ParallelVolumeFilter<InputType, OutputType>::ParallelVolumeFilter(int zExtent, c
 {
 }
 
+template<typename InputType, typename OutputType>
+const int ParallelVolumeFilter<InputType, OutputType>::BLOCK_ROWS = 16;
+
 template<typename InputType, typename OutputType>
 std::unique_ptr<VolumeRAM> ParallelVolumeFilter<InputType, OutputType>::getFilteredSlice(const CachingSliceReader* src, int z) const {
     tgtAssert(src->getZExtent() == zExtent_, "z extent mismatch");
 
+    tgt::ivec2 blockExtent = getBlockExtent();
+    if(blockExtent.x >= 0 && blockExtent.y >= 0) {
+        return getFilteredSliceBlockwise(src, z, blockExtent);
+    }
+
     const tgt::ivec3& srcDim = src->getSignedDimensions();
 
     const auto& inputMetadata = src->getMetaData();
@@ -125,6 +182,54 @@ std::unique_ptr<VolumeRAM> ParallelVolumeFilter<InputType, OutputType>::getFilte
     return slice;
 }
 
+template<typename InputType, typename OutputType>
+std::unique_ptr<VolumeRAM> ParallelVolumeFilter<InputType, OutputType>::getFilteredSliceBlockwise(const CachingSliceReader* src, int z, const tgt::ivec2& blockExtent) const {
+    const tgt::ivec3& srcDim = src->getSignedDimensions();
+
+    const auto& inputMetadata = src->getMetaData();
+    const auto& outputMetaData = getMetaData(inputMetadata);
+
+    VolumeFactory volumeFactory;
+    std::string format = volumeFactory.getFormat(outputMetaData.getBaseType(), OutputType::dim);
+    std::unique_ptr<VolumeRAM> slice(volumeFactory.create(format, tgt::svec3(srcDim.xy(), 1)));
+
+    // The block is filled channel-wise, so we need a scalar sampling strategy per input channel.
+    std::vector<SamplingStrategy<float>> channelStrategies;
+    for(size_t d=0; d < InputType::dim; ++d) {
+        channelStrategies.push_back(samplingStrategy_.template convert<float>([d] (InputType v) { return v[d]; }));
+    }
+
+    const int numBands = (srcDim.y + BLOCK_ROWS - 1) / BLOCK_ROWS;
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int band = 0; band < numBands; ++band) {
+        const int yBegin = band * BLOCK_ROWS;
+        const int yEnd = std::min(yBegin + BLOCK_ROWS, srcDim.y);
+
+        ParallelFilterBlock block(srcDim.x, blockExtent, zExtent_, InputType::dim);
+        block.fill(src, channelStrategies, yBegin, yEnd, z);
+
+        std::vector<float> row(OutputType::dim * srcDim.x);
+        for(int y = yBegin; y < yEnd; ++y) {
+            getRow(block, y, z, row.data(), inputMetadata, outputMetaData);
+            for(size_t d=0; d < OutputType::dim; ++d) {
+                writeSliceRowNormalized(slice.get(), y, d, row.data() + d*srcDim.x);
+            }
+        }
+    }
+    return slice;
+}
+
+template<typename InputType, typename OutputType>
+tgt::ivec2 ParallelVolumeFilter<InputType, OutputType>::getBlockExtent() const {
+    return tgt::ivec2(-1);
+}
+
+template<typename InputType, typename OutputType>
+void ParallelVolumeFilter<InputType, OutputType>::getRow(const ParallelFilterBlock& block, int y, int z, float* out, const SliceReaderMetaData& inputMetadata, const SliceReaderMetaData& outputMetaData) const {
+    tgtAssert(false, "Block kernel not implemented, but block extent specified");
+}
+
 template<typename InputType, typename OutputType>
 int ParallelVolumeFilter<InputType, OutputType>::zExtent() const {
     return zExtent_;
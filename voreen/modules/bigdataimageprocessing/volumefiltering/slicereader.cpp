@@ -25,6 +25,10 @@
 
 #include "slicereader.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace voreen {
 
 // SliceReaderMetaData ---------------------------------------------------------------
@@ -281,6 +285,49 @@ const VolumeRAM* CachingSliceReader::getCurrentSlice() const {
     return getSlice(0);
 }
 
+void CachingSliceReader::getRowNormalized(int y, int z, size_t channel, float* out) const {
+    const VolumeRAM* slice = getSlice(z-getCurrentZPos());
+    tgtAssert(slice, "no slice");
+    tgtAssert(channel < getNumChannels(), "Invalid channel");
+    readSliceRowNormalized(slice, y, channel, out);
+}
+
+void CachingSliceReader::getPaddedRowNormalized(int y, int z, size_t channel, int padding, const SamplingStrategy<float>& samplingStrategy, float* out) const {
+    tgtAssert(padding >= 0, "Invalid padding");
+    const tgt::ivec3& dim = getSignedDimensions();
+
+    SamplingStrategy<float>::Sampler getValueFromReader = [this, channel] (const tgt::ivec3& p) {
+        return getVoxelNormalized(p, channel);
+    };
+
+    bool rowInside = y >= 0 && y < dim.y && z >= 0 && z < dim.z;
+    if(rowInside) {
+        getRowNormalized(y, z, channel, out);
+    } else if(samplingStrategy.type_ == MIRROR_T) {
+        getRowNormalized(mirror(y, dim.y), mirror(z, dim.z), channel, out);
+        rowInside = true;
+    } else if(samplingStrategy.type_ == CLAMP_T) {
+        getRowNormalized(clamp(y, dim.y), clamp(z, dim.z), channel, out);
+        rowInside = true;
+    } else {
+        for(int x = 0; x < dim.x; ++x) {
+            out[x] = samplingStrategy.sample(tgt::ivec3(x, y, z), dim, getValueFromReader);
+        }
+    }
+
+    // The border in x can be taken from the row itself unless values outside the volume are requested explicitly.
+    if(rowInside && samplingStrategy.type_ != PASS_THROUGH_T && samplingStrategy.type_ != ASSERT_FALSE_T) {
+        fillRowBorder(out, dim.x, padding, samplingStrategy);
+    } else {
+        for(int x = -padding; x < 0; ++x) {
+            out[x] = samplingStrategy.sample(tgt::ivec3(x, y, z), dim, getValueFromReader);
+        }
+        for(int x = dim.x; x < dim.x + padding; ++x) {
+            out[x] = samplingStrategy.sample(tgt::ivec3(x, y, z), dim, getValueFromReader);
+        }
+    }
+}
+
 void CachingSliceReader::advance() {
     base_->advance();
     //tgtAssert(getCurrentZPos() < getSignedDimensions().z, "Advanced past volume");
@@ -507,15 +554,188 @@ void FilteringSliceReader::updateCurrentSlice() {
     tgtAssert(currentSlice_->getNumChannels() == getNumChannels(), "filter produced slice with wrong number of channels");
 }
 
+// PipelinedSliceReader --------------------------------------------------------------------------
+
+PipelinedSliceReader::PipelinedSliceReader(std::unique_ptr<SliceReader> base, size_t capacity)
+    : SliceReader(base->getSignedDimensions(), SliceReaderMetaData::fromBaseAccurate(base->getMetaData()))
+    , base_(std::move(base))
+    , capacity_(capacity)
+    , numChannels_(base_->getNumChannels())
+    , numThreads_(1)
+    , z_(std::numeric_limits<int>::max()) // Not initialized, yet
+    , currentSlice_(nullptr)
+    , workerException_(nullptr)
+    , stopWorker_(false)
+{
+    tgtAssert(capacity_ > 0, "capacity must be > 0");
+}
+
+PipelinedSliceReader::~PipelinedSliceReader() {
+    stopWorker();
+}
+
+void PipelinedSliceReader::advance() {
+    if(z_ == std::numeric_limits<int>::max()) {
+        throw tgt::Exception("PipelinedSliceReader: advance() called before seek()");
+    }
+    if(z_ + 1 >= getSignedDimensions().z) {
+        // The worker stops at the end of the volume.
+        ++z_;
+        currentSlice_.reset(nullptr);
+        return;
+    }
+
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    while(slices_.empty() && !workerException_) {
+        sliceProduced_.wait(lock);
+    }
+    if(slices_.empty()) {
+        // The worker died, so the slice will never arrive: The reader stays failed and every
+        // subsequent call reports the original exception.
+        std::rethrow_exception(workerException_);
+    }
+    currentSlice_ = std::move(slices_.front());
+    slices_.pop_front();
+    ++z_;
+    sliceConsumed_.notify_one();
+}
+
+void PipelinedSliceReader::seek(int z) {
+    {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        if(workerException_) {
+            // The state of the base reader is unknown after a failure, so we cannot restart from it.
+            std::rethrow_exception(workerException_);
+        }
+    }
+    if(z_ == z) {
+        return;
+    }
+    stopWorker();
+
+    try {
+        base_->seek(z);
+        const VolumeRAM* slice = base_->getCurrentSlice();
+        currentSlice_.reset(slice ? slice->clone() : nullptr);
+    } catch(...) {
+        workerException_ = std::current_exception();
+        throw;
+    }
+    z_ = z;
+
+    startWorker();
+}
+
+int PipelinedSliceReader::getCurrentZPos() const {
+    return z_;
+}
+
+float PipelinedSliceReader::getVoxelNormalized(const tgt::ivec3& xyz, size_t channel) const {
+    tgtAssert(currentSlice_, "No slice");
+    tgtAssert(xyz.z == z_, "invalid z pos");
+    tgtAssert(channel < getNumChannels(), "Invalid channel");
+    return currentSlice_->getVoxelNormalized(tgt::svec3(xyz.x, xyz.y, 0), channel);
+}
+
+const VolumeRAM* PipelinedSliceReader::getCurrentSlice() const {
+    return currentSlice_.get();
+}
+
+size_t PipelinedSliceReader::getNumChannels() const {
+    return numChannels_;
+}
+
+void PipelinedSliceReader::setNumThreads(int numThreads) {
+    tgtAssert(!worker_.joinable(), "Worker already running");
+    tgtAssert(numThreads > 0, "numThreads must be > 0");
+    numThreads_ = numThreads;
+}
+
+void PipelinedSliceReader::startWorker() {
+    tgtAssert(!worker_.joinable(), "Worker still running");
+    worker_ = boost::thread(&PipelinedSliceReader::produceSlices, this, z_+1);
+}
+
+void PipelinedSliceReader::stopWorker() {
+    {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        stopWorker_ = true;
+    }
+    sliceConsumed_.notify_all();
+    if(worker_.joinable()) {
+        worker_.join();
+    }
+    slices_.clear();
+    stopWorker_ = false;
+}
+
+void PipelinedSliceReader::produceSlices(int beginZ) {
+#ifdef _OPENMP
+    // The OpenMP thread count is per thread, so it has to be set on the worker itself.
+    omp_set_num_threads(numThreads_);
+#endif
+    try {
+        for(int z = beginZ; z < getSignedDimensions().z; ++z) {
+            {
+                boost::unique_lock<boost::mutex> lock(mutex_);
+                while(slices_.size() >= capacity_ && !stopWorker_) {
+                    sliceConsumed_.wait(lock);
+                }
+                if(stopWorker_) {
+                    return;
+                }
+            }
+
+            // The (potentially expensive) computation of the slice happens without holding the lock.
+            base_->advance();
+            const VolumeRAM* slice = base_->getCurrentSlice();
+            std::unique_ptr<VolumeRAM> copy(slice ? slice->clone() : nullptr);
+
+            boost::lock_guard<boost::mutex> lock(mutex_);
+            slices_.push_back(std::move(copy));
+            sliceProduced_.notify_one();
+        }
+    } catch(...) {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        workerException_ = std::current_exception();
+        sliceProduced_.notify_one();
+    }
+}
+
 // VolumeFilterStackBuilder --------------------------------------------------------------------------
 
-VolumeFilterStackBuilder::VolumeFilterStackBuilder(const VolumeBase& volume)
+const size_t VolumeFilterStackBuilder::OUTPUT_PIPELINE_CAPACITY = 4;
+
+VolumeFilterStackBuilder::VolumeFilterStackBuilder(const VolumeBase& volume, bool pipelined)
     : top_(new VolumeSliceReader(volume))
+    , pipelined_(pipelined)
 {
 }
 
+void VolumeFilterStackBuilder::addPipelineStage(size_t capacity) {
+    PipelinedSliceReader* stage = new PipelinedSliceReader(std::move(top_), capacity);
+    stages_.push_back(stage);
+    top_ = std::unique_ptr<SliceReader>(stage);
+}
+
+void VolumeFilterStackBuilder::distributeThreads() {
+#ifdef _OPENMP
+    // The bottom stage only reads the input volume. All other stages compute a filter layer and
+    // share the cores, so that short stacks still parallelize their filters.
+    int numFilterStages = std::max(static_cast<int>(stages_.size()) - 1, 1);
+    int threadsPerStage = std::max(omp_get_max_threads() / numFilterStages, 1);
+    for(size_t i = 1; i < stages_.size(); ++i) {
+        stages_[i]->setNumThreads(threadsPerStage);
+    }
+#endif
+}
+
 VolumeFilterStackBuilder& VolumeFilterStackBuilder::addLayer(std::unique_ptr<VolumeFilter> conv) {
     tgtAssert(top_.get(), "No top. Did you .build() already?");
+    if(pipelined_) {
+        // Buffer enough slices to refill the whole neighborhood of the new layer plus one slice ahead.
+        addPipelineStage(2*conv->zExtent()+2);
+    }
     top_ = std::unique_ptr<SliceReader>(new FilteringSliceReader(
                 std::unique_ptr<CachingSliceReader>(new CachingSliceReader(std::move(top_), conv->zExtent())),
                 std::move(conv)
@@ -525,6 +745,10 @@ VolumeFilterStackBuilder& VolumeFilterStackBuilder::addLayer(std::unique_ptr<Vol
 
 std::unique_ptr<SliceReader> VolumeFilterStackBuilder::build(int initZPos) {
     tgtAssert(top_.get(), "No top. Did you .build() already?");
+    if(pipelined_) {
+        addPipelineStage(OUTPUT_PIPELINE_CAPACITY);
+        distributeThreads();
+    }
     top_->seek(initZPos);
     //tgtAssert(top_->getNumChannels() == 1, "Built multichannel volume"); // Maybe someone wants that? Then we'd need accessors first
     return std::move(top_);
@@ -532,6 +756,10 @@ std::unique_ptr<SliceReader> VolumeFilterStackBuilder::build(int initZPos) {
 
 std::unique_ptr<CachingSliceReader> VolumeFilterStackBuilder::buildCaching(int initZPos, int neighborhoodSize) {
     tgtAssert(top_.get(), "No top. Did you .build() already?");
+    if(pipelined_) {
+        addPipelineStage(2*neighborhoodSize+2);
+        distributeThreads();
+    }
     top_->seek(initZPos);
     //tgtAssert(top_->getNumChannels() == 1, "Built multichannel volume"); // Maybe someone wants that? Then we'd need accessors first
     return std::unique_ptr<CachingSliceReader>(new CachingSliceReader(std::move(top_), neighborhoodSize));
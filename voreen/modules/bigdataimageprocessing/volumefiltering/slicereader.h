@@ -35,6 +35,11 @@
 #include "voreen/core/io/progressreporter.h"
 
 #include <functional>
+#include <deque>
+#include <exception>
+#include <vector>
+
+#include <boost/thread.hpp>
 
 namespace voreen {
 
@@ -131,6 +136,13 @@ public:
 
     int getZExtent() const;
 
+    // Reads row y of the cached slice z (has to be within the volume) into out (getSignedDimensions().x elements).
+    void getRowNormalized(int y, int z, size_t channel, float* out) const;
+
+    // Reads row (y, z) into out[-padding, getSignedDimensions().x+padding), i.e., out points to the element for x = 0.
+    // Values outside of the volume (in x, y or z) are determined by the sampling strategy.
+    void getPaddedRowNormalized(int y, int z, size_t channel, int padding, const SamplingStrategy<float>& samplingStrategy, float* out) const;
+
     VolumeRAM* const& getSlice(int dz) const;
 protected:
     VolumeRAM*& getSlice(int dz);
@@ -207,11 +219,67 @@ protected:
     float thisToBaseOffset_;
 };
 
+/**
+ * Computes the slices of its base reader ahead of time on a worker thread and buffers up to
+ * capacity of them. Placed between the layers of a filter stack, this lets all layers (and the
+ * consumer of the top layer) work concurrently, so that the throughput of the stack approaches
+ * that of its slowest layer instead of the sum of all layers.
+ * Only sequential access via advance() is pipelined, seek() restarts the worker at the new position.
+ * seek() has to be called before the first call to advance(). If computing a slice fails, the reader
+ * stays failed and every subsequent call to advance() or seek() rethrows the exception of the worker.
+ * The worker computes the base reader with the number of OpenMP threads set via setNumThreads()
+ * (1 by default), so that the workers of a stack do not oversubscribe the cores.
+ */
+class PipelinedSliceReader : public SliceReader {
+public:
+    PipelinedSliceReader(std::unique_ptr<SliceReader> base, size_t capacity);
+    virtual ~PipelinedSliceReader();
+
+    void advance();
+    void seek(int z);
+    int getCurrentZPos() const;
+
+    float getVoxelNormalized(const tgt::ivec3& xyz, size_t channel = 0) const;
+    const VolumeRAM* getCurrentSlice() const;
+    size_t getNumChannels() const;
+
+    /**
+     * Sets the number of OpenMP threads the worker uses to compute the base reader.
+     * Has to be called before the first call to seek().
+     */
+    void setNumThreads(int numThreads);
+
+protected:
+    void startWorker();
+    void stopWorker();
+    void produceSlices(int beginZ);
+
+    std::unique_ptr<SliceReader> base_; // only accessed by the worker while it is running
+    const size_t capacity_;
+    const size_t numChannels_;
+    int numThreads_;
+    int z_;
+    std::unique_ptr<VolumeRAM> currentSlice_;
+
+    boost::thread worker_;
+    boost::mutex mutex_;
+    boost::condition_variable sliceProduced_;
+    boost::condition_variable sliceConsumed_;
+    std::deque<std::unique_ptr<VolumeRAM>> slices_; // slices z_+1, z_+2, ... (null outside of the volume)
+    std::exception_ptr workerException_; // set once the worker (or seeking the base reader) has failed
+    bool stopWorker_;
+};
+
 // VolumeFilterStackBuilder -------------------------------------------------------------------------------------
 
 class VolumeFilterStackBuilder {
 public:
-    VolumeFilterStackBuilder(const VolumeBase& volume);
+    /**
+     * @param pipelined if true, each layer (and the top of the stack) is computed on its own
+     *        worker thread, see PipelinedSliceReader. The available OpenMP threads are split
+     *        among the filter layers.
+     */
+    VolumeFilterStackBuilder(const VolumeBase& volume, bool pipelined = false);
 
     VolumeFilterStackBuilder& addLayer(std::unique_ptr<VolumeFilter> conv);
     std::unique_ptr<SliceReader> build(int initZPos);
@@ -219,7 +287,15 @@ public:
     std::unique_ptr<CachingSliceReader> buildCaching(int initZPos, int neighborhoodSize);
 
 private:
+    void addPipelineStage(size_t capacity);
+    void distributeThreads();
+
     std::unique_ptr<SliceReader> top_;
+    const bool pipelined_;
+    std::vector<PipelinedSliceReader*> stages_; // owned by top_, bottom to top
+
+    // Number of slices buffered on top of the stack, i.e., between the last layer and the consumer
+    static const size_t OUTPUT_PIPELINE_CAPACITY;
 };
 
 // Utility functions -------------------------------------------------------------------------------------
@@ -26,8 +26,69 @@
 #include "volumefilter.h"
 #include "slicereader.h"
 
+#include "voreen/core/utils/stringutils.h"
+
 namespace voreen {
 
+template<typename Base>
+static void readSliceRowNormalizedGeneric(const VolumeRAM* slice, int y, size_t channel, float* out) {
+    // access the channel as strided array of the base type to avoid virtual calls per voxel
+    const size_t stride = slice->getBytesPerVoxel() / sizeof(Base);
+    const size_t dimX = slice->getDimensions().x;
+    const Base* values = static_cast<const Base*>(slice->getData()) + static_cast<size_t>(y)*dimX*stride + channel;
+    for(size_t x = 0; x < dimX; ++x) {
+        out[x] = getTypeAsFloat(values[x*stride]);
+    }
+}
+
+template<typename Base>
+static void writeSliceRowNormalizedGeneric(VolumeRAM* slice, int y, size_t channel, const float* values) {
+    const size_t stride = slice->getBytesPerVoxel() / sizeof(Base);
+    const size_t dimX = slice->getDimensions().x;
+    Base* out = static_cast<Base*>(slice->getData()) + static_cast<size_t>(y)*dimX*stride + channel;
+    for(size_t x = 0; x < dimX; ++x) {
+        out[x*stride] = getFloatAsType<Base>(values[x]);
+    }
+}
+
+void readSliceRowNormalized(const VolumeRAM* slice, int y, size_t channel, float* out) {
+    tgtAssert(slice, "no slice");
+    tgtAssert(y >= 0 && static_cast<size_t>(y) < slice->getDimensions().y, "invalid row");
+    tgtAssert(channel < slice->getNumChannels(), "invalid channel");
+    DISPATCH_FOR_BASETYPE(slice->getBaseType(), readSliceRowNormalizedGeneric, slice, y, channel, out);
+}
+
+void writeSliceRowNormalized(VolumeRAM* slice, int y, size_t channel, const float* values) {
+    tgtAssert(slice, "no slice");
+    tgtAssert(y >= 0 && static_cast<size_t>(y) < slice->getDimensions().y, "invalid row");
+    tgtAssert(channel < slice->getNumChannels(), "invalid channel");
+    DISPATCH_FOR_BASETYPE(slice->getBaseType(), writeSliceRowNormalizedGeneric, slice, y, channel, values);
+}
+
+static float getRowBorderValue(const float* row, int x, int dimX, const SamplingStrategy<float>& samplingStrategy) {
+    switch(samplingStrategy.type_) {
+        case MIRROR_T:
+            return row[mirror(x, dimX)];
+        case CLAMP_T:
+            return row[clamp(x, dimX)];
+        case SET_T:
+            return samplingStrategy.outsideVolumeValue_;
+        default:
+            tgtAssert(false, "Sampling strategy cannot be applied to a row");
+            return 0.0f;
+    }
+}
+
+void fillRowBorder(float* row, int dimX, int padding, const SamplingStrategy<float>& samplingStrategy) {
+    tgtAssert(padding >= 0, "Invalid padding");
+    for(int x = -padding; x < 0; ++x) {
+        row[x] = getRowBorderValue(row, x, dimX, samplingStrategy);
+    }
+    for(int x = dimX; x < dimX + padding; ++x) {
+        row[x] = getRowBorderValue(row, x, dimX, samplingStrategy);
+    }
+}
+
 boost::optional<tgt::svec3> VolumeFilter::getOverwrittenDimensions() const {
     return boost::none;
 }
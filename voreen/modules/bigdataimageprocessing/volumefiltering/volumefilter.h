@@ -142,6 +142,15 @@ private:
 };
 
 
+// Typed row access: Read/write row y of a single channel of a slice as normalized floats directly from/to
+// the underlying base type data, avoiding a virtual call per voxel. values/out hold slice->getDimensions().x elements.
+void readSliceRowNormalized(const VolumeRAM* slice, int y, size_t channel, float* out);
+void writeSliceRowNormalized(VolumeRAM* slice, int y, size_t channel, const float* values);
+
+// Fills row[-padding, 0) and row[dimX, dimX+padding) from the values in row[0, dimX) according to the
+// sampling strategy. Only MIRROR, CLAMP and SET can be expressed in terms of the row itself.
+void fillRowBorder(float* row, int dimX, int padding, const SamplingStrategy<float>& samplingStrategy);
+
 template<typename T, typename F>
 inline T mapScalars(const T& value, F f, typename std::enable_if<!std::is_same<T, float>::value>::type* = 0);
 
@@ -535,6 +535,7 @@ CoreModule::CoreModule(const std::string& modulePath)
     registerSerializableType(new VolumeMinMax());
     registerSerializableType(new VolumeMinMaxMagnitude());
     registerSerializableType(new VolumeHash());
+    registerSerializableType(new VolumeChunkedHash());
     registerSerializableType(new VolumePreview());
     registerSerializableType(new VolumeHistogramIntensity());
     registerSerializableType(new VolumeHistogramIntensityGradient());
@@ -36,6 +36,7 @@
 #include "voreen/core/utils/stringutils.h"
 #include "voreen/core/datastructures/volume/volumeatomic.h"
 #include "voreen/core/datastructures/volume/volumedisk.h"
+#include "voreen/core/io/serialization/binaryblobsidecar.h"
 
 using tgt::vec3;
 using tgt::ivec3;
@@ -79,6 +80,20 @@ VolumeList* VvdVolumeReader::read(const std::string &url) {
 
     std::vector<VvdObject> vec;
     Deserializer deserializer(d);
+
+    // derived data may be stored in a binary blob sidecar file referenced by the vvd-file, which is mapped during deserialization
+    std::unique_ptr<BinaryBlobSidecarReader> sidecar;
+    try {
+        std::string sidecarName = BinaryBlobSidecar::getReferencedFilename(deserializer, fileName);
+        if (!sidecarName.empty()) {
+            sidecar.reset(new BinaryBlobSidecarReader(sidecarName));
+            d.setBinaryBlobSidecarReader(sidecar.get());
+        }
+    }
+    catch (SerializationException& e) {
+        throw tgt::FileException(e.what());
+    }
+
     // deserialize from data stream
     try {
         deserializer.deserialize("Volumes", vec, "Volume");
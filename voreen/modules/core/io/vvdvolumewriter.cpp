@@ -29,6 +29,7 @@
 #include "voreen/core/datastructures/volume/volumeatomic.h"
 #include "voreen/core/datastructures/volume/volumedisk.h"
 #include "voreen/core/datastructures/volume/volume.h"
+#include "voreen/core/io/serialization/binaryblobsidecar.h"
 
 #include "tgt/filesystem.h"
 #include "tgt/matrix.h"
@@ -37,7 +38,9 @@ namespace voreen {
 
 const std::string VvdVolumeWriter::loggerCat_("voreen.io.VvdVolumeWriter");
 
-VvdVolumeWriter::VvdVolumeWriter() {
+VvdVolumeWriter::VvdVolumeWriter()
+    : useBinaryBlobSidecar_(false)
+{
     extensions_.push_back("vvd");
 }
 
@@ -55,6 +58,16 @@ void VvdVolumeWriter::write(const std::string& filename, const VolumeBase* volum
 
     // VVD: ---------------------------
 
+    // the sidecar gets a new name for each write, the sidecars of previous writes are removed once the vvd-file has been written
+    std::unique_ptr<BinaryBlobSidecarWriter> sidecar;
+    try {
+        if (useBinaryBlobSidecar_)
+            sidecar.reset(new BinaryBlobSidecarWriter(BinaryBlobSidecar::createFilename(vvdname)));
+    }
+    catch (SerializationException& e) {
+        throw tgt::IOException(e.what());
+    }
+
     XmlSerializer s(vvdname);
     s.setUseAttributes(true);
 
@@ -63,8 +76,21 @@ void VvdVolumeWriter::write(const std::string& filename, const VolumeBase* volum
     vec.push_back(o);
 
     Serializer serializer(s);
+    if (sidecar) {
+        serializer.serialize(BinaryBlobSidecar::DOCUMENT_KEY, tgt::FileSystem::fileName(sidecar->getFilename()));
+        serializer.setBinaryBlobSidecarWriter(sidecar.get());
+    }
     serializer.serialize("Volumes", vec, "Volume");
 
+    if (sidecar) {
+        try {
+            sidecar->close();
+        }
+        catch (SerializationException& e) {
+            throw tgt::IOException(e.what());
+        }
+    }
+
     //errorList_ = s.getErrors();
 
     // write serialization data to temporary string stream
@@ -99,6 +125,7 @@ void VvdVolumeWriter::write(const std::string& filename, const VolumeBase* volum
                                      + vvdname + "' (unknown exception).");
     }
     fileStream.close();
+    BinaryBlobSidecar::deleteFiles(vvdname, sidecar ? sidecar->getFilename() : "");
 
     std::fstream rawout(rawname.c_str(), std::ios::out | std::ios::binary);
 
@@ -143,7 +170,17 @@ void VvdVolumeWriter::write(const std::string& filename, const VolumeBase* volum
 }
 
 VolumeWriter* VvdVolumeWriter::create(ProgressBar* /*progress*/) const {
-    return new VvdVolumeWriter();
+    VvdVolumeWriter* writer = new VvdVolumeWriter();
+    writer->setUseBinaryBlobSidecar(useBinaryBlobSidecar_);
+    return writer;
+}
+
+void VvdVolumeWriter::setUseBinaryBlobSidecar(bool useSidecar) {
+    useBinaryBlobSidecar_ = useSidecar;
+}
+
+bool VvdVolumeWriter::getUseBinaryBlobSidecar() const {
+    return useBinaryBlobSidecar_;
 }
 
 } // namespace voreen
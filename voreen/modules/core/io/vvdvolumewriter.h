@@ -49,7 +49,19 @@ public:
      * @param volume Volume dataset
      */
     virtual void write(const std::string& filename, const VolumeBase* volumeHandle);
+
+    /**
+     * If enabled, binary derived data (e.g., histograms, previews) is written natively to a
+     * sidecar file next to the vvd-file instead of being base64 encoded into it.
+     *
+     * @see BinaryBlobSidecar
+     */
+    void setUseBinaryBlobSidecar(bool useSidecar);
+    bool getUseBinaryBlobSidecar() const;
+
 private:
+    bool useBinaryBlobSidecar_;
+
     static const std::string loggerCat_;
 };
 
@@ -196,6 +196,8 @@ OctreeCreator::OctreeCreator()
 
     brickPoolManager_.addOption("brickPoolManagerRAM",  "RAM (non-persistent)");
     brickPoolManager_.addOption("brickPoolManagerDisk", "Disk");
+    if (OctreeBrickPoolManagerDisk::isBrickCompressionSupported(OctreeBrickPoolManagerDisk::COMPRESSION_LZ4))
+        brickPoolManager_.addOption("brickPoolManagerDiskLZ4", "Disk (LZ4 compressed)");
     brickPoolManager_.addOption("brickPoolManagerMmap", "Mmap");
     brickPoolManager_.select("brickPoolManagerDisk");
     addProperty(brickPoolManager_);
@@ -361,12 +363,15 @@ OctreeCreatorInput OctreeCreator::prepareComputeInput() {
         // if the memory is sufficient: create the brick pool manager
         brickPoolManager = new OctreeBrickPoolManagerRAM(singleBufferMemorySize_.get() << 20);
     }
-    else if (brickPoolManager_.isSelected("brickPoolManagerDisk")) {
+    else if (brickPoolManager_.isSelected("brickPoolManagerDisk") || brickPoolManager_.isSelected("brickPoolManagerDiskLZ4")) {
         std::string brickPoolPath = tgt::FileSystem::cleanupPath(getOctreeStoragePath() + "/" + BRICK_BUFFER_SUBDIR);
         if (!tgt::FileSystem::dirExists(brickPoolPath))
             tgt::FileSystem::createDirectoryRecursive(brickPoolPath);
-        brickPoolManager = new OctreeBrickPoolManagerDisk(static_cast<size_t>(singleBufferMemorySize_.get()) << 20,
+        OctreeBrickPoolManagerDisk* brickPoolManagerDisk = new OctreeBrickPoolManagerDisk(static_cast<size_t>(singleBufferMemorySize_.get()) << 20,
             VoreenApplication::app()->getCpuRamLimit(), brickPoolPath, BRICK_BUFFER_FILE_PREFIX);
+        if (brickPoolManager_.isSelected("brickPoolManagerDiskLZ4"))
+            brickPoolManagerDisk->setBrickCompression(OctreeBrickPoolManagerDisk::COMPRESSION_LZ4);
+        brickPoolManager = brickPoolManagerDisk;
     }
     else if (brickPoolManager_.isSelected("brickPoolManagerMmap")) {
         std::string brickPoolPath = tgt::FileSystem::cleanupPath(getOctreeStoragePath() + "/" + BRICK_BUFFER_SUBDIR);
@@ -27,6 +27,7 @@
 #include "voreen/core/io/volumeserializer.h"
 #include "voreen/core/io/volumeserializerpopulator.h"
 #include "voreen/core/io/volumewriter.h"
+#include "modules/core/io/vvdvolumewriter.h"
 #include "voreen/core/utils/stringutils.h"
 #include "voreen/core/io/progressbar.h"
 
@@ -42,6 +43,7 @@ VolumeSave::VolumeSave()
     , saveButton_("save", "Save")
     , saveOnPathChange_("saveOnPathChange","Save on path change",true)
     , continousSave_("continousSave", "Save on inport change", false)
+    , binaryBlobSidecar_("binaryBlobSidecar", "Save derived data to separate binary file (vvd)", false, Processor::VALID, Property::LOD_ADVANCED)
     , volumeInfo_("volumeInfo","info")
     , saveVolume_(false)
     , volSerializerPopulator_(0)
@@ -54,6 +56,7 @@ VolumeSave::VolumeSave()
     addProperty(saveButton_);
     addProperty(saveOnPathChange_);
     addProperty(continousSave_);
+    addProperty(binaryBlobSidecar_);
     addProperty(volumeInfo_);
 }
 
@@ -121,6 +124,11 @@ void VolumeSave::saveVolume() {
         s->setProgressBar(dynamic_cast<ProgressBar*>(progressBars_.at(0)));
     else
         s->setProgressBar(0);
+    const std::vector<VolumeWriter*> volumeWriters = s->getWriters();
+    for (size_t i=0; i<volumeWriters.size(); i++) {
+        if (VvdVolumeWriter* vvdWriter = dynamic_cast<VvdVolumeWriter*>(volumeWriters.at(i)))
+            vvdWriter->setUseBinaryBlobSidecar(binaryBlobSidecar_.get());
+    }
     try {
         s->write(filename_.get(), inport_.getData());
     }
@@ -74,6 +74,7 @@ private:
     ButtonProperty saveButton_;
     BoolProperty saveOnPathChange_;
     BoolProperty continousSave_;
+    BoolProperty binaryBlobSidecar_;    ///< passed to the VvdVolumeWriter
     VolumeInfoProperty volumeInfo_;
 
     bool saveVolume_;
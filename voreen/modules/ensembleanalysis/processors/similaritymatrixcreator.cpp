@@ -34,6 +34,7 @@
 #include "voreen/core/datastructures/volume/volumeminmax.h"
 
 #include <random>
+#include <algorithm>
 
 // Determine if we want to use memory mapped files for storing the flags.
 // This in general is necessary since matrices will get too big for large ensembles.
@@ -45,6 +46,39 @@
 
 namespace voreen {
 
+namespace {
+
+// Number of rows per tile and number of flags per block used for calculating the distance matrix.
+const long DISTANCE_TILE_SIZE = 16;
+const size_t DISTANCE_BLOCK_SIZE = 1024;
+
+/**
+ * Returns the sum of max(a[k], b[k]) over all k < n.
+ * Independent partial sums allow the compiler to vectorize the loop.
+ */
+float sumOfMaxima(const float* a, const float* b, size_t n) {
+    const size_t NUM_PARTIAL_SUMS = 8;
+    float partialSums[NUM_PARTIAL_SUMS] = {};
+
+    size_t k = 0;
+    for (; k + NUM_PARTIAL_SUMS <= n; k += NUM_PARTIAL_SUMS) {
+        for (size_t l = 0; l < NUM_PARTIAL_SUMS; l++) {
+            partialSums[l] += std::max(a[k + l], b[k + l]);
+        }
+    }
+
+    float sum = 0.0f;
+    for (; k < n; k++) {
+        sum += std::max(a[k], b[k]);
+    }
+    for (size_t l = 0; l < NUM_PARTIAL_SUMS; l++) {
+        sum += partialSums[l];
+    }
+    return sum;
+}
+
+} // anonymous namespace
+
 const std::string SimilarityMatrixCreator::loggerCat_("voreen.ensembleanalysis.SimilarityMatrixCreator");
 
 SimilarityMatrixCreator::SimilarityMatrixCreator()
@@ -148,6 +182,10 @@ std::string SimilarityMatrixCreator::calculateHash() const {
     hash += seedMask_.getHash();
     hash += singleChannelSimilarityMeasure_.get();
     hash += multiChannelSimilarityMeasure_.get();
+    if(singleChannelSimilarityMeasure_.getValue() == MEASURE_AVG_DIFFERENCE) {
+        // Cached matrices of this measure used to consider only the last flag and must not be reused.
+        hash += "allFlags";
+    }
     hash += std::to_string(seedTime_.get());
     hash += std::to_string(numSeedPoints_.get());
 
@@ -423,208 +461,290 @@ SimilarityMatrixCreatorOutput SimilarityMatrixCreator::compute(SimilarityMatrixC
         bool useMultiChannelMeasure = !useSingleChannelMeasure
                 || input.multiChannelSimilarityMeasure == MEASURE_MULT_MAGNITUDE_AND_ANGLE;
 
-        SubtaskProgressReporter flagsProgress(progress,tgt::vec2((fi+0.7f), (fi+1.0f)) / tgt::vec2(fieldNames.size()));
-        ThreadedTaskProgressReporter threadedProgress(flagsProgress, size);
-        bool aborted = false;
+        // If we decide to split the channels, we consider each channel as flag.
+        size_t numFlags = seedPoints.size();
+        if(input.multiChannelSimilarityMeasure == MEASURE_SPLIT_CHANNELS) {
+            numFlags *= numChannels;
+        }
 
-#ifdef VRN_MODULE_OPENMP
-#pragma omp parallel for schedule(dynamic)
-#endif
-        for (long i = 0; i < size; i++) {
-#ifdef VRN_MODULE_OPENMP
-            if(aborted) {
-                continue;
-            }
-#else
-            if(aborted) {
-                break;
-            }
-#endif
+        // Both measures only touch a single time step per row, so we access the flags as plain array.
+        const float* flags = numElements > 0 ? &Flags[0] : nullptr;
+
+        // The single channel measures only depend on the normalized (and possibly thresholded) flag
+        // values. The distance of two rows can be computed from the sums of their values and the sum of
+        // their component-wise maxima, so only the row sums are stored. The values themselves are derived
+        // from the flags block-wise whenever they are needed, which is cheap compared to the distances.
+        auto gatherValues = [&] (long i, size_t begin, size_t count, float* dest) {
+            for (size_t k = begin; k < begin + count; k++) {
+                float a = 0.0f;
+                if(numChannels > 1 && input.multiChannelSimilarityMeasure == MEASURE_MAGNITUDE) {
+                    // Calculate length.
+                    for (size_t channel = 0; channel < numChannels; channel++) {
+                        float flag = flags[index(i, k, channel)];
+                        a += flag * flag;
+                    }
+                    a = std::sqrt(a);
+                }
+                else if(numChannels > 1 && input.multiChannelSimilarityMeasure == MEASURE_SPLIT_CHANNELS) {
+                    size_t newK = k/numChannels;                //k of the current channel
+                    size_t channel = k / (numFlags/numChannels);
+                    a = flags[index(i, newK, channel)];
+                }
+                else {
+                    a = flags[index(i, k)];
+                }
 
-            for (long j = 0; j <= i; j++) {
-                if(useSingleChannelMeasure) {
+                // Normalize range to interval [0, 1].
+                a = mapRange(a, valueRange.x, valueRange.y, 0.0f, 1.0f);
+
+                if (input.singleChannelSimilarityMeasure == MEASURE_ISOCONTOURS) {
+                    a = a < input.isoValue ? 1.0f : 0.0f;
+                }
 
-                    float intersectionSamples = 0.0f;
-                    float unionSamples = 0.0f;
+                dest[k - begin] = a;
+            }
+        };
 
-                    // If we decide to split the channels, we consider each channel as flag.
-                    size_t numFlags = seedPoints.size();
-                    if(input.multiChannelSimilarityMeasure == MEASURE_SPLIT_CHANNELS) {
-                        numFlags *= numChannels;
+        std::vector<double> rowSums(useSingleChannelMeasure ? size : 0, 0.0);
+        if(useSingleChannelMeasure) {
+#ifdef VRN_MODULE_OPENMP
+            #pragma omp parallel for
+#endif
+            for (long i = 0; i < size; i++) {
+                std::vector<float> block(DISTANCE_BLOCK_SIZE);
+                double rowSum = 0.0;
+                for (size_t blockBegin = 0; blockBegin < numFlags; blockBegin += DISTANCE_BLOCK_SIZE) {
+                    const size_t blockSize = std::min(DISTANCE_BLOCK_SIZE, numFlags - blockBegin);
+                    gatherValues(i, blockBegin, blockSize, block.data());
+                    for (size_t k = 0; k < blockSize; k++) {
+                        rowSum += block[k];
                     }
+                }
+                rowSums[i] = rowSum;
+            }
+        }
 
-                    for (size_t k = 0; k < numFlags; k++) {
+        // Mean of the multi channel measure over all seed points of the two passed time steps.
+        auto multiChannelDistance = [&] (long i, long j) {
+            const float* flags_i = flags + index(i, 0);
+            const float* flags_j = flags + index(j, 0);
 
-                        float a = 0.0f;
-                        float b = 0.0f;
+            double sum = 0.0;
+            size_t numSamples = 0;
+            auto addSample = [&] (float sample) {
+                sum += sample;
+                numSamples++;
+            };
 
-                        if(numChannels > 1 && input.multiChannelSimilarityMeasure == MEASURE_MAGNITUDE) {
-                            // Calculate length.
-                            for (size_t channel = 0; channel < numChannels; channel++) {
-                                float flagA = Flags[index(i, k, channel)];
-                                a += flagA * flagA;
+            for (size_t k = 0; k < seedPoints.size(); k++) {
 
-                                float flagB = Flags[index(j, k, channel)];
-                                b += flagB * flagB;
-                            }
+                tgt::vec4 vector_i = tgt::vec4::zero;
+                tgt::vec4 vector_j = tgt::vec4::zero;
 
-                            a = std::sqrt(a);
-                            b = std::sqrt(b);
-                        }
-                        else if(numChannels > 1 && input.multiChannelSimilarityMeasure == MEASURE_SPLIT_CHANNELS) {
-                            size_t newK = k/numChannels;                //k of the current channel
-                            size_t channel = k / (numFlags/numChannels);
-                            a = Flags[index(i, newK, channel)];
-                            b = Flags[index(j, newK, channel)];
-                        }
-                        else {
-                            a = Flags[index(i, k)];
-                            b = Flags[index(j, k)];
-                        }
+                for (size_t channel = 0; channel < numChannels; channel++) {
+                    vector_i[channel] = flags_i[k * numChannels + channel];
+                    vector_j[channel] = flags_j[k * numChannels + channel];
+                }
 
-                        // Normalize range to interval [0, 1].
-                        a = mapRange(a, valueRange.x, valueRange.y, 0.0f, 1.0f);
-                        b = mapRange(b, valueRange.x, valueRange.y, 0.0f, 1.0f);
+                if(input.multiChannelSimilarityMeasure == MEASURE_ANGLE
+                || input.multiChannelSimilarityMeasure == MEASURE_MULT_MAGNITUDE_AND_ANGLE) {
+                    if (vector_i != tgt::vec4::zero && vector_j != tgt::vec4::zero) {
+                        tgt::vec4 normVector_i = tgt::normalize(vector_i);
+                        tgt::vec4 normVector_j = tgt::normalize(vector_j);
 
-                        if(input.singleChannelSimilarityMeasure == MEASURE_AVG_DIFFERENCE) {
-                            intersectionSamples = 1.0f - std::abs(a - b);
-                            unionSamples += 1.0f;
+                        float dot = tgt::dot(normVector_i, normVector_j);
+                        float angle = std::acos(tgt::clamp(dot, -1.0f, 1.0f)) / tgt::PIf;
+                        if(!tgt::isNaN(angle)) {
+                            addSample(angle);
                         }
                         else {
-                            if (input.singleChannelSimilarityMeasure == MEASURE_ISOCONTOURS) {
-                                a = a < input.isoValue ? 1.0f : 0.0f;
-                                b = b < input.isoValue ? 1.0f : 0.0f;
-                            }
-
-                            intersectionSamples += (1.0f - std::max(a, b));
-                            unionSamples += (1.0f - std::min(a, b));
+                            tgtAssert(false, "NaN value");
                         }
-                    }
 
-                    if (unionSamples > 0.0f)
-                        distanceMatrix(i, j) = (unionSamples - intersectionSamples) / unionSamples;
-                    else
-                        distanceMatrix(i, j) = 1.0f;
+                    }
+                    else if (vector_i == tgt::vec4::zero && vector_j == tgt::vec4::zero) {
+                        addSample(0.0f);
+                    }
+                    else {
+                        addSample(1.0f);
+                    }
                 }
-                if(useMultiChannelMeasure) {
+                else if(input.multiChannelSimilarityMeasure == MEASURE_JIANG) {
+                    float a = tgt::length(vector_i);
+                    float b = tgt::length(vector_j);
 
-                    Statistics statistics(false);
+                    if (a > 0.0f && b > 0.0f) {
+                        tgt::vec4 normVector_i = vector_i / a;
+                        tgt::vec4 normVector_j = vector_j / b;
 
-                    for (size_t k = 0; k < seedPoints.size(); k++) {
+                        float dot = tgt::dot(normVector_i, normVector_j);
+                        float angle = std::asin(tgt::clamp(dot, -1.0f, 1.0f));
+                        tgtAssert(!tgt::isNaN(angle), "NaN value");
 
-                        tgt::vec4 vector_i = tgt::vec4::zero;
-                        tgt::vec4 vector_j = tgt::vec4::zero;
-
-                        for (size_t channel = 0; channel < numChannels; channel++) {
-                            vector_i[channel] = Flags[index(i, k, channel)];
-                            vector_j[channel] = Flags[index(j, k, channel)];
-                        }
-
-                        if(input.multiChannelSimilarityMeasure == MEASURE_ANGLE
-                        || input.multiChannelSimilarityMeasure == MEASURE_MULT_MAGNITUDE_AND_ANGLE) {
-                            if (vector_i != tgt::vec4::zero && vector_j != tgt::vec4::zero) {
-                                tgt::vec4 normVector_i = tgt::normalize(vector_i);
-                                tgt::vec4 normVector_j = tgt::normalize(vector_j);
-
-                                float dot = tgt::dot(normVector_i, normVector_j);
-                                float angle = std::acos(tgt::clamp(dot, -1.0f, 1.0f)) / tgt::PIf;
-                                if(!tgt::isNaN(angle)) {
-                                    statistics.addSample(angle);
-                                }
-                                else {
-                                    tgtAssert(false, "NaN value");
-                                }
+                        // We don't use the lower bound of the value range on purpose here!
+                        float magnitude = mapRange(std::abs(a - b), 0.0f, valueRange.y, 0.0f, 1.0f);
+                        addSample(1.0f - ((1.0f - input.weight) * std::exp(-magnitude) + input.weight * std::exp(-2.0f*angle)));
+                    }
+                    else if (a == 0.0f && b == 0.0f) {
+                        addSample(0.0f);
+                    }
+                    else { // Exactly one vector was zero.
 
-                            }
-                            else if (vector_i == tgt::vec4::zero && vector_j == tgt::vec4::zero) {
-                                statistics.addSample(0.0f);
+                        // We add a 'maximally different' sample (which leads, however, to a discontinuity).
+                        addSample(1.0f);
+                        // Instead, we could also fallback to the magnitude difference
+                        //addSample(std::abs(a-b)/valueRange.y);
+                    }
+                }
+                else if(input.multiChannelSimilarityMeasure == MEASURE_CROSSPRODUCT) {
+                    if (vector_i == tgt::vec4::zero && vector_j == tgt::vec4::zero) {
+                        addSample(0.0f);
+                    }
+                    else if (vector_i != tgt::vec4::zero && vector_j != tgt::vec4::zero) {
+                        // Normalize vectors according to max magnitude within data set.
+                        tgt::vec3 a = vector_i.xyz() / valueRange.y;
+                        tgt::vec3 b = vector_j.xyz() / valueRange.y;
+
+                        float area = tgt::length(tgt::cross(a, b));
+                        // In case area is 0, we have to account for collinear vectors.
+                        if(area < std::numeric_limits<float>::epsilon()) {
+                            float length_a = tgt::length(a);
+                            float length_b = tgt::length(b);
+
+                            tgt::vec3 normA = a / length_a;
+                            tgt::vec3 normB = b / length_b;
+
+                            // Determine direction of collinearity.
+                            float dot = tgt::dot(normA, normB);
+                            float angle = std::acos(tgt::clamp(dot, -1.0f, 1.0f));
+                            if(angle > tgt::PIf*0.5f) {
+                                addSample(tgt::abs(length_a + length_b) * 0.5f);
                             }
                             else {
-                                statistics.addSample(1.0f);
+                                addSample(tgt::abs(length_a - length_b) * 0.5f);
                             }
                         }
-                        else if(input.multiChannelSimilarityMeasure == MEASURE_JIANG) {
-                            float a = tgt::length(vector_i);
-                            float b = tgt::length(vector_j);
+                        else {
+                            addSample(area);
+                        }
+                    }
+                    else {
+                        addSample(0.0f);
+                    }
+                }
+                else if(input.multiChannelSimilarityMeasure == MEASURE_EUCLIDEAN_NORM) {
+                    addSample(tgt::length(vector_i - vector_j) / (2*valueRange.y));
+                }
+            }
 
-                            if (a > 0.0f && b > 0.0f) {
-                                tgt::vec4 normVector_i = vector_i / a;
-                                tgt::vec4 normVector_j = vector_j / b;
+            return numSamples > 0 ? static_cast<float>(sum / numSamples) : 0.0f;
+        };
 
-                                float dot = tgt::dot(normVector_i, normVector_j);
-                                float angle = std::asin(tgt::clamp(dot, -1.0f, 1.0f));
-                                tgtAssert(!tgt::isNaN(angle), "NaN value");
+        // The lower triangle of the matrix is processed in square tiles of rows. For each pair of
+        // tiles, the value rows are traversed block-wise, such that the blocks of all rows of
+        // both tiles remain in cache while the sums of maxima of all row pairs are accumulated.
+        const long numTiles = (size + DISTANCE_TILE_SIZE - 1) / DISTANCE_TILE_SIZE;
+        std::vector<std::pair<long, long>> tilePairs;
+        tilePairs.reserve(numTiles * (numTiles + 1) / 2);
+        for (long tileI = 0; tileI < numTiles; tileI++) {
+            for (long tileJ = 0; tileJ <= tileI; tileJ++) {
+                tilePairs.push_back(std::make_pair(tileI, tileJ));
+            }
+        }
+        long numTilePairs = static_cast<long>(tilePairs.size());
 
-                                // We don't use the lower bound of the value range on purpose here!
-                                float magnitude = mapRange(std::abs(a - b), 0.0f, valueRange.y, 0.0f, 1.0f);
-                                statistics.addSample(1.0f - ((1.0f - input.weight) * std::exp(-magnitude) + input.weight * std::exp(-2.0f*angle)));
-                            }
-                            else if (a == 0.0f && b == 0.0f) {
-                                statistics.addSample(0.0f);
-                            }
-                            else { // Exactly one vector was zero.
+        SubtaskProgressReporter flagsProgress(progress,tgt::vec2((fi+0.7f), (fi+1.0f)) / tgt::vec2(fieldNames.size()));
+        ThreadedTaskProgressReporter threadedProgress(flagsProgress, numTilePairs);
+        bool aborted = false;
 
-                                // We add a 'maximally different' sample (which leads, however, to a discontinuity).
-                                statistics.addSample(1.0f);
-                                // Instead, we could also fallback to the magnitude difference
-                                //statistics.addSample(std::abs(a-b)/valueRange.y);
-                            }
-                        }
-                        else if(input.multiChannelSimilarityMeasure == MEASURE_CROSSPRODUCT) {
-                            if (vector_i == tgt::vec4::zero && vector_j == tgt::vec4::zero) {
-                                statistics.addSample(0.0f);
-                            }
-                            else if (vector_i != tgt::vec4::zero && vector_j != tgt::vec4::zero) {
-                                // Normalize vectors according to max magnitude within data set.
-                                tgt::vec3 a = vector_i.xyz() / valueRange.y;
-                                tgt::vec3 b = vector_j.xyz() / valueRange.y;
-
-                                float area = tgt::length(tgt::cross(a, b));
-                                // In case area is 0, we have to account for collinear vectors.
-                                if(area < std::numeric_limits<float>::epsilon()) {
-                                    float length_a = tgt::length(a);
-                                    float length_b = tgt::length(b);
-
-                                    tgt::vec3 normA = a / length_a;
-                                    tgt::vec3 normB = b / length_b;
-
-                                    // Determine direction of collinearity.
-                                    float dot = tgt::dot(normA, normB);
-                                    float angle = std::acos(tgt::clamp(dot, -1.0f, 1.0f));
-                                    if(angle > tgt::PIf*0.5f) {
-                                        statistics.addSample(tgt::abs(length_a + length_b) * 0.5f);
-                                    }
-                                    else {
-                                        statistics.addSample(tgt::abs(length_a - length_b) * 0.5f);
-                                    }
-                                }
-                                else {
-                                    statistics.addSample(area);
-                                }
-                            }
-                            else {
-                                statistics.addSample(0.0f);
-                            }
+#ifdef VRN_MODULE_OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+        for (long p = 0; p < numTilePairs; p++) {
+#ifdef VRN_MODULE_OPENMP
+            if(aborted) {
+                continue;
+            }
+#else
+            if(aborted) {
+                break;
+            }
+#endif
+
+            const long beginI = tilePairs[p].first * DISTANCE_TILE_SIZE;
+            const long endI = std::min(beginI + DISTANCE_TILE_SIZE, size);
+            const long beginJ = tilePairs[p].second * DISTANCE_TILE_SIZE;
+            const long endJ = std::min(beginJ + DISTANCE_TILE_SIZE, size);
+
+            if(useSingleChannelMeasure) {
+                // Values of the current block of all rows of both tiles, see gatherValues.
+                std::vector<float> valuesI(DISTANCE_TILE_SIZE * DISTANCE_BLOCK_SIZE);
+                std::vector<float> valuesJ(DISTANCE_TILE_SIZE * DISTANCE_BLOCK_SIZE);
+                const bool diagonalTile = beginI == beginJ;
+
+                double sumsOfMaxima[DISTANCE_TILE_SIZE][DISTANCE_TILE_SIZE] = {};
+                for (size_t blockBegin = 0; blockBegin < numFlags; blockBegin += DISTANCE_BLOCK_SIZE) {
+                    const size_t blockSize = std::min(DISTANCE_BLOCK_SIZE, numFlags - blockBegin);
+                    for (long i = beginI; i < endI; i++) {
+                        gatherValues(i, blockBegin, blockSize, valuesI.data() + (i - beginI) * blockSize);
+                    }
+                    if(!diagonalTile) {
+                        for (long j = beginJ; j < endJ; j++) {
+                            gatherValues(j, blockBegin, blockSize, valuesJ.data() + (j - beginJ) * blockSize);
                         }
-                        else if(input.multiChannelSimilarityMeasure == MEASURE_EUCLIDEAN_NORM) {
-                            statistics.addSample(tgt::length(vector_i - vector_j) / (2*valueRange.y));
+                    }
+                    const float* blockJ = diagonalTile ? valuesI.data() : valuesJ.data();
+
+                    for (long i = beginI; i < endI; i++) {
+                        const float* row_i = valuesI.data() + (i - beginI) * blockSize;
+                        for (long j = beginJ; j < endJ && j <= i; j++) {
+                            const float* row_j = blockJ + (j - beginJ) * blockSize;
+                            sumsOfMaxima[i - beginI][j - beginJ] += sumOfMaxima(row_i, row_j, blockSize);
                         }
                     }
+                }
 
-                    if(useSingleChannelMeasure) {
-                        distanceMatrix(i, j) = statistics.getMean();
-                        //DistanceMatrix(i, j) = statistics.getMedian(); // Needs collecting samples enabled
-                        //DistanceMatrix(i, j) = statistics.getRelStdDev();
+                for (long i = beginI; i < endI; i++) {
+                    for (long j = beginJ; j < endJ && j <= i; j++) {
+                        double sumOfMax = sumsOfMaxima[i - beginI][j - beginJ];
+                        if(numFlags == 0) {
+                            distanceMatrix(i, j) = 1.0f;
+                        }
+                        else if(input.singleChannelSimilarityMeasure == MEASURE_AVG_DIFFERENCE) {
+                            // Mean of |a - b| over all flags, using |a - b| = 2 max(a, b) - a - b.
+                            double sumOfDifferences = std::max(0.0, 2.0 * sumOfMax - rowSums[i] - rowSums[j]);
+                            distanceMatrix(i, j) = static_cast<float>(sumOfDifferences / numFlags);
+                        }
+                        else {
+                            // Sum over (1 - max(a, b)) and (1 - min(a, b)) using min(a, b) = a + b - max(a, b).
+                            float intersectionSamples = static_cast<float>(numFlags - sumOfMax);
+                            float unionSamples = static_cast<float>(numFlags - (rowSums[i] + rowSums[j] - sumOfMax));
+
+                            if (unionSamples > 0.0f)
+                                distanceMatrix(i, j) = (unionSamples - intersectionSamples) / unionSamples;
+                            else
+                                distanceMatrix(i, j) = 1.0f;
+                        }
                     }
-                    else {
-                        // We combine the two measures as proposed by Leistikow et al. (see SimilarityMatrixCombine).
-                        distanceMatrix(i, j) = 1.0f - (1-distanceMatrix(i,j)) * (1-statistics.getMean());
+                }
+            }
+            if(useMultiChannelMeasure) {
+                for (long i = beginI; i < endI; i++) {
+                    for (long j = beginJ; j < endJ && j <= i; j++) {
+                        float mean = multiChannelDistance(i, j);
+                        if(useSingleChannelMeasure) {
+                            distanceMatrix(i, j) = mean;
+                            //DistanceMatrix(i, j) = statistics.getMedian(); // Needs collecting samples enabled
+                            //DistanceMatrix(i, j) = statistics.getRelStdDev();
+                        }
+                        else {
+                            // We combine the two measures as proposed by Leistikow et al. (see SimilarityMatrixCombine).
+                            distanceMatrix(i, j) = 1.0f - (1-distanceMatrix(i,j)) * (1-mean);
+                        }
                     }
-
                 }
             }
 
-
             if (threadedProgress.reportStepDone()) {
 #ifdef VRN_MODULE_OPENMP
                 #pragma omp critical
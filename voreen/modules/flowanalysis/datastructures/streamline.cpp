@@ -24,6 +24,7 @@
  ***********************************************************************************/
 
 #include "streamline.h"
+#include "streamlinestorage.h"
 
 #include "voreen/core/utils/stringutils.h"
 
@@ -32,12 +33,25 @@
 namespace voreen {
 
 Streamline::Streamline()
-    : magnitudeStatistics_(false)
+    : offset_(0)
+    , numElements_(0)
+    , magnitudeStatistics_(false)
     , curvatureStatistics_(false)
     , physicalLength_(0.0f)
 {
 }
 
+Streamline::Streamline(const std::shared_ptr<const StreamlineStorage>& storage, size_t offset, const Streamline& source)
+    : storage_(storage)
+    , offset_(offset)
+    , numElements_(source.numElements_)
+    , magnitudeStatistics_(source.magnitudeStatistics_)
+    , curvatureStatistics_(source.curvatureStatistics_)
+    , physicalLength_(source.physicalLength_)
+{
+    tgtAssert(storage_ && offset_ + numElements_ <= storage_->getNumElements(), "Invalid storage range");
+}
+
 Streamline::~Streamline() {
 }
 
@@ -45,63 +59,85 @@ Streamline::~Streamline() {
 //  Construction
 //----------------
 void Streamline::addElementAtEnd(const StreamlineElement& element) {
-    if(!streamlineElements_.empty()) {
-        // Update physical length.
-        physicalLength_ += tgt::distance(streamlineElements_.back().position_, element.position_);
+    detach();
+    updateStatistics(element, numElements_ > 0 ? &getLastElement() : nullptr);
 
-        // Update curvature statistics.
-        float currMagnitude = tgt::length(element.velocity_);
-        float prevMagnitude = tgt::length(streamlineElements_.back().velocity_);
-        if(currMagnitude > 0.0f && prevMagnitude > 0.0f) {
-            float angle = std::acos(std::abs(tgt::dot(streamlineElements_.back().velocity_, element.velocity_)) /
-                                    (prevMagnitude * currMagnitude));
-            curvatureStatistics_.addSample(angle);
-        }
+    elements_.push_back(element);
+    numElements_++;
+}
+
+void Streamline::addElementAtFront(const StreamlineElement& element) {
+    detach();
+    updateStatistics(element, numElements_ > 0 ? &getFirstElement() : nullptr);
+
+    if(offset_ == 0) {
+        // Reserve space for (at least) as many elements at the front as currently stored to amortize the insertion.
+        size_t headroom = std::max<size_t>(numElements_, 16);
+        elements_.insert(elements_.begin(), headroom, StreamlineElement());
+        offset_ = headroom;
     }
+    elements_[--offset_] = element;
+    numElements_++;
+}
 
-    streamlineElements_.push_back(element);
-    float length = tgt::length(element.velocity_);
-    magnitudeStatistics_.addSample(length);
+void Streamline::detach() {
+    if(!storage_) {
+        return;
+    }
+
+    const StreamlineElement* elements = getElements();
+    elements_.assign(elements, elements + numElements_);
+    offset_ = 0;
+    storage_.reset();
 }
 
-void Streamline::addElementAtFront(const StreamlineElement& element) {
-    if(!streamlineElements_.empty()) {
+void Streamline::updateStatistics(const StreamlineElement& element, const StreamlineElement* neighbor) {
+    float currMagnitude = tgt::length(element.velocity_);
+    if(neighbor) {
         // Update physical length.
-        physicalLength_ += tgt::distance(streamlineElements_.front().position_, element.position_);
+        physicalLength_ += tgt::distance(neighbor->position_, element.position_);
 
         // Update curvature statistics.
-        float currMagnitude = tgt::length(element.velocity_);
-        float prevMagnitude = tgt::length(streamlineElements_.front().velocity_);
+        float prevMagnitude = tgt::length(neighbor->velocity_);
         if(currMagnitude > 0.0f && prevMagnitude > 0.0f) {
-            float angle = std::acos(std::abs(tgt::dot(streamlineElements_.front().velocity_, element.velocity_)) /
+            float angle = std::acos(std::abs(tgt::dot(neighbor->velocity_, element.velocity_)) /
                                     (prevMagnitude * currMagnitude));
             curvatureStatistics_.addSample(angle);
         }
     }
 
-    streamlineElements_.push_front(element);
-    float length = tgt::length(element.velocity_);
-    magnitudeStatistics_.addSample(length);
+    magnitudeStatistics_.addSample(currMagnitude);
 }
 
 //----------------
 //  Access
 //----------------
 size_t Streamline::getNumElements() const {
-    return streamlineElements_.size();
+    return numElements_;
+}
+
+const Streamline::StreamlineElement* Streamline::getElements() const {
+    if(storage_) {
+        return storage_->getElements() + offset_;
+    }
+    return elements_.data() + offset_;
+}
+
+const std::shared_ptr<const StreamlineStorage>& Streamline::getStorage() const {
+    return storage_;
 }
 
 const Streamline::StreamlineElement& Streamline::getElementAt(size_t pos) const {
     tgtAssert(pos < getNumElements(), "Requested element does not exist!");
-    return streamlineElements_[pos];
+    return getElements()[pos];
 }
 
 const Streamline::StreamlineElement& Streamline::getFirstElement() const {
-    return streamlineElements_.front();
+    return getElementAt(0);
 }
 
 const Streamline::StreamlineElement& Streamline::getLastElement() const {
-    return streamlineElements_.back();
+    return getElementAt(numElements_ - 1);
 }
 
 //----------------
@@ -122,8 +158,9 @@ Streamline Streamline::resample(size_t samples) const {
 
         float totalLength = 0.0f;
         distances[0] = 0.0f;
+        const StreamlineElement* elements = getElements();
         for(size_t i = 1; i < getNumElements(); i++) {
-            totalLength += tgt::distance(streamlineElements_[i-1].position_, streamlineElements_[i].position_);
+            totalLength += tgt::distance(elements[i-1].position_, elements[i].position_);
             distances[i] = totalLength;
         }
 
@@ -135,10 +172,10 @@ Streamline Streamline::resample(size_t samples) const {
             const float t = tgt::clamp((segmentLength * i - distances[pos]) / (distances[pos + 1] - distances[pos]), 0.0f, 1.0f);
 
             Streamline::StreamlineElement element;
-            element.position_  = streamlineElements_[pos].position_  * (1.0f - t) + streamlineElements_[pos + 1].position_  * t;
-            element.velocity_  = streamlineElements_[pos].velocity_  * (1.0f - t) + streamlineElements_[pos + 1].velocity_  * t;
-            element.radius_    = streamlineElements_[pos].radius_    * (1.0f - t) + streamlineElements_[pos + 1].radius_    * t;
-            element.time_      = streamlineElements_[pos].time_      * (1.0f - t) + streamlineElements_[pos + 1].time_      * t;
+            element.position_  = elements[pos].position_  * (1.0f - t) + elements[pos + 1].position_  * t;
+            element.velocity_  = elements[pos].velocity_  * (1.0f - t) + elements[pos + 1].velocity_  * t;
+            element.radius_    = elements[pos].radius_    * (1.0f - t) + elements[pos + 1].radius_    * t;
+            element.time_      = elements[pos].time_      * (1.0f - t) + elements[pos + 1].time_      * t;
 
             resampled.addElementAtEnd(element);
         }
@@ -181,7 +218,8 @@ tgt::vec2 Streamline::getTemporalRange() const {
 std::string Streamline::toCSVString(const tgt::mat4& transformationMatrix, const tgt::mat4& velocityTransfomationMatrix) const {
     std::stringstream output;
     output << getNumElements();
-    for(const StreamlineElement& element: streamlineElements_) {
+    for(size_t i = 0; i < getNumElements(); i++) {
+        const StreamlineElement& element = getElementAt(i);
         tgt::vec4 transformedPosition = transformationMatrix * tgt::vec4(element.position_,1.f);
         tgt::vec4 transformedVelocity = velocityTransfomationMatrix * tgt::vec4(element.velocity_,1.f);
         output << ", " << transformedPosition.x <<
@@ -198,12 +236,12 @@ std::string Streamline::toCSVString(const tgt::mat4& transformationMatrix, const
 
 void Streamline::serialize(Serializer& s) const {
     //serialize elements as blob
-    std::vector<StreamlineElement> vec(streamlineElements_.begin(), streamlineElements_.end());
+    std::vector<StreamlineElement> vec(getElements(), getElements() + getNumElements());
     s.serializeBinaryBlob("StreamlineElements",vec);
 }
 
 void Streamline::deserialize(Deserializer& s) {
-    streamlineElements_.clear();
+    *this = Streamline();
 
     //deserialize streamlines from binary blob
     std::vector<Streamline::StreamlineElement> vec;
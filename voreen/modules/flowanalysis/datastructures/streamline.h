@@ -36,13 +36,20 @@
 
 #include "tgt/vector.h"
 
-#include <deque>
+#include <memory>
+#include <vector>
 
 namespace voreen {
 
+class StreamlineStorage;
+
 /**
  * Datastructure used to represent streamlines. It is used in the flowanalysis module.
  * A streamline consists of multiple StreamlineElements each storing a position and the velocity at this position.
+ *
+ * The elements are stored contiguously, either in a buffer owned by the streamline (while it is constructed)
+ * or in a StreamlineStorage shared by all streamlines of a StreamlineList. Copies of the latter are cheap;
+ * they are detached from the storage only when elements are added.
  */
 class VRN_CORE_API Streamline : public Serializable {
 public:
@@ -76,6 +83,9 @@ public:
     /** Destructor */
     ~Streamline();
 
+    /** Creates a streamline referencing the elements [offset, offset+numElements) of the passed storage. */
+    Streamline(const std::shared_ptr<const StreamlineStorage>& storage, size_t offset, const Streamline& source);
+
     //----------------
     //  Construction
     //----------------
@@ -92,6 +102,12 @@ public:
     const StreamlineElement& getLastElement() const;
     size_t getNumElements() const;
 
+    /** Returns the contiguous array of all elements from front to back. */
+    const StreamlineElement* getElements() const;
+
+    /** Returns the storage the elements are located in, or null, if they are owned by this streamline. */
+    const std::shared_ptr<const StreamlineStorage>& getStorage() const;
+
     //----------------
     //  Utility
     //----------------
@@ -131,10 +147,21 @@ public:
     //  Members
     //----------------
 private:
-    std::deque<StreamlineElement> streamlineElements_;   ///< list of all streamline elements from front to back
-    Statistics magnitudeStatistics_;                     ///< statistics of the contained magnitudes
-    Statistics curvatureStatistics_;                     ///< statistics of the lines curvature
-    float physicalLength_;                               ///< total physical length (in mm)
+    friend class StreamlineList;
+
+    /** Copies the elements of a shared storage into an owned buffer. */
+    void detach();
+    /** Updates the statistics for an element appended next to the passed neighbor element. */
+    void updateStatistics(const StreamlineElement& element, const StreamlineElement* neighbor);
+
+    std::shared_ptr<const StreamlineStorage> storage_;  ///< shared storage of the elements, null if owned
+    std::vector<StreamlineElement> elements_;           ///< owned elements, the front part is reserved for elements added at the front
+    size_t offset_;                                     ///< index of the first element within storage_ or elements_
+    size_t numElements_;                                ///< number of elements
+
+    Statistics magnitudeStatistics_;                    ///< statistics of the contained magnitudes
+    Statistics curvatureStatistics_;                    ///< statistics of the lines curvature
+    float physicalLength_;                              ///< total physical length (in mm)
 };
 
 }   // namespace
@@ -24,13 +24,88 @@
  ***********************************************************************************/
 
 #include "streamlinelist.h"
+#include "streamlinestorage.h"
 
 #include "voreen/core/datastructures/volume/volumebase.h"
 
+#include "tgt/exception.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
 namespace voreen {
 
+namespace {
+
+/// Magic number identifying binary VSD files.
+const char BINARY_VSD_MAGIC[8] = { 'V', 'S', 'D', 'B', 'I', 'N', '0', '2' };
+
+/// Alignment of the element array within binary VSD files.
+const uint64_t BINARY_VSD_ELEMENT_ALIGNMENT = 64;
+
+/// Summary of a Statistics object within binary VSD files.
+struct BinaryVSDStatistics {
+    uint64_t numSamples_;
+    float min_;
+    float max_;
+    float sum_;
+    float mean_;
+    float variance_;
+    float padding_;
+
+    void set(const Statistics& statistics) {
+        numSamples_ = statistics.getNumSamples();
+        min_        = statistics.getMin();
+        max_        = statistics.getMax();
+        sum_        = statistics.getSum();
+        mean_       = statistics.getMean();
+        variance_   = numSamples_ > 0 ? statistics.getVariance() : 0.0f;
+    }
+
+    Statistics get() const {
+        return Statistics::fromSummary(numSamples_, min_, max_, sum_, mean_, variance_);
+    }
+};
+
+/// Per-streamline record of binary VSD files.
+struct BinaryVSDRecord {
+    uint64_t offset_;               ///< index of the first element
+    uint64_t numElements_;
+    float physicalLength_;
+    float padding_;
+    BinaryVSDStatistics magnitudeStatistics_;
+    BinaryVSDStatistics curvatureStatistics_;
+};
+
+uint64_t alignOffset(uint64_t offset, uint64_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+void openBinaryVSD(std::ifstream& file, const std::string& filename, uint64_t& headerSize, uint64_t& fileSize) {
+    file.open(filename.c_str(), std::ios::binary | std::ios::ate);
+    if(!file.good()) {
+        throw tgt::FileNotFoundException("Could not open file", filename);
+    }
+    fileSize = static_cast<uint64_t>(file.tellg());
+    file.seekg(0);
+
+    char magic[sizeof(BINARY_VSD_MAGIC)];
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&headerSize), sizeof(headerSize));
+    if(!file.good() || std::memcmp(magic, BINARY_VSD_MAGIC, sizeof(magic)) != 0) {
+        throw tgt::CorruptedFileException("Not a binary VSD file", filename);
+    }
+    if(headerSize > fileSize - sizeof(magic) - sizeof(headerSize)) {
+        throw tgt::CorruptedFileException("Binary VSD header is truncated", filename);
+    }
+}
+
+}
+
 StreamlineList::StreamlineList(const VolumeBase* volume)
     : StreamlineListBase()
+    , storage_(new StreamlineStorage())
     , dimensions_(1)
     , spacing_(1.0f)
     , magnitudeRange_(tgt::vec2::zero)
@@ -55,7 +130,11 @@ StreamlineList::~StreamlineList() {
 StreamlineListBase* StreamlineList::clone() const{
     StreamlineList* result           = new StreamlineList();
 
-    result->streamlines_             = this->streamlines_;
+    // Streamlines are stored in a storage of their own, since ours might be appended to.
+    result->streamlines_.reserve(streamlines_.size());
+    for(const Streamline& line : streamlines_) {
+        result->streamlines_.push_back(Streamline(result->storage_, result->storage_->append(line), line));
+    }
     result->dimensions_              = this->dimensions_;
     result->spacing_                 = this->spacing_;
     result->worldBounds_             = this->worldBounds_;
@@ -70,6 +149,20 @@ StreamlineListBase* StreamlineList::clone() const{
     return result;
 }
 
+void StreamlineList::copyMeta(const StreamlineListBase& list) {
+    notifyPendingDataInvalidation();
+    dimensions_              = list.getOriginalDimensions();
+    spacing_                 = list.getOriginalSpacing();
+    worldBounds_             = list.getOriginalWorldBounds();
+    voxelBounds_             = list.getOriginalVoxelBounds();
+    voxelToWorldMatrix_      = list.getOriginalVoxelToWorldMatrix();
+    worldToVoxelMatrix_      = list.getOriginalWorldToVoxelMatrix();
+    magnitudeRange_          = tgt::vec2(list.getMinMagnitude(), list.getMaxMagnitude());
+    temporalRange_           = list.getTemporalRange();
+    listTransformMatrix_     = list.getListTransformMatrix();
+    velocityTransformMatrix_ = list.getVelocityTransformMatrix();
+}
+
     //------------------------
     //  Streamline Handling
     //------------------------
@@ -83,7 +176,7 @@ void StreamlineList::addStreamline(const Streamline& line) {
     notifyPendingDataInvalidation();
 
     bool wasEmpty = streamlines_.empty();
-    streamlines_.push_back(line);
+    streamlines_.push_back(Streamline(storage_, storage_->append(line), line));
 
     if (wasEmpty || magnitudeRange_.x > line.getMinMagnitude()) {
         magnitudeRange_.x = line.getMinMagnitude();
@@ -120,7 +213,12 @@ void StreamlineList::addStreamlineList(const StreamlineListBase& list) {
     }
 
     //copy streamlines
-    streamlines_.insert(streamlines_.end(), list.getStreamlines().begin(), list.getStreamlines().end());
+    const std::vector<Streamline>& lines = list.getStreamlines();
+    size_t numLines = lines.size();
+    streamlines_.reserve(streamlines_.size() + numLines);
+    for(size_t i = 0; i < numLines; i++) {
+        streamlines_.push_back(Streamline(storage_, storage_->append(lines[i]), lines[i]));
+    }
 }
 
 void StreamlineList::removeStreamline(size_t pos) {
@@ -133,6 +231,8 @@ void StreamlineList::removeStreamline(size_t pos) {
 void StreamlineList::clearStreamlines() {
     notifyPendingDataInvalidation();
     streamlines_.clear();
+    // Copies of the removed streamlines keep the old storage alive.
+    storage_.reset(new StreamlineStorage());
 }
 
 const std::vector<Streamline>& StreamlineList::getStreamlines() const {
@@ -247,9 +347,124 @@ void StreamlineList::deserialize(Deserializer& s) {
     size_t numStreamlines = 0;
     s.deserialize("NumStreamlines", numStreamlines);
     streamlines_.clear();
-    streamlines_.resize(numStreamlines);
+    streamlines_.reserve(numStreamlines);
+    storage_.reset(new StreamlineStorage());
     for(size_t i = 0; i < numStreamlines; i++) {
-        s.deserialize("Streamline" + std::to_string(i), streamlines_[i]);
+        Streamline line;
+        s.deserialize("Streamline" + std::to_string(i), line);
+        streamlines_.push_back(Streamline(storage_, storage_->append(line), line));
+    }
+}
+
+bool StreamlineList::isBinaryVSD(const std::string& filename) {
+    std::ifstream file(filename.c_str(), std::ios::binary);
+    char magic[sizeof(BINARY_VSD_MAGIC)];
+    file.read(magic, sizeof(magic));
+    return file.good() && std::memcmp(magic, BINARY_VSD_MAGIC, sizeof(magic)) == 0;
+}
+
+void StreamlineList::writeBinaryVSD(const std::string& filename, const std::string& header, const StreamlineListBase& list) {
+    std::ofstream file(filename.c_str(), std::ios::binary | std::ios::trunc);
+    if(!file.good()) {
+        throw tgt::FileAccessException("Could not open file for writing", filename);
+    }
+
+    const std::vector<Streamline>& lines = list.getStreamlines();
+
+    std::vector<BinaryVSDRecord> records(lines.size());
+    uint64_t numElements = 0;
+    for(size_t i = 0; i < lines.size(); i++) {
+        const Streamline& line = lines[i];
+        BinaryVSDRecord& record = records[i];
+        std::memset(&record, 0, sizeof(record));
+        record.offset_              = numElements;
+        record.numElements_         = line.getNumElements();
+        record.physicalLength_      = line.physicalLength_;
+        record.magnitudeStatistics_.set(line.magnitudeStatistics_);
+        record.curvatureStatistics_.set(line.curvatureStatistics_);
+        numElements += line.getNumElements();
+    }
+
+    uint64_t headerSize = header.size();
+    uint64_t tableOffset = alignOffset(sizeof(BINARY_VSD_MAGIC) + sizeof(headerSize) + headerSize, sizeof(uint64_t));
+    uint64_t recordsOffset = tableOffset + 3 * sizeof(uint64_t);
+    uint64_t elementsOffset = alignOffset(recordsOffset + records.size() * sizeof(BinaryVSDRecord), BINARY_VSD_ELEMENT_ALIGNMENT);
+    uint64_t numStreamlines = lines.size();
+    const char padding[BINARY_VSD_ELEMENT_ALIGNMENT] = { 0 };
+
+    file.write(BINARY_VSD_MAGIC, sizeof(BINARY_VSD_MAGIC));
+    file.write(reinterpret_cast<const char*>(&headerSize), sizeof(headerSize));
+    file.write(header.data(), headerSize);
+    file.write(padding, tableOffset - (sizeof(BINARY_VSD_MAGIC) + sizeof(headerSize) + headerSize));
+    file.write(reinterpret_cast<const char*>(&numStreamlines), sizeof(numStreamlines));
+    file.write(reinterpret_cast<const char*>(&numElements), sizeof(numElements));
+    file.write(reinterpret_cast<const char*>(&elementsOffset), sizeof(elementsOffset));
+    file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(BinaryVSDRecord));
+    file.write(padding, elementsOffset - (recordsOffset + records.size() * sizeof(BinaryVSDRecord)));
+    for(const Streamline& line : lines) {
+        file.write(reinterpret_cast<const char*>(line.getElements()), line.getNumElements() * sizeof(Streamline::StreamlineElement));
+    }
+
+    if(!file.good()) {
+        throw tgt::FileAccessException("Failed to write binary VSD file", filename);
+    }
+}
+
+std::string StreamlineList::readBinaryVSDHeader(const std::string& filename) {
+    std::ifstream file;
+    uint64_t headerSize = 0, fileSize = 0;
+    openBinaryVSD(file, filename, headerSize, fileSize);
+
+    std::string header(headerSize, '\0');
+    file.read(&header[0], headerSize);
+    if(!file.good()) {
+        throw tgt::CorruptedFileException("Binary VSD header is truncated", filename);
+    }
+    return header;
+}
+
+void StreamlineList::mapBinaryVSD(const std::string& filename) {
+    std::ifstream file;
+    uint64_t headerSize = 0, fileSize = 0;
+    openBinaryVSD(file, filename, headerSize, fileSize);
+
+    uint64_t numStreamlines = 0, numElements = 0, elementsOffset = 0;
+    file.seekg(alignOffset(sizeof(BINARY_VSD_MAGIC) + sizeof(headerSize) + headerSize, sizeof(uint64_t)));
+    file.read(reinterpret_cast<char*>(&numStreamlines), sizeof(numStreamlines));
+    file.read(reinterpret_cast<char*>(&numElements), sizeof(numElements));
+    file.read(reinterpret_cast<char*>(&elementsOffset), sizeof(elementsOffset));
+    if(!file.good()) {
+        throw tgt::CorruptedFileException("Binary VSD streamline table is truncated", filename);
+    }
+
+    // Validate the table size before allocating it: the records have to fit between the table header and the elements.
+    uint64_t recordsOffset = static_cast<uint64_t>(file.tellg());
+    if(elementsOffset < recordsOffset || elementsOffset > fileSize ||
+       numStreamlines > (elementsOffset - recordsOffset) / sizeof(BinaryVSDRecord)) {
+        throw tgt::CorruptedFileException("Binary VSD streamline table is corrupt", filename);
+    }
+    std::vector<BinaryVSDRecord> records(numStreamlines);
+    file.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(BinaryVSDRecord));
+    if(!file.good()) {
+        throw tgt::CorruptedFileException("Binary VSD streamline table is truncated", filename);
+    }
+    file.close();
+
+    std::shared_ptr<const StreamlineStorage> mapped(new StreamlineStorage(filename, elementsOffset, numElements));
+
+    notifyPendingDataInvalidation();
+    streamlines_.reserve(streamlines_.size() + records.size());
+    for(const BinaryVSDRecord& record : records) {
+        if(record.offset_ > numElements || record.numElements_ > numElements - record.offset_) {
+            throw tgt::CorruptedFileException("Binary VSD streamline table is corrupt", filename);
+        }
+
+        Streamline line;
+        line.numElements_         = record.numElements_;
+        line.physicalLength_      = record.physicalLength_;
+        line.magnitudeStatistics_ = record.magnitudeStatistics_.get();
+        line.curvatureStatistics_ = record.curvatureStatistics_.get();
+        streamlines_.push_back(Streamline(mapped, record.offset_, line));
     }
 }
 
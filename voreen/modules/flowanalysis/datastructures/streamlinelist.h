@@ -31,15 +31,22 @@
 #include "streamline.h"
 #include "streamlinebundle.h"
 
+#include <memory>
 #include <vector>
 #include <string>
 
 namespace voreen {
 
 class VolumeBase;
+class StreamlineStorage;
 
 /**
  * Implementation of StreamlineListBase, storing the streamlines.
+ * The elements of all streamlines are packed into a single StreamlineStorage, which the streamlines reference.
+ *
+ * Besides the XML based VSD format, lists can be stored as binary VSD files, consisting of an XML header
+ * holding the meta data, followed by the per-streamline records and the packed elements. The latter are
+ * memory-mapped when loading, so that the elements are only read from disk when they are accessed.
  */
 class VRN_CORE_API StreamlineList : public StreamlineListBase {
 public:
@@ -91,6 +98,9 @@ public:
 
     virtual const tgt::vec2& getTemporalRange() const;
 
+    /** Copies the meta data (but not the streamlines) of the passed list. */
+    void copyMeta(const StreamlineListBase& list);
+
 protected:
     /**
      * Only used by the StreamlineRotation processor.
@@ -107,12 +117,36 @@ public:
     virtual void serialize(Serializer& s) const;
     virtual void deserialize(Deserializer& s);
 
+    /** Returns true, if the passed file is a binary VSD file. */
+    static bool isBinaryVSD(const std::string& filename);
+
+    /**
+     * Writes a binary VSD file containing the streamlines of the passed list.
+     * @param header XML document stored in front of the streamlines, typically containing the meta data.
+     * @throws tgt::FileException
+     */
+    static void writeBinaryVSD(const std::string& filename, const std::string& header, const StreamlineListBase& list);
+
+    /**
+     * Returns the XML header of a binary VSD file.
+     * @throws tgt::FileException
+     */
+    static std::string readBinaryVSDHeader(const std::string& filename);
+
+    /**
+     * Appends the streamlines of a binary VSD file, whose elements are memory-mapped.
+     * The meta data has to be read from the header separately.
+     * @throws tgt::FileException
+     */
+    void mapBinaryVSD(const std::string& filename);
+
     //----------------
     //  Members
     //----------------
 protected:
 
-    std::vector<Streamline> streamlines_; ///< list of streamlines
+    std::vector<Streamline> streamlines_;           ///< list of streamlines
+    std::shared_ptr<StreamlineStorage> storage_;    ///< packed elements of the streamlines added to this list
 
     //meta
     tgt::svec3 dimensions_;             ///< original dimensions of the input volume
@@ -0,0 +1,93 @@
+/***********************************************************************************
+ *                                                                                 *
+ * Voreen - The Volume Rendering Engine                                            *
+ *                                                                                 *
+ * Copyright (C) 2005-2024 University of Muenster, Germany,                        *
+ * Department of Computer Science.                                                 *
+ * For a list of authors please refer to the file "CREDITS.txt".                   *
+ *                                                                                 *
+ * This file is part of the Voreen software package. Voreen is free software:      *
+ * you can redistribute it and/or modify it under the terms of the GNU General     *
+ * Public License version 2 as published by the Free Software Foundation.          *
+ *                                                                                 *
+ * Voreen is distributed in the hope that it will be useful, but WITHOUT ANY       *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR   *
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.      *
+ *                                                                                 *
+ * You should have received a copy of the GNU General Public License in the file   *
+ * "LICENSE.txt" along with this file. If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                                 *
+ * For non-commercial academic use see the license exception specified in the file *
+ * "LICENSE-academic.txt". To get information about commercial licensing please    *
+ * contact the authors.                                                            *
+ *                                                                                 *
+ ***********************************************************************************/
+
+
+#include "streamlinestorage.h"
+
+#include "tgt/assert.h"
+#include "tgt/exception.h"
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+namespace voreen {
+
+StreamlineStorage::StreamlineStorage()
+    : mappedElements_(nullptr)
+    , numMappedElements_(0)
+{
+}
+
+StreamlineStorage::StreamlineStorage(const std::string& filename, size_t offset, size_t numElements)
+    : mappedElements_(nullptr)
+    , numMappedElements_(0)
+{
+    try {
+        file_.reset(new boost::iostreams::mapped_file_source(filename));
+    } catch(std::exception& e) {
+        file_.reset();
+        throw tgt::FileException("Failed to map streamline file: " + std::string(e.what()), filename);
+    }
+
+    if(offset % alignof(Streamline::StreamlineElement) != 0 || offset > file_->size() ||
+       numElements > (file_->size() - offset) / sizeof(Streamline::StreamlineElement)) {
+        file_.reset();
+        throw tgt::CorruptedFileException("Streamline file is truncated", filename);
+    }
+
+    mappedElements_ = reinterpret_cast<const Streamline::StreamlineElement*>(file_->data() + offset);
+    numMappedElements_ = numElements;
+}
+
+StreamlineStorage::~StreamlineStorage() {
+}
+
+size_t StreamlineStorage::append(const Streamline& line) {
+    tgtAssert(!isMapped(), "Mapped storages are read-only");
+
+    size_t offset = elements_.size();
+    const Streamline::StreamlineElement* elements = line.getElements();
+    if(line.getStorage().get() == this) {
+        // The source elements would be invalidated by reallocation.
+        std::vector<Streamline::StreamlineElement> tmp(elements, elements + line.getNumElements());
+        elements_.insert(elements_.end(), tmp.begin(), tmp.end());
+    } else {
+        elements_.insert(elements_.end(), elements, elements + line.getNumElements());
+    }
+    return offset;
+}
+
+const Streamline::StreamlineElement* StreamlineStorage::getElements() const {
+    return file_ ? mappedElements_ : elements_.data();
+}
+
+size_t StreamlineStorage::getNumElements() const {
+    return file_ ? numMappedElements_ : elements_.size();
+}
+
+bool StreamlineStorage::isMapped() const {
+    return file_ != nullptr;
+}
+
+}   // namespace
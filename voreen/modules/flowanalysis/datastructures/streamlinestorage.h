@@ -0,0 +1,87 @@
+/***********************************************************************************
+ *                                                                                 *
+ * Voreen - The Volume Rendering Engine                                            *
+ *                                                                                 *
+ * Copyright (C) 2005-2024 University of Muenster, Germany,                        *
+ * Department of Computer Science.                                                 *
+ * For a list of authors please refer to the file "CREDITS.txt".                   *
+ *                                                                                 *
+ * This file is part of the Voreen software package. Voreen is free software:      *
+ * you can redistribute it and/or modify it under the terms of the GNU General     *
+ * Public License version 2 as published by the Free Software Foundation.          *
+ *                                                                                 *
+ * Voreen is distributed in the hope that it will be useful, but WITHOUT ANY       *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR   *
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.      *
+ *                                                                                 *
+ * You should have received a copy of the GNU General Public License in the file   *
+ * "LICENSE.txt" along with this file. If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                                 *
+ * For non-commercial academic use see the license exception specified in the file *
+ * "LICENSE-academic.txt". To get information about commercial licensing please    *
+ * contact the authors.                                                            *
+ *                                                                                 *
+ ***********************************************************************************/
+
+
+#ifndef VRN_STREAMLINESTORAGE_H
+#define VRN_STREAMLINESTORAGE_H
+
+#include "streamline.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace boost { namespace iostreams { class mapped_file_source; } }
+
+namespace voreen {
+
+/**
+ * Contiguous storage of the elements of multiple streamlines, which reference their elements by offset.
+ * The elements are either held in memory, where new streamlines can be appended, or located in a
+ * read-only memory-mapped file, e.g., a binary VSD file (@see StreamlineList::mapBinaryVSD).
+ */
+class VRN_CORE_API StreamlineStorage {
+public:
+    /** Creates an empty in-memory storage. */
+    StreamlineStorage();
+
+    /**
+     * Maps numElements elements located at the passed byte offset of a file.
+     * @throws tgt::FileException if the file can not be mapped or is too small.
+     */
+    StreamlineStorage(const std::string& filename, size_t offset, size_t numElements);
+
+    ~StreamlineStorage();
+
+    /**
+     * Copies the elements of the passed streamline to the end of the storage.
+     * Must not be called for mapped storages.
+     *
+     * @return offset of the first copied element
+     */
+    size_t append(const Streamline& line);
+
+    /** Returns the contiguous array of all elements. Invalidated by append. */
+    const Streamline::StreamlineElement* getElements() const;
+
+    /** Returns the total number of elements. */
+    size_t getNumElements() const;
+
+    /** Returns true, if the elements are located in a memory-mapped file. */
+    bool isMapped() const;
+
+private:
+    StreamlineStorage(const StreamlineStorage&);
+    StreamlineStorage& operator=(const StreamlineStorage&);
+
+    std::vector<Streamline::StreamlineElement> elements_;           ///< elements of the in-memory storage
+    std::unique_ptr<boost::iostreams::mapped_file_source> file_;    ///< mapped file, null for in-memory storages
+    const Streamline::StreamlineElement* mappedElements_;           ///< first mapped element
+    size_t numMappedElements_;                                      ///< number of mapped elements
+};
+
+}   // namespace
+
+#endif
@@ -13,7 +13,8 @@ SET(MOD_CORE_SOURCES
     ${MOD_DIR}/datastructures/streamlinelist.cpp
     ${MOD_DIR}/datastructures/streamlinelistbase.cpp
     ${MOD_DIR}/datastructures/streamlinelistdecorator.cpp
-    ${MOD_DIR}/datastructures/streamlinelistobserver.cpp
+    ${MOD_DIR}/datastructures/streamlinelistobserver.cpp
+    ${MOD_DIR}/datastructures/streamlinestorage.cpp
 
     # ports
     ${MOD_DIR}/ports/parallelvectorsolutionpointsport.cpp
@@ -61,7 +62,8 @@ SET(MOD_CORE_HEADERS
     ${MOD_DIR}/datastructures/streamlinelist.h
     ${MOD_DIR}/datastructures/streamlinelistbase.h
     ${MOD_DIR}/datastructures/streamlinelistdecorator.h
-    ${MOD_DIR}/datastructures/streamlinelistobserver.h
+    ${MOD_DIR}/datastructures/streamlinelistobserver.h
+    ${MOD_DIR}/datastructures/streamlinestorage.h
 
     # ports
     ${MOD_DIR}/ports/parallelvectorsolutionpointsport.h
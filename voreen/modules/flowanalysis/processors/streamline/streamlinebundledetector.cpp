@@ -27,8 +27,91 @@
 
 #include "../../datastructures/streamlinelist.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 namespace voreen {
 
+namespace {
+
+/**
+ * Uniform grid over the barycenters of the bundle centroids, used to prune the bundles a streamline has to be
+ * compared to. Since the MDF is the mean of the point-wise distances, it is bounded from below by the distance
+ * of the barycenters (triangle inequality). With a cell size of (at least) the distance threshold, only bundles
+ * located in the 27 cells around the barycenter of a streamline can thus be closer than the threshold.
+ */
+class CentroidGrid {
+public:
+    CentroidGrid(double cellSize)
+        : cellSize_(cellSize)
+    {
+    }
+
+    void insert(size_t bundle, const tgt::dvec3& barycenter) {
+        cells_[getCell(barycenter)].push_back(bundle);
+    }
+
+    void move(size_t bundle, const tgt::dvec3& from, const tgt::dvec3& to) {
+        tgt::ivec3 oldCell = getCell(from);
+        tgt::ivec3 newCell = getCell(to);
+        if(oldCell == newCell) {
+            return;
+        }
+
+        std::vector<size_t>& bundles = cells_[oldCell];
+        bundles.erase(std::find(bundles.begin(), bundles.end(), bundle));
+        if(bundles.empty()) {
+            cells_.erase(oldCell);
+        }
+        insert(bundle, to);
+    }
+
+    /// Calls func for each bundle whose barycenter might be closer to the passed one than the cell size.
+    template<typename F>
+    void forEachCandidate(const tgt::dvec3& barycenter, F func) const {
+        tgt::ivec3 center = getCell(barycenter);
+        tgt::ivec3 cell;
+        for(cell.z = center.z - 1; cell.z <= center.z + 1; cell.z++) {
+            for(cell.y = center.y - 1; cell.y <= center.y + 1; cell.y++) {
+                for(cell.x = center.x - 1; cell.x <= center.x + 1; cell.x++) {
+                    auto iter = cells_.find(cell);
+                    if(iter != cells_.end()) {
+                        for(size_t bundle : iter->second) {
+                            func(bundle);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+private:
+
+    struct CellHash {
+        size_t operator()(const tgt::ivec3& cell) const {
+            return static_cast<size_t>(cell.x) * 73856093u ^ static_cast<size_t>(cell.y) * 19349663u ^ static_cast<size_t>(cell.z) * 83492791u;
+        }
+    };
+
+    tgt::ivec3 getCell(const tgt::dvec3& position) const {
+        return tgt::ivec3(tgt::floor(position / cellSize_));
+    }
+
+    double cellSize_;
+    std::unordered_map<tgt::ivec3, std::vector<size_t>, CellHash> cells_;
+};
+
+tgt::dvec3 calculateBarycenter(const Streamline& streamline) {
+    tgt::dvec3 sum = tgt::dvec3::zero;
+    const Streamline::StreamlineElement* elements = streamline.getElements();
+    for(size_t i = 0; i < streamline.getNumElements(); i++) {
+        sum += tgt::dvec3(elements[i].position_);
+    }
+    return sum / static_cast<double>(streamline.getNumElements());
+}
+
+}
+
 const std::string StreamlineBundleDetector::loggerCat_("flowanalysis.StreamlineBundleDetector");
 
 StreamlineBundleDetector::StreamlineBundleDetector()
@@ -142,44 +225,130 @@ StreamlineBundleDetectorOutput StreamlineBundleDetector::compute(StreamlineBundl
         // We actually calculate the average distance here, since our streamline calculation stores
         // the elements in sorted order. Thus, we can save some time and ignore the flipped distance calculation.
 
+        const Streamline::StreamlineElement* sElements = s.getElements();
+        const Streamline::StreamlineElement* tElements = t.getElements();
         float sum = 0.0f;
 
         for(int i = 0; i < input.resampleSize; i++) {
-            sum += tgt::distance(s.getElementAt(i).position_, t.getElementAt(i).position_);
+            sum += tgt::distance(sElements[i].position_, tElements[i].position_);
         }
 
         return sum / input.resampleSize;
     };
 
     // Step 1: Execute quickbundle algorithm.
+    // Each streamline is assigned to the bundle with the closest centroid, if closer than the threshold.
+    // In case of equal distances, the bundle created first is chosen.
+    // Streamlines are processed in batches: The expensive part (resampling and comparing against the
+    // bundles present before the batch) is done in parallel, while the assignment is done sequentially in
+    // order of the streamlines, comparing only against bundles that have been changed within the batch.
+    // Hence, the result is identical to a sequential execution, independent of the number of threads.
     std::vector<StreamlineBundle> bundles;
+    std::vector<tgt::dvec3> barycenters;        // barycenters of the bundle centroids
+    std::vector<bool> modified;                 // determines whether a bundle has been changed within the current batch
+
+    // Slightly enlarge the cells to be robust against rounding errors.
+    const bool bundling = input.distanceThreshold > 0.0f;
+    CentroidGrid grid(bundling ? input.distanceThreshold * 1.001 : 1.0);
+
+    const size_t batchSize = 4096;
+    const std::vector<Streamline>& inputStreamlines = streamlines->getStreamlines();
+    size_t numStreamlines = inputStreamlines.size();
+    ThreadedTaskProgressReporter progress(progressReporter, numStreamlines);
+    bool aborted = false;
+
+    for(size_t batchBegin = 0; batchBegin < numStreamlines; batchBegin += batchSize) {
+        size_t batchEnd = std::min(batchBegin + batchSize, numStreamlines);
+
+        std::vector<Streamline> resampled(batchEnd - batchBegin);
+        std::vector<tgt::dvec3> lineBarycenters(resampled.size());
+        std::vector<std::vector<std::pair<float, size_t>>> candidates(resampled.size());
+
+#ifdef VRN_MODULE_OPENMP
+        #pragma omp parallel for schedule(dynamic, 64)
+        for (long i=0; i<static_cast<long>(resampled.size()); i++) {
+            if (aborted) {
+                continue;
+            }
+#else
+        for(size_t i=0; i<resampled.size(); i++) {
+#endif
+            // Resample the streamline.
+            resampled[i] = inputStreamlines[batchBegin + i].resample(input.resampleSize);
+            lineBarycenters[i] = calculateBarycenter(resampled[i]);
+
+            // Collect all bundles closer than the threshold.
+            if(bundling) {
+                grid.forEachCandidate(lineBarycenters[i], [&] (size_t k) {
+                    float distance = calculateMDF(bundles[k].getCentroid(), resampled[i]);
+                    if(distance < input.distanceThreshold) {
+                        candidates[i].push_back(std::make_pair(distance, k));
+                    }
+                });
+            }
 
-    size_t numStreamlines = streamlines->getStreamlines().size();
-    for(size_t i = 0; i < numStreamlines; i++) {
+            if (progress.reportStepDone()) {
+#ifdef VRN_MODULE_OPENMP
+                #pragma omp critical
+                aborted = true;
+#else
+                aborted = true;
+                break;
+#endif
+            }
+        }
 
-        // Resample the streamline.
-        Streamline t = streamlines->getStreamlines()[i].resample(input.resampleSize);
+        if (aborted) {
+            throw boost::thread_interrupted();
+        }
 
-        // Look for the bundle the streamlines fits best in.
-        float m = std::numeric_limits<float>::max();
-        size_t l = 0;
-        for(size_t k = 0; k < bundles.size(); k++) {
+        std::vector<size_t> modifiedBundles;
+        for(size_t i = 0; i < resampled.size(); i++) {
+            Streamline& t = resampled[i];
+
+            // Look for the bundle the streamlines fits best in.
+            // Distances to bundles that have been modified in this batch are outdated and need to be recalculated.
+            std::pair<float, size_t> best(std::numeric_limits<float>::max(), 0);
+            for(const std::pair<float, size_t>& candidate : candidates[i]) {
+                if(!modified[candidate.second]) {
+                    best = std::min(best, candidate);
+                }
+            }
+            if(bundling) {
+                grid.forEachCandidate(lineBarycenters[i], [&] (size_t k) {
+                    if(modified[k]) {
+                        best = std::min(best, std::make_pair(calculateMDF(bundles[k].getCentroid(), t), k));
+                    }
+                });
+            }
 
-            Streamline centroid = bundles[k].getCentroid();
-            float distance = calculateMDF(centroid, t);
+            size_t l = best.second;
+            if(best.first < input.distanceThreshold) {
+                bundles[l].addStreamline(std::move(t));
 
-            if(distance < m) {
-                m = distance;
-                l = k;
+                tgt::dvec3 barycenter = calculateBarycenter(bundles[l].getCentroid());
+                grid.move(l, barycenters[l], barycenter);
+                barycenters[l] = barycenter;
+            }
+            else {
+                l = bundles.size();
+                bundles.emplace_back(StreamlineBundle(std::move(t)));
+                barycenters.push_back(lineBarycenters[i]);
+                modified.push_back(false);
+                if(bundling) {
+                    grid.insert(l, barycenters[l]);
+                }
             }
-        }
 
-        if(m < input.distanceThreshold)
-            bundles[l].addStreamline(std::move(t));
-        else
-            bundles.emplace_back(StreamlineBundle(std::move(t)));
+            if(!modified[l]) {
+                modified[l] = true;
+                modifiedBundles.push_back(l);
+            }
+        }
 
-        progressReporter.setProgress(1.0f * i / numStreamlines);
+        for(size_t k : modifiedBundles) {
+            modified[k] = false;
+        }
     }
 
     // Step 2: Mark all Streamlines not being absorbed as noise.
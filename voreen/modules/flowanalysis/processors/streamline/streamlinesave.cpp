@@ -25,17 +25,39 @@
 
 #include "streamlinesave.h"
 
+#include "../../datastructures/streamlinelist.h"
+
 #include "voreen/core/voreenapplication.h"
 #include "modules/core/io/vvdformat.h"
 
 #include "tgt/filesystem.h"
 
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+#include <cstdio>
 #include <fstream>
+#include <sstream>
 
 namespace voreen {
 
 const std::string StreamlineSave::loggerCat_("flowanalysis.StreamlineSave");
 
+// Moves the written temporary file into place without truncating the existing file first.
+// A StreamlineList that has mapped the existing (binary) file keeps reading its original content.
+static void replaceWithTemporaryFile(const std::string& tmpfilename, const std::string& filename) {
+#ifdef WIN32
+    bool success = (MoveFileEx(tmpfilename.c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_COPY_ALLOWED) != 0);
+#else
+    bool success = (std::rename(tmpfilename.c_str(), filename.c_str()) == 0);
+#endif
+    if(!success) {
+        FileSys.deleteFile(tmpfilename);
+        throw tgt::FileAccessException("Could not replace file", filename);
+    }
+}
+
 StreamlineSave::StreamlineSave()
     : Processor()
     // ports
@@ -46,6 +68,7 @@ StreamlineSave::StreamlineSave()
             "Voreen streamline data (*.vsd);;Character-separated values (*.csv)", FileDialogProperty::SAVE_FILE, Processor::INVALID_PATH)
     , saveButton_("saveButton", "Save")
     , saveVolumeInVsd_("saveVolumeInVsd","Save Volume in VSD?",true,Processor::INVALID_RESULT,Property::LOD_ADVANCED)
+    , vsdEncodingProp_("vsdEncoding", "VSD Encoding", Processor::INVALID_RESULT, false, Property::LOD_ADVANCED)
     // members
     , saveStreamlines_(false)
 {
@@ -57,6 +80,9 @@ StreamlineSave::StreamlineSave()
     addProperty(filenameProp_);
     addProperty(saveButton_);
     addProperty(saveVolumeInVsd_);
+    addProperty(vsdEncodingProp_);
+        vsdEncodingProp_.addOption("xml", "XML", VSD_XML);
+        vsdEncodingProp_.addOption("binary", "Binary (memory-mapped)", VSD_BINARY);
 }
 
 StreamlineSave::~StreamlineSave() {
@@ -106,23 +132,37 @@ void StreamlineSave::saveStreamlines() {
         LWARNING("Selected file extension is neither *.csv nor *.vsd");
         return;
     }
-    // write file
+    // write file to a temporary file first, which is moved into place afterwards
+    const std::string tmpfilename = filenameProp_.get() + ".tmp";
     try {
-        std::ofstream outFile;
-        outFile.open(filenameProp_.get().c_str());
         LINFO("Writing streamlines to file " << filenameProp_.get());
 
         if(!extension.compare("csv")) {
+            std::ofstream outFile;
+            outFile.open(tmpfilename.c_str());
             //write meta
             outFile << streamlineInport_.getData()->metaToCSVString().c_str() << "\n";
             //write streamlines
             for(size_t i = 0; i < streamlineInport_.getData()->getStreamlines().size(); i++) {
                 outFile << streamlineInport_.getData()->getStreamlines().at(i).toCSVString(tgt::mat4::identity,streamlineInport_.getData()->getVelocityTransformMatrix()).c_str() << "\n";
             }
+            outFile.close();
         } else { // case vsd
+            bool binary = vsdEncodingProp_.getValue() == VSD_BINARY;
+
+            // The binary format only stores the meta data in its xml header.
+            StreamlineList meta;
+            if(binary) {
+                meta.copyMeta(*streamlineInport_.getData());
+            }
+
             XmlSerializer s;
             Serializer serializer(s);
-            serializer.serialize("VSD-File", streamlineInport_.getData());
+            if(binary) {
+                serializer.serialize("VSD-File", static_cast<const StreamlineListBase*>(&meta));
+            } else {
+                serializer.serialize("VSD-File", streamlineInport_.getData());
+            }
             bool saveVolume = false;
             //save volume if present
             if(saveVolumeInVsd_.get()) {
@@ -132,21 +172,31 @@ void StreamlineSave::saveStreamlines() {
                     saveVolume = true;
                 }
             }
+            std::vector<VvdObject> vec;
             if(saveVolume) {
                 VvdObject vvd(volumeInport_.getData(),"",false);
-                std::vector<VvdObject> vec;
                 vec.push_back(vvd);
                 serializer.serialize("Magnitude-Volumes", vec, "Volume");
-                s.write(outFile); // vvd must present during write. null pointer otherwise
+            }
+            // vvd must present during write. null pointer otherwise
+            if(binary) {
+                std::stringstream header;
+                s.write(header);
+                StreamlineList::writeBinaryVSD(tmpfilename, header.str(), *streamlineInport_.getData());
             } else {
+                std::ofstream outFile;
+                outFile.open(tmpfilename.c_str());
                 s.write(outFile);
+                outFile.close();
             }
         }
-
-        outFile.close();
+        replaceWithTemporaryFile(tmpfilename, filenameProp_.get());
     }
     catch(tgt::FileException& e) {
         LERROR(e.what());
+        if(FileSys.fileExists(tmpfilename)) {
+            FileSys.deleteFile(tmpfilename);
+        }
         filenameProp_.set("");
     }
     LINFO("Saving " << filenameProp_.get() << " was successful.");
@@ -31,6 +31,7 @@
 #include "voreen/core/properties/filedialogproperty.h"
 #include "voreen/core/properties/buttonproperty.h"
 #include "voreen/core/properties/boolproperty.h"
+#include "voreen/core/properties/optionproperty.h"
 
 #include "../../ports/streamlinelistport.h"
 #include "voreen/core/ports/volumeport.h"
@@ -67,10 +68,14 @@ protected:
                        "Where each streamline is stored as:<br>position1, velocity1, ... positionX, velocityX<br><br>" \
                        "and each bundle is stored as:<br>radius, position1, velocity1, ... positionX, velocityX<br><br>" \
                        "The VSD format can be loaded into Voreen by the StreamlineSource. If the volume port is connected, the " \
-                       "volume will be stored in the vsd file for later usage.");
+                       "volume will be stored in the vsd file for later usage.<br><br>" \
+                       "VSD files are either written as XML or in a binary format, which stores the meta data (and volume) as XML header " \
+                       "followed by the packed streamline elements. Binary files are much smaller and are memory-mapped when loaded, " \
+                       "so that even large streamline lists are available immediately.");
         streamlineInport_.setDescription("Port containing the streamline data to be saved.");
         volumeInport_.setDescription("If a volume is connected and the save volume property is enabled,the volume will be stored in the vsd file. "\
                                      "For a csv file, this port has no functionality. Normally this file corresponds the the magnitude image used as reference.");
+        vsdEncodingProp_.setDescription("Determines whether VSD files are written as XML or in the binary, memory-mappable format.");
     }
 
     //--------------------------
@@ -89,6 +94,12 @@ protected:
         SF_VSD
     };
 
+    /** Encodings of VSD files */
+    enum VSDEncoding {
+        VSD_XML,
+        VSD_BINARY
+    };
+
     //--------------
     //  Callbacks
     //--------------
@@ -105,6 +116,7 @@ private:
     FileDialogProperty filenameProp_;               ///< determines the name of the saved file
     ButtonProperty saveButton_;                     ///< triggers a save
     BoolProperty saveVolumeInVsd_;                  ///< if true, a connected volume is stored inside the vsd file
+    OptionProperty<VSDEncoding> vsdEncodingProp_;   ///< determines, if vsd files are written as xml or binary
 
     bool saveStreamlines_;          ///< used to determine, if process should save or not
 
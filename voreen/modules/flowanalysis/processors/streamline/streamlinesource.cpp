@@ -33,6 +33,7 @@
 #include "tgt/filesystem.h"
 
 #include <fstream>
+#include <sstream>
 
 namespace voreen {
 
@@ -233,14 +234,24 @@ std::pair<StreamlineList*,Volume*> StreamlineSource::loadVSDFile(const std::stri
         Volume* volume = 0;
         std::vector<VvdObject> vec; ///< used for deserialization
     try {
+        // Binary files hold the xml document as header, followed by the streamlines.
+        bool binary = StreamlineList::isBinaryVSD(absPath);
         std::ifstream inFile;
-        inFile.open(absPath.c_str());
+        std::stringstream header;
+        if(binary) {
+            header.str(StreamlineList::readBinaryVSDHeader(absPath));
+        } else {
+            inFile.open(absPath.c_str());
+        }
         LINFO("Reading streamlines from file " << absPath);
 
         XmlDeserializer d;
-        d.read(inFile);
+        d.read(binary ? static_cast<std::istream&>(header) : inFile);
         Deserializer deserializer(d);
         deserializer.deserialize("VSD-File", *list);
+        if(binary) {
+            list->mapBinaryVSD(absPath);
+        }
 
         //optional deserialize not imlpemented for std::vector :-(
         try {
@@ -257,6 +268,11 @@ std::pair<StreamlineList*,Volume*> StreamlineSource::loadVSDFile(const std::stri
         delete list;
         list = 0;
     }
+    catch(tgt::FileException& e) {
+        LERROR(e.what());
+        delete list;
+        list = 0;
+    }
     return std::make_pair(list,volume);
 }
 
@@ -34,9 +34,23 @@ SpatialSampler::SpatialSampler(const VolumeRAM* volume,
                                const tgt::mat4& velocityTransformationMatrix)
     : toVoxelMatrix_(toVoxelMatrix)
     , toVoxelMatrixSet_(toVoxelMatrix_ != tgt::mat4::identity)
+    , toVoxelMatrixAffine_(toVoxelMatrix_[3] == tgt::vec4(0.0f, 0.0f, 0.0f, 1.0f))
     , velocityTransformationMatrix_(velocityTransformationMatrix)
     , velocityTransformationMatrixSet_(velocityTransformationMatrix != tgt::mat4::identity)
+    , velocityTransformationMatrixAffine_(velocityTransformationMatrix_[3] == tgt::vec4(0.0f, 0.0f, 0.0f, 1.0f))
+    , data_(nullptr)
+    , dimensions_(volume->getDimensions())
+    , filter_(filter)
+    , rwmScale_(rwm.getScale())
+    , rwmOffset_(rwm.getOffset())
 {
+    // Sample 3xFloat volumes directly.
+    const VolumeRAM_3xFloat* vec3Volume = dynamic_cast<const VolumeRAM_3xFloat*>(volume);
+    if(vec3Volume && (filter == VolumeRAM::NEAREST || filter == VolumeRAM::LINEAR)) {
+        data_ = vec3Volume->voxel();
+        return;
+    }
+
     switch(filter) {
     case VolumeRAM::NEAREST:
         sampleFunction_ = [volume, rwm] (const tgt::vec3& pos) {
@@ -70,21 +84,6 @@ SpatialSampler::SpatialSampler(const VolumeRAM* volume,
     }
 }
 
-tgt::vec3 SpatialSampler::sample(tgt::vec3 pos) const {
-    if(toVoxelMatrixSet_) {
-        pos = toVoxelMatrix_ * pos;
-    }
-
-    auto velocity = sampleFunction_(pos);
-
-    if(velocityTransformationMatrixSet_) {
-        velocity = velocityTransformationMatrix_ * velocity;
-    }
-
-    return velocity;
-}
-
-
 SpatioTemporalSampler::SpatioTemporalSampler(const VolumeRAM* volume0,
                                              const VolumeRAM* volume1,
                                              float alpha,
@@ -99,13 +98,6 @@ SpatioTemporalSampler::SpatioTemporalSampler(const VolumeRAM* volume0,
     tgtAssert(alpha_ >= 0.0f && alpha_ <= 1.0f, "Alpha must be in range [0, 1]");
 }
 
-tgt::vec3 SpatioTemporalSampler::sample(tgt::vec3 pos) const {
-    tgt::vec3 voxel0 = filter0_.sample(pos);
-    tgt::vec3 voxel1 = filter1_.sample(pos);
-    return voxel0 * (1.0f - alpha_) + voxel1 * alpha_;
-}
-
-
 tgt::mat4 createTransformationMatrix(const tgt::vec3& position, const tgt::vec3& velocity) {
 
     tgt::vec3 tangent(tgt::normalize(velocity));
@@ -27,6 +27,7 @@
 #define VRN_FLOWUTILS_H
 
 #include "voreen/core/datastructures/volume/volumeram.h"
+#include "voreen/core/datastructures/volume/volumeatomic.h"
 
 namespace voreen {
 
@@ -37,7 +38,15 @@ public:
     virtual tgt::vec3 sample(tgt::vec3 pos) const = 0;
 };
 
-class SpatialSampler : public VelocitySampler {
+/**
+ * Samples the velocity of a flow volume at positions in world space.
+ *
+ * Volumes of type VolumeRAM_3xFloat (the common case for flow fields) are sampled directly from
+ * their voxel data, interpolating all three channels at once. Other volume types as well as cubic
+ * filtering fall back to the generic, per-channel VolumeRAM interface.
+ * The class is final, so that sample calls on a SpatialSampler do not need to be dispatched virtually.
+ */
+class SpatialSampler final : public VelocitySampler {
 public:
     SpatialSampler(const VolumeRAM* volume,
                    const RealWorldMapping& rwm,
@@ -49,17 +58,33 @@ public:
      * Samples the given volume at the given specified position.
      * @param pos Position in world space.
      */
-    tgt::vec3 sample(tgt::vec3 pos) const;
+    inline tgt::vec3 sample(tgt::vec3 pos) const override;
 
 private:
+    /// Samples the data of a VolumeRAM_3xFloat using the specified filter (NEAREST or LINEAR).
+    template<VolumeRAM::Filter filter>
+    inline tgt::vec3 sampleVec3(const tgt::vec3& pos) const;
+
+    /// Same as matrix * v, but skips the homogeneous division for affine matrices.
+    static inline tgt::vec3 transform(const tgt::mat4& matrix, bool affine, const tgt::vec3& v);
+
     const tgt::mat4 toVoxelMatrix_;
     const bool toVoxelMatrixSet_;
+    const bool toVoxelMatrixAffine_;
     const tgt::mat4 velocityTransformationMatrix_;
     const bool velocityTransformationMatrixSet_;
+    const bool velocityTransformationMatrixAffine_;
     std::function<tgt::vec3(tgt::vec3)> sampleFunction_;
+
+    // Direct access to VolumeRAM_3xFloat volumes, data_ is null otherwise.
+    const tgt::vec3* data_;
+    const tgt::svec3 dimensions_;
+    const VolumeRAM::Filter filter_;
+    const float rwmScale_;
+    const float rwmOffset_;
 };
 
-class SpatioTemporalSampler : public VelocitySampler {
+class SpatioTemporalSampler final : public VelocitySampler {
 public:
 
     /**
@@ -82,7 +107,7 @@ public:
      * Samples the given volume at the given specified position.
      * @param pos Position in world space.
      */
-    tgt::vec3 sample(tgt::vec3 pos) const;
+    inline tgt::vec3 sample(tgt::vec3 pos) const override;
 
 private:
     const SpatialSampler filter0_;
@@ -92,6 +117,74 @@ private:
 
 tgt::mat4 createTransformationMatrix(const tgt::vec3& position, const tgt::vec3& velocity);
 
+//---------------------------------------------------------------------------
+// Inline implementations
+
+template<>
+inline tgt::vec3 SpatialSampler::sampleVec3<VolumeRAM::NEAREST>(const tgt::vec3& pos) const {
+    tgt::svec3 voxel = tgt::min(tgt::svec3(tgt::max(pos, tgt::vec3::zero)), dimensions_ - tgt::svec3::one);
+    return data_[(voxel.z * dimensions_.y + voxel.y) * dimensions_.x + voxel.x];
+}
+
+template<>
+inline tgt::vec3 SpatialSampler::sampleVec3<VolumeRAM::LINEAR>(const tgt::vec3& pos) const {
+    // Same sampling scheme as VolumeRAM::getVoxelNormalizedLinear.
+    tgt::vec3 posAbs = tgt::max(pos, tgt::vec3::zero);
+    tgt::vec3 p = posAbs - tgt::floor(posAbs);
+    tgt::svec3 llb = tgt::min(tgt::svec3(posAbs), dimensions_ - tgt::svec3::one);
+    tgt::svec3 urf = tgt::min(tgt::svec3(tgt::ceil(posAbs)), dimensions_ - tgt::svec3::one);
+
+    const size_t sliceSize = dimensions_.x * dimensions_.y;
+    const tgt::vec3* llbSlice = data_ + llb.z * sliceSize;
+    const tgt::vec3* urfSlice = data_ + urf.z * sliceSize;
+    const size_t llbRow = llb.y * dimensions_.x;
+    const size_t urfRow = urf.y * dimensions_.x;
+
+    tgt::vec3 back  = (llbSlice[llbRow + llb.x] * (1.f - p.x) + llbSlice[llbRow + urf.x] * p.x) * (1.f - p.y)
+                    + (llbSlice[urfRow + llb.x] * (1.f - p.x) + llbSlice[urfRow + urf.x] * p.x) * p.y;
+    tgt::vec3 front = (urfSlice[llbRow + llb.x] * (1.f - p.x) + urfSlice[llbRow + urf.x] * p.x) * (1.f - p.y)
+                    + (urfSlice[urfRow + llb.x] * (1.f - p.x) + urfSlice[urfRow + urf.x] * p.x) * p.y;
+    return back * (1.f - p.z) + front * p.z;
+}
+
+tgt::vec3 SpatialSampler::transform(const tgt::mat4& matrix, bool affine, const tgt::vec3& v) {
+    if(!affine) {
+        return matrix * v;
+    }
+    return tgt::vec3(tgt::dot(matrix[0].xyz(), v) + matrix[0].w,
+                     tgt::dot(matrix[1].xyz(), v) + matrix[1].w,
+                     tgt::dot(matrix[2].xyz(), v) + matrix[2].w);
+}
+
+tgt::vec3 SpatialSampler::sample(tgt::vec3 pos) const {
+    if(toVoxelMatrixSet_) {
+        pos = transform(toVoxelMatrix_, toVoxelMatrixAffine_, pos);
+    }
+
+    tgt::vec3 velocity;
+    if(data_ && filter_ == VolumeRAM::LINEAR) {
+        velocity = sampleVec3<VolumeRAM::LINEAR>(pos) * rwmScale_ + tgt::vec3(rwmOffset_);
+    }
+    else if(data_) {
+        velocity = sampleVec3<VolumeRAM::NEAREST>(pos) * rwmScale_ + tgt::vec3(rwmOffset_);
+    }
+    else {
+        velocity = sampleFunction_(pos);
+    }
+
+    if(velocityTransformationMatrixSet_) {
+        velocity = transform(velocityTransformationMatrix_, velocityTransformationMatrixAffine_, velocity);
+    }
+
+    return velocity;
+}
+
+tgt::vec3 SpatioTemporalSampler::sample(tgt::vec3 pos) const {
+    tgt::vec3 voxel0 = filter0_.sample(pos);
+    tgt::vec3 voxel1 = filter1_.sample(pos);
+    return voxel0 * (1.0f - alpha_) + voxel1 * alpha_;
+}
+
 }
 
 
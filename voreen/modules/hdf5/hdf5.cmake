@@ -103,6 +103,15 @@ ELSEIF(UNIX)
     ELSE()
         MESSAGE(FATAL_ERROR "HDF5 library could not be found")
     ENDIF()
+
+    # Optional: zlib for decompressing deflate-compressed chunks in parallel outside of the HDF5 library
+    FIND_PACKAGE(ZLIB)
+    IF(ZLIB_FOUND)
+        MESSAGE(STATUS "Found ZLIB: enabling parallel chunk decompression")
+        LIST(APPEND MOD_INCLUDE_DIRECTORIES ${ZLIB_INCLUDE_DIRS})
+        LIST(APPEND MOD_LIBRARIES ${ZLIB_LIBRARIES})
+        LIST(APPEND MOD_DEFINITIONS "-DVRN_HDF5_WITH_ZLIB")
+    ENDIF()
 ENDIF()
 
 
@@ -34,8 +34,99 @@
 
 #include <boost/thread.hpp>
 
+#include <atomic>
+#include <list>
+#include <unordered_map>
+
+// Direct chunk reads are available since HDF5 1.10.2. Decompression requires zlib.
+#if defined(VRN_HDF5_WITH_ZLIB) && H5_VERSION_GE(1, 10, 2)
+#define VRN_HDF5_DIRECT_CHUNK_READ
+#include <zlib.h>
+#endif
+
+#ifdef VRN_MODULE_OPENMP
+#include "omp.h"
+#endif
+
 namespace voreen {
 
+/**
+ * Chunk layout of a dataSet (read on first use, guarded by hdf5libMutex) and an LRU cache
+ * of its decompressed chunks keyed by the linear chunk index (guarded by mutex_).
+ * Each clear() starts a new generation: chunks read from the file before cannot be inserted afterwards.
+ * All coordinates are given in HDF5 order (zyx, followed by the channel for 4D datasets).
+ */
+struct HDF5ChunkCache {
+    typedef std::shared_ptr<const std::vector<char>> Chunk;
+
+    HDF5ChunkCache()
+        : layoutRead_(false)
+        , supported_(false)
+        , rank_(0)
+        , elementSize_(0)
+        , cacheSize_(0)
+        , generation_(0)
+    {
+    }
+
+    uint64_t getGeneration() {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        return generation_;
+    }
+
+    Chunk get(uint64_t key) {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        auto entry = entries_.find(key);
+        if(entry == entries_.end()) {
+            return nullptr;
+        }
+        lru_.splice(lru_.begin(), lru_, entry->second);
+        return entry->second->second;
+    }
+
+    /// Inserts the chunk, unless the cache has been cleared since the passed generation (i.e., the chunk may be stale).
+    void put(uint64_t key, Chunk chunk, uint64_t generation) {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        if(generation != generation_ || entries_.count(key)) {
+            return;
+        }
+        lru_.push_front(std::make_pair(key, chunk));
+        entries_[key] = lru_.begin();
+        cacheSize_ += chunk->size();
+        while(cacheSize_ > MAX_CACHE_SIZE && lru_.size() > 1) {
+            cacheSize_ -= lru_.back().second->size();
+            entries_.erase(lru_.back().first);
+            lru_.pop_back();
+        }
+    }
+
+    void clear() {
+        boost::lock_guard<boost::mutex> lock(mutex_);
+        entries_.clear();
+        lru_.clear();
+        cacheSize_ = 0;
+        generation_++;
+    }
+
+    static const size_t MAX_CACHE_SIZE; ///< in bytes
+
+    bool layoutRead_;
+    bool supported_;
+    int rank_;
+    hsize_t datasetDims_[4];
+    hsize_t chunkDims_[4];
+    size_t elementSize_;
+    std::vector<H5Z_filter_t> filters_; ///< in the order they are applied when writing
+
+    boost::mutex mutex_;
+    std::list<std::pair<uint64_t, Chunk>> lru_; ///< most recently used first
+    std::unordered_map<uint64_t, std::list<std::pair<uint64_t, Chunk>>::iterator> entries_;
+    size_t cacheSize_;
+    uint64_t generation_;
+};
+
+const size_t HDF5ChunkCache::MAX_CACHE_SIZE = 64 << 20;
+
 const std::string HDF5FileVolume::loggerCat_("voreen.hdf5.HDF5FileVolume");
 
 const std::string HDF5FileVolume::SPACING_ATTRIBUTE_NAME("element_size_um");
@@ -825,15 +916,20 @@ void HDF5FileVolume::writeSlices(const VolumeRAM* vol, size_t firstSlice, size_t
 }
 
 VolumeRAM* HDF5FileVolume::loadBrick(const tgt::svec3& offset, const tgt::svec3& dimensions, size_t firstChannel, size_t numberOfChannels) const {
-    // HDF5-cxx-libs are NOT threadsafe!
-    boost::lock_guard<boost::recursive_mutex> lock(hdf5libMutex);
-
     tgtAssert(dimensions.x + offset.x <= dimensions_.x, "Brick does not fit into file volume with the given offset in x dimension.");
     tgtAssert(dimensions.y + offset.y <= dimensions_.y, "Brick does not fit into file volume with the given offset in y dimension.");
     tgtAssert(dimensions.z + offset.z <= dimensions_.z, "Brick does not fit into file volume with the given offset in z dimension.");
 
     tgtAssert(firstChannel + numberOfChannels <= getNumberOfChannels(), "Invalid channel range.");
 
+    // Compressed chunks are preferably decompressed in parallel outside of hdf5libMutex.
+    if(VolumeRAM* data = tryLoadBrickFromChunks(offset, dimensions, firstChannel, numberOfChannels)) {
+        return data;
+    }
+
+    // HDF5-cxx-libs are NOT threadsafe!
+    boost::lock_guard<boost::recursive_mutex> lock(hdf5libMutex);
+
     try {
         //Select the hyperslab (Brick + fourth dimension)
 
@@ -901,6 +997,9 @@ void HDF5FileVolume::writeBrick(const VolumeRAM* vol, const tgt::svec3& offset,
         //Write the volume to disk.
         dataSet_->write(vol->getData(), dataSet_->getDataType(), memSpace, fileSpace);
 
+        // Cached chunks may be outdated now.
+        chunkCache_->clear();
+
     } catch(H5::Exception& error) { // catch HDF5 exceptions
         LERROR(error.getFuncName() + ": " + error.getDetailMsg());
         throw tgt::IOException("An Error occured while writing volume to file " + getFileName());
@@ -912,6 +1011,7 @@ HDF5FileVolume::HDF5FileVolume(std::unique_ptr<H5::H5File> file, std::unique_ptr
     , dataSet_(std::move(dataSet))
     , fileName_(fileName)
     , volumeLocation_(volumeLocation)
+    , chunkCache_(new HDF5ChunkCache())
 {
     dimensions_ = this->readDimensions();
 }
@@ -931,6 +1031,251 @@ tgt::svec3 HDF5FileVolume::readDimensions() const {
     return vec3HDF5ToTgt(dim);
 }
 
+#ifdef VRN_HDF5_DIRECT_CHUNK_READ
+
+/**
+ * Reads the chunk layout of the dataSet and checks whether its chunks can be decoded without the library.
+ * @note hdf5libMutex has to be locked by the caller.
+ */
+static bool readChunkLayout(const H5::DataSet& dataSet, HDF5ChunkCache& layout) {
+    try {
+        H5::DSetCreatPropList propList = dataSet.getCreatePlist();
+        if(propList.getLayout() != H5D_CHUNKED) {
+            return false;
+        }
+
+        H5::DataSpace dataSpace = dataSet.getSpace();
+        layout.rank_ = dataSpace.getSimpleExtentNdims();
+        if(layout.rank_ != 3 && layout.rank_ != 4) {
+            return false;
+        }
+        dataSpace.getSimpleExtentDims(layout.datasetDims_);
+        propList.getChunk(layout.rank_, layout.chunkDims_);
+
+        // Unallocated chunks can only be reproduced for the default fill value (zero).
+        H5D_fill_value_t fillValueStatus;
+        if(H5Pfill_value_defined(propList.getId(), &fillValueStatus) < 0 || fillValueStatus == H5D_FILL_VALUE_USER_DEFINED) {
+            return false;
+        }
+
+        layout.filters_.clear();
+        for(int i = 0; i < propList.getNfilters(); i++) {
+            unsigned int flags = 0;
+            size_t numClientValues = 0;
+            unsigned int filterConfig = 0;
+            H5Z_filter_t filter = H5Pget_filter2(propList.getId(), i, &flags, &numClientValues, nullptr, 0, nullptr, &filterConfig);
+            if(filter != H5Z_FILTER_DEFLATE && filter != H5Z_FILTER_SHUFFLE) {
+                return false;
+            }
+            layout.filters_.push_back(filter);
+        }
+
+        // The raw chunks are not converted, so they have to be stored in the native type.
+        H5::DataType type = dataSet.getDataType();
+        if(!(type == getPredType(getBaseTypeFromDataType(type)))) {
+            return false;
+        }
+        layout.elementSize_ = type.getSize();
+    } catch(H5::Exception&) {
+        return false;
+    } catch(tgt::Exception&) {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Reverts the filters applied to a raw chunk. Filters whose bit is set in filterMask have been skipped when writing.
+ */
+static bool decodeChunk(std::vector<char>& data, unsigned int filterMask, const HDF5ChunkCache& layout) {
+    size_t chunkBytes = layout.elementSize_;
+    for(int d = 0; d < layout.rank_; d++) {
+        chunkBytes *= layout.chunkDims_[d];
+    }
+
+    for(int i = static_cast<int>(layout.filters_.size()) - 1; i >= 0; i--) {
+        if(filterMask & (1u << i)) {
+            continue;
+        }
+        if(layout.filters_[i] == H5Z_FILTER_DEFLATE) {
+            std::vector<char> inflated(chunkBytes);
+            uLongf inflatedSize = static_cast<uLongf>(chunkBytes);
+            if(uncompress(reinterpret_cast<Bytef*>(inflated.data()), &inflatedSize, reinterpret_cast<const Bytef*>(data.data()), static_cast<uLong>(data.size())) != Z_OK
+                    || inflatedSize != chunkBytes) {
+                return false;
+            }
+            data.swap(inflated);
+        }
+        else if(layout.filters_[i] == H5Z_FILTER_SHUFFLE && layout.elementSize_ > 1) {
+            // The shuffle filter stores byte b of all elements consecutively, trailing bytes are left in place.
+            const size_t numElements = data.size() / layout.elementSize_;
+            std::vector<char> unshuffled(data.size());
+            for(size_t b = 0; b < layout.elementSize_; b++) {
+                const char* src = data.data() + b*numElements;
+                for(size_t e = 0; e < numElements; e++) {
+                    unshuffled[e*layout.elementSize_ + b] = src[e];
+                }
+            }
+            std::copy(data.begin() + numElements*layout.elementSize_, data.end(), unshuffled.begin() + numElements*layout.elementSize_);
+            data.swap(unshuffled);
+        }
+    }
+    return data.size() == chunkBytes;
+}
+
+#endif
+
+VolumeRAM* HDF5FileVolume::tryLoadBrickFromChunks(const tgt::svec3& offset, const tgt::svec3& dimensions, size_t firstChannel, size_t numberOfChannels) const {
+#ifndef VRN_HDF5_DIRECT_CHUNK_READ
+    return nullptr;
+#else
+    HDF5ChunkCache& layout = *chunkCache_;
+
+    // Brick in HDF5 order. 3D datasets are treated as having a channel dimension of extent 1.
+    hsize_t start[4];
+    vec4TgtToHDF5(tgt::svec4(firstChannel, offset), start);
+    hsize_t count[4];
+    vec4TgtToHDF5(tgt::svec4(numberOfChannels, dimensions), count);
+
+    struct ChunkRequest {
+        hsize_t offset[4];
+        uint64_t key;
+        HDF5ChunkCache::Chunk chunk; ///< decoded chunk, if cached
+        std::vector<char> raw;
+        unsigned int filterMask;
+        bool allocated;
+    };
+    std::vector<ChunkRequest> requests;
+    std::string format;
+    hsize_t chunkExtent[4];
+    hsize_t brickStart[4];
+    hsize_t brickCount[4];
+    uint64_t generation;
+
+    // Only reading the raw chunks requires the library lock.
+    {
+        boost::lock_guard<boost::recursive_mutex> lock(hdf5libMutex);
+        // writeBrick() clears the cache while holding the library lock => chunks read below belong to this generation
+        generation = layout.getGeneration();
+
+        if(!layout.layoutRead_) {
+            layout.supported_ = readChunkLayout(*dataSet_, layout);
+            layout.layoutRead_ = true;
+        }
+        if(!layout.supported_) {
+            return nullptr;
+        }
+        format = VolumeFactory().getFormat(getBaseTypeFromDataType(dataSet_->getDataType()), numberOfChannels);
+
+        hsize_t firstChunk[4], lastChunk[4], numChunks[4];
+        for(int d = 0; d < 4; d++) {
+            bool used = d < layout.rank_;
+            chunkExtent[d] = used ? layout.chunkDims_[d] : 1;
+            brickStart[d] = used ? start[d] : 0;
+            brickCount[d] = used ? count[d] : 1;
+            firstChunk[d] = brickStart[d] / chunkExtent[d];
+            lastChunk[d] = (brickStart[d] + brickCount[d] - 1) / chunkExtent[d];
+            numChunks[d] = used ? (layout.datasetDims_[d] + chunkExtent[d] - 1) / chunkExtent[d] : 1;
+        }
+
+        hsize_t c[4];
+        for(c[0] = firstChunk[0]; c[0] <= lastChunk[0]; c[0]++) {
+            for(c[1] = firstChunk[1]; c[1] <= lastChunk[1]; c[1]++) {
+                for(c[2] = firstChunk[2]; c[2] <= lastChunk[2]; c[2]++) {
+                    for(c[3] = firstChunk[3]; c[3] <= lastChunk[3]; c[3]++) {
+                        ChunkRequest request;
+                        for(int d = 0; d < 4; d++) {
+                            request.offset[d] = c[d] * chunkExtent[d];
+                        }
+                        request.key = ((c[0]*numChunks[1] + c[1])*numChunks[2] + c[2])*numChunks[3] + c[3];
+                        request.filterMask = 0;
+                        request.allocated = true;
+                        request.chunk = layout.get(request.key);
+                        if(!request.chunk) {
+                            hsize_t storageSize = 0;
+                            if(H5Dget_chunk_storage_size(dataSet_->getId(), request.offset, &storageSize) < 0) {
+                                return nullptr;
+                            }
+                            request.allocated = storageSize > 0;
+                            if(request.allocated) {
+                                request.raw.resize(storageSize);
+                                uint32_t filterMask = 0;
+                                if(H5Dread_chunk(dataSet_->getId(), H5P_DEFAULT, request.offset, &filterMask, request.raw.data()) < 0) {
+                                    return nullptr;
+                                }
+                                request.filterMask = filterMask;
+                            }
+                        }
+                        requests.push_back(std::move(request));
+                    }
+                }
+            }
+        }
+    }
+
+    std::unique_ptr<VolumeRAM> data(VolumeFactory().create(format, dimensions));
+    if(!data) {
+        throw tgt::IOException("Could not create VolumeRAM of format " + format);
+    }
+    char* target = static_cast<char*>(data->getData());
+    const size_t elementSize = layout.elementSize_;
+    const size_t chunkBytes = elementSize * chunkExtent[0] * chunkExtent[1] * chunkExtent[2] * chunkExtent[3];
+
+    std::atomic<bool> failed(false);
+    const int numRequests = static_cast<int>(requests.size());
+#ifdef VRN_MODULE_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for(int i = 0; i < numRequests; i++) {
+        ChunkRequest& request = requests[i];
+        if(!request.chunk) {
+            std::shared_ptr<std::vector<char>> decoded(new std::vector<char>());
+            if(request.allocated) {
+                decoded->swap(request.raw);
+                if(!decodeChunk(*decoded, request.filterMask, layout)) {
+                    failed = true;
+                    continue;
+                }
+            } else {
+                decoded->assign(chunkBytes, 0);
+            }
+            request.chunk = decoded;
+            layout.put(request.key, request.chunk, generation);
+        }
+
+        // Copy the intersection of chunk and brick. Runs along x (and channel) are contiguous in both.
+        hsize_t lo[4], hi[4];
+        for(int d = 0; d < 4; d++) {
+            lo[d] = std::max(request.offset[d], brickStart[d]);
+            hi[d] = std::min(request.offset[d] + chunkExtent[d], brickStart[d] + brickCount[d]);
+        }
+        const size_t numRunChannels = hi[3] - lo[3];
+        const bool contiguousX = numRunChannels == chunkExtent[3] && numRunChannels == brickCount[3];
+        for(hsize_t z = lo[0]; z < hi[0]; z++) {
+            for(hsize_t y = lo[1]; y < hi[1]; y++) {
+                const char* src = request.chunk->data() + ((((z - request.offset[0])*chunkExtent[1] + (y - request.offset[1]))*chunkExtent[2]
+                        + (lo[2] - request.offset[2]))*chunkExtent[3] + (lo[3] - request.offset[3]))*elementSize;
+                char* dst = target + ((((z - brickStart[0])*brickCount[1] + (y - brickStart[1]))*brickCount[2]
+                        + (lo[2] - brickStart[2]))*brickCount[3] + (lo[3] - brickStart[3]))*elementSize;
+                if(contiguousX) {
+                    std::memcpy(dst, src, (hi[2] - lo[2])*numRunChannels*elementSize);
+                } else {
+                    for(hsize_t x = 0; x < hi[2] - lo[2]; x++) {
+                        std::memcpy(dst + x*brickCount[3]*elementSize, src + x*chunkExtent[3]*elementSize, numRunChannels*elementSize);
+                    }
+                }
+            }
+        }
+    }
+
+    if(failed) {
+        LWARNING("Could not decode chunks of " << getFileName() << ", falling back to regular read");
+        return nullptr;
+    }
+    return data.release();
+#endif
+}
+
 size_t HDF5FileVolume::getNumberOfChannels() const {
     boost::lock_guard<boost::recursive_mutex> lock(hdf5libMutex);
 
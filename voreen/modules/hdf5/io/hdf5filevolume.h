@@ -35,6 +35,8 @@
 
 namespace voreen {
 
+struct HDF5ChunkCache;
+
 /**
  * Represents a volume inside a HDF5 file.
  *
@@ -431,6 +433,15 @@ private:
      */
     tgt::svec3 readDimensions() const;
 
+    /**
+     * Loads a brick by reading the raw chunks intersecting it while holding hdf5libMutex and
+     * decompressing them in parallel outside of the lock. Decompressed chunks are cached.
+     * @return the brick or null if the layout or the filters of the dataSet are not supported,
+     *          in which case the regular read path has to be used.
+     * @note Locks hdf5libMutex only for reading the raw chunks.
+     */
+    VolumeRAM* tryLoadBrickFromChunks(const tgt::svec3& offset, const tgt::svec3& dimensions, size_t firstChannel, size_t numberOfChannels) const;
+
     /// The HDF5-library file object
     std::unique_ptr<H5::H5File> file_;
     /// The HDF5-library DataSet object. Contains the volume.
@@ -441,6 +452,8 @@ private:
     std::string volumeLocation_;
     /// Dimensions are cashed in ram for faster access:
     tgt::svec3 dimensions_;
+    /// Chunk layout and decompressed chunks for tryLoadBrickFromChunks.
+    std::unique_ptr<HDF5ChunkCache> chunkCache_;
 
     static const std::string SPACING_ATTRIBUTE_NAME;
     static const std::string OFFSET_ATTRIBUTE_NAME;
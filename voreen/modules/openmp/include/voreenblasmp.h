@@ -33,6 +33,9 @@ namespace voreen {
 
 /**
  * OpenMP implementation of the Basic Linear Algebra Subprograms (BLAS).
+ *
+ * The vectors are split into cache-sized blocks, which are processed by
+ * the SIMD kernels of VoreenBlasKernels in parallel.
  */
 class VRN_CORE_API VoreenBlasMP : public VoreenBlas {
 
@@ -56,6 +59,10 @@ public:
         float* initial = 0, float threshold = 1e-4f, int maxIterations = 1000) const;
 
 private:
+    template<typename T>
+    int conjGradEll(const EllpackMatrix<T>& mat, const float* vec, float* result,
+        float* initial, ConjGradPreconditioner precond, float threshold, int maxIterations, ProgressReporter* progress) const;
+
     static const std::string loggerCat_; ///< category used in logging
 };
 
@@ -25,8 +25,11 @@
 
 #include "modules/openmp/include/voreenblasmp.h"
 
+#include "voreen/core/utils/voreenblas/voreenblaskernels.h"
+
 #include <cmath>
 #include <cstring>
+#include <algorithm>
 
 #ifdef WIN32
 #include <omp.h>
@@ -36,94 +39,81 @@ namespace voreen {
 
 const std::string VoreenBlasMP::loggerCat_("voreen.VoreenBlasMP");
 
-void VoreenBlasMP::sAXPY(size_t vecSize, const float* vecx, const float* vecy, float alpha, float* result) const {
+namespace {
+
+/// Number of vector elements (resp. matrix rows) processed by a thread at once
+const size_t BLOCK_SIZE = 1 << 14;
+
+/**
+ * Applies the kernel to all cache-sized blocks of [0, size) in parallel and returns the sum of its results.
+ * The static schedule assigns the same blocks to each thread on every call, so that they stay in its cache.
+ */
+template<typename Kernel>
+double forEachBlock(size_t size, Kernel kernel) {
+    const int numBlocks = static_cast<int>((size + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    double result = 0.0;
 
-    #pragma omp parallel for
-    for (int i=0; i<static_cast<int>(vecSize); ++i) {
-        result[i] = alpha*vecx[i] + vecy[i];
+    #pragma omp parallel for reduction(+:result) schedule(static)
+    for (int block=0; block < numBlocks; ++block) {
+        size_t begin = static_cast<size_t>(block)*BLOCK_SIZE;
+        result += kernel(begin, std::min(begin + BLOCK_SIZE, size));
     }
 
+    return result;
 }
 
-float VoreenBlasMP::sDOT(size_t vecSize, const float* vecx, const float* vecy) const {
-    float result = 0.f;
+} // namespace anonymous
 
-    #pragma omp parallel for reduction(+:result)
-    for (int i=0; i < static_cast<int>(vecSize); i++)
-        result += (vecx[i] * vecy[i]);
+void VoreenBlasMP::sAXPY(size_t vecSize, const float* vecx, const float* vecy, float alpha, float* result) const {
+    forEachBlock(vecSize, [&] (size_t begin, size_t end) {
+        VoreenBlasKernels::axpy(begin, end, vecx, vecy, alpha, result);
+        return 0.0;
+    });
+}
 
-    return result;
+float VoreenBlasMP::sDOT(size_t vecSize, const float* vecx, const float* vecy) const {
+    return static_cast<float>(forEachBlock(vecSize, [&] (size_t begin, size_t end) {
+        return VoreenBlasKernels::dot(begin, end, vecx, vecy);
+    }));
 }
 
 float VoreenBlasMP::sNRM2(size_t vecSize, const float* vecx) const {
-    float result = 0.f;
-
-    #pragma omp parallel for reduction(+:result)
-    for (int i=0; i < static_cast<int>(vecSize); i++)
-        result += (vecx[i] * vecx[i]);
-
-    return sqrt(result);
+    return static_cast<float>(std::sqrt(forEachBlock(vecSize, [&] (size_t begin, size_t end) {
+        return VoreenBlasKernels::dot(begin, end, vecx, vecx);
+    })));
 }
 
 void VoreenBlasMP::sSpMVEll(const EllpackMatrix<float>& mat, const float* vec, float* result) const {
-
-    const int numRows = static_cast<int>(mat.getNumRows());
-    const size_t numColsPerRow = mat.getNumColsPerRow();
-
-    #pragma omp parallel for
-    for (int row=0; row < numRows; ++row) {
-        result[row] = 0.f;
-        for (size_t colIndex=0; colIndex < numColsPerRow; ++colIndex) {
-            size_t col = mat.getColumn(row, colIndex);
-            if(col != -1) {
-                result[row] += mat.getValueByIndex(row, colIndex) * vec[col];
-            }
-        }
-    }
-
+    forEachBlock(mat.getNumRows(), [&] (size_t begin, size_t end) {
+        return VoreenBlasKernels::spMVEll(mat, begin, end, vec, result, nullptr);
+    });
 }
 
 void VoreenBlasMP::hSpMVEll(const EllpackMatrix<int16_t>& mat, const float* vec, float* result) const {
-
-    const float maxValue = static_cast<float>((1<<15) - 1);
-    const int numRows = static_cast<int>(mat.getNumRows());
-    const size_t numColsPerRow = mat.getNumColsPerRow();
-
-    #pragma omp parallel for
-    for (int row=0; row < numRows; ++row) {
-        result[row] = 0.f;
-        for (size_t colIndex=0; colIndex < numColsPerRow; ++colIndex) {
-            size_t col = mat.getColumn(row, colIndex);
-            if(col != -1) {
-                result[row] += mat.getValueByIndex(row, colIndex) * vec[col];
-            }
-        }
-    }
+    forEachBlock(mat.getNumRows(), [&] (size_t begin, size_t end) {
+        return VoreenBlasKernels::spMVEll(mat, begin, end, vec, result, nullptr);
+    });
 }
 
 float VoreenBlasMP::sSpInnerProductEll(const EllpackMatrix<float>& mat, const float* vecx, const float* vecy) const {
-
-    const int numRows = static_cast<int>(mat.getNumRows());
-    const size_t numColsPerRow = mat.getNumColsPerRow();
-
-    float result = 0.f;
-
-    #pragma omp parallel for reduction(+:result)
-    for (int row=0; row < numRows; ++row) {
-        float dot = 0.f;
-        for (size_t colIndex=0; colIndex < numColsPerRow; ++colIndex) {
-            size_t col = mat.getColumn(row, colIndex);
-            if(col != -1) {
-                dot += mat.getValueByIndex(row, colIndex) * vecy[col];
-            }
-        }
-        result += dot*vecx[row];
-    }
-    return result;
+    return static_cast<float>(forEachBlock(mat.getNumRows(), [&] (size_t begin, size_t end) {
+        return VoreenBlasKernels::spMVEll(mat, begin, end, vecy, nullptr, vecx);
+    }));
 }
 
 int VoreenBlasMP::sSpConjGradEll(const EllpackMatrix<float>& mat, const float* vec, float* result,
                                  float* initial, ConjGradPreconditioner precond, float threshold, int maxIterations, ProgressReporter* progress) const {
+    return conjGradEll(mat, vec, result, initial, precond, threshold, maxIterations, progress);
+}
+
+int VoreenBlasMP::hSpConjGradEll(const EllpackMatrix<int16_t>& mat, const float* vec, float* result,
+                                    float* initial, float threshold, int maxIterations) const {
+    return conjGradEll(mat, vec, result, initial, NoPreconditioner, threshold, maxIterations, nullptr);
+}
+
+template<typename T>
+int VoreenBlasMP::conjGradEll(const EllpackMatrix<T>& mat, const float* vec, float* result,
+                              float* initial, ConjGradPreconditioner precond, float threshold, int maxIterations, ProgressReporter* progress) const {
 
     if (!mat.isSymmetric()) {
         LERROR("Symmetric matrix expected.");
@@ -144,45 +134,39 @@ int VoreenBlasMP::sSpConjGradEll(const EllpackMatrix<float>& mat, const float* v
     memcpy(xBuf, initial, sizeof(float)*vecSize);
 
     float* tmpBuf = initial;
-    memcpy(tmpBuf, vec, sizeof(float)*vecSize);
 
     float* rBuf = new float[vecSize];
     float* pBuf = new float[vecSize];
 
     float* zBuf = 0;
-
-    EllpackMatrix<float>* preconditioner = 0;
+    float* invDiag = 0;
     if (precond == Jacobi) {
-        preconditioner = new EllpackMatrix<float>(vecSize, vecSize, 1);
-        preconditioner->initializeBuffers();
+        invDiag = new float[vecSize];
 
         #pragma omp parallel for
         for (int i=0; i<static_cast<int>(vecSize); i++)
-            preconditioner->setValueByIndex(i, i, 0, 1.f / std::max(mat.getValue(i,i), 1e-6f));
+            invDiag[i] = 1.f / std::max(static_cast<float>(mat.getValue(i,i)), 1e-6f);
 
         zBuf = new float[vecSize];
     }
-
-    float nominator;
-    float denominator;
+    else {
+        // without preconditioner, z equals r
+        zBuf = rBuf;
+    }
 
     int iteration = 0;
 
-    // r <= A*x_0
-    sSpMVEll(mat, xBuf, rBuf);
-
-    // p <= -r + b
-    sAXPY(vecSize, rBuf, tmpBuf, -1.f, pBuf);
-
-    // r <= -r + b
-    sAXPY(vecSize, rBuf, tmpBuf, -1.f, rBuf);
-
-    // preconditioning
-    if (precond == Jacobi) {
-        sSpMVEll(*preconditioner, rBuf, zBuf);
-        memcpy(pBuf, zBuf, vecSize * sizeof(float));
-    }
-
+    // r <= b - A*x_0, z <= M^-1 * r, p <= z, nominator <= dot(r, z)
+    double nominator = forEachBlock(vecSize, [&] (size_t begin, size_t end) {
+        VoreenBlasKernels::spMVEll(mat, begin, end, xBuf, rBuf, nullptr);
+        VoreenBlasKernels::axpy(begin, end, rBuf, vec, -1.f, rBuf);
+        if (invDiag) {
+            for (size_t i=begin; i<end; ++i)
+                zBuf[i] = invDiag[i]*rBuf[i];
+        }
+        memcpy(pBuf + begin, zBuf + begin, (end - begin) * sizeof(float));
+        return VoreenBlasKernels::dot(begin, end, rBuf, zBuf);
+    });
 
     try {
         while (iteration < maxIterations) {
@@ -190,58 +174,37 @@ int VoreenBlasMP::sSpConjGradEll(const EllpackMatrix<float>& mat, const float* v
 
             iteration++;
 
-            // norm(r_k)
-            nominator = sDOT(vecSize, rBuf, rBuf);
-
-            if (precond == Jacobi)
-                nominator = sDOT(vecSize, rBuf, zBuf);
-            else
-                nominator = sDOT(vecSize, rBuf, rBuf);
-
-            // tmp <= A * p_k
-            sSpMVEll(mat, pBuf, tmpBuf);
-
-            // dot(p_k^T, tmp)
-            denominator = sDOT(vecSize, pBuf, tmpBuf);
-
-            float alpha = nominator / denominator;
-
-            // x <= alpha*p + x
-            sAXPY(vecSize, pBuf, xBuf, alpha, xBuf);
+            // tmp <= A * p_k, denominator <= dot(p_k, tmp)
+            double denominator = forEachBlock(vecSize, [&] (size_t begin, size_t end) {
+                return VoreenBlasKernels::spMVEll(mat, begin, end, pBuf, tmpBuf, pBuf);
+            });
 
-            // r <= -alpha*tmp + r
-            sAXPY(vecSize, tmpBuf, rBuf, -alpha, rBuf);
+            float alpha = static_cast<float>(nominator / denominator);
 
-            float beta;
+            // x <= alpha*p + x, r <= -alpha*tmp + r, z <= M^-1 * r
+            double beta = forEachBlock(vecSize, [&] (size_t begin, size_t end) {
+                return VoreenBlasKernels::updateResidual(begin, end, alpha, pBuf, tmpBuf, xBuf, rBuf, invDiag, zBuf);
+            });
 
-            // norm(r_k+1)
-            if (precond == Jacobi) {
-                sSpMVEll(*preconditioner, rBuf, zBuf);
-                beta = sDOT(vecSize, rBuf, zBuf);
-            }
-            else {
-                beta = sDOT(vecSize, rBuf, rBuf);
-            }
-
-            if (sqrt(beta) < threshold)
+            if (std::sqrt(beta) < threshold)
                 break;
 
-            beta /= nominator;
+            // p <= beta*p + z
+            float direction = static_cast<float>(beta / nominator);
+            forEachBlock(vecSize, [&] (size_t begin, size_t end) {
+                VoreenBlasKernels::updateDirection(begin, end, direction, zBuf, pBuf);
+                return 0.0;
+            });
 
-            // p <= beta*p + r
-            if (precond == Jacobi) {
-                sAXPY(vecSize, pBuf, zBuf, beta, pBuf);
-            }
-            else {
-                sAXPY(vecSize, pBuf, rBuf, beta, pBuf);
-            }
+            nominator = beta;
         }
         if(progress) { progress->setProgress(1.0f); }
     } catch(boost::thread_interrupted& e) {
         delete[] rBuf;
         delete[] pBuf;
-        delete[] zBuf;
-        delete preconditioner;
+        if (precond == Jacobi)
+            delete[] zBuf;
+        delete[] invDiag;
 
         if (initialAllocated)
             delete[] initial;
@@ -251,91 +214,9 @@ int VoreenBlasMP::sSpConjGradEll(const EllpackMatrix<float>& mat, const float* v
 
     delete[] rBuf;
     delete[] pBuf;
-    delete[] zBuf;
-    delete preconditioner;
-
-    if (initialAllocated)
-        delete[] initial;
-
-    return iteration;
-}
-
-int VoreenBlasMP::hSpConjGradEll(const EllpackMatrix<int16_t>& mat, const float* vec, float* result,
-                                    float* initial, float threshold, int maxIterations) const {
-
-    if (!mat.isSymmetric()) {
-        LERROR("Symmetric matrix expected.");
-        return -1;
-    }
-
-    size_t vecSize = mat.getNumRows();
-
-    bool initialAllocated = false;
-    if (initial == 0) {
-        initial = new float[vecSize];
-        initialAllocated = true;
-        for (size_t i=0; i<vecSize; ++i)
-            initial[i] = 0.f;
-    }
-
-    float* xBuf = result;
-    memcpy(xBuf, initial, sizeof(float)*vecSize);
-
-    float* tmpBuf = initial;
-    memcpy(tmpBuf, vec, sizeof(float)*vecSize);
-
-    float* rBuf = new float[vecSize];
-    float* pBuf = new float[vecSize];
-
-    float nominator;
-    float denominator;
-
-    int iteration = 0;
-
-    // r <= A*x_0
-    hSpMVEll(mat, xBuf, rBuf);
-
-    // p <= -r + b
-    sAXPY(vecSize, rBuf, tmpBuf, -1.f, pBuf);
-
-    // r <= -r + b
-    sAXPY(vecSize, rBuf, tmpBuf, -1.f, rBuf);
-
-    while (iteration < maxIterations) {
-
-        iteration++;
-
-        // norm(r_k)
-        nominator = sDOT(vecSize, rBuf, rBuf);
-
-        // tmp <= A * p_k
-        hSpMVEll(mat, pBuf, tmpBuf);
-
-        // dot(p_k^T, tmp)
-        denominator = sDOT(vecSize, pBuf, tmpBuf);
-
-        float alpha = nominator / denominator;
-
-        // x <= alpha*p + x
-        sAXPY(vecSize, pBuf, xBuf, alpha, xBuf);
-
-        // r <= -alpha*tmp + r
-        sAXPY(vecSize, tmpBuf, rBuf, -alpha, rBuf);
-
-        // norm(r_k+1)
-        float beta = sDOT(vecSize, rBuf, rBuf);
-
-        if (sqrt(beta) < threshold)
-            break;
-
-        beta /= nominator;
-
-        // p <= beta*p + r
-        sAXPY(vecSize, pBuf, rBuf, beta, pBuf);
-    }
-
-    delete[] rBuf;
-    delete[] pBuf;
+    if (precond == Jacobi)
+        delete[] zBuf;
+    delete[] invDiag;
 
     if (initialAllocated)
         delete[] initial;
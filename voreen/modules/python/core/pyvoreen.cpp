@@ -1086,8 +1086,9 @@ static PyObject* voreen_setPortData(PyObject* /*self*/, PyObject* args) {
         return 0;
     }
 
-    // Delete old data first.
-    port->clear();
+    // Delete old data first. Volume ports are cleared after the passed object has been validated.
+    if (!dynamic_cast<VolumePort*>(port))
+        port->clear();
 
     // determine port type, convert and assign data
     if (VolumePort* typedPort = dynamic_cast<VolumePort*>(port)) {
@@ -1096,63 +1097,93 @@ static PyObject* voreen_setPortData(PyObject* /*self*/, PyObject* args) {
             return 0;
         tgtAssert(object, "parsing VolumeObject failed");
 
-        const VolumeObject& volumeObject = *((VolumeObject*) object);
+        VolumeObject& volumeObject = *((VolumeObject*) object);
 
-        unsigned int numVoxels = volumeObject.dimX * volumeObject.dimY * volumeObject.dimZ;
-        Py_ssize_t size = PyList_Size(volumeObject.data);
-        if(size != numVoxels) {
-            std::string error = "Volume data has invalid size '" + std::to_string(size) + "', must be '" + std::to_string(numVoxels) + "') according to dimensions";
-            PyErr_SetString(PyExc_ValueError, error.c_str());
-            return 0;
+        // Validate the object before the current port data is deleted.
+        if(volumeObject.data) {
+            unsigned int numVoxels = volumeObject.dimX * volumeObject.dimY * volumeObject.dimZ;
+            Py_ssize_t size = PyList_Size(volumeObject.data);
+            if(size != numVoxels) {
+                std::string error = "Volume data has invalid size '" + std::to_string(size) + "', must be '" + std::to_string(numVoxels) + "') according to dimensions";
+                PyErr_SetString(PyExc_ValueError, error.c_str());
+                return 0;
+            }
         }
-
-        std::string format = PyUnicodeAsString(volumeObject.format);
-        std::unique_ptr<VolumeRAM> volume;
-        try {
-            volume.reset(VolumeFactory().create(format, tgt::svec3(volumeObject.dimX, volumeObject.dimY, volumeObject.dimZ)));
-        } catch(const std::bad_alloc& error) {
-            PyErr_SetString(PyExc_ValueError, "Could not allocate memory for volume");
-            return 0;
+        else if(volumeObject.volume) {
+            // The storage is handed over to the port below, so it must not be aliased by exported buffers.
+            if(volumeObject.numExports > 0) {
+                PyErr_SetString(PyExc_BufferError, "Volume data is still exported (e.g. by a numpy array), "
+                                                   "release all buffers before calling setPortData()");
+                return 0;
+            }
+            if(volumeObject.volume->getDimensions() != tgt::svec3(volumeObject.dimX, volumeObject.dimY, volumeObject.dimZ)) {
+                PyErr_SetString(PyExc_ValueError, "Volume dimensions do not match its data");
+                return 0;
+            }
         }
-        if(!volume) {
-            std::string error = "Volume of format '" + format + "' could not be created.";
-            PyErr_SetString(PyExc_ValueError, error.c_str());
+        else {
+            if(!VolumeObject_raiseIfMoved(&volumeObject, PyExc_ValueError))
+                PyErr_SetString(PyExc_ValueError, "Volume has no data");
             return 0;
         }
+        typedPort->clear();
+
+        std::unique_ptr<VolumeRAM> volume;
+
+        if(volumeObject.data) {
+            // Legacy: Convert the list of normalized voxel values.
+            std::string format = PyUnicodeAsString(volumeObject.format);
+            try {
+                volume.reset(VolumeFactory().create(format, tgt::svec3(volumeObject.dimX, volumeObject.dimY, volumeObject.dimZ)));
+            } catch(const std::bad_alloc& error) {
+                PyErr_SetString(PyExc_ValueError, "Could not allocate memory for volume");
+                return 0;
+            }
+            if(!volume) {
+                std::string error = "Volume of format '" + format + "' could not be created.";
+                PyErr_SetString(PyExc_ValueError, error.c_str());
+                return 0;
+            }
+
+            // Set voxel values.
+            bool error = false;
+            for(size_t i=0; i<volume->getNumVoxels() && !error; i++) {
+                PyObject* p = PyList_GetItem(volumeObject.data, i);
+
+                tgt::vec4 value = tgt::vec4::zero;
+                switch(volume->getNumChannels()) {
+                case 1:
+                    value.x = static_cast<float>(PyFloat_AsDouble(p));
+                    error |= PyErr_Occurred() != nullptr;
+                    break;
+                case 2:
+                    error |= !PyArg_ParseTuple(p, "ff", &value.x, &value.y);
+                    break;
+                case 3:
+                    error |= !PyArg_ParseTuple(p, "fff", &value.x, &value.y, &value.z);
+                    break;
+                case 4:
+                    error |= !PyArg_ParseTuple(p, "ffff", &value.x, &value.y, &value.z, &value.w);
+                    break;
+                default:
+                    tgtAssert(false, "unsupported channel count");
+                }
 
-        // Set voxel values.
-        bool error = false;
-        for(size_t i=0; i<volume->getNumVoxels() && !error; i++) {
-            PyObject* p = PyList_GetItem(volumeObject.data, i);
-
-            tgt::vec4 value = tgt::vec4::zero;
-            switch(volume->getNumChannels()) {
-            case 1:
-                value.x = static_cast<float>(PyFloat_AsDouble(p));
-                error |= PyErr_Occurred() != nullptr;
-                break;
-            case 2:
-                error |= !PyArg_ParseTuple(p, "ff", &value.x, &value.y);
-                break;
-            case 3:
-                error |= !PyArg_ParseTuple(p, "fff", &value.x, &value.y, &value.z);
-                break;
-            case 4:
-                error |= !PyArg_ParseTuple(p, "ffff", &value.x, &value.y, &value.z, &value.w);
-                break;
-            default:
-                tgtAssert(false, "unsupported channel count");
+                for(size_t channel = 0; channel < volume->getNumChannels(); channel++) {
+                    volume->setVoxelNormalized(value[channel], i, channel);
+                }
             }
 
-            for(size_t channel = 0; channel < volume->getNumChannels(); channel++) {
-                volume->setVoxelNormalized(value[channel], i, channel);
+            if(error) {
+                std::string message = "Volume contains invalid values.";
+                PyErr_SetString(PyExc_ValueError, message.c_str());
+                return 0;
             }
         }
-
-        if(error) {
-            std::string message = "Volume contains invalid values.";
-            PyErr_SetString(PyExc_ValueError, message.c_str());
-            return 0;
+        else {
+            // Hand over the storage without copying. The object is detached from it,
+            // so Python never aliases data owned by the port.
+            volume.reset(VolumeObject_releaseVolume(&volumeObject));
         }
 
         // Set meta data.
@@ -1307,44 +1338,16 @@ static PyObject* voreen_getPortData(PyObject* /*self*/, PyObject* args) {
         if(!volumeObject)
             return 0;
 
-        Py_DECREF(volumeObject->format); // Format will be overwritten.
-        volumeObject->format = PyUnicode_FromString(volume->getFormat().c_str());
-
-        for(size_t i=0; i<volume->getNumVoxels(); i++) {
-            tgt::vec4 value = tgt::vec4::zero;
-            for(size_t channel = 0; channel < volume->getNumChannels(); channel++) {
-                value[channel] = volume->getVoxelNormalized(i, channel);
-            }
-
-            PyObject* p = NULL;
-            switch(volume->getNumChannels()) {
-            case 1:
-                p = PyFloat_FromDouble(value.x);
-                break;
-            case 2:
-                p = Py_BuildValue("(ff)", value.x, value.y);
-                break;
-            case 3:
-                p = Py_BuildValue("(fff)", value.x, value.y, value.z);
-                break;
-            case 4:
-                p = Py_BuildValue("(ffff)", value.x, value.y, value.z, value.w);
-                break;
-            default:
-                tgtAssert(false, "unsupported channel count");
-            }
-
-            tgtAssert(p, "value null");
-            PyList_Append(volumeObject->data, p);
-
-            // p is now owned by the list
-            Py_XDECREF(p);
+        // Copy the port's storage at once, such that exported buffers stay valid when the port data changes.
+        // The voxel list is only created on demand.
+        try {
+            VolumeObject_setVolume(volumeObject, volume->clone());
+        } catch(const std::bad_alloc&) {
+            Py_DECREF(volumeObject);
+            PyErr_SetString(PyExc_ValueError, "Could not allocate memory for volume");
+            return 0;
         }
 
-        volumeObject->dimX = data->getDimensions().x;
-        volumeObject->dimY = data->getDimensions().y;
-        volumeObject->dimZ = data->getDimensions().z;
-
         volumeObject->spacingX = data->getSpacing().x;
         volumeObject->spacingY = data->getSpacing().y;
         volumeObject->spacingZ = data->getSpacing().z;
@@ -1939,6 +1942,10 @@ static PyMethodDef voreen_methods[] = {
         METH_VARARGS,
         "setPortData(processor name, port id, data)\n\n"
         "Assigns data to a processor port.\n"
+        "The voxel storage of a voreen.Volume is passed to the port without copying,\n"
+        "afterwards accessing the data of the volume object raises an error until new\n"
+        "data is assigned. Buffers exported by the volume (e.g. numpy arrays) have to be\n"
+        "released before."
     },
     {
         "getPortData",
@@ -1946,7 +1953,9 @@ static PyMethodDef voreen_methods[] = {
         METH_VARARGS,
         "getPortData(processor name, port id) -> data\n\n"
         "Returns the data of a processor port,\n"
-        "depending on the port's type. See: setPortData"
+        "depending on the port's type. See: setPortData\n"
+        "Volumes hold a copy of the port's voxels and support the buffer protocol,\n"
+        "e.g. numpy.asarray(volume) returns a (z, y, x[, channel]) view of the copy."
     },
     {
         "setCameraPosition",
@@ -25,12 +25,67 @@
 
 #include "pyvoreenobjects.h"
 
+#include "voreen/core/datastructures/volume/volumeram.h"
+#include "voreen/core/datastructures/volume/volumefactory.h"
+
+#include <cstring>
+#include <memory>
+
 namespace voreen {
 
 //////////////////////////////////////////////////////////////////
 // VolumeObject
 //////////////////////////////////////////////////////////////////
 
+/*
+ * Returns the struct module format character of the passed base type, or NULL if unsupported.
+ */
+static const char* getBufferFormat(const std::string& baseType) {
+    if (baseType == "uint8")  return "B";
+    if (baseType == "int8")   return "b";
+    if (baseType == "uint16") return "H";
+    if (baseType == "int16")  return "h";
+    if (baseType == "uint32") return "I";
+    if (baseType == "int32")  return "i";
+    if (baseType == "uint64") return "Q";
+    if (baseType == "int64")  return "q";
+    if (baseType == "float")  return "f";
+    if (baseType == "double") return "d";
+    return NULL;
+}
+
+/*
+ * Checks whether the elements of a buffer with the passed format and item size match the base type.
+ * Format characters are compared by kind and size (e.g., numpy exports int64 as 'l' on most platforms).
+ */
+static bool isCompatibleBufferFormat(const char* format, Py_ssize_t itemSize, const std::string& baseType) {
+    if (!format)
+        format = "B";
+
+    // Only native byte order is supported for multi-byte types.
+    char byteOrder = *format;
+    if (byteOrder == '@' || byteOrder == '=')
+        format++;
+#if PY_LITTLE_ENDIAN
+    else if (byteOrder == '<')
+        format++;
+#endif
+    else if ((byteOrder == '<' || byteOrder == '>' || byteOrder == '!') && itemSize == 1)
+        format++;
+
+    if (format[0] == '\0' || format[1] != '\0')
+        return false;
+
+    std::string type;
+    if (std::strchr("fd", format[0]))
+        type = itemSize == 4 ? "float" : (itemSize == 8 ? "double" : "");
+    else if (std::strchr("bhilq", format[0]))
+        type = "int" + std::to_string(itemSize * 8);
+    else if (std::strchr("BHILQ", format[0]))
+        type = "uint" + std::to_string(itemSize * 8);
+
+    return type == baseType;
+}
 
 PyObject* VolumeObject_new(PyTypeObject *type, PyObject */*args*/, PyObject */*kwds*/) {
     VolumeObject *self;
@@ -41,16 +96,15 @@ PyObject* VolumeObject_new(PyTypeObject *type, PyObject */*args*/, PyObject */*k
             Py_DECREF(self);
             return NULL;
         }
-        self->data = PyList_New(0);
-        if (self->data == NULL) {
-            Py_DECREF(self);
-            return NULL;
-        }
+        self->data = NULL; // Created on demand.
         self->dimX = self->dimY = self->dimZ = 0u;
         self->spacingX = self->spacingY = self->spacingZ = 1.0f;
         self->offsetX = self->offsetY = self->offsetZ = 0.0f;
         self->rwmScale = 1.0f;
         self->rwmOffset = 0.0f;
+        self->volume = NULL;
+        self->numExports = 0;
+        self->moved = false;
     }
     return (PyObject *) self;
 }
@@ -60,6 +114,11 @@ int VolumeObject_init(VolumeObject *self, PyObject *args, PyObject *kwds) {
     static const char *kwlist[] = {"format", "data", "dimension", NULL};
     PyObject *format = NULL, *data = NULL, *tmp;
 
+    if (self->numExports > 0) {
+        PyErr_SetString(PyExc_BufferError, "Volume can not be initialized while its data is exported");
+        return -1;
+    }
+
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "OO(III)", (char **) kwlist,
                                      &format,
                                      &data,
@@ -72,21 +131,229 @@ int VolumeObject_init(VolumeObject *self, PyObject *args, PyObject *kwds) {
         self->format = format;
         Py_XDECREF(tmp);
     }
-    if (data) {
+
+    // Legacy: voxels are passed as list of normalized values.
+    if (PyList_Check(data)) {
         tmp = self->data;
         Py_INCREF(data);
         self->data = data;
         Py_XDECREF(tmp);
+        VolumeObject_setVolume(self, NULL);
+        self->moved = false;
+        return 0;
+    }
+
+    const char* formatStr = PyUnicode_Check(self->format) ? PyUnicode_AsUTF8(self->format) : NULL;
+    if (!formatStr) {
+        PyErr_SetString(PyExc_TypeError, "Volume format must be a string");
+        return -1;
+    }
+
+    std::unique_ptr<VolumeRAM> volume;
+    try {
+        volume.reset(VolumeFactory().create(formatStr, tgt::svec3(self->dimX, self->dimY, self->dimZ)));
+    } catch(const std::bad_alloc&) {
+        PyErr_SetString(PyExc_ValueError, "Could not allocate memory for volume");
+        return -1;
+    }
+    if (!volume) {
+        std::string error = "Volume of format '" + std::string(formatStr) + "' could not be created.";
+        PyErr_SetString(PyExc_ValueError, error.c_str());
+        return -1;
+    }
+
+    if (data == Py_None) {
+        volume->clear();
+    }
+    else {
+        // Copy the contents of the passed buffer at once.
+        Py_buffer buffer;
+        if (PyObject_GetBuffer(data, &buffer, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) < 0)
+            return -1;
+
+        bool valid = static_cast<size_t>(buffer.len) == volume->getNumBytes()
+                && isCompatibleBufferFormat(buffer.format, buffer.itemsize, volume->getBaseType());
+        if (valid)
+            std::memcpy(volume->getData(), buffer.buf, volume->getNumBytes());
+        PyBuffer_Release(&buffer);
+
+        if (!valid) {
+            std::string error = "Volume data does not match format '" + std::string(formatStr) + "' and dimensions";
+            PyErr_SetString(PyExc_ValueError, error.c_str());
+            return -1;
+        }
     }
+
+    Py_CLEAR(self->data);
+    VolumeObject_setVolume(self, volume.release());
     return 0;
 }
 
 void VolumeObject_dealloc(VolumeObject *self) {
     Py_XDECREF(self->format);
     Py_XDECREF(self->data);
+    delete self->volume;
     Py_TYPE(self)->tp_free((PyObject *) self);
 }
 
+void VolumeObject_setVolume(VolumeObject* self, VolumeRAM* volume) {
+    tgtAssert(self->numExports == 0, "volume storage is exported");
+    if (self->volume != volume)
+        delete self->volume;
+
+    self->volume = volume;
+
+    if (volume) {
+        self->moved = false;
+
+        PyObject* tmp = self->format;
+        self->format = PyUnicode_FromString(volume->getFormat().c_str());
+        Py_XDECREF(tmp);
+
+        self->dimX = static_cast<unsigned int>(volume->getDimensions().x);
+        self->dimY = static_cast<unsigned int>(volume->getDimensions().y);
+        self->dimZ = static_cast<unsigned int>(volume->getDimensions().z);
+    }
+}
+
+VolumeRAM* VolumeObject_releaseVolume(VolumeObject* self) {
+    tgtAssert(self->numExports == 0, "volume storage is exported");
+    VolumeRAM* volume = self->volume;
+    self->volume = NULL;
+    self->moved = self->moved || volume;
+    return volume;
+}
+
+bool VolumeObject_raiseIfMoved(VolumeObject* self, PyObject* exceptionType) {
+    if (!self->moved)
+        return false;
+
+    PyErr_SetString(exceptionType, "Volume data has been moved into a port by setPortData(), "
+                                   "use getPortData() to access it");
+    return true;
+}
+
+PyObject* VolumeObject_getData(VolumeObject* self, void* /*closure*/) {
+    // An assigned list is returned as is, the voxel storage is converted into a new list on
+    // every access, so that it always reflects modifications made through the buffer protocol.
+    if (self->data) {
+        Py_INCREF(self->data);
+        return self->data;
+    }
+    if (VolumeObject_raiseIfMoved(self, PyExc_ValueError))
+        return NULL;
+
+    const VolumeRAM* volume = self->volume;
+    Py_ssize_t numVoxels = volume ? static_cast<Py_ssize_t>(volume->getNumVoxels()) : 0;
+
+    PyObject* list = PyList_New(numVoxels);
+    if (!list)
+        return NULL;
+
+    for (Py_ssize_t i = 0; i < numVoxels; i++) {
+        tgt::vec4 value = tgt::vec4::zero;
+        for (size_t channel = 0; channel < volume->getNumChannels(); channel++) {
+            value[channel] = volume->getVoxelNormalized(i, channel);
+        }
+
+        PyObject* p = NULL;
+        switch (volume->getNumChannels()) {
+        case 1:
+            p = PyFloat_FromDouble(value.x);
+            break;
+        case 2:
+            p = Py_BuildValue("(ff)", value.x, value.y);
+            break;
+        case 3:
+            p = Py_BuildValue("(fff)", value.x, value.y, value.z);
+            break;
+        case 4:
+            p = Py_BuildValue("(ffff)", value.x, value.y, value.z, value.w);
+            break;
+        default:
+            tgtAssert(false, "unsupported channel count");
+        }
+
+        if (!p) {
+            Py_DECREF(list);
+            return NULL;
+        }
+
+        // p is now owned by the list
+        PyList_SET_ITEM(list, i, p);
+    }
+
+    return list;
+}
+
+int VolumeObject_setData(VolumeObject* self, PyObject* value, void* /*closure*/) {
+    // Deleting the list falls back to the voxel storage.
+    if (value && !PyList_Check(value)) {
+        PyErr_SetString(PyExc_TypeError, "Volume data must be a list");
+        return -1;
+    }
+
+    PyObject* tmp = self->data;
+    Py_XINCREF(value);
+    self->data = value;
+    Py_XDECREF(tmp);
+    if (value)
+        self->moved = false;
+    return 0;
+}
+
+int VolumeObject_getBuffer(VolumeObject* self, Py_buffer* view, int flags) {
+    view->obj = NULL;
+
+    if (VolumeObject_raiseIfMoved(self, PyExc_BufferError))
+        return -1;
+
+    const VolumeRAM* volume = self->volume;
+    if (!volume) {
+        PyErr_SetString(PyExc_BufferError, "Volume has no voxel storage");
+        return -1;
+    }
+    const char* format = getBufferFormat(volume->getBaseType());
+    if (!format) {
+        std::string error = "Volume format '" + volume->getFormat() + "' is not supported by the buffer protocol";
+        PyErr_SetString(PyExc_BufferError, error.c_str());
+        return -1;
+    }
+
+    // Voxels are stored x-fastest, channels interleaved.
+    size_t numChannels = volume->getNumChannels();
+    Py_ssize_t itemSize = static_cast<Py_ssize_t>(volume->getBytesPerVoxel() / numChannels);
+    tgt::svec3 dim = volume->getDimensions();
+    self->shape[0] = static_cast<Py_ssize_t>(dim.z);
+    self->shape[1] = static_cast<Py_ssize_t>(dim.y);
+    self->shape[2] = static_cast<Py_ssize_t>(dim.x);
+    self->shape[3] = static_cast<Py_ssize_t>(numChannels);
+    self->strides[3] = itemSize;
+    self->strides[2] = self->strides[3] * self->shape[3];
+    self->strides[1] = self->strides[2] * self->shape[2];
+    self->strides[0] = self->strides[1] * self->shape[1];
+
+    view->buf = self->volume->getData();
+    view->obj = (PyObject*) self;
+    Py_INCREF(self);
+    view->len = static_cast<Py_ssize_t>(volume->getNumBytes());
+    view->readonly = 0;
+    view->itemsize = itemSize;
+    view->format = (flags & PyBUF_FORMAT) ? const_cast<char*>(format) : NULL;
+    view->ndim = numChannels > 1 ? 4 : 3;
+    view->shape = (flags & PyBUF_ND) == PyBUF_ND ? self->shape : NULL;
+    view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? self->strides : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+
+    self->numExports++;
+    return 0;
+}
+
+void VolumeObject_releaseBuffer(VolumeObject* self, Py_buffer* /*view*/) {
+    self->numExports--;
+}
+
 
 //////////////////////////////////////////////////////////////////
 // RenderTargetObject
@@ -35,16 +35,24 @@ namespace voreen {
 // VolumeObject
 //////////////////////////////////////////////////////////////////
 
+class VolumeRAM;
+
 typedef struct {
     PyObject_HEAD
     PyObject* format;
     //unsigned int numChannels; // Encoded in format
-    PyObject* data;
+    PyObject* data;         // list of normalized voxel values, only created on demand
     unsigned int dimX, dimY, dimZ;
     float spacingX, spacingY, spacingZ;
     float offsetX, offsetY, offsetZ;
     float rwmScale;
     float rwmOffset;
+
+    VolumeRAM* volume;      // voxel storage owned by the object and exported by the buffer protocol, may be null
+    Py_ssize_t numExports;  // number of active buffer exports
+    bool moved;             // the storage has been handed over to a port, see VolumeObject_releaseVolume
+    Py_ssize_t shape[4];    // buffer shape: z, y, x, channel
+    Py_ssize_t strides[4];
 } VolumeObject;
 
 /*
@@ -53,7 +61,6 @@ typedef struct {
 static PyMemberDef VolumeObject_members[] = {
     {(char*)"format",      T_OBJECT_EX,    offsetof(VolumeObject, format),     0, (char*)"Format: (Vector(2|3|4))?(float | double | u?int(8|16|32|64))" },
     //{(char*)"numChannels", T_OBJECT_EX,    offsetof(VolumeObject, numChannels),0, (char*)"Number of Channels [1, 4]"},
-    {(char*)"data",        T_OBJECT_EX,    offsetof(VolumeObject, data),       0, (char*)"data"       },
     {(char*)"dimX",        T_UINT,         offsetof(VolumeObject, dimX),       0, (char*)"Dimension X"},
     {(char*)"dimY",        T_UINT,         offsetof(VolumeObject, dimY),       0, (char*)"Dimension Y"},
     {(char*)"dimZ",        T_UINT,         offsetof(VolumeObject, dimZ),       0, (char*)"Dimension Z"},
@@ -75,16 +82,69 @@ PyObject* VolumeObject_new(PyTypeObject *type, PyObject */*args*/, PyObject */*k
 int VolumeObject_init(VolumeObject *self, PyObject *args, PyObject *kwds);
 void VolumeObject_dealloc(VolumeObject *self);
 
+/*
+ * Replaces the voxel storage of the volume object, which takes ownership of it.
+ * The dimensions and format of the object are updated accordingly.
+ * Must not be called while the storage is exported.
+ */
+void VolumeObject_setVolume(VolumeObject* self, VolumeRAM* volume);
+
+/*
+ * Detaches the voxel storage from the volume object and returns it to the caller,
+ * which takes ownership of it. Must not be called while the storage is exported.
+ * Until new data is assigned, every access to the data of the object raises an error.
+ */
+VolumeRAM* VolumeObject_releaseVolume(VolumeObject* self);
+
+/*
+ * Sets a python exception of the passed type and returns true, if the storage of the
+ * volume object has been released and no new data has been assigned since.
+ */
+bool VolumeObject_raiseIfMoved(VolumeObject* self, PyObject* exceptionType);
+
+/*
+ * Legacy list access of the voxel data, see VolumeObject_getset.
+ */
+PyObject* VolumeObject_getData(VolumeObject* self, void* closure);
+int VolumeObject_setData(VolumeObject* self, PyObject* value, void* closure);
+
+static PyGetSetDef VolumeObject_getset[] = {
+    {(char*)"data", (getter) VolumeObject_getData, (setter) VolumeObject_setData,
+     (char*)"List of normalized voxel values (tuples for multi channel volumes). "
+            "Slow for large volumes, use the buffer protocol (e.g. numpy.asarray(volume)) instead. "
+            "Reading returns a copy of the voxel values, unless a list has been assigned. "
+            "An assigned list is used by setPortData().", NULL},
+    {NULL}  /* Sentinel */
+};
+
+/*
+ * Buffer protocol: The voxel storage is exported without copying as (z, y, x) or
+ * (z, y, x, channel) array of the volume's base type, such that e.g. numpy.asarray(volume)
+ * aliases the volume object. The storage never belongs to port data, so exports remain
+ * valid independently of the network.
+ */
+int VolumeObject_getBuffer(VolumeObject* self, Py_buffer* view, int flags);
+void VolumeObject_releaseBuffer(VolumeObject* self, Py_buffer* view);
+
+static PyBufferProcs VolumeObject_as_buffer = {
+    (getbufferproc) VolumeObject_getBuffer,
+    (releasebufferproc) VolumeObject_releaseBuffer
+};
+
 /*
  * The following struct defines the python equivalent for a Voreen Volume.
  * Currently, the implementation is very rudimentary and only supports:
  *   - format
- *   - data (single channel, float, only!)
+ *   - data (as buffer or list of normalized values)
  *   - dimension
  *   - spacing
  *   - offset
  *   - real world mapping scaling
  *   - real world mapping offset
+ *
+ * The constructor Volume(format, data, (x, y, z)) accepts a list of normalized values,
+ * None for a zero-initialized volume or any object supporting the buffer protocol
+ * (e.g. a numpy array of matching type and size) whose contents are copied once.
  */
 static PyTypeObject VolumeObjectType = {
     PyVarObject_HEAD_INIT(NULL, 0)
@@ -105,7 +165,7 @@ static PyTypeObject VolumeObjectType = {
     NULL,                                   /*tp_str*/
     NULL,                                   /*tp_getattro*/
     NULL,                                   /*tp_setattro*/
-    NULL,                                   /*tp_as_buffer*/
+    &VolumeObject_as_buffer,                /*tp_as_buffer*/
     Py_TPFLAGS_DEFAULT,                     /*tp_flags*/
     "Volume, contained by a port",          /*tp_doc*/
     NULL,                                   /*tp_traverse*/
@@ -116,7 +176,7 @@ static PyTypeObject VolumeObjectType = {
     NULL,                                   /*tp_iternext*/
     NULL,                                   /*tp_methods*/
     VolumeObject_members,                   /*tp_members*/
-    NULL,                                   /*tp_getset*/
+    VolumeObject_getset,                    /*tp_getset*/
     NULL,                                   /*tp_base*/
     NULL,                                   /*tp_dict*/
     NULL,                                   /*tp_descr_get*/
@@ -217,7 +217,9 @@ RandomWalker::RandomWalker()
     // conjugate gradient solver
     preconditioner_.addOption("none", "None");
     preconditioner_.addOption("jacobi", "Jacobi");
+    preconditioner_.addOption("multigrid", "Multigrid (matrix-free, CPU)");
     preconditioner_.select("jacobi");
+    preconditioner_.onChange(MemberFunctionCallback<RandomWalker>(this, &RandomWalker::updateGuiState));
     addProperty(preconditioner_);
     addProperty(errorThreshold_);
     addProperty(maxIterations_);
@@ -390,6 +392,7 @@ RandomWalker::ComputeInput RandomWalker::prepareComputeInput() {
     VoreenBlas::ConjGradPreconditioner precond = VoreenBlas::NoPreconditioner;
     if (preconditioner_.isSelected("jacobi"))
         precond = VoreenBlas::Jacobi;
+    bool matrixFree = preconditioner_.isSelected("multigrid");
 
 
     std::vector<float> prevProbs;
@@ -417,6 +420,7 @@ RandomWalker::ComputeInput RandomWalker::prepareComputeInput() {
         bounds,
         voreenBlas,
         precond,
+        matrixFree,
         lodForegroundSeedThresh,
         lodBackgroundSeedThresh,
         errorThresh,
@@ -634,7 +638,7 @@ RandomWalker::ComputeOutput RandomWalker::compute(ComputeInput input, ProgressRe
         solver.reset(new RandomWalkerSolver(workVolume, seeds.release(), *weights));
         try {
             auto start = clock::now();
-            solver->setupEquationSystem(iterationProgressSteps.get<1>());
+            solver->setupEquationSystem(iterationProgressSteps.get<1>(), input.matrixFree_);
             auto finish = clock::now();
             //LINFO("...finished: " << std::chrono::duration<float>(finish-start).count() << " sec");
             loopRecord.timeSetup = finish - start;
@@ -649,10 +653,14 @@ RandomWalker::ComputeOutput RandomWalker::compute(ComputeInput input, ProgressRe
             loopRecord.numBackgroundSeeds = twoLabelSeeds->getNumBackgroundSeeds();
         }
 
-        ProfileAllocation profmatvalues(ramProfiler_, 7 * solver->getSystemSize() * sizeof(float));
-        ProfileAllocation profmatrows(ramProfiler_, 7 * solver->getSystemSize() * sizeof(size_t));
-        ProfileAllocation profbsize(ramProfiler_, solver->getSystemSize() * sizeof(float));
-        ProfileAllocation profindextable(ramProfiler_, inputVolume->getNumVoxels() * sizeof(size_t));
+        size_t numMatrixEntries = solver->isMatrixFree() ? 0 : 7 * solver->getSystemSize();
+        ProfileAllocation profmatvalues(ramProfiler_, numMatrixEntries * sizeof(float));
+        ProfileAllocation profmatrows(ramProfiler_, numMatrixEntries * sizeof(size_t));
+        // matrix-free systems use voxel indexed vectors instead of an index table
+        size_t vectorSize = solver->isMatrixFree() ? solver->getNumVoxels() : solver->getSystemSize();
+        size_t indexTableSize = solver->isMatrixFree() ? 0 : inputVolume->getNumVoxels();
+        ProfileAllocation profbsize(ramProfiler_, vectorSize * sizeof(float));
+        ProfileAllocation profindextable(ramProfiler_, indexTableSize * sizeof(size_t));
 
         /*
          * 3. Compute Random Walker solution.
@@ -923,11 +931,10 @@ void RandomWalker::putOutEdgeWeights(const RandomWalkerSolver* solver) {
         return;
     }
 
-    const EllpackMatrix<float>& mat = solver->getMatrix();
-
     float maxWeightSum = 0.f;
-    for (size_t row=0; row<solver->getSystemSize(); row++) {
-        maxWeightSum = std::max(maxWeightSum, mat.getValue(row, row));
+    for (size_t i=0; i<solver->getNumVoxels(); i++) {
+        if (!solver->isSeedPoint(i))
+            maxWeightSum = std::max(maxWeightSum, solver->getEdgeWeightSum(i));
     }
 
     for (size_t i=0; i<solver->getNumVoxels(); i++) {
@@ -936,9 +943,7 @@ void RandomWalker::putOutEdgeWeights(const RandomWalkerSolver* solver) {
             weight = solver->getSeedValue(i);
         }
         else {
-            size_t row = solver->getRowIndex(i); // volIndexToRow[i];
-            tgtAssert(row < solver->getSystemSize(), "Invalid row");
-            weight = logf(1.f + (mat.getValue(row, row) / maxWeightSum)*1e3f) / logf(1e3f);
+            weight = logf(1.f + (solver->getEdgeWeightSum(i) / maxWeightSum)*1e3f) / logf(1e3f);
             weight = 1.f - weight;
         }
 
@@ -1026,6 +1031,9 @@ void RandomWalker::updateGuiState() {
     lodMaxResolution_.setVisibleFlag(lodEnabled);
 
     resampleOutputVolumes_.setVisibleFlag(lodEnabled);
+
+    // the multigrid solver does not use VoreenBlas
+    conjGradImplementation_.setVisibleFlag(!preconditioner_.isSelected("multigrid"));
 }
 
 }   // namespace
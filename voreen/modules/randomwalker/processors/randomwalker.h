@@ -75,6 +75,7 @@ struct RandomWalkerInput {
     boost::optional<tgt::IntBounds> clipRegion_;
     const VoreenBlas* blas_;
     VoreenBlas::ConjGradPreconditioner precond_;
+    bool matrixFree_;
     float lodForegroundSeedThresh_;
     float lodBackgroundSeedThresh_;
     float errorThreshold_;
@@ -34,6 +34,7 @@ SET(MOD_CORE_SOURCES
     ${MOD_DIR}/processors/rwmultilabelloopinitializer.cpp
     ${MOD_DIR}/processors/supervoxelwalker.cpp
 
+    ${MOD_DIR}/solver/randomwalkermultigrid.cpp
     ${MOD_DIR}/solver/randomwalkersolver.cpp
     ${MOD_DIR}/solver/randomwalkerseeds.cpp
     ${MOD_DIR}/solver/randomwalkerweights.cpp
@@ -52,6 +53,7 @@ SET(MOD_CORE_HEADERS
     ${MOD_DIR}/processors/rwmultilabelloopfinalizer.h
     ${MOD_DIR}/processors/supervoxelwalker.h
 
+    ${MOD_DIR}/solver/randomwalkermultigrid.h
     ${MOD_DIR}/solver/randomwalkersolver.h
     ${MOD_DIR}/solver/randomwalkerseeds.h
     ${MOD_DIR}/solver/randomwalkerweights.h
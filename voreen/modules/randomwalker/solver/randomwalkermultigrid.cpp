@@ -0,0 +1,377 @@
+/***********************************************************************************
+ *                                                                                 *
+ * Voreen - The Volume Rendering Engine                                            *
+ *                                                                                 *
+ * Copyright (C) 2005-2024 University of Muenster, Germany,                        *
+ * Department of Computer Science.                                                 *
+ * For a list of authors please refer to the file "CREDITS.txt".                   *
+ *                                                                                 *
+ * This file is part of the Voreen software package. Voreen is free software:      *
+ * you can redistribute it and/or modify it under the terms of the GNU General     *
+ * Public License version 2 as published by the Free Software Foundation.          *
+ *                                                                                 *
+ * Voreen is distributed in the hope that it will be useful, but WITHOUT ANY       *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR   *
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.      *
+ *                                                                                 *
+ * You should have received a copy of the GNU General Public License in the file   *
+ * "LICENSE.txt" along with this file. If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                                 *
+ * For non-commercial academic use see the license exception specified in the file *
+ * "LICENSE-academic.txt". To get information about commercial licensing please    *
+ * contact the authors.                                                            *
+ *                                                                                 *
+ ***********************************************************************************/
+
+#include "randomwalkermultigrid.h"
+
+#include "voreen/core/io/progressreporter.h"
+#include "tgt/logmanager.h"
+#include "tgt/assert.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace voreen {
+
+const size_t RandomWalkerMultigrid::COARSEST_LEVEL_SIZE = 512;
+const int RandomWalkerMultigrid::NUM_SMOOTHING_STEPS = 2;
+const int RandomWalkerMultigrid::NUM_COARSEST_SMOOTHING_STEPS = 16;
+const float RandomWalkerMultigrid::COARSE_CORRECTION_SCALE = 1.5f;
+const std::string RandomWalkerMultigrid::loggerCat_("voreen.RandomWalker.RandomWalkerMultigrid");
+
+namespace {
+
+// Scalar product of two voxel vectors, accumulated in double precision.
+double dot(const tgt::ivec3& dim, const float* x, const float* y) {
+    const size_t sliceSize = static_cast<size_t>(dim.x)*dim.y;
+    double sum = 0.0;
+    #ifdef VRN_MODULE_OPENMP
+    #pragma omp parallel for reduction(+:sum)
+    #endif
+    for (int z=0; z<dim.z; z++) {
+        double sliceSum = 0.0;
+        for (size_t i=z*sliceSize; i<(z+1)*sliceSize; i++)
+            sliceSum += static_cast<double>(x[i])*y[i];
+        sum += sliceSum;
+    }
+    return sum;
+}
+
+}
+
+RandomWalkerMultigrid::Level::Level(const tgt::ivec3& dim)
+    : dim_(dim)
+    , active_(tgt::hmul(tgt::svec3(dim)), 0)
+    , sink_(tgt::hmul(tgt::svec3(dim)), 0.f)
+{
+    for (int a=0; a<3; a++)
+        couplings_[a].resize(tgt::hmul(tgt::svec3(dim)), 0.f);
+}
+
+float RandomWalkerMultigrid::Level::diagonal(int x, int y, int z, size_t i) const {
+    float d = sink_[i] + couplings_[0][i] + couplings_[1][i] + couplings_[2][i];
+    if (x > 0)
+        d += couplings_[0][i-1];
+    if (y > 0)
+        d += couplings_[1][i-dim_.x];
+    if (z > 0)
+        d += couplings_[2][i-static_cast<size_t>(dim_.x)*dim_.y];
+    return d;
+}
+
+float RandomWalkerMultigrid::Level::offDiagonalProduct(int x, int y, int z, size_t i, const float* vec) const {
+    const size_t strideZ = static_cast<size_t>(dim_.x)*dim_.y;
+    float sum = 0.f;
+    if (x > 0)
+        sum += couplings_[0][i-1] * vec[i-1];
+    if (x < dim_.x-1)
+        sum += couplings_[0][i] * vec[i+1];
+    if (y > 0)
+        sum += couplings_[1][i-dim_.x] * vec[i-dim_.x];
+    if (y < dim_.y-1)
+        sum += couplings_[1][i] * vec[i+dim_.x];
+    if (z > 0)
+        sum += couplings_[2][i-strideZ] * vec[i-strideZ];
+    if (z < dim_.z-1)
+        sum += couplings_[2][i] * vec[i+strideZ];
+    return sum;
+}
+
+RandomWalkerMultigrid::RandomWalkerMultigrid(const tgt::ivec3& dim) {
+    levels_.push_back(Level(dim));
+}
+
+void RandomWalkerMultigrid::setFineStencil(size_t voxel, const tgt::vec3& couplings, float sink) {
+    tgtAssert(levels_.size() == 1, "hierarchy already built");
+    Level& fine = levels_.front();
+    tgtAssert(voxel < fine.active_.size(), "invalid voxel");
+    fine.active_[voxel] = 1;
+    fine.sink_[voxel] = sink;
+    for (int a=0; a<3; a++)
+        fine.couplings_[a][voxel] = couplings[a];
+}
+
+float RandomWalkerMultigrid::getDiagonal(size_t voxel) const {
+    const Level& fine = levels_.front();
+    tgtAssert(voxel < fine.active_.size(), "invalid voxel");
+    if (!fine.active_[voxel])
+        return 0.f;
+
+    const size_t sliceSize = static_cast<size_t>(fine.dim_.x)*fine.dim_.y;
+    int z = static_cast<int>(voxel / sliceSize);
+    int y = static_cast<int>((voxel % sliceSize) / fine.dim_.x);
+    int x = static_cast<int>(voxel % fine.dim_.x);
+    return fine.diagonal(x, y, z, voxel);
+}
+
+size_t RandomWalkerMultigrid::getNumLevels() const {
+    return levels_.size();
+}
+
+void RandomWalkerMultigrid::buildHierarchy() {
+    tgtAssert(levels_.size() == 1, "hierarchy already built");
+
+    while (tgt::hmul(tgt::svec3(levels_.back().dim_)) > COARSEST_LEVEL_SIZE && tgt::max(levels_.back().dim_) > 1) {
+        tgt::ivec3 coarseDim = (levels_.back().dim_ + tgt::ivec3(1)) / 2;
+        levels_.push_back(Level(coarseDim));
+        Level& coarse = levels_.back();
+        coarsen(levels_[levels_.size()-2], coarse);
+        coarse.x_.resize(coarse.active_.size(), 0.f);
+        coarse.b_.resize(coarse.active_.size(), 0.f);
+    }
+    LDEBUG("Multigrid hierarchy: " << levels_.size() << " levels, coarsest level: " << levels_.back().dim_);
+}
+
+void RandomWalkerMultigrid::coarsen(const Level& fine, Level& coarse) const {
+    const tgt::ivec3& fineDim = fine.dim_;
+
+    #ifdef VRN_MODULE_OPENMP
+    #pragma omp parallel for
+    #endif
+    for (int cz=0; cz<coarse.dim_.z; cz++) {
+        for (int cy=0; cy<coarse.dim_.y; cy++) {
+            for (int cx=0; cx<coarse.dim_.x; cx++) {
+                size_t ci = coarse.index(cx, cy, cz);
+                bool active = false;
+                float sink = 0.f;
+                tgt::vec3 couplings(0.f);
+                for (int z=2*cz; z<std::min(2*cz+2, fineDim.z); z++) {
+                    for (int y=2*cy; y<std::min(2*cy+2, fineDim.y); y++) {
+                        for (int x=2*cx; x<std::min(2*cx+2, fineDim.x); x++) {
+                            size_t i = fine.index(x, y, z);
+                            if (!fine.active_[i])
+                                continue;
+                            active = true;
+                            sink += fine.sink_[i];
+                            // Only couplings leaving the block remain, internal ones cancel out.
+                            if (x == 2*cx+1)
+                                couplings.x += fine.couplings_[0][i];
+                            if (y == 2*cy+1)
+                                couplings.y += fine.couplings_[1][i];
+                            if (z == 2*cz+1)
+                                couplings.z += fine.couplings_[2][i];
+                        }
+                    }
+                }
+                coarse.active_[ci] = active ? 1 : 0;
+                coarse.sink_[ci] = sink;
+                for (int a=0; a<3; a++)
+                    coarse.couplings_[a][ci] = couplings[a];
+            }
+        }
+    }
+}
+
+void RandomWalkerMultigrid::applyOperator(const Level& level, const float* x, float* y) const {
+    const tgt::ivec3& dim = level.dim_;
+
+    #ifdef VRN_MODULE_OPENMP
+    #pragma omp parallel for
+    #endif
+    for (int vz=0; vz<dim.z; vz++) {
+        for (int vy=0; vy<dim.y; vy++) {
+            size_t i = level.index(0, vy, vz);
+            for (int vx=0; vx<dim.x; vx++, i++) {
+                if (level.active_[i])
+                    y[i] = level.diagonal(vx, vy, vz, i)*x[i] - level.offDiagonalProduct(vx, vy, vz, i, x);
+                else
+                    y[i] = 0.f;
+            }
+        }
+    }
+}
+
+void RandomWalkerMultigrid::smooth(const Level& level, const float* b, float* x, int color) const {
+    const tgt::ivec3& dim = level.dim_;
+
+    #ifdef VRN_MODULE_OPENMP
+    #pragma omp parallel for
+    #endif
+    for (int vz=0; vz<dim.z; vz++) {
+        for (int vy=0; vy<dim.y; vy++) {
+            for (int vx=(vy+vz+color)&1; vx<dim.x; vx+=2) {
+                size_t i = level.index(vx, vy, vz);
+                if (!level.active_[i])
+                    continue;
+                float d = level.diagonal(vx, vy, vz, i);
+                if (d > 0.f)
+                    x[i] = (b[i] + level.offDiagonalProduct(vx, vy, vz, i, x)) / d;
+            }
+        }
+    }
+}
+
+void RandomWalkerMultigrid::vCycle(size_t levelIndex, const float* b, float* x) {
+    const Level& level = levels_[levelIndex];
+    std::fill_n(x, level.active_.size(), 0.f);
+
+    // Coarsest level: approximate solution by smoothing only. The color order of the
+    // second half mirrors the first one so that the cycle stays symmetric.
+    if (levelIndex == levels_.size()-1) {
+        for (int k=0; k<NUM_COARSEST_SMOOTHING_STEPS; k++) {
+            smooth(level, b, x, 0);
+            smooth(level, b, x, 1);
+        }
+        for (int k=0; k<NUM_COARSEST_SMOOTHING_STEPS; k++) {
+            smooth(level, b, x, 1);
+            smooth(level, b, x, 0);
+        }
+        return;
+    }
+
+    // pre-smoothing
+    for (int k=0; k<NUM_SMOOTHING_STEPS; k++) {
+        smooth(level, b, x, 0);
+        smooth(level, b, x, 1);
+    }
+
+    // restrict residual: b_c <= P^T (b - A*x)
+    Level& coarse = levels_[levelIndex+1];
+    const tgt::ivec3& dim = level.dim_;
+    #ifdef VRN_MODULE_OPENMP
+    #pragma omp parallel for
+    #endif
+    for (int cz=0; cz<coarse.dim_.z; cz++) {
+        for (int cy=0; cy<coarse.dim_.y; cy++) {
+            for (int cx=0; cx<coarse.dim_.x; cx++) {
+                float residual = 0.f;
+                for (int vz=2*cz; vz<std::min(2*cz+2, dim.z); vz++) {
+                    for (int vy=2*cy; vy<std::min(2*cy+2, dim.y); vy++) {
+                        for (int vx=2*cx; vx<std::min(2*cx+2, dim.x); vx++) {
+                            size_t i = level.index(vx, vy, vz);
+                            if (level.active_[i])
+                                residual += b[i] - level.diagonal(vx, vy, vz, i)*x[i] + level.offDiagonalProduct(vx, vy, vz, i, x);
+                        }
+                    }
+                }
+                coarse.b_[coarse.index(cx, cy, cz)] = residual;
+            }
+        }
+    }
+
+    vCycle(levelIndex+1, coarse.b_.data(), coarse.x_.data());
+
+    // prolongate correction: x <= x + s*P*x_c
+    // (Piecewise constant prolongation underestimates smooth errors, hence the over-correction.)
+    #ifdef VRN_MODULE_OPENMP
+    #pragma omp parallel for
+    #endif
+    for (int vz=0; vz<dim.z; vz++) {
+        for (int vy=0; vy<dim.y; vy++) {
+            size_t i = level.index(0, vy, vz);
+            for (int vx=0; vx<dim.x; vx++, i++) {
+                if (level.active_[i])
+                    x[i] += COARSE_CORRECTION_SCALE * coarse.x_[coarse.index(vx/2, vy/2, vz/2)];
+            }
+        }
+    }
+
+    // post-smoothing in reverse color order
+    for (int k=0; k<NUM_SMOOTHING_STEPS; k++) {
+        smooth(level, b, x, 1);
+        smooth(level, b, x, 0);
+    }
+}
+
+int RandomWalkerMultigrid::solve(const float* rhs, float* solution, float threshold, int maxIterations, ProgressReporter* progress) {
+    tgtAssert(rhs && solution, "null pointer passed");
+
+    const Level& fine = levels_.front();
+    const tgt::ivec3& dim = fine.dim_;
+    const size_t numVoxels = fine.active_.size();
+    const size_t sliceSize = static_cast<size_t>(dim.x)*dim.y;
+
+    std::vector<float> r(numVoxels);
+    std::vector<float> p(numVoxels);
+    std::vector<float> q(numVoxels);
+    std::vector<float> z(numVoxels);
+
+    // r <= b - A*x_0
+    for (size_t i=0; i<numVoxels; i++) {
+        if (!fine.active_[i])
+            solution[i] = 0.f;
+    }
+    applyOperator(fine, solution, q.data());
+    for (size_t i=0; i<numVoxels; i++)
+        r[i] = fine.active_[i] ? rhs[i] - q[i] : 0.f;
+
+    if (std::sqrt(dot(dim, r.data(), r.data())) < threshold)
+        return 0;
+
+    // p <= M^-1 * r
+    vCycle(0, r.data(), z.data());
+    p = z;
+    double rz = dot(dim, r.data(), z.data());
+
+    int iteration = 0;
+    while (iteration < maxIterations) {
+        if (progress)
+            progress->setProgress(static_cast<float>(iteration)/maxIterations);
+
+        iteration++;
+
+        // q <= A*p
+        applyOperator(fine, p.data(), q.data());
+        float alpha = static_cast<float>(rz / dot(dim, p.data(), q.data()));
+
+        // x <= x + alpha*p, r <= r - alpha*q
+        double rr = 0.0;
+        #ifdef VRN_MODULE_OPENMP
+        #pragma omp parallel for reduction(+:rr)
+        #endif
+        for (int vz=0; vz<dim.z; vz++) {
+            double sliceSum = 0.0;
+            for (size_t i=vz*sliceSize; i<(vz+1)*sliceSize; i++) {
+                solution[i] += alpha*p[i];
+                r[i] -= alpha*q[i];
+                sliceSum += static_cast<double>(r[i])*r[i];
+            }
+            rr += sliceSum;
+        }
+
+        if (std::sqrt(rr) < threshold)
+            break;
+
+        // z <= M^-1 * r
+        vCycle(0, r.data(), z.data());
+        double rzNew = dot(dim, r.data(), z.data());
+        float beta = static_cast<float>(rzNew / rz);
+        rz = rzNew;
+
+        // p <= z + beta*p
+        #ifdef VRN_MODULE_OPENMP
+        #pragma omp parallel for
+        #endif
+        for (int vz=0; vz<dim.z; vz++) {
+            for (size_t i=vz*sliceSize; i<(vz+1)*sliceSize; i++)
+                p[i] = z[i] + beta*p[i];
+        }
+    }
+    if (progress)
+        progress->setProgress(1.f);
+
+    return iteration;
+}
+
+} // namespace
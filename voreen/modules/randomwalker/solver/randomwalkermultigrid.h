@@ -0,0 +1,138 @@
+/***********************************************************************************
+ *                                                                                 *
+ * Voreen - The Volume Rendering Engine                                            *
+ *                                                                                 *
+ * Copyright (C) 2005-2024 University of Muenster, Germany,                        *
+ * Department of Computer Science.                                                 *
+ * For a list of authors please refer to the file "CREDITS.txt".                   *
+ *                                                                                 *
+ * This file is part of the Voreen software package. Voreen is free software:      *
+ * you can redistribute it and/or modify it under the terms of the GNU General     *
+ * Public License version 2 as published by the Free Software Foundation.          *
+ *                                                                                 *
+ * Voreen is distributed in the hope that it will be useful, but WITHOUT ANY       *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR   *
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.      *
+ *                                                                                 *
+ * You should have received a copy of the GNU General Public License in the file   *
+ * "LICENSE.txt" along with this file. If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                                 *
+ * For non-commercial academic use see the license exception specified in the file *
+ * "LICENSE-academic.txt". To get information about commercial licensing please    *
+ * contact the authors.                                                            *
+ *                                                                                 *
+ ***********************************************************************************/
+
+#ifndef VRN_RANDOMWALKERMULTIGRID_H
+#define VRN_RANDOMWALKERMULTIGRID_H
+
+#include "tgt/vector.h"
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace voreen {
+
+class ProgressReporter;
+
+/**
+ * Matrix-free representation of the random walker equation system on the voxel grid,
+ * solved by a conjugate gradient solver that is preconditioned with a multigrid V-cycle.
+ *
+ * In contrast to the EllpackMatrix based system, no matrix is stored: Each level only holds the
+ * 7-point stencil in form of the couplings (edge weights) to the +x/+y/+z neighbors and the
+ * coupling to seed voxels ("sink"), from which the diagonal is derived on the fly. All vectors are
+ * indexed by voxel; seed voxels are inactive and always hold 0.
+ *
+ * Coarse levels are obtained by aggregating 2x2x2 blocks with a piecewise constant prolongation P.
+ * The Galerkin operator P^T A P of a (Dirichlet-) graph Laplacian again is a 7-point stencil of
+ * the same form, so all levels share the same representation and smoother (red-black Gauss-Seidel).
+ * Pre- and post-smoothing are performed in opposite color order and the coarse grid correction is
+ * only scaled by a constant, which keeps the preconditioner symmetric as required by CG.
+ */
+class RandomWalkerMultigrid {
+public:
+    /// Creates the (inactive) fine level for a voxel grid of the given dimensions.
+    RandomWalkerMultigrid(const tgt::ivec3& dim);
+
+    /**
+     * Defines the stencil of an unseeded voxel of the fine level.
+     * May be called concurrently for different voxels.
+     *
+     * @param couplings edge weights to the +x/+y/+z neighbors, 0 if the neighbor is a seed or outside the volume
+     * @param sink sum of the edge weights to neighboring seed voxels
+     */
+    void setFineStencil(size_t voxel, const tgt::vec3& couplings, float sink);
+
+    /// Returns the diagonal entry of the system matrix for the passed voxel (0 for seeds).
+    float getDiagonal(size_t voxel) const;
+
+    /// Builds the coarse levels. Has to be called after the fine level has been set up.
+    void buildHierarchy();
+
+    /// Returns the number of levels (including the fine level).
+    size_t getNumLevels() const;
+
+    /**
+     * Solves the system using the multigrid preconditioned conjugate gradient method.
+     *
+     * @param rhs right hand side, indexed by voxel
+     * @param solution initial guess, receives the result. Indexed by voxel.
+     * @param threshold the iteration stops when the euclidean norm of the residual falls below this value
+     * @param maxIterations maximum number of CG iterations
+     *
+     * @return the number of performed iterations
+     */
+    int solve(const float* rhs, float* solution, float threshold, int maxIterations, ProgressReporter* progress = nullptr);
+
+    /// Number of voxels of the coarsest level below which no further coarsening is performed.
+    static const size_t COARSEST_LEVEL_SIZE;
+
+private:
+    struct Level {
+        tgt::ivec3 dim_;
+        std::vector<uint8_t> active_;
+        std::vector<float> sink_;
+        std::vector<float> couplings_[3];
+
+        // Work buffers of the coarse levels
+        std::vector<float> x_;
+        std::vector<float> b_;
+
+        Level(const tgt::ivec3& dim);
+
+        size_t index(int x, int y, int z) const {
+            return (static_cast<size_t>(z)*dim_.y + y)*dim_.x + x;
+        }
+
+        /// Sum of all couplings and the sink of an active voxel
+        float diagonal(int x, int y, int z, size_t i) const;
+
+        /// Sum of the couplings times the neighbor values of x
+        float offDiagonalProduct(int x, int y, int z, size_t i, const float* vec) const;
+    };
+
+    /// y <= A*x on the passed level
+    void applyOperator(const Level& level, const float* x, float* y) const;
+
+    /// Red-black Gauss-Seidel half sweep updating all active voxels of the passed color
+    void smooth(const Level& level, const float* b, float* x, int color) const;
+
+    /// Builds the next coarser level by aggregation of 2x2x2 blocks of the passed level
+    void coarsen(const Level& fine, Level& coarse) const;
+
+    /// Performs a V-cycle approximating A^{-1}b for the passed level, starting with x = 0
+    void vCycle(size_t levelIndex, const float* b, float* x);
+
+    std::vector<Level> levels_;
+
+    static const int NUM_SMOOTHING_STEPS;
+    static const int NUM_COARSEST_SMOOTHING_STEPS;
+    static const float COARSE_CORRECTION_SCALE;
+    static const std::string loggerCat_;
+};
+
+} // namespace
+
+#endif
@@ -27,6 +27,7 @@
 
 #include "randomwalkerseeds.h"
 #include "randomwalkerweights.h"
+#include "randomwalkermultigrid.h"
 
 #include "voreen/core/datastructures/volume/volumeram.h"
 #include "voreen/core/datastructures/volume/volume.h"
@@ -42,6 +43,7 @@ RandomWalkerSolver::RandomWalkerSolver(const VolumeBase* volume,
     seeds_(seeds),
     edgeWeights_(edgeWeights),
     mat_(),
+    multigrid_(),
     vec_(0),
     volIndexToRow_(0),
     solution_(0),
@@ -68,7 +70,7 @@ RandomWalkerSolver::~RandomWalkerSolver() {
     seeds_ = 0;
 }
 
-void RandomWalkerSolver::setupEquationSystem(ProgressReporter& progress) {
+void RandomWalkerSolver::setupEquationSystem(ProgressReporter& progress, bool matrixFree) {
 
     progress.setProgress(0.0f);
 
@@ -94,29 +96,42 @@ void RandomWalkerSolver::setupEquationSystem(ProgressReporter& progress) {
 
     size_t systemSize = numVoxels_ - numSeeds_;
 
-    // initialize matrix
-    mat_.setDimensions(systemSize, systemSize, 7);
-    try {
-        mat_.initializeBuffers();
+    // initialize matrix or stencil representation
+    if (matrixFree) {
+        try {
+            multigrid_.reset(new RandomWalkerMultigrid(volDim_));
+        }
+        catch (std::bad_alloc&) {
+            throw VoreenException("Bad allocation during creation of matrix-free system");
+        }
     }
-    catch (VoreenException& e) {
-        throw VoreenException("Failed to set up matrix: " + std::string(e.what()));
+    else {
+        mat_.setDimensions(systemSize, systemSize, 7);
+        try {
+            mat_.initializeBuffers();
+        }
+        catch (VoreenException& e) {
+            throw VoreenException("Failed to set up matrix: " + std::string(e.what()));
+        }
     }
 
-    // initialize vector
+    // initialize vector (indexed by voxel for matrix-free systems)
+    size_t vecSize = matrixFree ? numVoxels_ : systemSize;
     try {
-        vec_ = new float[systemSize];
+        vec_ = new float[vecSize];
     }
     catch (std::bad_alloc&) {
         throw VoreenException("Bad allocation during creation of vec buffer");
     }
-    for (size_t i=0; i<systemSize; i++)
+    for (size_t i=0; i<vecSize; i++)
         vec_[i] = 0.f;
 
     // compute mapping from voxel index to row index
     // (leaving out seed voxels)
-    computeVolIndexToRowMapping(seeds_);
-    tgtAssert(volIndexToRow_, "volIndexToRowBuffer empty");
+    if (!matrixFree) {
+        computeVolIndexToRowMapping(seeds_);
+        tgtAssert(volIndexToRow_, "volIndexToRowBuffer empty");
+    }
 
     // iterate over volume and compute edge weights for each voxel
     ThreadedTaskProgressReporter parallelProgress(progress, volDim_.z);
@@ -132,7 +147,10 @@ void RandomWalkerSolver::setupEquationSystem(ProgressReporter& progress) {
         }
         for (int y=0; y<volDim_.y; y++) {
             for (int x=0; x<volDim_.x; x++) {
-                edgeWeights_.processVoxel(tgt::ivec3(x, y, z), seeds_, mat_, vec_, volIndexToRow_, mat_mutex, vec_mutex);
+                if (matrixFree)
+                    edgeWeights_.processVoxel(tgt::ivec3(x, y, z), seeds_, *multigrid_, vec_);
+                else
+                    edgeWeights_.processVoxel(tgt::ivec3(x, y, z), seeds_, mat_, vec_, volIndexToRow_, mat_mutex, vec_mutex);
             }
         }
         if(parallelProgress.reportStepDone()) {
@@ -146,6 +164,15 @@ void RandomWalkerSolver::setupEquationSystem(ProgressReporter& progress) {
         throw boost::thread_interrupted();
     }
 
+    if (matrixFree) {
+        try {
+            multigrid_->buildHierarchy();
+        }
+        catch (std::bad_alloc&) {
+            throw VoreenException("Bad allocation during creation of multigrid hierarchy");
+        }
+    }
+
     state_ = Setup;
 }
 
@@ -155,40 +182,57 @@ int RandomWalkerSolver::solve(const VoreenBlas* voreenBlas, float* oldSystemSolu
 
     if (state_ != Setup)
         throw VoreenException("System is not setup or has already been solved");
-    tgtAssert(mat_.isInitialized(), "matrix not initialized");
+    tgtAssert(mat_.isInitialized() || multigrid_, "matrix not initialized");
     tgtAssert(vec_, "vector not created");
-    tgtAssert(volIndexToRow_, "volIndexToRow buffer vector not created");
+    tgtAssert(volIndexToRow_ || multigrid_, "volIndexToRow buffer vector not created");
     tgtAssert(!solution_, "solution buffer already created");
 
     size_t systemSize = getSystemSize();
 
-    // create solution buffer
+    // create solution buffer (indexed by voxel for matrix-free systems)
+    size_t solutionSize = multigrid_ ? numVoxels_ : systemSize;
     try {
-        solution_ = new float[systemSize];
+        solution_ = new float[solutionSize];
     }
     catch (std::bad_alloc&) {
         throw VoreenException("Bad allocation during creation of solution buffer");
     }
 
-    float* initialization;
-    if(oldSystemSolution) {
-        initialization = oldSystemSolution;
-    } else {
-        try {
-            initialization = new float[systemSize];
-            std::fill_n(initialization, systemSize, 0.5f);
-        } catch (std::bad_alloc&) {
-            throw VoreenException("Bad allocation during creation of initialization buffer");
+    int iterations = 0;
+    if (multigrid_) {
+        // The solution buffer serves as initial guess. Seed voxels are inactive and have to hold 0.
+        size_t row = 0;
+        for (size_t i=0; i<numVoxels_; i++) {
+            if (seeds_->isSeedPoint(i))
+                solution_[i] = 0.f;
+            else
+                solution_[i] = oldSystemSolution ? oldSystemSolution[row++] : 0.5f;
         }
+
+        iterations = multigrid_->solve(vec_, solution_, errorThreshold, maxIterations, &progress);
     }
+    else {
+        float* initialization;
+        if(oldSystemSolution) {
+            initialization = oldSystemSolution;
+        } else {
+            try {
+                initialization = new float[systemSize];
+                std::fill_n(initialization, systemSize, 0.5f);
+            } catch (std::bad_alloc&) {
+                throw VoreenException("Bad allocation during creation of initialization buffer");
+            }
+        }
 
-    int iterations = voreenBlas->sSpConjGradEll(mat_, vec_, solution_, initialization,
-        preConditioner, errorThreshold, maxIterations, &progress);
-    state_ = Solved;
-    if(!oldSystemSolution) {
-        // Slightly ugly: We only own the initialization if we have no oldSystemSolution
-        delete[] initialization;
+        iterations = voreenBlas->sSpConjGradEll(mat_, vec_, solution_, initialization,
+            preConditioner, errorThreshold, maxIterations, &progress);
+
+        if(!oldSystemSolution) {
+            // Slightly ugly: We only own the initialization if we have no oldSystemSolution
+            delete[] initialization;
+        }
     }
+    state_ = Solved;
     return iterations;
 }
 
@@ -221,6 +265,8 @@ float RandomWalkerSolver::getProbabilityValue(size_t voxel) const {
 
     if (seeds_->isSeedPoint(voxel))
         return seeds_->getSeedValue(voxel);
+    else if (multigrid_)
+        return solution_[voxel];
     else
         return solution_[volIndexToRow_[voxel]];
 }
@@ -243,6 +289,16 @@ bool RandomWalkerSolver::isSeedPoint(size_t voxel) const {
     return seeds_->isSeedPoint(voxel);
 }
 
+float RandomWalkerSolver::getEdgeWeightSum(size_t voxel) const {
+    tgtAssert(state_ >= Setup, "system has not been setup");
+    tgtAssert(!isSeedPoint(voxel), "seed voxel passed");
+
+    if (multigrid_)
+        return multigrid_->getDiagonal(voxel);
+    else
+        return mat_.getValue(volIndexToRow_[voxel], volIndexToRow_[voxel]);
+}
+
 float RandomWalkerSolver::getSeedValue(size_t voxel) const {
     return seeds_->getSeedValue(voxel);
 }
@@ -264,6 +320,7 @@ size_t RandomWalkerSolver::getNumVoxels() const {
 }
 
 size_t RandomWalkerSolver::getRowIndex(size_t voxel) const {
+    tgtAssert(volIndexToRow_, "no row indices for matrix-free systems");
     return volIndexToRow_[voxel];
 }
 
@@ -293,6 +350,10 @@ RandomWalkerSolver::SystemState RandomWalkerSolver::getSystemState() const {
     return state_;
 }
 
+bool RandomWalkerSolver::isMatrixFree() const {
+    return multigrid_ != nullptr;
+}
+
 tgt::vec2 RandomWalkerSolver::getSeedRange() const {
     tgtAssert(state_ >= Setup, "system has not been setup");
     return seeds_->getSeedRange();
@@ -33,12 +33,14 @@
 
 #include <string>
 #include <ostream>
+#include <memory>
 
 namespace voreen {
 
 class Volume;
 class RandomWalkerSeeds;
 class RandomWalkerWeights;
+class RandomWalkerMultigrid;
 
 /**
  * Framework for computing a 3D random walker solution on a voxel grid
@@ -55,6 +57,10 @@ class RandomWalkerWeights;
  * Note: Due to the heavy computational load involved in solving the random walker problem
  * on a 3D grid, we strongly recommend to use the OpenCL implementation!
  *
+ * Alternatively, the equation system can be set up matrix-free (see RandomWalkerMultigrid). It is then
+ * solved on the CPU by a multigrid preconditioned conjugate gradient solver, which requires far less
+ * memory and iterations than the VoreenBlas solvers operating on the EllpackMatrix.
+ *
  * The solver undergoes the life cycle initialization -> problem setup -> solved. Some operations
  * are only permitted in certain stages. If an error occurs in a transition between two stages,
  * the solver enters the failure state.
@@ -92,9 +98,12 @@ public:
     /**
      * Constructs the random walker equation system. On success, the solver enters the state 'Setup'.
      *
+     * @param matrixFree if true, no EllpackMatrix is assembled. Instead, the system is represented
+     *        by its stencil on the voxel grid and solved by multigrid preconditioned CG.
+     *
      * @throw VoreenException if setup has failed
      */
-    void setupEquationSystem(ProgressReporter& progress);
+    void setupEquationSystem(ProgressReporter& progress, bool matrixFree = false);
 
     /**
      * Computes the random walker solution using a conjugate gradient solver provided by the passed
@@ -103,6 +112,9 @@ public:
      * The computation finishes when either the equation error falls below the specified threshold or the
      * maximum number of conjugate gradient iterations is reached. The solver then enters the state 'Solved'.
      *
+     * For matrix-free systems, voreenBlas and preConditioner are ignored.
+     * oldSystemSolution is always indexed by equation, i.e., it contains one value per unseeded voxel.
+     *
      * @see VoreenBlasCPU, VoreenBlasMP, VoreenBlasCL
      *
      * @param voreenBlas VoreenBlas implementation to use for solving the equation system
@@ -118,10 +130,13 @@ public:
     /// Returns the current state of the solver.
     SystemState getSystemState() const;
 
+    /// Returns whether the equation system has been set up without assembling a matrix.
+    bool isMatrixFree() const;
+
     /**
      * Returns the quadratic matrix representing the random walker equation system.
      * The matrix contains one row/col per unseeded voxel.
-     * Only allowed in state >= 'Setup'.
+     * Only allowed in state >= 'Setup' and if the system is not matrix-free.
      */
     const EllpackMatrix<float>& getMatrix() const;
     EllpackMatrix<float>& getMatrix();
@@ -129,6 +144,7 @@ public:
     /**
      * Returns the vector of the random walker equation system.
      * The number of vector elements equals the number of unseeded voxels.
+     * For matrix-free systems, the vector is indexed by voxel instead and holds 0 for seed voxels.
      * Only allowed in state >= 'Setup'.
      */
     const float* getVector() const;
@@ -137,6 +153,7 @@ public:
     /**
      * Returns the random walker solution consisting of a vector that contains
      * one probability value for each unseeded voxel.
+     * For matrix-free systems, the vector is indexed by voxel instead and holds 0 for seed voxels.
      * Only allowed in state 'Solved'.
      */
     const float* getSolution() const;
@@ -153,6 +170,12 @@ public:
     /// Returns whether the voxel at the passed index is defined to be a seed.
     bool isSeedPoint(size_t voxel) const;
 
+    /**
+     * Returns the sum of the weights of all edges incident to the specified unseeded voxel,
+     * i.e., its diagonal entry of the system matrix. Only allowed in state >= 'Setup'.
+     */
+    float getEdgeWeightSum(size_t voxel) const;
+
     /// Returns the seed value of the specified voxel, or -1.0 if the voxel is not a seed.
     float getSeedValue(size_t voxel) const;
 
@@ -176,7 +199,7 @@ public:
 
     /**
      * Returns the index of the equation that represents the voxel with the specified id.
-     * For seed voxels -1 is returned.
+     * For seed voxels -1 is returned. Not available for matrix-free systems.
      */
     size_t getRowIndex(size_t voxel) const;
 
@@ -204,8 +227,9 @@ private:
     //size_t opacityBufferSize_;
 
     EllpackMatrix<float> mat_;
+    std::unique_ptr<RandomWalkerMultigrid> multigrid_; ///< replaces mat_ for matrix-free systems
     float* vec_;
-    size_t* volIndexToRow_;
+    size_t* volIndexToRow_;     ///< not created for matrix-free systems
     float* solution_;
 
     tgt::ivec3 volDim_;
@@ -204,6 +204,40 @@ void RandomWalkerWeights::processVoxel(const tgt::ivec3& voxel, const RandomWalk
     mat.setValue(curRow, curRow, weightSum);
 }
 
+void RandomWalkerWeights::processVoxel(const tgt::ivec3& voxel, const RandomWalkerSeeds* seeds, RandomWalkerMultigrid& system, float* vec) {
+    tgtAssert(seeds, "no seed definer passed");
+    tgtAssert(vec, "no vector passed");
+
+    size_t index = volumeCoordsToIndex(voxel, volDim_);
+    if (seeds->isSeedPoint(index))
+        return;
+
+    tgt::vec3 couplings(0.f);
+    float sink = 0.f;
+    float seedSum = 0.f;
+    for (int axis=0; axis<3; axis++) {
+        for (int dir=-1; dir<=1; dir+=2) {
+            tgt::ivec3 neighbor = voxel;
+            neighbor[axis] += dir;
+            if (neighbor[axis] < 0 || neighbor[axis] >= volDim_[axis])
+                continue;
+
+            float weight = weightFun_->edgeWeight(voxel, neighbor);
+            if (seeds->isSeedPoint(neighbor)) {
+                sink += weight;
+                seedSum += weight * seeds->getSeedValue(neighbor);
+            }
+            else if (dir > 0) {
+                // couplings to the -x/-y/-z neighbors are defined by the respective neighbor
+                couplings[axis] = weight;
+            }
+        }
+    }
+
+    system.setFineStencil(index, couplings, sink);
+    vec[index] = seedSum;
+}
+
 RandomWalkerVoxelAccessorVolume::RandomWalkerVoxelAccessorVolume(const VolumeBase& volume)
     : vol_(volume.getRepresentation<VolumeRAM>())
     , rwm_(volume.getRealWorldMapping())
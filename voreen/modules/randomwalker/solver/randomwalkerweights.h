@@ -28,6 +28,7 @@
 
 #include "randomwalkersolver.h"
 #include "randomwalkerseeds.h"
+#include "randomwalkermultigrid.h"
 #include "voreen/core/datastructures/transfunc/1d/transfunc1d.h"
 
 #include <boost/thread/mutex.hpp>
@@ -134,6 +135,13 @@ public:
 
     virtual void processVoxel(const tgt::ivec3& voxel, const RandomWalkerSeeds* seeds, EllpackMatrix<float>& mat, float* vec, const size_t* volumeIndexToRowTable, boost::mutex& mat_mutex, boost::mutex& vec_mutex);
 
+    /**
+     * Matrix-free counterpart of the above: Defines the stencil of the passed voxel in the fine level
+     * of the passed system and writes the seed contribution to vec, which is indexed by voxel.
+     * Only data of the passed voxel is written, so no locking is required.
+     */
+    virtual void processVoxel(const tgt::ivec3& voxel, const RandomWalkerSeeds* seeds, RandomWalkerMultigrid& system, float* vec);
+
 protected:
     std::unique_ptr<RandomWalkerEdgeWeight> weightFun_;
     tgt::ivec3 volDim_;
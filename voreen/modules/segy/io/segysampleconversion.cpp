@@ -0,0 +1,231 @@
+/***********************************************************************************
+ *                                                                                 *
+ * Voreen - The Volume Rendering Engine                                            *
+ *                                                                                 *
+ * Copyright (C) 2005-2024 University of Muenster, Germany,                        *
+ * Department of Computer Science.                                                 *
+ * For a list of authors please refer to the file "CREDITS.txt".                   *
+ *                                                                                 *
+ * This file is part of the Voreen software package. Voreen is free software:      *
+ * you can redistribute it and/or modify it under the terms of the GNU General     *
+ * Public License version 2 as published by the Free Software Foundation.          *
+ *                                                                                 *
+ * Voreen is distributed in the hope that it will be useful, but WITHOUT ANY       *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR   *
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.      *
+ *                                                                                 *
+ * You should have received a copy of the GNU General Public License in the file   *
+ * "LICENSE.txt" along with this file. If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                                 *
+ * For non-commercial academic use see the license exception specified in the file *
+ * "LICENSE-academic.txt". To get information about commercial licensing please    *
+ * contact the authors.                                                            *
+ *                                                                                 *
+ ***********************************************************************************/
+
+#include "segysampleconversion.h"
+
+#include "tgt/logmanager.h"
+
+#include <cmath>
+#include <cstring>
+#include <stdint.h>
+
+// Runtime dispatched AVX2 kernels are only available for GCC compatible compilers targeting x86.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VRN_SEGY_X86_KERNELS
+#include <immintrin.h>
+#define VRN_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace voreen {
+
+const std::string SEGYSampleConversion::loggerCat_("voreen.segy.SEGYSampleConversion");
+
+namespace {
+
+//-------------------------------------------------------------------------------------------------
+// Generic kernels, also used for the remainders of the vectorized ones
+
+inline uint32_t loadBigEndian32(const char* src) {
+    const unsigned char* b = reinterpret_cast<const unsigned char*>(src);
+    return (static_cast<uint32_t>(b[0]) << 24) | (static_cast<uint32_t>(b[1]) << 16)
+         | (static_cast<uint32_t>(b[2]) << 8) | static_cast<uint32_t>(b[3]);
+}
+
+/**
+ * IBM floats are sign * 0.fraction * 16^(exponent-64) with a 24 bit fraction, i.e.,
+ * sign * fraction * 2^(4*exponent - 280). The product is exact in double precision,
+ * so the only rounding happens in the final conversion to float.
+ */
+inline float ibmToIEEE(uint32_t ibm) {
+    double magnitude = std::ldexp(static_cast<double>(ibm & 0x00FFFFFFu), 4*static_cast<int>((ibm >> 24) & 0x7Fu) - 280);
+    float result = static_cast<float>(magnitude);
+    return (ibm & 0x80000000u) ? -result : result;
+}
+
+void convertIBMFloatGeneric(const char* src, float* dst, size_t numSamples) {
+    for (size_t i=0; i<numSamples; ++i)
+        dst[i] = ibmToIEEE(loadBigEndian32(src + 4*i));
+}
+
+void swapBytes32Generic(const char* src, void* dst, size_t numSamples) {
+    uint32_t* out = static_cast<uint32_t*>(dst);
+    for (size_t i=0; i<numSamples; ++i)
+        out[i] = loadBigEndian32(src + 4*i);
+}
+
+void swapBytes16Generic(const char* src, void* dst, size_t numSamples) {
+    const unsigned char* b = reinterpret_cast<const unsigned char*>(src);
+    uint16_t* out = static_cast<uint16_t*>(dst);
+    for (size_t i=0; i<numSamples; ++i)
+        out[i] = static_cast<uint16_t>((b[2*i] << 8) | b[2*i+1]);
+}
+
+#ifdef VRN_SEGY_X86_KERNELS
+
+//-------------------------------------------------------------------------------------------------
+// AVX2 kernels: 8 4-byte samples or 16 2-byte samples per register.
+
+VRN_TARGET_AVX2
+inline __m256i swapMask32() {
+    return _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+}
+
+VRN_TARGET_AVX2
+inline __m256i swapMask16() {
+    return _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                            1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+}
+
+/// fraction * 2^(4*exponent - 280) for four samples, the scale factor is constructed from its double exponent bits.
+VRN_TARGET_AVX2
+inline __m128 scaleFraction(__m128i fraction, __m128i biasedExponent) {
+    __m256d scale = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_cvtepu32_epi64(biasedExponent), 52));
+    return _mm256_cvtpd_ps(_mm256_mul_pd(_mm256_cvtepi32_pd(fraction), scale));
+}
+
+VRN_TARGET_AVX2
+void convertIBMFloatAVX2(const char* src, float* dst, size_t numSamples) {
+    const __m256i mask = swapMask32();
+    const __m256i fractionMask = _mm256_set1_epi32(0x00FFFFFF);
+    const __m256i exponentMask = _mm256_set1_epi32(0x7F);
+    const __m256i signMask = _mm256_set1_epi32(static_cast<int>(0x80000000u));
+    // double exponent bits of 2^(4*exponent - 280): 4*exponent - 280 + 1023
+    const __m256i exponentBias = _mm256_set1_epi32(1023 - 280);
+
+    size_t i = 0;
+    for (; i+8 <= numSamples; i += 8) {
+        __m256i ibm = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 4*i)), mask);
+        __m256i fraction = _mm256_and_si256(ibm, fractionMask);
+        __m256i exponent = _mm256_add_epi32(_mm256_slli_epi32(_mm256_and_si256(_mm256_srli_epi32(ibm, 24), exponentMask), 2), exponentBias);
+
+        __m128 low = scaleFraction(_mm256_castsi256_si128(fraction), _mm256_castsi256_si128(exponent));
+        __m128 high = scaleFraction(_mm256_extracti128_si256(fraction, 1), _mm256_extracti128_si256(exponent, 1));
+        __m256 result = _mm256_insertf128_ps(_mm256_castps128_ps256(low), high, 1);
+        result = _mm256_or_ps(result, _mm256_castsi256_ps(_mm256_and_si256(ibm, signMask)));
+        _mm256_storeu_ps(dst + i, result);
+    }
+    convertIBMFloatGeneric(src + 4*i, dst + i, numSamples - i);
+}
+
+VRN_TARGET_AVX2
+void swapBytes32AVX2(const char* src, void* dst, size_t numSamples) {
+    const __m256i mask = swapMask32();
+    char* out = static_cast<char*>(dst);
+    size_t i = 0;
+    for (; i+8 <= numSamples; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 4*i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 4*i), _mm256_shuffle_epi8(v, mask));
+    }
+    swapBytes32Generic(src + 4*i, out + 4*i, numSamples - i);
+}
+
+VRN_TARGET_AVX2
+void swapBytes16AVX2(const char* src, void* dst, size_t numSamples) {
+    const __m256i mask = swapMask16();
+    char* out = static_cast<char*>(dst);
+    size_t i = 0;
+    for (; i+16 <= numSamples; i += 16) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 2*i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2*i), _mm256_shuffle_epi8(v, mask));
+    }
+    swapBytes16Generic(src + 2*i, out + 2*i, numSamples - i);
+}
+
+#endif // VRN_SEGY_X86_KERNELS
+
+//-------------------------------------------------------------------------------------------------
+// Dispatch
+
+struct KernelTable {
+    SEGYSampleConversion::InstructionSet instructionSet_;
+    void (*convertIBMFloat_)(const char*, float*, size_t);
+    void (*swapBytes32_)(const char*, void*, size_t);
+    void (*swapBytes16_)(const char*, void*, size_t);
+};
+
+KernelTable createKernelTable(SEGYSampleConversion::InstructionSet instructionSet) {
+    KernelTable table = { SEGYSampleConversion::GENERIC, &convertIBMFloatGeneric, &swapBytes32Generic, &swapBytes16Generic };
+#ifdef VRN_SEGY_X86_KERNELS
+    if (instructionSet == SEGYSampleConversion::AVX2) {
+        KernelTable avx2 = { SEGYSampleConversion::AVX2, &convertIBMFloatAVX2, &swapBytes32AVX2, &swapBytes16AVX2 };
+        table = avx2;
+    }
+#endif
+    return table;
+}
+
+KernelTable& getKernelTable() {
+    static KernelTable table = createKernelTable(SEGYSampleConversion::getSupportedInstructionSet());
+    return table;
+}
+
+} // namespace anonymous
+
+SEGYSampleConversion::InstructionSet SEGYSampleConversion::getInstructionSet() {
+    return getKernelTable().instructionSet_;
+}
+
+SEGYSampleConversion::InstructionSet SEGYSampleConversion::getSupportedInstructionSet() {
+#ifdef VRN_SEGY_X86_KERNELS
+    // Also checks whether the OS saves the extended registers.
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return AVX2;
+#endif
+    return GENERIC;
+}
+
+void SEGYSampleConversion::setInstructionSet(InstructionSet instructionSet) {
+    InstructionSet supported = getSupportedInstructionSet();
+    if (instructionSet > supported) {
+        LWARNING(getInstructionSetName(instructionSet) << " not supported by the CPU, using " << getInstructionSetName(supported));
+        instructionSet = supported;
+    }
+    getKernelTable() = createKernelTable(instructionSet);
+}
+
+std::string SEGYSampleConversion::getInstructionSetName(InstructionSet instructionSet) {
+    switch (instructionSet) {
+    case AVX2:
+        return "AVX2";
+    default:
+        return "generic";
+    }
+}
+
+void SEGYSampleConversion::convertIBMFloat(const char* src, float* dst, size_t numSamples) {
+    getKernelTable().convertIBMFloat_(src, dst, numSamples);
+}
+
+void SEGYSampleConversion::swapBytes32(const char* src, void* dst, size_t numSamples) {
+    getKernelTable().swapBytes32_(src, dst, numSamples);
+}
+
+void SEGYSampleConversion::swapBytes16(const char* src, void* dst, size_t numSamples) {
+    getKernelTable().swapBytes16_(src, dst, numSamples);
+}
+
+} // namespace voreen
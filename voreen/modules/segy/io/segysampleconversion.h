@@ -0,0 +1,83 @@
+/***********************************************************************************
+ *                                                                                 *
+ * Voreen - The Volume Rendering Engine                                            *
+ *                                                                                 *
+ * Copyright (C) 2005-2024 University of Muenster, Germany,                        *
+ * Department of Computer Science.                                                 *
+ * For a list of authors please refer to the file "CREDITS.txt".                   *
+ *                                                                                 *
+ * This file is part of the Voreen software package. Voreen is free software:      *
+ * you can redistribute it and/or modify it under the terms of the GNU General     *
+ * Public License version 2 as published by the Free Software Foundation.          *
+ *                                                                                 *
+ * Voreen is distributed in the hope that it will be useful, but WITHOUT ANY       *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR   *
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.      *
+ *                                                                                 *
+ * You should have received a copy of the GNU General Public License in the file   *
+ * "LICENSE.txt" along with this file. If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                                 *
+ * For non-commercial academic use see the license exception specified in the file *
+ * "LICENSE-academic.txt". To get information about commercial licensing please    *
+ * contact the authors.                                                            *
+ *                                                                                 *
+ ***********************************************************************************/
+
+#ifndef VRN_SEGYSAMPLECONVERSION_H
+#define VRN_SEGYSAMPLECONVERSION_H
+
+#include "voreen/core/voreencoreapi.h"
+
+#include <string>
+
+namespace voreen {
+
+/**
+ * Converts the big-endian trace samples of a SEG-Y file into native samples.
+ *
+ * The kernels are available as portable scalar code as well as in an AVX2 variant, which is
+ * selected at runtime if supported by the CPU. Both variants produce bitwise identical results.
+ * Source and destination must not overlap; neither needs to be aligned.
+ */
+class VRN_CORE_API SEGYSampleConversion {
+public:
+
+    enum InstructionSet {
+        GENERIC,
+        AVX2
+    };
+
+    /// Returns the instruction set used by the kernels.
+    static InstructionSet getInstructionSet();
+
+    /// Returns the best instruction set supported by the CPU.
+    static InstructionSet getSupportedInstructionSet();
+
+    /**
+     * Selects the instruction set to be used by the kernels, e.g., for testing.
+     * Instruction sets that are not supported by the CPU are replaced by the best supported one.
+     * Must not be called while kernels are executed by other threads.
+     */
+    static void setInstructionSet(InstructionSet instructionSet);
+
+    static std::string getInstructionSetName(InstructionSet instructionSet);
+
+    /**
+     * Converts big-endian 4-byte IBM floating-point samples into IEEE floats.
+     * Values exceeding the IEEE float range become +-infinity, tiny values are rounded to denormals or zero.
+     */
+    static void convertIBMFloat(const char* src, float* dst, size_t numSamples);
+
+    /// Copies 4-byte big-endian samples (IEEE float or integer) into native byte order.
+    static void swapBytes32(const char* src, void* dst, size_t numSamples);
+
+    /// Copies 2-byte big-endian samples into native byte order.
+    static void swapBytes16(const char* src, void* dst, size_t numSamples);
+
+private:
+    static const std::string loggerCat_;
+};
+
+} // namespace
+
+#endif
@@ -8,10 +8,12 @@
  */
 
 #include "segyvolumereader.h"
+#include "volumedisksegy.h"
 
 #include "tgt/exception.h"
 #include "tgt/filesystem.h"
 #include <sys/types.h>
+#include <algorithm>
 
 #include "voreen/core/io/progressbar.h"
 #include "voreen/core/datastructures/volume/volumeatomic.h"
@@ -58,9 +60,7 @@ namespace voreen {
     } // read
 
 
-    // >>>>>>> TO DO: update progress per upload step if required >>>>>
     // >>>>>>> TO DO: change spacing if required >>>>>>>>>>>>>>>>>>>>>>
-    // >>>>>>> TO DO: find out why converting gives better results? >>>
     // >>>>>>> TO DO: check if slice order need change >>>>>>>>>>>>>>>>
     // >>>>>>> assumming identity matrix for transformation >>>>>>>>>>>
     // --------------------------------------------------------------
@@ -68,151 +68,44 @@ namespace voreen {
         // retrieve header info:
         readHeaderInfo(fileName);
 
-        // check if we have to read only some slices instead of the whole volume.
-        if ( ! (firstSlice==0 && lastSlice==0)) {
-            if (lastSlice > firstSlice) {
-                dimensions_.z = static_cast<int>(lastSlice - firstSlice);
-            }
-        }//if
-
-        std::string info = "Loading SEG-Y file " + fileName + " ";
-
         if (dimensions_ == tgt::ivec3::zero) {
             throw tgt::CorruptedFileException("No readHints set.", fileName);
         }
 
-        FILE* fin;
-        fin = fopen(fileName.c_str(),"rb");
-
-        if (fin==NULL) {
-            throw tgt::IOException("Unable to open raw file for reading", fileName);
+        // all traces have to be present in the file
+        size_t firstTraceOffset = SEGY_TEXTUAL_HEADER_SIZE + SEGY_BINARY_HEADER_SIZE
+                                    + extendedTextualFileHeaderRecords_ * SEGY_TEXTUAL_HEADER_SIZE;
+        size_t traceSize = SEGY_TRACE_HEADER_SIZE + samplesPerDataTrace_ * sizeOfSample_;
+        if (firstTraceOffset + traceSize * dimensions_.y * dimensions_.z > tgt::FileSystem::fileSize(fileName)) {
+            throw tgt::CorruptedFileException("unexpected EOF", fileName);
         }
 
-
         // --------------------------------------------------------------------
 
-        // Now create proper volume type:
-
-        VolumeRAM* volume;
-
-        // >>>>>>>>>> assuming default spacing, i.e. 1.0 >>>>>>>>>>>>
+        // The traces are loaded lazily by the disk representation, so that surveys
+        // exceeding the main memory can be processed slice- or brick-wise.
+        VolumeDiskSEGY* diskVolume = new VolumeDiskSEGY(fileName, tgt::svec3(dimensions_), dataSampleFormat_, firstTraceOffset);
+        LINFO("Loading SEG-Y file " << fileName << " (" << diskVolume->getFormat() << ")");
 
-        if (dataSampleFormat_ == SEGY_IBM_FLOAT ||
-            dataSampleFormat_ == SEGY_IEEE_FLOAT)
-        {
-            LINFO(info << "(4-byte float)");
-            volume = new VolumeRAM_Float(dimensions_);
-        }
-        else if (dataSampleFormat_ == SEGY_INT32)
-        {
-            LINFO(info << "(4-byte int)");
-            volume = new VolumeRAM_Int32(dimensions_);
-        }
-        else if (dataSampleFormat_ == SEGY_INT16)
-        {
-            LINFO(info << "(2-byte int)");
-            volume = new VolumeRAM_Int16(dimensions_);
-        }
-        else if (dataSampleFormat_ == SEGY_INT8)
-        {
-            LINFO(info << "(1-byte int)");
-            volume = new VolumeRAM_Int8(dimensions_);
-        }
-        else {
-            fclose(fin);
-            throw tgt::CorruptedFileException("Unsupported format code # " + std::to_string(dataSampleFormat_), fileName);
-        }
-
-
-        // --------------------------------------------------------------------
-
-        // Now upload data from file into volume
-
-
-        // clear volume to be ready for uploading data from file
-        volume->clear();
-
-        if (getProgressBar()) {
-            getProgressBar()->setTitle("Loading volume");
-            getProgressBar()->setProgressMessage("Loading volume: " + tgt::FileSystem::fileName(fileName));
-        }
-
-        // >>>>>>>>>>>>> TO DO: update progress per upload step >>>>>>>>>>>
-
-        size_t offset;
-
-        // Reposition stream position indicator to first slice:
-        offset = SEGY_TEXTUAL_HEADER_SIZE + SEGY_BINARY_HEADER_SIZE
-                    + extendedTextualFileHeaderRecords_ * SEGY_TEXTUAL_HEADER_SIZE
-                    + (SEGY_TRACE_HEADER_SIZE + samplesPerDataTrace_ * sizeOfSample_) // i.e. dimension_.x
-                        * dimensions_.y // i.e. number of cross-lines
-                        * firstSlice;
-
-        fseeko (fin, offset, SEEK_SET);
-
-        //std::cout << "First slide .. position of file = " << ftell(fin) << "\n"; // >>>>>>>>>>>>> TESTING >>>>>>>>>>>
-
-        // read each trace and upload it to volume
-        for (size_t i = 0; i < (static_cast<size_t>(dimensions_.y) * static_cast<size_t>(dimensions_.z)); i++) {
-
-            //std::cout << "trace num = " << i << "\n"; // >>>>>>>>>>>>> TESTING >>>>>>>>>>>
-
-            // Reposition stream position indicator to trace data - skipping the trace header:
-            fseeko ( fin, SEGY_TRACE_HEADER_SIZE, SEEK_CUR);
-
-            //std::cout << "\t\tposition of file = " << ftell(fin) << "\n"; // >>>>>>>>>>>>> TESTING >>>>>>>>>>>
-
-            // read all samples of this trace into volume data
-            if (fread(reinterpret_cast<char*>(volume->getData())
-                      + samplesPerDataTrace_ * sizeOfSample_ * i,
-                      1, samplesPerDataTrace_ * sizeOfSample_, fin) == 0)
-                LWARNING("fread() failed");
-
-            // convert each sample value to little-endian based on its type:
-            if (dataSampleFormat_ == SEGY_IEEE_FLOAT)
-            {
-                float* samples = reinterpret_cast<float*>(volume->getData())
-                                + samplesPerDataTrace_ * i;
-
-                for (int y=0; y < samplesPerDataTrace_; y++) {
-                    endian_swap_32(&samples[y]);
-                }//for
-            }//if
-            else if (dataSampleFormat_ == SEGY_INT32)
-            {
-                int* samples = reinterpret_cast<int*>(volume->getData())
-                                + samplesPerDataTrace_ * i;
-
-                for (int y=0; y < samplesPerDataTrace_; y++) {
-                    endian_swap_32(&samples[y]);
-                }//for
-            }//else if
-            else if (dataSampleFormat_ == SEGY_INT16)
-            {
-                short* samples = reinterpret_cast<short*>(volume->getData())
-                                + samplesPerDataTrace_ * i;
-
-                for (int y=0; y < samplesPerDataTrace_; y++) {
-                    endian_swap_16(&samples[y]);
-                }//for
-            }//else if
-
-        }//for
-
-        if (lastSlice == 0) {
-            if (feof(fin) ) {
-                delete volume;
-                // throw exception
-                throw tgt::CorruptedFileException("unexpected EOF", fileName);
+        // check if we have to read only some slices instead of the whole volume.
+        VolumeRepresentation* volume = diskVolume;
+        if (lastSlice > firstSlice) {
+            if (getProgressBar()) {
+                getProgressBar()->setTitle("Loading volume");
+                getProgressBar()->setProgressMessage("Loading volume: " + tgt::FileSystem::fileName(fileName));
+            }
+            lastSlice = std::min(lastSlice, static_cast<size_t>(dimensions_.z));
+            try {
+                volume = diskVolume->loadSlices(firstSlice, lastSlice - 1);
+            }
+            catch (std::exception& e) {
+                delete diskVolume;
+                throw tgt::IOException(std::string("Unable to read slices: ") + e.what(), fileName);
             }
+            delete diskVolume;
+            dimensions_.z = static_cast<int>(lastSlice - firstSlice);
         }
 
-        fclose(fin);
-
-        // --------------------------------------------------------------------
-
-        // >>>>>>>>>>> slice order ???!!! >>>>>>>>>>>>
-
         // --------------------------------------------------------------------
 
         VolumeList* volumeList = new VolumeList();
@@ -255,6 +148,10 @@ namespace voreen {
         FILE* fin;
         fin = fopen(fileName.c_str(),"rb");
 
+        if (fin==NULL) {
+            throw tgt::IOException("Unable to open SEG-Y file for reading", fileName);
+        }
+
         size_t result; // to be used for fread() return value
 
         // --------------------------------------------------------------------
@@ -0,0 +1,232 @@
+/***********************************************************************************
+ *                                                                                 *
+ * Voreen - The Volume Rendering Engine                                            *
+ *                                                                                 *
+ * Copyright (C) 2005-2024 University of Muenster, Germany,                        *
+ * Department of Computer Science.                                                 *
+ * For a list of authors please refer to the file "CREDITS.txt".                   *
+ *                                                                                 *
+ * This file is part of the Voreen software package. Voreen is free software:      *
+ * you can redistribute it and/or modify it under the terms of the GNU General     *
+ * Public License version 2 as published by the Free Software Foundation.          *
+ *                                                                                 *
+ * Voreen is distributed in the hope that it will be useful, but WITHOUT ANY       *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR   *
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.      *
+ *                                                                                 *
+ * You should have received a copy of the GNU General Public License in the file   *
+ * "LICENSE.txt" along with this file. If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                                 *
+ * For non-commercial academic use see the license exception specified in the file *
+ * "LICENSE-academic.txt". To get information about commercial licensing please    *
+ * contact the authors.                                                            *
+ *                                                                                 *
+ ***********************************************************************************/
+
+#include "volumedisksegy.h"
+
+#include "segysampleconversion.h"
+#include "segyvolumereader.h"
+
+#include "voreen/core/datastructures/volume/volumefactory.h"
+#include "voreen/core/utils/hashing.h"
+#include "voreen/core/utils/stringutils.h"
+
+#include "tgt/filesystem.h"
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+namespace voreen {
+
+const std::string VolumeDiskSEGY::loggerCat_("voreen.segy.VolumeDiskSEGY");
+
+VolumeDiskSEGY::VolumeDiskSEGY(const std::string& filename, tgt::svec3 dimensions, int sampleFormat, size_t firstTraceOffset)
+    : VolumeDisk(getVolumeFormat(sampleFormat), dimensions)
+    , filename_(filename)
+    , sampleFormat_(sampleFormat)
+    , firstTraceOffset_(firstTraceOffset)
+    , traceSize_(0)
+    , mappedFileSize_(0)
+    , mappedFileTime_(0)
+    , mappingFailed_(false)
+{
+    if (format_.empty())
+        throw tgt::CorruptedFileException("SEGY: Unsupported format code # " + std::to_string(sampleFormat), filename);
+
+    // samples are stored with the size of the corresponding volume format
+    traceSize_ = SEGY_TRACE_HEADER_SIZE + dimensions.x * getBytesPerVoxel();
+}
+
+VolumeDiskSEGY::~VolumeDiskSEGY() {
+}
+
+std::string VolumeDiskSEGY::getVolumeFormat(int sampleFormat) {
+    switch (sampleFormat) {
+    case SEGYVolumeReader::SEGY_IBM_FLOAT:
+    case SEGYVolumeReader::SEGY_IEEE_FLOAT:
+        return "float";
+    case SEGYVolumeReader::SEGY_INT32:
+        return "int32";
+    case SEGYVolumeReader::SEGY_INT16:
+        return "int16";
+    case SEGYVolumeReader::SEGY_INT8:
+        return "int8";
+    default:
+        return "";
+    }
+}
+
+std::string VolumeDiskSEGY::getHash() const {
+    std::string configStr = getFileName() + "#";
+    configStr += genericToString(tgt::FileSystem::fileTime(getFileName())) + "#";
+    configStr += genericToString(tgt::FileSystem::fileSize(getFileName())) + "#";
+    configStr += itos(sampleFormat_) + "#";
+    configStr += genericToString(getDimensions()) + "#";
+    configStr += genericToString(firstTraceOffset_);
+
+    return VoreenHash::getHash(configStr);
+}
+
+VolumeRAM* VolumeDiskSEGY::loadVolume() const {
+    return loadBrick(tgt::svec3::zero, getDimensions());
+}
+
+VolumeRAM* VolumeDiskSEGY::loadSlices(const size_t firstSlice, const size_t lastSlice) const {
+    //check for wrong parameter
+    if (getDimensions().z <= lastSlice)
+        throw std::invalid_argument("lastSlice is out of volume dimension!!!");
+    if (firstSlice > lastSlice)
+        throw std::invalid_argument("firstSlice has to be less or equal lastSlice!!!");
+
+    return loadBrick(tgt::svec3(0, 0, firstSlice), tgt::svec3(getDimensions().x, getDimensions().y, lastSlice - firstSlice + 1));
+}
+
+VolumeRAM* VolumeDiskSEGY::loadBrick(const tgt::svec3& brickOffset, const tgt::svec3& brickDim) const {
+    // check parameters
+    if (tgt::hmul(brickDim) == 0)
+        throw std::invalid_argument("requested brick dimensions are zero");
+    if (!tgt::hand(tgt::lessThanEqual(brickOffset+brickDim, getDimensions())))
+        throw std::invalid_argument("requested brick (at least partially) outside volume dimensions");
+
+    LDEBUG("Loading brick: offset=" << brickOffset << ", dim=" << brickDim);
+
+    // create output VolumeRAM
+    VolumeFactory vf;
+    VolumeRAM* vr = 0;
+    try {
+        vr = vf.create(getFormat(), brickDim);
+    }
+    catch (std::bad_alloc&) {
+        throw tgt::Exception("bad allocation");
+    }
+    if (!vr)
+        throw VoreenException("Failed to create VolumeRAM");
+
+    // read and convert traces
+    try {
+        readBrick(brickOffset, brickDim, reinterpret_cast<char*>(vr->getData()));
+    }
+    catch (tgt::Exception&) {
+        delete vr;
+        throw;
+    }
+
+    return vr;
+}
+
+void VolumeDiskSEGY::readBrick(const tgt::svec3& brickOffset, const tgt::svec3& brickDim, char* dest) const {
+    const size_t bytesPerVoxel = getBytesPerVoxel();
+    const size_t rowBytes = brickDim.x * bytesPerVoxel;
+    const size_t sampleOffset = brickOffset.x * bytesPerVoxel;
+
+    // The samples are converted directly from the mapping into the volume.
+    std::shared_ptr<const boost::iostreams::mapped_file_source> mapping;
+    if (const char* data = getMappedData(mapping)) {
+        for (size_t z = 0; z < brickDim.z; z++) {
+            for (size_t y = 0; y < brickDim.y; y++) {
+                const char* src = data + getTraceDataOffset(brickOffset.y + y, brickOffset.z + z) + sampleOffset;
+                convertSamples(src, dest + (z*brickDim.y + y)*rowBytes, brickDim.x);
+            }
+        }
+        return;
+    }
+
+    std::ifstream infile(getFileName().c_str(), std::ios::in | std::ios::binary);
+    if (infile.fail())
+        throw tgt::FileException("Failed to open file for reading: " + getFileName());
+
+    // The requested traces of an in-line are contiguous in the file, so they are read at once.
+    const size_t spanBytes = (brickDim.y - 1)*traceSize_ + rowBytes;
+    std::vector<char> span(spanBytes);
+    for (size_t z = 0; z < brickDim.z; z++) {
+        infile.seekg(getTraceDataOffset(brickOffset.y, brickOffset.z + z) + sampleOffset);
+        infile.read(span.data(), spanBytes);
+        if (infile.fail())
+            throw tgt::FileException("Failed to read from file: " + getFileName());
+
+        for (size_t y = 0; y < brickDim.y; y++)
+            convertSamples(span.data() + y*traceSize_, dest + (z*brickDim.y + y)*rowBytes, brickDim.x);
+    }
+}
+
+void VolumeDiskSEGY::convertSamples(const char* src, char* dest, size_t numSamples) const {
+    switch (sampleFormat_) {
+    case SEGYVolumeReader::SEGY_IBM_FLOAT:
+        SEGYSampleConversion::convertIBMFloat(src, reinterpret_cast<float*>(dest), numSamples);
+        break;
+    case SEGYVolumeReader::SEGY_IEEE_FLOAT:
+    case SEGYVolumeReader::SEGY_INT32:
+        SEGYSampleConversion::swapBytes32(src, dest, numSamples);
+        break;
+    case SEGYVolumeReader::SEGY_INT16:
+        SEGYSampleConversion::swapBytes16(src, dest, numSamples);
+        break;
+    default:
+        std::memcpy(dest, src, numSamples);
+    }
+}
+
+size_t VolumeDiskSEGY::getTraceDataOffset(size_t y, size_t z) const {
+    return firstTraceOffset_ + (z*dimensions_.y + y)*traceSize_ + SEGY_TRACE_HEADER_SIZE;
+}
+
+const char* VolumeDiskSEGY::getMappedData(std::shared_ptr<const boost::iostreams::mapped_file_source>& mapping) const {
+    boost::lock_guard<boost::mutex> lock(mappingMutex_);
+    if (mappingFailed_)
+        return 0;
+
+    // Reading beyond the end of a truncated mapped file raises SIGBUS, so remap modified files.
+    uint64_t fileSize = tgt::FileSystem::fileSize(getFileName());
+    time_t fileTime = tgt::FileSystem::fileTime(getFileName());
+    if (mappedFile_ && (fileSize != mappedFileSize_ || fileTime != mappedFileTime_)) {
+        LDEBUG(getFileName() << " has been modified, mapping it again");
+        mappedFile_.reset();
+    }
+
+    if (!mappedFile_) {
+        try {
+            mappedFile_.reset(new boost::iostreams::mapped_file_source(getFileName()));
+            mappedFileSize_ = fileSize;
+            mappedFileTime_ = fileTime;
+        }
+        catch (std::exception& e) {
+            LDEBUG("Unable to map " << getFileName() << ", using stream access: " << e.what());
+            mappedFile_.reset();
+            mappingFailed_ = true;
+        }
+    }
+    if (!mappedFile_)
+        return 0;
+
+    if (firstTraceOffset_ + hmul(getDimensions().yz())*traceSize_ > mappedFile_->size())
+        throw tgt::FileException("Failed to read from file: " + getFileName());
+
+    mapping = mappedFile_;
+    return mappedFile_->data();
+}
+
+} // namespace voreen
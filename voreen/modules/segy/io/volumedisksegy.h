@@ -0,0 +1,130 @@
+/***********************************************************************************
+ *                                                                                 *
+ * Voreen - The Volume Rendering Engine                                            *
+ *                                                                                 *
+ * Copyright (C) 2005-2024 University of Muenster, Germany,                        *
+ * Department of Computer Science.                                                 *
+ * For a list of authors please refer to the file "CREDITS.txt".                   *
+ *                                                                                 *
+ * This file is part of the Voreen software package. Voreen is free software:      *
+ * you can redistribute it and/or modify it under the terms of the GNU General     *
+ * Public License version 2 as published by the Free Software Foundation.          *
+ *                                                                                 *
+ * Voreen is distributed in the hope that it will be useful, but WITHOUT ANY       *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR   *
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.      *
+ *                                                                                 *
+ * You should have received a copy of the GNU General Public License in the file   *
+ * "LICENSE.txt" along with this file. If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                                 *
+ * For non-commercial academic use see the license exception specified in the file *
+ * "LICENSE-academic.txt". To get information about commercial licensing please    *
+ * contact the authors.                                                            *
+ *                                                                                 *
+ ***********************************************************************************/
+
+#ifndef VRN_VOLUMEDISKSEGY_H
+#define VRN_VOLUMEDISKSEGY_H
+
+#include "voreen/core/datastructures/volume/volumedisk.h"
+
+namespace voreen {
+
+/**
+ * Disk volume referencing the traces of a SEG-Y file, which are loaded lazily.
+ *
+ * Each trace forms a row along x, cross-lines run along y and in-lines along z.
+ * The file is memory mapped for the lifetime of the representation (with a fallback to stream
+ * access) and the samples are converted from big-endian (and IBM float) directly into the
+ * returned volume, so that surveys larger than the main memory can be processed slice- or brick-wise.
+ *
+ * @see SEGYSampleConversion
+ */
+class VRN_CORE_API VolumeDiskSEGY : public VolumeDisk {
+public:
+    /**
+     * @param filename Absolute file name of the SEG-Y file.
+     * @param dimensions samples per trace, cross-lines per in-line and number of in-lines
+     * @param sampleFormat SEG-Y data sample format code, @see SEGYVolumeReader
+     * @param firstTraceOffset offset of the first trace header from the beginning of the file in bytes
+     *
+     * @throw tgt::CorruptedFileException if the sample format is not supported
+     */
+    VolumeDiskSEGY(const std::string& filename, tgt::svec3 dimensions, int sampleFormat, size_t firstTraceOffset);
+    virtual ~VolumeDiskSEGY();
+
+    std::string getFileName() const { return filename_; }
+    int getSampleFormat() const { return sampleFormat_; }
+
+    /// Computes a hash string from the filename, its modification time and size, the format and the dimensions.
+    virtual std::string getHash() const;
+
+    /**
+     * Loads the entire volume from disk and returns it as VolumeRAM.
+     * The caller is responsible for deleting the returned object.
+     *
+     * @throw tgt::Exception if the volume could not be loaded
+     */
+    virtual VolumeRAM* loadVolume() const;
+
+    /**
+     * Loads a set of consecutive in-lines from disk and returns them as VolumeRAM.
+     * The caller is responsible for deleting the returned object.
+     *
+     * @param firstZSlice first slice of the slice range to load (inclusive)
+     * @param lastZSlice last slice of the slice range to load (inclusive)
+     *
+     * @throw tgt::Exception if the slices could not be loaded
+     */
+    virtual VolumeRAM* loadSlices(const size_t firstZSlice, const size_t lastZSlice) const;
+
+    /**
+     * Loads a brick of the volume from disk and returns it as VolumeRAM.
+     * The caller is responsible for deleting the returned object.
+     *
+     * @param offset lower-left-front corner voxel of the brick to load
+     * @param dimensions dimension of the brick to load
+     *
+     * @throw tgt::Exception if the brick could not be loaded
+     */
+    virtual VolumeRAM* loadBrick(const tgt::svec3& offset, const tgt::svec3& dimensions) const;
+
+    /// Returns the volume format corresponding to the passed SEG-Y sample format code, or an empty string if it is not supported.
+    static std::string getVolumeFormat(int sampleFormat);
+
+protected:
+    /// Reads and converts the samples of the brick into dest.
+    void readBrick(const tgt::svec3& offset, const tgt::svec3& dimensions, char* dest) const;
+
+    /// Converts numSamples big-endian samples at src into native samples at dest.
+    void convertSamples(const char* src, char* dest, size_t numSamples) const;
+
+    /// Returns the file offset of the first sample of the trace (y, z).
+    size_t getTraceDataOffset(size_t y, size_t z) const;
+
+    /**
+     * Returns a pointer to the beginning of the memory mapped file, which is kept mapped for
+     * the lifetime of this representation. Returns null if the file cannot be mapped.
+     * The file is mapped again if its size or modification time has changed.
+     *
+     * @param mapping receives the mapping the returned pointer refers to. It must be kept while reading.
+     */
+    const char* getMappedData(std::shared_ptr<const boost::iostreams::mapped_file_source>& mapping) const;
+
+    std::string filename_;
+    int sampleFormat_;
+    size_t firstTraceOffset_;
+    size_t traceSize_; ///< size of a trace including its header in bytes
+
+    mutable std::shared_ptr<const boost::iostreams::mapped_file_source> mappedFile_;
+    mutable uint64_t mappedFileSize_;   ///< size of the file when it was mapped
+    mutable time_t mappedFileTime_;     ///< modification time of the file when it was mapped
+    mutable bool mappingFailed_;
+    mutable boost::mutex mappingMutex_;
+
+    static const std::string loggerCat_;
+};
+
+} // namespace voreen
+
+#endif
@@ -1,11 +1,15 @@
 SET(MOD_CORE_MODULECLASS SEGYModule)
 
 SET(MOD_CORE_SOURCES
+    ${MOD_DIR}/io/segysampleconversion.cpp
     ${MOD_DIR}/io/segyvolumereader.cpp
+    ${MOD_DIR}/io/volumedisksegy.cpp
 )
 
 SET(MOD_CORE_HEADERS
+    ${MOD_DIR}/io/segysampleconversion.h
     ${MOD_DIR}/io/segyvolumereader.h
+    ${MOD_DIR}/io/volumedisksegy.h
 )
 
 # deployment
@@ -224,56 +224,107 @@ void VolumeMask::scrape(ScrapeIterationDescriptor& scrapeDescriptor, size_t& num
     std::vector<tgt::svec3> to_delete_current;
 
     size_t deleted_this_it = 0;
-    auto deleteAll = [this, &deleted_this_it] (std::vector<tgt::svec3>& voxels, SurfaceSlices<4>& surface) {
-        for(const auto& pos : voxels) {
-            if(L::deletableScraping(*this, pos)) {
-                set(pos, VolumeMaskValue::BACKGROUND);
-                ++deleted_this_it;
-
-                // Add neighbors to active surface (as their status might have changed now)
-                {
-                    int z = -1;
-                    for(int y = -1; y != 2; ++y) {
-                        for(int x = -1; x != 2; ++x) {
-                            tgt::ivec3 p = tgt::ivec3(pos) + tgt::ivec3(x, y, z);
-                            if(get(p, VolumeMaskValue::BACKGROUND) == VolumeMaskValue::OBJECT) {
-                                surface.m<3>().push_back(toLinearPos(tgt::svec3(p)));
-                            }
-                        }
-                    }
+    std::vector<uint8_t> deletable;
+    auto deleteAll = [this, &deleted_this_it, &deletable] (std::vector<tgt::svec3>& voxels, SurfaceSlices<4>& surface) {
+        // All voxels are located in the same slice. Voxels with the same parity in x and y (i.e., of the same
+        // subfield) are not 26-adjacent, so deleting one of them does not change whether another one is deletable.
+        // Thus, the voxels of one subfield can be tested concurrently, while the deletion (and thus the
+        // test of the following subfields) happens sequentially, preserving the topology.
+        deletable.resize(voxels.size());
+        for(int subfield = 0; subfield < 4; ++subfield) {
+#ifdef VRN_MODULE_OPENMP
+            #pragma omp parallel for schedule(dynamic, 256)
+#endif
+            for(long i = 0; i < static_cast<long>(voxels.size()); ++i) {
+                const tgt::svec3& pos = voxels[i];
+                if(static_cast<int>((pos.x & 1) | ((pos.y & 1) << 1)) == subfield) {
+                    deletable[i] = L::deletableScraping(*this, pos);
                 }
+            }
 
-                {
-                    int z = 0;
-                    for(int y = -1; y != 2; ++y) {
-                        for(int x = -1; x != 2; ++x) {
-                            if(x != 0 || y != 0) {
+            for(size_t i = 0; i < voxels.size(); ++i) {
+                const tgt::svec3& pos = voxels[i];
+                if(static_cast<int>((pos.x & 1) | ((pos.y & 1) << 1)) != subfield) {
+                    continue;
+                }
+                if(deletable[i]) {
+                    set(pos, VolumeMaskValue::BACKGROUND);
+                    ++deleted_this_it;
+
+                    // Add neighbors to active surface (as their status might have changed now)
+                    {
+                        int z = -1;
+                        for(int y = -1; y != 2; ++y) {
+                            for(int x = -1; x != 2; ++x) {
                                 tgt::ivec3 p = tgt::ivec3(pos) + tgt::ivec3(x, y, z);
                                 if(get(p, VolumeMaskValue::BACKGROUND) == VolumeMaskValue::OBJECT) {
-                                    surface.m<2>().push_back(toLinearPos(tgt::svec3(p)));
+                                    surface.m<3>().push_back(toLinearPos(tgt::svec3(p)));
                                 }
                             }
                         }
                     }
-                }
 
-                {
-                    int z = 1;
-                    for(int y = -1; y != 2; ++y) {
-                        for(int x = -1; x != 2; ++x) {
-                            tgt::ivec3 p = tgt::ivec3(pos) + tgt::ivec3(x, y, z);
-                            if(get(p, VolumeMaskValue::BACKGROUND) == VolumeMaskValue::OBJECT) {
-                                surface.m<1>().push_back(toLinearPos(tgt::svec3(p)));
+                    {
+                        int z = 0;
+                        for(int y = -1; y != 2; ++y) {
+                            for(int x = -1; x != 2; ++x) {
+                                if(x != 0 || y != 0) {
+                                    tgt::ivec3 p = tgt::ivec3(pos) + tgt::ivec3(x, y, z);
+                                    if(get(p, VolumeMaskValue::BACKGROUND) == VolumeMaskValue::OBJECT) {
+                                        surface.m<2>().push_back(toLinearPos(tgt::svec3(p)));
+                                    }
+                                }
                             }
                         }
                     }
+
+                    {
+                        int z = 1;
+                        for(int y = -1; y != 2; ++y) {
+                            for(int x = -1; x != 2; ++x) {
+                                tgt::ivec3 p = tgt::ivec3(pos) + tgt::ivec3(x, y, z);
+                                if(get(p, VolumeMaskValue::BACKGROUND) == VolumeMaskValue::OBJECT) {
+                                    surface.m<1>().push_back(toLinearPos(tgt::svec3(p)));
+                                }
+                            }
+                        }
+                    }
+
+                } else {
+                    //Voxel is potentially deletable, but was not, so it will (or may at least) become inactive for now
+                    // => we do not: "surface.m<2>().push_back(toLinearPos(pos));"
                 }
+            }
+        }
+    };
 
+    // Active surface voxels of the current slice. Their classification (3) only depends on the slices z-1 to z+1,
+    // which are not modified before advancing to the next slice, so all voxels of a slice are classified at once.
+    std::vector<uint64_t> sliceVoxels;
+    std::vector<uint8_t> sliceVoxelClass; // 0: remains active, 1: deletion candidate, 2: neither
+    auto classifySlice = [&] () {
+        sliceVoxelClass.resize(sliceVoxels.size());
+#ifdef VRN_MODULE_OPENMP
+        #pragma omp parallel for schedule(dynamic, 256)
+#endif
+        for(long i = 0; i < static_cast<long>(sliceVoxels.size()); ++i) {
+            tgt::svec3 pos = fromLinearPos(sliceVoxels[i]);
+            if(get(scrapeDescriptor.getNeightbor(pos), VolumeMaskValue::OBJECT) == VolumeMaskValue::BACKGROUND) {
+                sliceVoxelClass[i] = isEulerInvariantVoxel(pos) ? 1 : 2;
             } else {
-                //Voxel is potentially deletable, but was not, so it will (or may at least) become inactive for now
-                // => we do not: "surface.m<2>().push_back(toLinearPos(pos));"
+                sliceVoxelClass[i] = 0;
+            }
+        }
+
+        for(size_t i = 0; i < sliceVoxels.size(); ++i) {
+            if(sliceVoxelClass[i] == 1) {
+                to_delete_current.push_back(fromLinearPos(sliceVoxels[i]));
+            } else if(sliceVoxelClass[i] == 0) {
+                // Active surface voxel is not valid for current scraping direction
+                surface.m<0>().push_back(sliceVoxels[i]);
             }
         }
+        sliceVoxels.clear();
     };
 
     size_t z = 0;
@@ -293,6 +344,11 @@ void VolumeMask::scrape(ScrapeIterationDescriptor& scrapeDescriptor, size_t& num
             continue;
         }
 
+        if(pos.z != z) {
+            // 3 (for the previous slice)
+            classifySlice();
+        }
+
         while(pos.z != z) {
             tgtAssert(pos.z > z, "pos too small");
 
@@ -308,16 +364,9 @@ void VolumeMask::scrape(ScrapeIterationDescriptor& scrapeDescriptor, size_t& num
             ++z;
         }
 
-        // 3
-        if(get(scrapeDescriptor.getNeightbor(pos), VolumeMaskValue::OBJECT) == VolumeMaskValue::BACKGROUND) {
-            if (isEulerInvariantVoxel(pos)) {
-                to_delete_current.push_back(pos);
-            }
-        } else {
-            // Active surface voxel is not valid for current scraping direction
-            surface.m<0>().push_back(linearPos);
-        }
+        sliceVoxels.push_back(linearPos);
     }
+    classifySlice();
     for(int i=0; i<5; ++i) {
         deleteAll(to_delete_prev_prev, surface);
         to_delete_prev_prev.clear();
@@ -474,8 +523,13 @@ void VolumeMask::skeletonize(size_t maxIterations, ProgressReporter& progress) {
 
 template<class L>
 void VolumeMask::thinnerByLee(ScrapeIterationDescriptor& scrapeDescriptor, size_t& numberOfDeletedVoxels, ProgressReporter& progress) {
-    std::vector<tgt::svec3> marked;
     tgt::ivec3 dim = getDimensions();
+
+    // Marking does not modify the mask, so slices can be processed concurrently.
+    std::vector<std::vector<tgt::svec3>> markedPerSlice(dim.z);
+#ifdef VRN_MODULE_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
     for(int z = 0; z<dim.z; ++z) {
         for(int y = 0; y<dim.y; ++y) {
             for(int x = 0; x<dim.x; ++x) {
@@ -484,12 +538,17 @@ void VolumeMask::thinnerByLee(ScrapeIterationDescriptor& scrapeDescriptor, size_
                 if(get(pos) == VolumeMaskValue::OBJECT
                         && L::deletableScraping(*this, pos)
                         && get(scrapeDescriptor.getNeightbor(pos), VolumeMaskValue::OBJECT) == VolumeMaskValue::BACKGROUND) {
-                    marked.push_back(pos);
+                    markedPerSlice[z].push_back(pos);
                 }
             }
         }
     }
 
+    std::vector<tgt::svec3> marked;
+    for(auto& slice : markedPerSlice) {
+        marked.insert(marked.end(), slice.begin(), slice.end());
+    }
+
     size_t deletedThisIt = 0;
     for(auto& pos : marked) {
         if(isSimple(pos)) {
@@ -986,8 +986,8 @@ VesselGraph::VesselGraph(const tgt::Bounds& bounds)
     : nodes_(new DiskArrayStorage<VesselGraphNode>(VoreenApplication::app()->getUniqueTmpFilePath(".vgnodes")))
     , edges_(new DiskArrayStorage<VesselGraphEdge>(VoreenApplication::app()->getUniqueTmpFilePath(".vgedges")))
     , nodeEdgeIdStorage_(new DiskArrayBackedList<VGEdgeID>::Storage(VoreenApplication::app()->getUniqueTmpFilePath(".vgnodeedgerefs")))
-    , edgeVoxelStorage_(new DiskArrayStorage<VesselSkeletonVoxel>(VoreenApplication::app()->getUniqueTmpFilePath(".vgedgevoxels")))
-    , nodeVoxelStorage_(new DiskArrayStorage<tgt::vec3>(VoreenApplication::app()->getUniqueTmpFilePath(".vgnodevoxels")))
+    , edgeVoxelStorage_(new ConcurrentDiskArrayStorage<VesselSkeletonVoxel>(VoreenApplication::app()->getUniqueTmpFilePath(".vgedgevoxels")))
+    , nodeVoxelStorage_(new ConcurrentDiskArrayStorage<tgt::vec3>(VoreenApplication::app()->getUniqueTmpFilePath(".vgnodevoxels")))
     , bounds_(bounds)
 {
 }
@@ -1148,19 +1148,13 @@ VGNodeID VesselGraphBuilder::insertNode(const tgt::vec3& position, const DiskArr
     return insertNode(position, voxels, radius, isAtSampleBorder, VoreenApplication::app()->generateUUID());
 }
 VGNodeID VesselGraphBuilder::insertNode(const tgt::vec3& position, const DiskArray<tgt::vec3>& voxels, float radius, bool isAtSampleBorder, VesselGraphNodeUUID uuid) {
-    size_t nodeID = graph_->nodes_->size();
-    graph_->bounds_.addPoint(position);
-    graph_->nodes_->storeElement(VesselGraphNode(*graph_, nodeID, position, graph_->nodeVoxelStorage_->store(voxels), radius, isAtSampleBorder, uuid));
-    return nodeID;
+    return insertNodeInternal(position, graph_->nodeVoxelStorage_->store(voxels), radius, isAtSampleBorder, uuid);
 }
 VGNodeID VesselGraphBuilder::insertNode(const tgt::vec3& position, const std::vector<tgt::vec3>& voxels, float radius, bool isAtSampleBorder) {
     return insertNode(position, voxels, radius, isAtSampleBorder, VoreenApplication::app()->generateUUID());
 }
 VGNodeID VesselGraphBuilder::insertNode(const tgt::vec3& position, const std::vector<tgt::vec3>& voxels, float radius, bool isAtSampleBorder, VesselGraphNodeUUID uuid) {
-    size_t nodeID = graph_->nodes_->size();
-    graph_->bounds_.addPoint(position);
-    graph_->nodes_->storeElement(VesselGraphNode(*graph_, nodeID, position, graph_->nodeVoxelStorage_->store(voxels), radius, isAtSampleBorder, uuid));
-    return nodeID;
+    return insertNodeInternal(position, graph_->nodeVoxelStorage_->store(voxels), radius, isAtSampleBorder, uuid);
 }
 
 
@@ -1168,33 +1162,13 @@ VGEdgeID VesselGraphBuilder::insertEdge(VGNodeID node1, VGNodeID node2, const Di
     return insertEdge(node1, node2, voxels, VoreenApplication::app()->generateUUID());
 }
 VGEdgeID VesselGraphBuilder::insertEdge(VGNodeID node1, VGNodeID node2, const DiskArray<VesselSkeletonVoxel>& voxels, VesselGraphEdgeUUID uuid) {
-    tgtAssert(node1 < graph_->nodes_->size(), "Edge references nonexistent node");
-    tgtAssert(node2 < graph_->nodes_->size(), "Edge references nonexistent node");
-    VesselGraphNode& n1 = graph_->getNode(node1);
-    VesselGraphNode& n2 = graph_->getNode(node2);
-
-    VGEdgeID edgeID = graph_->edges_->size();
-    graph_->edges_->storeElement(VesselGraphEdge(*graph_, edgeID, node1, node2, graph_->edgeVoxelStorage_->store(voxels), uuid));
-
-    n1.edges_.push(edgeID);
-    n2.edges_.push(edgeID);
-    return edgeID;
+    return insertEdgeInternal(node1, node2, graph_->edgeVoxelStorage_->store(voxels), uuid);
 }
 VGEdgeID VesselGraphBuilder::insertEdge(VGNodeID node1, VGNodeID node2, const std::vector<VesselSkeletonVoxel>& voxels) {
     return insertEdge(node1, node2, voxels, VoreenApplication::app()->generateUUID());
 }
 VGEdgeID VesselGraphBuilder::insertEdge(VGNodeID node1, VGNodeID node2, const std::vector<VesselSkeletonVoxel>& voxels, VesselGraphEdgeUUID uuid) {
-    tgtAssert(node1 < graph_->nodes_->size(), "Edge references nonexistent node");
-    tgtAssert(node2 < graph_->nodes_->size(), "Edge references nonexistent node");
-    VesselGraphNode& n1 = graph_->getNode(node1);
-    VesselGraphNode& n2 = graph_->getNode(node2);
-
-    VGEdgeID edgeID = graph_->edges_->size();
-    graph_->edges_->storeElement(VesselGraphEdge(*graph_, edgeID, node1, node2, graph_->edgeVoxelStorage_->store(voxels), uuid));
-
-    n1.edges_.push(edgeID);
-    n2.edges_.push(edgeID);
-    return edgeID;
+    return insertEdgeInternal(node1, node2, graph_->edgeVoxelStorage_->store(voxels), uuid);
 }
 
 VGEdgeID VesselGraphBuilder::insertEdge(VGNodeID node1, VGNodeID node2, const VesselGraphEdge& path_definition, VesselGraphEdgeUUID uuid) {
@@ -1209,6 +1183,7 @@ VGEdgeID VesselGraphBuilder::insertEdge(VGNodeID node1, VGNodeID node2, VesselGr
     return insertEdge(node1, node2, pathProperties, VoreenApplication::app()->generateUUID());
 }
 VGEdgeID VesselGraphBuilder::insertEdge(VGNodeID node1, VGNodeID node2, VesselGraphEdgePathProperties pathProperties, VesselGraphEdgeUUID uuid) {
+    boost::lock_guard<boost::mutex> lock(mutex_);
     tgtAssert(node1 < graph_->nodes_->size(), "Edge references nonexistent node");
     tgtAssert(node2 < graph_->nodes_->size(), "Edge references nonexistent node");
     VesselGraphNode& n1 = graph_->getNode(node1);
@@ -1222,6 +1197,29 @@ VGEdgeID VesselGraphBuilder::insertEdge(VGNodeID node1, VGNodeID node2, VesselGr
     return edgeID;
 }
 
+VGNodeID VesselGraphBuilder::insertNodeInternal(const tgt::vec3& position, DiskArray<tgt::vec3>&& voxels, float radius, bool isAtSampleBorder, VesselGraphNodeUUID uuid) {
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    size_t nodeID = graph_->nodes_->size();
+    graph_->bounds_.addPoint(position);
+    graph_->nodes_->storeElement(VesselGraphNode(*graph_, nodeID, position, std::move(voxels), radius, isAtSampleBorder, uuid));
+    return nodeID;
+}
+
+VGEdgeID VesselGraphBuilder::insertEdgeInternal(VGNodeID node1, VGNodeID node2, DiskArray<VesselSkeletonVoxel>&& voxels, VesselGraphEdgeUUID uuid) {
+    boost::lock_guard<boost::mutex> lock(mutex_);
+    tgtAssert(node1 < graph_->nodes_->size(), "Edge references nonexistent node");
+    tgtAssert(node2 < graph_->nodes_->size(), "Edge references nonexistent node");
+    VesselGraphNode& n1 = graph_->getNode(node1);
+    VesselGraphNode& n2 = graph_->getNode(node2);
+
+    VGEdgeID edgeID = graph_->edges_->size();
+    graph_->edges_->storeElement(VesselGraphEdge(*graph_, edgeID, node1, node2, std::move(voxels), uuid));
+
+    n1.edges_.push(edgeID);
+    n2.edges_.push(edgeID);
+    return edgeID;
+}
+
 const VesselGraphNode& VesselGraphBuilder::getNode(VGNodeID i) const {
     return graph_->getNode(i);
 }
@@ -42,6 +42,7 @@
 #endif
 
 #include <boost/uuid/uuid.hpp>
+#include <boost/thread/mutex.hpp>
 #include <functional>
 
 namespace voreen {
@@ -474,12 +475,21 @@ private:
     friend struct VesselGraphEdge;
     friend struct VesselGraphNode;
     friend struct VesselGraphEdgeDeserializable;
-    std::unique_ptr<DiskArrayStorage<VesselSkeletonVoxel>> edgeVoxelStorage_; //never null
-    std::unique_ptr<DiskArrayStorage<tgt::vec3>> nodeVoxelStorage_; //never null
+    // The voxel storages may be filled concurrently by multiple VesselGraphBuilder users.
+    std::unique_ptr<ConcurrentDiskArrayStorage<VesselSkeletonVoxel>> edgeVoxelStorage_; //never null
+    std::unique_ptr<ConcurrentDiskArrayStorage<tgt::vec3>> nodeVoxelStorage_; //never null
 
     tgt::Bounds bounds_;
 };
 
+/**
+ * Incrementally constructs a VesselGraph.
+ *
+ * insertNode and insertEdge may be called from multiple threads concurrently: Node and edge voxels
+ * are copied into their (concurrent) storages without locking, only the actual insertion into the
+ * graph is serialized. IDs are assigned in insertion order. getNode and finalize must not be called
+ * concurrently with insertions.
+ */
 class VesselGraphBuilder {
 public:
     // Create a graph with predetermined bounds
@@ -512,7 +522,11 @@ public:
     VGEdgeID insertEdge(VGNodeID node1, VGNodeID node2, VesselGraphEdgePathProperties pathProperties, VesselGraphEdgeUUID uuid);
 
 private:
+    VGNodeID insertNodeInternal(const tgt::vec3& position, DiskArray<tgt::vec3>&& voxels, float radius, bool isAtSampleBorder, VesselGraphNodeUUID uuid);
+    VGEdgeID insertEdgeInternal(VGNodeID node1, VGNodeID node2, DiskArray<VesselSkeletonVoxel>&& voxels, VesselGraphEdgeUUID uuid);
+
     std::unique_ptr<VesselGraph> graph_;
+    boost::mutex mutex_; ///< guards all modifications of graph_ except for the voxel storages
 };
 
 } // namespace voreen
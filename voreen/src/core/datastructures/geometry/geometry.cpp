@@ -112,6 +112,10 @@ std::string Geometry::getHash() const {
     return VoreenHash::getHash(stream.str());
 }
 
+size_t Geometry::getMemorySize() const {
+    return 0;
+}
+
 bool Geometry::isTransparent() const {
     return false;
 }
@@ -118,6 +118,17 @@ tgt::Bounds GeometrySequence::getBoundingBox(bool transformed) const {
         return b;
 }
 
+size_t GeometrySequence::getMemorySize() const {
+    size_t size = sizeof(*this);
+    for(size_t i=0; i<geometries_.size(); i++) {
+        size_t geometrySize = geometries_[i]->getMemorySize();
+        if(geometrySize == 0)
+            return 0;
+        size += geometrySize;
+    }
+    return size;
+}
+
 void GeometrySequence::serialize(Serializer& s) const {
     Geometry::serialize(s);
     s.serialize("geometries", geometries_);
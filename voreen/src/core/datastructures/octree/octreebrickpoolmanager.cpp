@@ -34,6 +34,10 @@
 #include <limits>
 #include <fstream>
 #include <stdint.h>
+#include <deque>
+#include <memory>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
 #include <boost/thread/locks.hpp>
 
 #include "tgt/assert.h"
@@ -127,15 +131,164 @@ const VolumeAtomic<uint16_t>& BrickPoolBrickConst::data() const {
 
 /// BrickPoolManagerBase -------------------------------------------------------
 const std::string OctreeBrickPoolManagerBase::loggerCat_("voreen.OctreeBrickPoolManagerBase");
+const size_t OctreeBrickPoolManagerBase::NUM_PREFETCH_THREADS = 2;
+
+struct OctreeBrickPoolManagerBase::BrickPrefetcher {
+    struct Request {
+        std::vector<uint64_t> addresses_;
+        size_t nextAddress_;                    ///< index of the next brick to be loaded
+        size_t numLoading_;                     ///< number of bricks of this request currently being loaded
+        bool finished_;
+        std::promise<void> promise_;
+        std::function<void()> callback_;
+    };
+
+    BrickPrefetcher()
+        : numLoading_(0)
+        , stop_(false)
+    {}
+
+    /// Completes the request. Has to be called with the mutex locked, which is released temporarily.
+    void finish(const std::shared_ptr<Request>& request, boost::unique_lock<boost::mutex>& lock) {
+        if (request->finished_)
+            return;
+        request->finished_ = true;
+        lock.unlock();
+        if (request->callback_)
+            request->callback_();
+        request->promise_.set_value();
+        lock.lock();
+    }
+
+    boost::mutex mutex_;
+    boost::condition_variable requestAvailable_;
+    boost::condition_variable brickLoaded_;
+    std::deque<std::shared_ptr<Request> > requests_;
+    size_t numLoading_;                         ///< number of bricks currently being loaded
+    bool stop_;
+    boost::thread_group threads_;
+};
 
 OctreeBrickPoolManagerBase::OctreeBrickPoolManagerBase()
     : brickMemorySizeInByte_(0)
     , initialized_(false)
+    , prefetcher_(0)
 {}
 
 OctreeBrickPoolManagerBase::~OctreeBrickPoolManagerBase() {
     if (isInitialized())
         LWARNING("~OctreeBrickPoolManagerBase(): not deinitialized");
+
+    if (prefetcher_) {
+        cancelPrefetching();
+        {
+            boost::lock_guard<boost::mutex> lock(prefetcher_->mutex_);
+            prefetcher_->stop_ = true;
+        }
+        prefetcher_->requestAvailable_.notify_all();
+        prefetcher_->threads_.join_all();
+        delete prefetcher_;
+    }
+}
+
+std::shared_future<void> OctreeBrickPoolManagerBase::prefetchBricks(const std::vector<uint64_t>& virtualMemoryAddresses,
+                                                                    const std::function<void()>& callback) const
+{
+    std::shared_ptr<BrickPrefetcher::Request> request(new BrickPrefetcher::Request());
+    for (size_t i = 0; i < virtualMemoryAddresses.size(); i++) {
+        if (virtualMemoryAddresses[i] != NO_BRICK_ADDRESS)
+            request->addresses_.push_back(virtualMemoryAddresses[i]);
+    }
+    request->nextAddress_ = 0;
+    request->numLoading_ = 0;
+    request->finished_ = false;
+    request->callback_ = callback;
+    std::shared_future<void> future = request->promise_.get_future().share();
+
+    if (request->addresses_.empty()) {
+        if (callback)
+            callback();
+        request->promise_.set_value();
+        return future;
+    }
+
+    {
+        boost::lock_guard<boost::mutex> creationLock(prefetcherCreationMutex_);
+        if (!prefetcher_) {
+            prefetcher_ = new BrickPrefetcher();
+            for (size_t i = 0; i < NUM_PREFETCH_THREADS; i++)
+                prefetcher_->threads_.create_thread(boost::bind(&OctreeBrickPoolManagerBase::processPrefetchRequests, this));
+        }
+    }
+
+    {
+        boost::lock_guard<boost::mutex> lock(prefetcher_->mutex_);
+        prefetcher_->requests_.push_back(request);
+    }
+    prefetcher_->requestAvailable_.notify_all();
+
+    return future;
+}
+
+void OctreeBrickPoolManagerBase::cancelPrefetching() const {
+    {
+        boost::lock_guard<boost::mutex> creationLock(prefetcherCreationMutex_);
+        if (!prefetcher_)
+            return;
+    }
+
+    boost::unique_lock<boost::mutex> lock(prefetcher_->mutex_);
+    while (!prefetcher_->requests_.empty()) {
+        std::shared_ptr<BrickPrefetcher::Request> request = prefetcher_->requests_.front();
+        prefetcher_->requests_.pop_front();
+        prefetcher_->finish(request, lock);
+    }
+    while (prefetcher_->numLoading_ > 0)
+        prefetcher_->brickLoaded_.wait(lock);
+}
+
+void OctreeBrickPoolManagerBase::processPrefetchRequests() const {
+    tgtAssert(prefetcher_, "no prefetcher");
+
+    boost::unique_lock<boost::mutex> lock(prefetcher_->mutex_);
+    while (true) {
+        while (prefetcher_->requests_.empty() && !prefetcher_->stop_)
+            prefetcher_->requestAvailable_.wait(lock);
+        if (prefetcher_->stop_)
+            return;
+
+        // take next brick of the oldest request
+        std::shared_ptr<BrickPrefetcher::Request> request = prefetcher_->requests_.front();
+        uint64_t address = request->addresses_[request->nextAddress_++];
+        if (request->nextAddress_ == request->addresses_.size())
+            prefetcher_->requests_.pop_front();
+        request->numLoading_++;
+        prefetcher_->numLoading_++;
+
+        lock.unlock();
+        try {
+            prefetchBrick(address);
+        }
+        catch (std::exception& e) {
+            LDEBUG("Failed to prefetch brick " << address << ": " << e.what());
+        }
+        lock.lock();
+
+        request->numLoading_--;
+        prefetcher_->numLoading_--;
+        if (request->nextAddress_ == request->addresses_.size() && request->numLoading_ == 0)
+            prefetcher_->finish(request, lock);
+        prefetcher_->brickLoaded_.notify_all();
+    }
+}
+
+void OctreeBrickPoolManagerBase::prefetchBrick(uint64_t virtualMemoryAddress) const {
+    if (isBrickInRAM(virtualMemoryAddress))
+        return;
+
+    // non-blocking: skip bricks that are currently written or would require to evict buffers in use
+    if (getBrick(virtualMemoryAddress, false))
+        releaseBrick(virtualMemoryAddress);
 }
 
 size_t OctreeBrickPoolManagerBase::getBrickMemorySizeInByte() const {
@@ -156,6 +309,8 @@ void OctreeBrickPoolManagerBase::initialize(size_t brickMemorySizeInByte) {
 }
 
 void OctreeBrickPoolManagerBase::deinitialize() {
+    cancelPrefetching();
+
     if (!isInitialized()) {
         LWARNING("deinitialize(): not initialized");
     }
@@ -190,6 +345,7 @@ OctreeBrickPoolManagerRAM::OctreeBrickPoolManagerRAM(size_t maxSingleBufferSize)
 }
 
 OctreeBrickPoolManagerRAM::~OctreeBrickPoolManagerRAM() {
+    cancelPrefetching();
     if (isInitialized())
         deinitialize();
 }
@@ -34,6 +34,16 @@
 #include "tgt/filesystem.h"
 
 #include <vector>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+
+#ifdef VRN_MODULE_BIGDATAIMAGEPROCESSING
+#include <lz4.h>
+#endif
+
+#ifdef VRN_MODULE_OPENMP
+#include "omp.h"
+#endif
 
 namespace voreen {
 
@@ -113,6 +123,7 @@ OctreeBrickPoolManagerDisk::OctreeBrickPoolManagerDisk(const size_t maxBufferSiz
     , ramLimitInBytes_(maxRamUsed)
     , maxNumBuffersInRAM_(0)
     , nextVirtualMemoryAddress_(0)
+    , brickCompression_(COMPRESSION_NONE)
     , numBuffersInRAM_(0)
 {
     brickPoolPath_ = tgt::FileSystem::absolutePath(brickPoolPath);
@@ -120,6 +131,7 @@ OctreeBrickPoolManagerDisk::OctreeBrickPoolManagerDisk(const size_t maxBufferSiz
 }
 
 OctreeBrickPoolManagerDisk::~OctreeBrickPoolManagerDisk() {
+    cancelPrefetching();
 }
 
 OctreeBrickPoolManagerDisk* OctreeBrickPoolManagerDisk::create() const {
@@ -155,6 +167,7 @@ void OctreeBrickPoolManagerDisk::initialize(size_t brickMemorySizeInByte) {
 }
 
 void OctreeBrickPoolManagerDisk::deinitialize() {
+    cancelPrefetching();
     flushPoolToDisk();
 
     for (size_t i = 0; i < bufferVector_.size(); i++) {
@@ -180,6 +193,8 @@ void OctreeBrickPoolManagerDisk::setRAMLimit(size_t ramLimitInBytes) {
             "[" + itos(ramLimitInBytes) + " bytes < 2*" + itos(singleBufferSizeBytes_) + " bytes]");
 
     if (ramLimitInBytes != ramLimitInBytes_) {
+        cancelPrefetching();
+
         // save non-persistent data to disk
         flushPoolToDisk();
 
@@ -202,6 +217,32 @@ void OctreeBrickPoolManagerDisk::setRAMLimit(size_t ramLimitInBytes) {
     }
 }
 
+void OctreeBrickPoolManagerDisk::setBrickCompression(BrickCompression compression) {
+    tgtAssert(!isInitialized(), "brick compression must be set before initialization");
+    if (!isBrickCompressionSupported(compression))
+        throw VoreenException("Brick compression codec not supported by this build: " + itos(static_cast<int>(compression)));
+    brickCompression_ = compression;
+}
+
+OctreeBrickPoolManagerDisk::BrickCompression OctreeBrickPoolManagerDisk::getBrickCompression() const {
+    return brickCompression_;
+}
+
+bool OctreeBrickPoolManagerDisk::isBrickCompressionSupported(BrickCompression compression) {
+    switch (compression) {
+    case COMPRESSION_NONE:
+        return true;
+    case COMPRESSION_LZ4:
+#ifdef VRN_MODULE_BIGDATAIMAGEPROCESSING
+        return true;
+#else
+        return false;
+#endif
+    default:
+        return false;
+    }
+}
+
 //-----------------------------------------------------------------------------------------------------------------------
 //      DE-/SERIALIZATION
 //-----------------------------------------------------------------------------------------------------------------------
@@ -223,6 +264,7 @@ void OctreeBrickPoolManagerDisk::serialize(Serializer& s) const {
     s.serialize("bufferFilePrefix", bufferFilePrefix_);
 
     s.serialize("nextVirtualMemoryAddress", nextVirtualMemoryAddress_);
+    s.serialize("brickCompression", static_cast<int>(brickCompression_));
 }
 
 void  OctreeBrickPoolManagerDisk::deserialize(Deserializer& s) {
@@ -243,6 +285,12 @@ void  OctreeBrickPoolManagerDisk::deserialize(Deserializer& s) {
 
     s.deserialize("nextVirtualMemoryAddress", nextVirtualMemoryAddress_);
 
+    int brickCompression = COMPRESSION_NONE;
+    s.optionalDeserialize("brickCompression", brickCompression, static_cast<int>(COMPRESSION_NONE));
+    brickCompression_ = static_cast<BrickCompression>(brickCompression);
+    if (!isBrickCompressionSupported(brickCompression_))
+        throw VoreenException("Brick buffer files use a compression codec that is not supported by this build: " + itos(brickCompression));
+
     // check brick pool path
     if (!tgt::FileSystem::dirExists(brickPoolPath_))
         throw VoreenException("Brick pool path does not exist: " + brickPoolPath_);
@@ -480,76 +528,128 @@ OctreeBrickPoolManagerDisk::BufferEntry* OctreeBrickPoolManagerDisk::loadBufferF
         LERROR("loadBrickFromDisk(): Buffer has not been created");
         throw VoreenException("Buffer has not been created");
     }
-    else {
-        //kick out old buffer, if RAM is to full
-        if(numBuffersInRAM_ == maxNumBuffersInRAM_) {
-            //find LRU buffer
-            size_t removeBuffer = brickPoolManagerQueue_.last_->previous_->data_;
-            tgtAssert(bufferVector_.size() > removeBuffer, "buffer is not in ram!")
-            if(blocking) {
-                while (bufferVector_[removeBuffer]->inUse_ > 0) {
-                    cond_.wait(lock);
-                    removeBuffer = brickPoolManagerQueue_.last_->previous_->data_;
-                }
-            } else {
-                if(bufferVector_[removeBuffer]->inUse_ > 0) {
-                    throw AllBuffersInUseException();
-                }
-            }
-            //safe old buffer
-            if(bufferVector_[removeBuffer]->mustBeSavedToDisk_)
-                saveBufferToDisk(removeBuffer);
-            //clean up
-            if(removeBuffer != brickPoolManagerQueue_.removeLast()) {
-                tgtAssert(false, "something went wrong!");
-                LERROR("something went wrong!");
-            }
-            delete[] bufferVector_[removeBuffer]->data_;
-            bufferVector_[removeBuffer]->data_ = 0;
-            bufferVector_[removeBuffer]->node_ = 0;
-            bufferVector_[removeBuffer]->isInRAM_ = false;
-            //LERROR("kicked: " << removeBuffer << " loaded: " << bufferID);
-            numBuffersInRAM_--;
+
+    BufferEntry* entry = bufferVector_[bufferID];
+    while (true) {
+        // another thread (e.g., a prefetching one) is already loading the buffer
+        while (entry->isLoading_)
+            cond_.wait(lock);
+        if (entry->isInRAM_) {
+            tgtAssert(entry->inUse_ != 255,"Overflow in use buffer!");
+            entry->inUse_++;
+            brickPoolManagerQueue_.pushToFront(entry->node_);
+            return entry;
         }
+        if (numBuffersInRAM_ < maxNumBuffersInRAM_)
+            break;
 
-        const std::string bufferFile = bufferFiles_.at(bufferID);
-        tgtAssert(!bufferFile.empty(), "buffer file path is empty");
-        if (!tgt::FileSystem::fileExists(bufferFile)) {
-            tgtAssert(false,"Buffer file does not exists!");
-            LERROR("Buffer file does not exists!");
-            throw VoreenException("Buffer file does not exists!");
+        //kick out old buffer, if RAM is to full
+        //find LRU buffer
+        size_t removeBuffer = brickPoolManagerQueue_.last_->previous_->data_;
+        tgtAssert(bufferVector_.size() > removeBuffer, "buffer is not in ram!")
+        if (bufferVector_[removeBuffer]->inUse_ > 0) {
+            if (!blocking)
+                throw AllBuffersInUseException();
+            // the lock is released while waiting, so the state has to be checked again
+            cond_.wait(lock);
+            continue;
         }
-        char* buffer = 0;
+        //safe old buffer
+        if(bufferVector_[removeBuffer]->mustBeSavedToDisk_)
+            saveBufferToDisk(removeBuffer);
+        //clean up
+        if(removeBuffer != brickPoolManagerQueue_.removeLast()) {
+            tgtAssert(false, "something went wrong!");
+            LERROR("something went wrong!");
+        }
+        delete[] bufferVector_[removeBuffer]->data_;
+        bufferVector_[removeBuffer]->data_ = 0;
+        bufferVector_[removeBuffer]->node_ = 0;
+        bufferVector_[removeBuffer]->isInRAM_ = false;
+        numBuffersInRAM_--;
+    }
+
+    // Reserve the slot, it is used (and cannot be evicted) until the buffer has been loaded.
+    entry->isLoading_ = true;
+    entry->inUse_ = 1;
+    entry->mustBeSavedToDisk_ = false;
+    entry->node_ = brickPoolManagerQueue_.insertToFront(bufferID);
+    numBuffersInRAM_++;
+    const std::string bufferFile = bufferFiles_.at(bufferID);
+
+    // Read and decompress the buffer without holding the lock, so that loads of
+    // other buffers and accesses to resident bricks are not blocked by the I/O.
+    char* buffer = 0;
+    lock.unlock();
+    try {
+        buffer = readBufferFile(bufferFile);
+    }
+    catch (...) {
+        lock.lock();
+        brickPoolManagerQueue_.remove(entry->node_);
+        entry->node_ = 0;
+        entry->inUse_ = 0;
+        entry->isLoading_ = false;
+        numBuffersInRAM_--;
+        cond_.notify_all();
+        throw;
+    }
+    lock.lock();
+
+    // publish the buffer
+    entry->data_ = buffer;
+    entry->isInRAM_ = true;
+    entry->isLoading_ = false;
+    cond_.notify_all();
+    return entry;
+}
+
+char* OctreeBrickPoolManagerDisk::readBufferFile(const std::string& bufferFile) const {
+    tgtAssert(!bufferFile.empty(), "buffer file path is empty");
+    if (!tgt::FileSystem::fileExists(bufferFile)) {
+        tgtAssert(false,"Buffer file does not exists!");
+        LERROR("Buffer file does not exists!");
+        throw VoreenException("Buffer file does not exists!");
+    }
+    char* buffer = 0;
+    try {
+        buffer = new char[singleBufferSizeBytes_];
+    } catch(std::bad_alloc& e) {
+        tgtAssert(false,e.what());
+        LERROR(e.what());
+        throw VoreenException(e.what());
+    }
+    std::ifstream infile(bufferFile.c_str(), std::ios::in | std::ios::binary);
+    if(infile.fail()) {
+        delete[] buffer;
+        tgtAssert(false,"Could not open buffer file!");
+        LERROR("Could not open buffer file!");
+        throw VoreenException("Could not open buffer file!");
+    }
+    if (brickCompression_ == COMPRESSION_NONE) {
+        infile.read(buffer,singleBufferSizeBytes_);
+        tgtAssert(!infile.bad(), "reading from disk went wrong");
+    }
+    else {
+        // read compressed file at once and decompress bricks into the RAM buffer
+        infile.seekg(0, std::ios::end);
+        std::vector<char> fileContent(static_cast<size_t>(infile.tellg()));
+        infile.seekg(0, std::ios::beg);
+        if (!fileContent.empty())
+            infile.read(&fileContent[0], fileContent.size());
         try {
-            buffer = new char[singleBufferSizeBytes_];
-        } catch(std::bad_alloc& e) {
-            tgtAssert(false,e.what());
-            LERROR(e.what());
-            throw VoreenException(e.what());
+            if (infile.fail())
+                throw VoreenException("Failed to read buffer file: " + bufferFile);
+            decompressBuffer(fileContent, buffer);
         }
-        std::ifstream infile(bufferFile.c_str(), std::ios::in | std::ios::binary);
-        if(infile.fail()) {
+        catch (VoreenException& e) {
             delete[] buffer;
-            tgtAssert(false,"Could not open buffer file!");
-            LERROR("Could not open buffer file!");
-            throw VoreenException("Could not open buffer file!");
+            LERROR(e.what());
+            throw;
         }
-        infile.read(buffer,singleBufferSizeBytes_);
-        tgtAssert(!infile.bad(), "reading from disk went wrong");
-        infile.close();
-
-        BrickPoolManagerQueueNode<size_t>* node = brickPoolManagerQueue_.insertToFront(bufferID);
-        bufferVector_[bufferID]->data_ = buffer;
-        bufferVector_[bufferID]->isInRAM_ = true;
-        bufferVector_[bufferID]->inUse_ = 1;
-        bufferVector_[bufferID]->mustBeSavedToDisk_ = false;
-        bufferVector_[bufferID]->node_ = node;
-        numBuffersInRAM_++;
-
-        return bufferVector_[bufferID];
     }
-    tgtAssert(false, "Should not get here");
-    throw VoreenException("Should not get here");
+    infile.close();
+    return buffer;
 }
 
 void OctreeBrickPoolManagerDisk::saveBufferToDisk(const size_t bufferID) const {
@@ -569,17 +669,113 @@ void OctreeBrickPoolManagerDisk::saveBufferToDisk(const size_t bufferID) const {
             return ;
         }*/
 
-        std::ofstream outfile(bufferFile.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
-        if(outfile.fail()) {
-            tgtAssert(false,"Could not open buffer file!");
-            LERROR("Could not open buffer file!");
-            return ;
+        if (brickCompression_ == COMPRESSION_NONE) {
+            writeBufferFile(bufferID, bufferVector_[bufferID]->data_, singleBufferSizeBytes_);
         }
-        outfile.write(bufferVector_[bufferID]->data_,singleBufferSizeBytes_);
-        tgtAssert(!outfile.bad(), "writing brick to disk went wrong");
-        outfile.close();
-        bufferVector_[bufferID]->mustBeSavedToDisk_ = false;
+        else {
+            std::vector<char> fileContent;
+            compressBuffer(bufferVector_[bufferID]->data_, fileContent);
+            writeBufferFile(bufferID, &fileContent[0], fileContent.size());
+        }
+    }
+}
+
+void OctreeBrickPoolManagerDisk::writeBufferFile(size_t bufferID, const char* data, size_t numBytes) const {
+    const std::string bufferFile = bufferFiles_.at(bufferID);
+    tgtAssert(!bufferFile.empty(), "buffer file path is empty");
+
+    std::ofstream outfile(bufferFile.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+    if(outfile.fail()) {
+        tgtAssert(false,"Could not open buffer file!");
+        LERROR("Could not open buffer file!");
+        return ;
     }
+    outfile.write(data, numBytes);
+    tgtAssert(!outfile.bad(), "writing brick to disk went wrong");
+    outfile.close();
+    bufferVector_[bufferID]->mustBeSavedToDisk_ = false;
+}
+
+void OctreeBrickPoolManagerDisk::compressBuffer(const char* data, std::vector<char>& fileContent) const {
+    tgtAssert(data, "no buffer data");
+    tgtAssert(brickCompression_ == COMPRESSION_LZ4, "unsupported brick compression");
+
+    const size_t brickSize = getBrickMemorySizeInByte();
+    const size_t indexSize = (numBrickSlotsPerBuffer_ + 1) * sizeof(uint64_t);
+    std::vector<std::vector<char> > bricks(numBrickSlotsPerBuffer_);
+
+#ifdef VRN_MODULE_BIGDATAIMAGEPROCESSING
+    #ifdef VRN_MODULE_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (long i = 0; i < static_cast<long>(numBrickSlotsPerBuffer_); i++) {
+        const char* brick = data + i * brickSize;
+        std::vector<char>& compressed = bricks[i];
+        compressed.resize(LZ4_compressBound(static_cast<int>(brickSize)));
+        int compressedSize = LZ4_compress_default(brick, &compressed[0], static_cast<int>(brickSize), static_cast<int>(compressed.size()));
+        // store brick uncompressed, if compression does not pay off
+        if (compressedSize <= 0 || static_cast<size_t>(compressedSize) >= brickSize)
+            compressed.assign(brick, brick + brickSize);
+        else
+            compressed.resize(compressedSize);
+    }
+#endif
+
+    // brick offset index followed by the brick data
+    std::vector<uint64_t> offsets(numBrickSlotsPerBuffer_ + 1);
+    offsets[0] = indexSize;
+    for (size_t i = 0; i < numBrickSlotsPerBuffer_; i++)
+        offsets[i+1] = offsets[i] + bricks[i].size();
+
+    fileContent.resize(static_cast<size_t>(offsets.back()));
+    memcpy(&fileContent[0], &offsets[0], indexSize);
+    for (size_t i = 0; i < numBrickSlotsPerBuffer_; i++) {
+        if (!bricks[i].empty())
+            memcpy(&fileContent[static_cast<size_t>(offsets[i])], &bricks[i][0], bricks[i].size());
+    }
+}
+
+void OctreeBrickPoolManagerDisk::decompressBuffer(const std::vector<char>& fileContent, char* data) const {
+    tgtAssert(data, "no buffer data");
+    tgtAssert(brickCompression_ == COMPRESSION_LZ4, "unsupported brick compression");
+
+    const size_t brickSize = getBrickMemorySizeInByte();
+    const size_t indexSize = (numBrickSlotsPerBuffer_ + 1) * sizeof(uint64_t);
+    if (fileContent.size() < indexSize)
+        throw VoreenException("Corrupt brick buffer file: missing brick index");
+
+    std::vector<uint64_t> offsets(numBrickSlotsPerBuffer_ + 1);
+    memcpy(&offsets[0], &fileContent[0], indexSize);
+    if (offsets[0] != indexSize || offsets.back() != fileContent.size())
+        throw VoreenException("Corrupt brick buffer file: invalid brick index");
+    for (size_t i = 0; i < numBrickSlotsPerBuffer_; i++) {
+        if (offsets[i+1] < offsets[i])
+            throw VoreenException("Corrupt brick buffer file: invalid brick index");
+    }
+
+    bool failed = false;
+#ifdef VRN_MODULE_BIGDATAIMAGEPROCESSING
+    #ifdef VRN_MODULE_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+    #endif
+    for (long i = 0; i < static_cast<long>(numBrickSlotsPerBuffer_); i++) {
+        const char* src = &fileContent[0] + offsets[i];
+        size_t srcSize = static_cast<size_t>(offsets[i+1] - offsets[i]);
+        char* brick = data + i * brickSize;
+        if (srcSize == brickSize) {
+            memcpy(brick, src, brickSize);
+        }
+        else {
+            int decompressedSize = LZ4_decompress_safe(src, brick, static_cast<int>(srcSize), static_cast<int>(brickSize));
+            if (decompressedSize != static_cast<int>(brickSize))
+                failed = true;
+        }
+    }
+#else
+    failed = true;
+#endif
+    if (failed)
+        throw VoreenException("Corrupt brick buffer file: failed to decompress brick");
 }
 
 void OctreeBrickPoolManagerDisk::flushPoolToDisk(ProgressReporter* progressReporter /*= 0*/) {
@@ -591,15 +787,46 @@ void OctreeBrickPoolManagerDisk::flushPoolToDisk(ProgressReporter* progressRepor
     }
 
     // save buffers to disk
-    size_t numSavedToDisk = 0;
-    for (size_t i = 0; i < bufferVector_.size(); i++) {
-        if (bufferVector_[i]->mustBeSavedToDisk_) {
-            tgtAssert(bufferVector_[i]->isInRAM_,"buffer not in ram!");
-            saveBufferToDisk(i);
-            numSavedToDisk++;
+    if (brickCompression_ == COMPRESSION_NONE) {
+        size_t numSavedToDisk = 0;
+        for (size_t i = 0; i < bufferVector_.size(); i++) {
+            if (bufferVector_[i]->mustBeSavedToDisk_) {
+                tgtAssert(bufferVector_[i]->isInRAM_,"buffer not in ram!");
+                saveBufferToDisk(i);
+                numSavedToDisk++;
+                if (progressReporter)
+                    progressReporter->setProgress((float)(numSavedToDisk) / (float)numToBeSavedToDisk);
+                //LINFO("Saved " << numSavedToDisk << "/" << numToBeSavedToDisk);
+            }
+        }
+    }
+    else {
+        std::vector<size_t> buffersToSave;
+        for (size_t i = 0; i < bufferVector_.size(); i++) {
+            if (bufferVector_[i]->mustBeSavedToDisk_) {
+                tgtAssert(bufferVector_[i]->isInRAM_,"buffer not in ram!");
+                buffersToSave.push_back(i);
+            }
+        }
+
+        // write-behind: compress the next buffer in the background while the current one is written
+        std::vector<char> fileContent, nextFileContent;
+        if (!buffersToSave.empty())
+            compressBuffer(bufferVector_[buffersToSave.front()]->data_, fileContent);
+        for (size_t i = 0; i < buffersToSave.size(); i++) {
+            boost::thread compressor;
+            if (i + 1 < buffersToSave.size()) {
+                compressor = boost::thread(boost::bind(&OctreeBrickPoolManagerDisk::compressBuffer, this,
+                    bufferVector_[buffersToSave[i+1]]->data_, boost::ref(nextFileContent)));
+            }
+
+            writeBufferFile(buffersToSave[i], &fileContent[0], fileContent.size());
             if (progressReporter)
-                progressReporter->setProgress((float)(numSavedToDisk) / (float)numToBeSavedToDisk);
-            //LINFO("Saved " << numSavedToDisk << "/" << numToBeSavedToDisk);
+                progressReporter->setProgress((float)(i+1) / (float)numToBeSavedToDisk);
+
+            if (compressor.joinable())
+                compressor.join();
+            fileContent.swap(nextFileContent);
         }
     }
 }
@@ -73,6 +73,7 @@ OctreeBrickPoolManagerMmap::OctreeBrickPoolManagerMmap(const std::string& brickP
 }
 
 OctreeBrickPoolManagerMmap::~OctreeBrickPoolManagerMmap() {
+    cancelPrefetching();
 }
 
 OctreeBrickPoolManagerMmap* OctreeBrickPoolManagerMmap::create() const {
@@ -87,6 +88,7 @@ void OctreeBrickPoolManagerMmap::initialize(size_t brickMemorySizeInByte) {
 }
 
 void OctreeBrickPoolManagerMmap::deinitialize() {
+    cancelPrefetching();
     flushPoolToDisk();
 
     OctreeBrickPoolManagerBase::deinitialize();
@@ -222,6 +224,15 @@ void OctreeBrickPoolManagerMmap::releaseBrick(uint64_t virtualMemoryAddress, Acc
     // Nothing to do here: Blocks are writting back to disk by OS.
 }
 
+void OctreeBrickPoolManagerMmap::prefetchBrick(uint64_t virtualMemoryAddress) const {
+    const size_t pageSize = 4096;
+    const volatile char* brick = reinterpret_cast<const volatile char*>(getBrick(virtualMemoryAddress));
+    char sum = 0;
+    for (size_t offset = 0; offset < getBrickMemorySizeInByte(); offset += pageSize)
+        sum ^= brick[offset];
+    (void)sum;
+}
+
 uint64_t OctreeBrickPoolManagerMmap::allocateBrick() {
 
     // Fast path: Check if free list is empty. If this is the case we just
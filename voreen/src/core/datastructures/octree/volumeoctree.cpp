@@ -42,6 +42,8 @@
 #include "tgt/filesystem.h"
 
 #include <sstream>
+#include <algorithm>
+#include <iterator>
 #include <queue>
 
 #ifdef VRN_MODULE_OPENMP
@@ -237,6 +239,43 @@ namespace {
 namespace voreen {
 
 const std::string VolumeOctree::loggerCat_("voreen.VolumeOctree");
+const size_t VolumeOctree::PREFETCH_WINDOW_SIZE = 64;
+
+class VolumeOctree::BrickPrefetchWindow {
+public:
+    BrickPrefetchWindow(const OctreeBrickPoolManagerBase* brickPoolManager, std::vector<uint64_t>& brickAddresses, size_t windowSize)
+        : brickPoolManager_(brickPoolManager)
+        , windowSize_(std::max<size_t>(windowSize, 2))
+        , numConsumed_(0)
+        , numRequested_(0)
+    {
+        brickAddresses_.swap(brickAddresses);
+        advance();
+    }
+
+    /// Has to be called before each brick is accessed, in the order of the passed addresses.
+    void brickConsumed() {
+        numConsumed_++;
+        // request the next half window at once rather than one request per brick
+        if (numRequested_ - std::min(numConsumed_, numRequested_) <= windowSize_/2)
+            advance();
+    }
+
+private:
+    void advance() {
+        size_t end = std::min(numConsumed_ + windowSize_, brickAddresses_.size());
+        if (end <= numRequested_)
+            return;
+        brickPoolManager_->prefetchBricks(std::vector<uint64_t>(brickAddresses_.begin() + numRequested_, brickAddresses_.begin() + end));
+        numRequested_ = end;
+    }
+
+    const OctreeBrickPoolManagerBase* brickPoolManager_;
+    std::vector<uint64_t> brickAddresses_;
+    const size_t windowSize_;
+    size_t numConsumed_;
+    size_t numRequested_;
+};
 
 VolumeOctree::VolumeOctree(const std::vector<const VolumeBase*>& channelVolumes, size_t brickDim, float homogeneityThreshold,
             HalfSampleAggregateFunction halfSampleFn, OctreeBrickPoolManagerBase* brickPoolManager,
@@ -554,8 +593,14 @@ VolumeRAM* VolumeOctree::createVolume(size_t level /*= 0*/, clock_t timeLimit /*
     tgtAssert(levelVolumeRam, "output volume not created");
     uint16_t* levelVolumeBuffer = reinterpret_cast<uint16_t*>(levelVolumeRam->getData());
 
+    // let the brick pool manager load the next bricks in the background while the current ones are copied
+    std::vector<uint64_t> brickAddresses;
+    collectNodeBrickAddresses(rootNode_, getNumLevels()-1, level, brickAddresses);
+    BrickPrefetchWindow prefetchWindow(brickPoolManager_, brickAddresses, PREFETCH_WINDOW_SIZE);
+
     bool volumeComplete;
-    composeNodeTexture(rootNode_, svec3(0,0,0), getNumLevels()-1, level, levelVolumeBuffer, levelVolumeDim, timeLimit, runtimeWatch, volumeComplete);
+    composeNodeTexture(rootNode_, svec3(0,0,0), getNumLevels()-1, level, levelVolumeBuffer, levelVolumeDim, timeLimit, runtimeWatch, volumeComplete,
+        prefetchWindow);
     if (complete)
         *complete = volumeComplete;
 
@@ -621,12 +666,33 @@ VolumeRAM* VolumeOctree::createSlice(SliceAlignment sliceAlignment, size_t slice
 
     // recursively copy voxel data from bricks to output slice
     uint16_t* sliceVolumeBuffer = reinterpret_cast<uint16_t*>(sliceVolumeRam->getData());
+    std::vector<uint64_t> brickAddresses;
+    collectNodeSliceBrickAddresses(sliceAlignment, rootNode_, svec3(0,0,0), sliceIndexAtLevel, getNumLevels()-1, level,
+        beginAtLevel, endAtLevel, brickAddresses);
+    brickPoolManager_->prefetchBricks(brickAddresses);
+
     bool sliceComplete;
     composeNodeSliceTexture(sliceAlignment, rootNode_, svec3(0,0,0), sliceIndexAtLevel, getNumLevels()-1, level,
         sliceVolumeBuffer, sliceVolumeDim, timeLimit, runtimeWatch, sliceComplete, beginAtLevel, endAtLevel);
     if (complete)
         *complete = sliceComplete;
 
+    // slicing usually proceeds to a neighboring slice => prefetch bricks of the adjacent slices
+    std::vector<uint64_t> adjacentBrickAddresses;
+    if (sliceIndexAtLevel > beginAtLevel[sliceAlignment])
+        collectNodeSliceBrickAddresses(sliceAlignment, rootNode_, svec3(0,0,0), sliceIndexAtLevel-1, getNumLevels()-1, level,
+            beginAtLevel, endAtLevel, adjacentBrickAddresses);
+    if (sliceIndexAtLevel+1 < endAtLevel[sliceAlignment])
+        collectNodeSliceBrickAddresses(sliceAlignment, rootNode_, svec3(0,0,0), sliceIndexAtLevel+1, getNumLevels()-1, level,
+            beginAtLevel, endAtLevel, adjacentBrickAddresses);
+    std::sort(adjacentBrickAddresses.begin(), adjacentBrickAddresses.end());
+    adjacentBrickAddresses.erase(std::unique(adjacentBrickAddresses.begin(), adjacentBrickAddresses.end()), adjacentBrickAddresses.end());
+    std::sort(brickAddresses.begin(), brickAddresses.end());
+    std::vector<uint64_t> newBrickAddresses;
+    std::set_difference(adjacentBrickAddresses.begin(), adjacentBrickAddresses.end(), brickAddresses.begin(), brickAddresses.end(),
+        std::back_inserter(newBrickAddresses));
+    brickPoolManager_->prefetchBricks(newBrickAddresses);
+
     return sliceVolumeRam;
 }
 
@@ -1030,7 +1096,8 @@ const VolumeOctreeNode* VolumeOctree::getNodeAtVoxel(const svec3& voxel, const s
 }
 
 void VolumeOctree::composeNodeTexture(const VolumeOctreeNode* node, const svec3& nodeOffset, size_t curLevel, size_t targetLevel,
-    uint16_t* textureBuffer, const svec3& textureDim, clock_t timeLimit, tgt::Stopwatch& runtimeWatch, bool& complete) const
+    uint16_t* textureBuffer, const svec3& textureDim, clock_t timeLimit, tgt::Stopwatch& runtimeWatch, bool& complete,
+    BrickPrefetchWindow& prefetchWindow) const
 {
     tgtAssert(brickPoolManager_, "no brick pool manager");
     tgtAssert(node, "null pointer passed");
@@ -1041,6 +1108,10 @@ void VolumeOctree::composeNodeTexture(const VolumeOctreeNode* node, const svec3&
     const size_t numChannels = getNumChannels();
     svec3 nodeDim = getBrickDim() * svec3(1<<(curLevel - targetLevel));
 
+    // brick collected by collectNodeBrickAddresses() => move prefetch window (also if the brick is skipped)
+    if (!node->isHomogeneous() && curLevel == targetLevel && node->hasBrick())
+        prefetchWindow.brickConsumed();
+
     // skip leaf brick, if time limit for the volume creation has been reached
     bool timeLimitReached = (timeLimit > 0 && runtimeWatch.getRuntime() >= timeLimit);
     bool skipBrickDueToTimeLimit =
@@ -1075,7 +1146,7 @@ void VolumeOctree::composeNodeTexture(const VolumeOctreeNode* node, const svec3&
             bool childComplete;
             tgtAssert(child, "no child node");
             composeNodeTexture(child, nodeOffset + childCoord*subNodeDim,
-                curLevel-1, targetLevel, textureBuffer, textureDim, timeLimit, runtimeWatch, childComplete);
+                curLevel-1, targetLevel, textureBuffer, textureDim, timeLimit, runtimeWatch, childComplete, prefetchWindow);
             complete &= childComplete;
         }
     }
@@ -1178,6 +1249,70 @@ void VolumeOctree::composeNodeSliceTexture(SliceAlignment sliceAlignment, const
     }
 }
 
+void VolumeOctree::collectNodeBrickAddresses(const VolumeOctreeNode* node, size_t curLevel, size_t targetLevel,
+    std::vector<uint64_t>& brickAddresses) const
+{
+    tgtAssert(node, "null pointer passed");
+    tgtAssert(curLevel >= targetLevel && curLevel < getNumLevels(), "invalid current level");
+
+    if (node->isHomogeneous())
+        return;
+    else if (curLevel == targetLevel) {
+        if (node->hasBrick())
+            brickAddresses.push_back(node->getBrickAddress());
+    }
+    else {
+        for (size_t i=0; i<8; i++) {
+            tgtAssert(node->children_[i], "no child node");
+            collectNodeBrickAddresses(node->children_[i], curLevel-1, targetLevel, brickAddresses);
+        }
+    }
+}
+
+void VolumeOctree::collectNodeSliceBrickAddresses(SliceAlignment sliceAlignment, const VolumeOctreeNode* node,
+    const tgt::svec3& nodeOffsetInTexture, size_t sliceIndexInNode, size_t curLevel, size_t targetLevel,
+    const tgt::svec3& begin, const tgt::svec3& end, std::vector<uint64_t>& brickAddresses) const
+{
+    tgtAssert(node, "null pointer passed");
+    tgtAssert(curLevel >= targetLevel && curLevel < getNumLevels(), "invalid current level");
+
+    const svec3 nodeDimInTexture = getBrickDim() * svec3(1<<(curLevel-targetLevel));
+    tgtAssert(sliceIndexInNode < nodeDimInTexture[sliceAlignment], "invalid slice index");
+
+    // skip nodes outside the requested region (composeNodeSliceTexture does not copy any voxels for them)
+    for (size_t dim=0; dim<3; dim++) {
+        if (dim != static_cast<size_t>(sliceAlignment) &&
+                (nodeOffsetInTexture[dim] >= end[dim] || nodeOffsetInTexture[dim] + nodeDimInTexture[dim] <= begin[dim]))
+            return;
+    }
+
+    if (node->isHomogeneous())
+        return;
+    else if (curLevel == targetLevel) {
+        if (node->hasBrick())
+            brickAddresses.push_back(node->getBrickAddress());
+    }
+    else {
+        // same child selection as in composeNodeSliceTexture
+        svec3 childNodeDim = nodeDimInTexture / svec3(2);
+        size_t childLayer = 0;
+        if (sliceIndexInNode >= childNodeDim[sliceAlignment]) {
+            childLayer = 1;
+            sliceIndexInNode -= childNodeDim[sliceAlignment];
+        }
+        svec3 childStart = svec3(0, 0, 0);
+        svec3 childEnd = svec3(2, 2, 2);
+        childStart[sliceAlignment] = childLayer;
+        childEnd[sliceAlignment] = childLayer+1;
+        VRN_FOR_EACH_VOXEL(childCoord, childStart, childEnd) {
+            const VolumeOctreeNode* child = node->children_[cubicCoordToLinear(childCoord, svec3::two)];
+            tgtAssert(child, "no child node");
+            collectNodeSliceBrickAddresses(sliceAlignment, child, nodeOffsetInTexture + childCoord*childNodeDim, sliceIndexInNode,
+                curLevel-1, targetLevel, begin, end, brickAddresses);
+        }
+    }
+}
+
 
 //------------------
 // low-level helper functions
@@ -27,15 +27,204 @@
 #include "voreen/core/datastructures/volume/volume.h"
 #include "voreen/core/datastructures/volume/volumeram.h"
 #include "voreen/core/datastructures/volume/volumedisk.h"
+#include "voreen/core/datastructures/volume/volumederiveddatasweep.h"
 #include "voreen/core/datastructures/volume/operators/volumeoperatorgradient.h"
 
 #include "voreen/core/io/serialization/serialization.h"
+#include "voreen/core/utils/stringutils.h"
+
+#ifdef VRN_MODULE_OPENMP
+#include "omp.h"
+#endif
 
 namespace voreen {
 
 using tgt::vec3;
 using tgt::ivec3;
 
+namespace {
+
+/// Number of voxels binned by the typed histogram kernel between two interruption points.
+const int64_t HISTOGRAM_BLOCK_SIZE = 1 << 24;
+
+template<typename Base>
+void addVolumeToHistogram1DGeneric(Histogram1D& histogram, const VolumeRAM* volume, const RealWorldMapping& rwm, size_t channel) {
+    // access the channel as strided array of the base type to avoid virtual calls per voxel
+    const size_t stride = volume->getBytesPerVoxel() / sizeof(Base);
+    const Base* values = static_cast<const Base*>(volume->getData()) + channel;
+    const int64_t numVoxels = static_cast<int64_t>(volume->getNumVoxels());
+    const size_t numBuckets = histogram.getNumBuckets();
+    const float scale = rwm.getScale();
+    const float offset = rwm.getOffset();
+
+    // for 8 and 16 bit integers, the bucket of each possible value is looked up instead of computed
+    std::vector<int> bucketLookUp;
+    const int64_t lookUpOffset = std::numeric_limits<Base>::is_integer ? static_cast<int64_t>(std::numeric_limits<Base>::min()) : 0;
+    if (std::numeric_limits<Base>::is_integer && sizeof(Base) <= 2) {
+        bucketLookUp.resize(size_t(1) << (8 * std::min<size_t>(sizeof(Base), 2)));
+        for (size_t i = 0; i < bucketLookUp.size(); i++) {
+            Base value = static_cast<Base>(static_cast<int64_t>(i) + lookUpOffset);
+            bucketLookUp[i] = histogram.getBucketIndex(getTypeAsFloat(value) * scale + offset);
+        }
+    }
+
+    // each thread bins into its own buckets, which are merged at the end
+    int numThreads = 1;
+#ifdef VRN_MODULE_OPENMP
+    numThreads = omp_get_max_threads();
+#endif
+    std::vector<std::vector<uint64_t> > threadBuckets(numThreads, std::vector<uint64_t>(numBuckets, 0));
+
+    for (int64_t blockStart = 0; blockStart < numVoxels; blockStart += HISTOGRAM_BLOCK_SIZE) {
+        boost::this_thread::interruption_point();
+        const int64_t blockEnd = std::min(blockStart + HISTOGRAM_BLOCK_SIZE, numVoxels);
+
+        #ifdef VRN_MODULE_OPENMP
+        #pragma omp parallel
+        #endif
+        {
+            int thread = 0;
+#ifdef VRN_MODULE_OPENMP
+            thread = omp_get_thread_num();
+#endif
+            uint64_t* buckets = threadBuckets[thread].data();
+            if (!bucketLookUp.empty()) {
+                const int* lookUp = bucketLookUp.data();
+                #ifdef VRN_MODULE_OPENMP
+                #pragma omp for
+                #endif
+                for (int64_t i = blockStart; i < blockEnd; i++)
+                    buckets[lookUp[static_cast<int64_t>(values[i*stride]) - lookUpOffset]]++;
+            }
+            else {
+                #ifdef VRN_MODULE_OPENMP
+                #pragma omp for
+                #endif
+                for (int64_t i = blockStart; i < blockEnd; i++)
+                    buckets[histogram.getBucketIndex(getTypeAsFloat(values[i*stride]) * scale + offset)]++;
+            }
+        }
+    }
+
+    for (size_t thread = 0; thread < threadBuckets.size(); thread++) {
+        for (size_t bucket = 0; bucket < numBuckets; bucket++) {
+            if (threadBuckets[thread][bucket] > 0)
+                histogram.increaseBucket(bucket, threadBuckets[thread][bucket]);
+        }
+    }
+}
+
+/**
+ * Computes the intensity histograms of all channels during a VolumeDerivedDataSweep.
+ * If the value range of the volume is not yet known, the occurrences of each value
+ * are counted instead and binned when finalizing, which is feasible for 8 and 16 bit
+ * integer volumes only.
+ */
+class VolumeHistogramIntensitySweepAccumulator : public VolumeDerivedDataSweepAccumulator {
+public:
+    VolumeHistogramIntensitySweepAccumulator(const VolumeBase* handle, const VolumeMinMax* minMax, int bucketCount)
+        : rwm_(handle->getRealWorldMapping())
+        , baseType_(handle->getBaseType())
+        , numChannels_(handle->getNumChannels())
+        , bucketCount_(bucketCount)
+    {
+        if (minMax) {
+            tgtAssert(minMax->getNumChannels() == numChannels_, "invalid number of channels");
+            for (size_t channel = 0; channel < numChannels_; channel++) {
+                float min = rwm_.normalizedToRealWorld(minMax->getMinNormalized(channel));
+                float max = rwm_.normalizedToRealWorld(minMax->getMaxNormalized(channel));
+                histograms_.push_back(Histogram1D(min, max, bucketCount_));
+            }
+        }
+        else {
+            tgtAssert(supportsValueCounting(baseType_), "value range required");
+            size_t numValues = (baseType_ == "uint8" || baseType_ == "int8") ? 1 << 8 : 1 << 16;
+            valueCounts_.assign(numChannels_, std::vector<uint64_t>(numValues, 0));
+        }
+    }
+
+    static bool supportsValueCounting(const std::string& baseType) {
+        return baseType == "uint8" || baseType == "int8" || baseType == "uint16" || baseType == "int16";
+    }
+
+    virtual void processSlab(const VolumeRAM* slab, size_t /*firstSlice*/) {
+        if (!histograms_.empty()) {
+            for (size_t channel = 0; channel < numChannels_; channel++)
+                addVolumeToHistogram1D(histograms_[channel], slab, rwm_, channel);
+        }
+        else if (baseType_ == "uint8")
+            countValues<uint8_t>(slab);
+        else if (baseType_ == "int8")
+            countValues<int8_t>(slab);
+        else if (baseType_ == "uint16")
+            countValues<uint16_t>(slab);
+        else if (baseType_ == "int16")
+            countValues<int16_t>(slab);
+    }
+
+    virtual VolumeDerivedData* finalize() {
+        if (!histograms_.empty())
+            return new VolumeHistogramIntensity(histograms_);
+        else if (baseType_ == "uint8")
+            return binValueCounts<uint8_t>();
+        else if (baseType_ == "int8")
+            return binValueCounts<int8_t>();
+        else if (baseType_ == "uint16")
+            return binValueCounts<uint16_t>();
+        else if (baseType_ == "int16")
+            return binValueCounts<int16_t>();
+        return 0;
+    }
+
+private:
+    template<typename T>
+    void countValues(const VolumeRAM* slab) {
+        const T* data = static_cast<const T*>(slab->getData());
+        size_t numVoxels = slab->getNumVoxels();
+        for (size_t channel = 0; channel < numChannels_; channel++) {
+            std::vector<uint64_t>& counts = valueCounts_[channel];
+            for (size_t i = 0; i < numVoxels; i++)
+                counts[static_cast<int64_t>(data[i*numChannels_ + channel]) - std::numeric_limits<T>::min()]++;
+        }
+    }
+
+    template<typename T>
+    VolumeDerivedData* binValueCounts() const {
+        std::vector<Histogram1D> histograms;
+        for (size_t channel = 0; channel < numChannels_; channel++) {
+            const std::vector<uint64_t>& counts = valueCounts_[channel];
+
+            // the occurring value range determines the histogram range, just as the VolumeMinMax would
+            size_t first = 0;
+            while (first + 1 < counts.size() && counts[first] == 0)
+                first++;
+            size_t last = counts.size() - 1;
+            while (last > first && counts[last] == 0)
+                last--;
+
+            float min = rwm_.normalizedToRealWorld(getTypeAsFloat(static_cast<T>(first + std::numeric_limits<T>::min())));
+            float max = rwm_.normalizedToRealWorld(getTypeAsFloat(static_cast<T>(last + std::numeric_limits<T>::min())));
+            Histogram1D h(min, max, bucketCount_);
+            for (size_t value = first; value <= last; value++) {
+                if (counts[value] > 0)
+                    h.addSamples(rwm_.normalizedToRealWorld(getTypeAsFloat(static_cast<T>(value + std::numeric_limits<T>::min()))), counts[value]);
+            }
+            histograms.push_back(h);
+        }
+        return new VolumeHistogramIntensity(histograms);
+    }
+
+    RealWorldMapping rwm_;
+    std::string baseType_;
+    size_t numChannels_;
+    int bucketCount_;
+
+    std::vector<Histogram1D> histograms_;               ///< used if the value range is known in advance
+    std::vector<std::vector<uint64_t> > valueCounts_;   ///< per channel occurrences of each value otherwise
+};
+
+} // namespace
+
 Histogram1D createHistogram1DFromVolume(const VolumeBase* handle, size_t bucketCount, size_t channel /*= 0*/) {
     RealWorldMapping rwm = handle->getRealWorldMapping();
 
@@ -78,49 +267,38 @@ VRN_CORE_API Histogram1D createHistogram1DFromVolume(const VolumeBase* handle, s
     }
     tgtAssert(volumeRam || volumeDisk, "no representation");
 
+    if (volumeRam) {
+        // access volume data in RAM directly
+        addVolumeToHistogram1D(h, volumeRam, rwm, channel);
+        return h;
+    }
+
     // iterate over slices
-    tgt::svec3 dims = handle->getDimensions();
-    tgt::svec3 pos;
-    for (pos.z = 0; pos.z < dims.z; ++pos.z) {
+    size_t numSlices = handle->getDimensions().z;
+    for (size_t z = 0; z < numSlices; ++z) {
         boost::this_thread::interruption_point();
 
-        if (volumeRam) {
-            // access volume data in RAM directly
-            for (pos.y = 0; pos.y < dims.y; ++pos.y) {
-                for (pos.x = 0; pos.x < dims.x; ++pos.x) {
-                    float val = volumeRam->getVoxelNormalized(pos, channel);
-                    val = rwm.normalizedToRealWorld(val);
-                    h.addSample(val);
-                }
-            }
+        try {
+            // temporarily load current slice into RAM
+            std::unique_ptr<VolumeRAM> sliceVolume(volumeDisk->loadSlices(z, z));
+            tgtAssert(sliceVolume, "null pointer returned (exception expected)");
+            addVolumeToHistogram1D(h, sliceVolume.get(), rwm, channel);
         }
-        else if (volumeDisk) {
-            try {
-                // temporarily load current slice into RAM
-                VolumeRAM* sliceVolume = volumeDisk->loadSlices(pos.z, pos.z);
-                tgtAssert(sliceVolume, "null pointer returned (exception expected)");
-                for (pos.y = 0; pos.y < dims.y; ++pos.y) {
-                    for (pos.x = 0; pos.x < dims.x; ++pos.x) {
-                        float val = sliceVolume->getVoxelNormalized(tgt::svec3(pos.x, pos.y, 0), channel);
-                        val = rwm.normalizedToRealWorld(val);
-                        h.addSample(val);
-                    }
-                }
-                delete sliceVolume;
-            }
-            catch (tgt::Exception& e) {
-                LWARNINGC("voreen.Histogram", "Unable to compute 1D histogram: failed to load slice from disk volume: " + std::string(e.what()));
-                return h;
-            }
-        }
-        else {
-            tgtAssert(false, "should never get here");
+        catch (tgt::Exception& e) {
+            LWARNINGC("voreen.Histogram", "Unable to compute 1D histogram: failed to load slice from disk volume: " + std::string(e.what()));
+            return h;
         }
     }
 
     return h;
 }
 
+void addVolumeToHistogram1D(Histogram1D& histogram, const VolumeRAM* volume, const RealWorldMapping& rwm, size_t channel) {
+    tgtAssert(volume, "no volume");
+    tgtAssert(channel < volume->getNumChannels(), "invalid channel");
+    DISPATCH_FOR_BASETYPE(volume->getBaseType(), addVolumeToHistogram1DGeneric, histogram, volume, rwm, channel);
+}
+
 //-----------------------------------------------------------------------------
 
 Histogram2D createHistogram2DFromVolume(const VolumeBase* handle, int bucketCountIntensity, int bucketCountGradient, size_t channel) {
@@ -216,6 +394,19 @@ VolumeHistogramIntensity::VolumeHistogramIntensity(const std::vector<Histogram1D
 
 VolumeDerivedData* VolumeHistogramIntensity::createFrom(const VolumeBase* handle) const {
     tgtAssert(handle, "no volume");
+
+    // for disk volumes, the histogram is usually computed as by-product of the min/max sweep
+    if (!handle->hasRepresentation<VolumeRAM>() && handle->hasRepresentation<VolumeDisk>()) {
+        // blocks until the min/max computation (possibly running in another thread) has finished
+        boost::this_thread::interruption_point();
+        if (handle->getDerivedData<VolumeMinMax>()) {
+            if (VolumeHistogramIntensity* histogram = handle->hasDerivedData<VolumeHistogramIntensity>())
+                return new VolumeHistogramIntensity(*histogram);
+        }
+        if (VolumeDerivedData* result = VolumeDerivedDataSweep::computeWithByproducts(handle, this))
+            return result;
+    }
+
     VolumeHistogramIntensity* h = new VolumeHistogramIntensity();
     for (size_t channel = 0; channel < handle->getNumChannels(); channel++) {
         Histogram1D hist = createHistogram1DFromVolume(handle, 256, channel);
@@ -224,6 +415,14 @@ VolumeDerivedData* VolumeHistogramIntensity::createFrom(const VolumeBase* handle
     return h;
 }
 
+VolumeDerivedDataSweepAccumulator* VolumeHistogramIntensity::createSweepAccumulator(const VolumeBase* handle) const {
+    tgtAssert(handle, "no volume");
+    const VolumeMinMax* minMax = handle->hasDerivedData<VolumeMinMax>();
+    if (!minMax && !VolumeHistogramIntensitySweepAccumulator::supportsValueCounting(handle->getBaseType()))
+        return 0; // value range has to be known before the sweep
+    return new VolumeHistogramIntensitySweepAccumulator(handle, minMax, 256);
+}
+
 size_t VolumeHistogramIntensity::getNumChannels() const {
     return histograms_.size();
 }
@@ -0,0 +1,195 @@
+/***********************************************************************************
+ *                                                                                 *
+ * Voreen - The Volume Rendering Engine                                            *
+ *                                                                                 *
+ * Copyright (C) 2005-2024 University of Muenster, Germany,                        *
+ * Department of Computer Science.                                                 *
+ * For a list of authors please refer to the file "CREDITS.txt".                   *
+ *                                                                                 *
+ * This file is part of the Voreen software package. Voreen is free software:      *
+ * you can redistribute it and/or modify it under the terms of the GNU General     *
+ * Public License version 2 as published by the Free Software Foundation.          *
+ *                                                                                 *
+ * Voreen is distributed in the hope that it will be useful, but WITHOUT ANY       *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR   *
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.      *
+ *                                                                                 *
+ * You should have received a copy of the GNU General Public License in the file   *
+ * "LICENSE.txt" along with this file. If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                                 *
+ * For non-commercial academic use see the license exception specified in the file *
+ * "LICENSE-academic.txt". To get information about commercial licensing please    *
+ * contact the authors.                                                            *
+ *                                                                                 *
+ ***********************************************************************************/
+
+#include "voreen/core/datastructures/volume/operators/volumeoperatorconnectedcomponents.h"
+
+#include <cstdlib>
+#include <limits>
+#include <numeric>
+#include <string>
+
+namespace voreen {
+
+ConnectedComponentStatistics::ConnectedComponentStatistics()
+    : numVoxels(0)
+    , llf(std::numeric_limits<size_t>::max())
+    , urb(0)
+    , centroid(0.0)
+{
+}
+
+//-------------------------------------------------------------------------------------------------
+
+const size_t ConnectedComponentLabeling::SLAB_DEPTH = 16;
+
+ConnectedComponentLabeling::ConnectedComponentLabeling(const tgt::svec3& dim, int connectivity)
+    : dim_(dim)
+{
+    tgtAssert(connectivity == 6 || connectivity == 18 || connectivity == 26, "invalid connectivity");
+    int maxDistance = connectivity == 6 ? 1 : (connectivity == 18 ? 2 : 3);
+
+    for (int z = -1; z <= 0; z++) {
+        for (int y = -1; y <= 1; y++) {
+            for (int x = -1; x <= 1; x++) {
+                bool precedes = z < 0 || (z == 0 && (y < 0 || (y == 0 && x < 0)));
+                if (precedes && std::abs(x) + std::abs(y) + std::abs(z) <= maxDistance)
+                    backwardNeighbors_.push_back(tgt::ivec3(x, y, z));
+            }
+        }
+    }
+
+    // Slab labels have to fit into 32 bits.
+    size_t sliceSize = std::max<size_t>(dim.x*dim.y, 1);
+    size_t slabDepth = tgt::clamp<size_t>(std::numeric_limits<uint32_t>::max() / sliceSize, 1, SLAB_DEPTH);
+    tgtAssert(sliceSize < std::numeric_limits<uint32_t>::max(), "slices too large");
+
+    for (size_t z = 0; z < dim.z; z += slabDepth) {
+        slabBegin_.push_back(z);
+    }
+    numSlabLabels_.resize(slabBegin_.size(), 0);
+    slabBegin_.push_back(dim.z);
+}
+
+size_t ConnectedComponentLabeling::getNumSlabs() const {
+    return numSlabLabels_.size();
+}
+
+uint32_t ConnectedComponentLabeling::merge(uint32_t* labels, bool stretchLabels, std::vector<ConnectedComponentStatistics>* statistics) {
+    const size_t numSlabs = getNumSlabs();
+
+    // Global label of local label l of slab s: labelOffset[s] + l
+    std::vector<size_t> labelOffset(numSlabs + 1, 0);
+    for (size_t slab = 0; slab < numSlabs; slab++) {
+        labelOffset[slab + 1] = labelOffset[slab] + numSlabLabels_[slab];
+    }
+
+    std::vector<size_t> parent(labelOffset[numSlabs] + 1);
+    std::iota(parent.begin(), parent.end(), size_t(0));
+
+    // Merge components touching across the boundary to the previous slab.
+    for (size_t slab = 1; slab < numSlabs; slab++) {
+        size_t z = slabBegin_[slab];
+        for (size_t y = 0; y < dim_.y; y++) {
+            for (size_t x = 0; x < dim_.x; x++) {
+                uint32_t label = labels[index(x, y, z)];
+                if (label == 0)
+                    continue;
+
+                for (const tgt::ivec3& offset : backwardNeighbors_) {
+                    if (offset.z == 0)
+                        continue;
+
+                    size_t nx = x + offset.x;
+                    size_t ny = y + offset.y;
+                    if (nx >= dim_.x || ny >= dim_.y)
+                        continue;
+
+                    uint32_t neighborLabel = labels[index(nx, ny, z - 1)];
+                    if (neighborLabel != 0)
+                        unite(parent, labelOffset[slab] + label, labelOffset[slab - 1] + neighborLabel);
+                }
+            }
+        }
+    }
+
+    // Roots are the smallest global label of their set, i.e., the one of the first voxel in scan order.
+    std::vector<uint32_t> finalLabel(parent.size(), 0);
+    size_t numComponents = 0;
+    for (size_t label = 1; label < parent.size(); label++) {
+        size_t root = findRoot(parent, label);
+        if (root == label) {
+            if (numComponents == std::numeric_limits<uint32_t>::max())
+                throw VoreenException("Number of connected components exceeds the supported maximum of " + std::to_string(numComponents));
+            finalLabel[label] = static_cast<uint32_t>(++numComponents);
+        }
+        else {
+            finalLabel[label] = finalLabel[root];
+        }
+    }
+
+    uint32_t stretchFactor = 1;
+    if (stretchLabels && numComponents > 0)
+        stretchFactor = std::numeric_limits<uint32_t>::max() / static_cast<uint32_t>(numComponents);
+
+    if (statistics) {
+        statistics->clear();
+        statistics->resize(numComponents);
+    }
+
+    long numSlabsLong = static_cast<long>(numSlabs);
+#ifdef VRN_MODULE_OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for (long slab = 0; slab < numSlabsLong; slab++) {
+        // Statistics are gathered per slab label and merged afterwards.
+        std::vector<ConnectedComponentStatistics> slabStatistics(statistics ? numSlabLabels_[slab] + 1 : 0);
+        std::vector<tgt::dvec3> positionSums(slabStatistics.size(), tgt::dvec3::zero);
+
+        for (size_t z = slabBegin_[slab]; z < slabBegin_[slab + 1]; z++) {
+            for (size_t y = 0; y < dim_.y; y++) {
+                for (size_t x = 0; x < dim_.x; x++) {
+                    uint32_t& label = labels[index(x, y, z)];
+                    if (label == 0)
+                        continue;
+
+                    if (statistics) {
+                        ConnectedComponentStatistics& component = slabStatistics[label];
+                        tgt::svec3 pos(x, y, z);
+                        component.numVoxels++;
+                        component.llf = tgt::min(component.llf, pos);
+                        component.urb = tgt::max(component.urb, pos);
+                        positionSums[label] += tgt::dvec3(pos);
+                    }
+
+                    label = finalLabel[labelOffset[slab] + label] * stretchFactor;
+                }
+            }
+        }
+
+        if (statistics) {
+#ifdef VRN_MODULE_OPENMP
+            #pragma omp critical
+#endif
+            for (uint32_t label = 1; label < slabStatistics.size(); label++) {
+                const ConnectedComponentStatistics& slabComponent = slabStatistics[label];
+                ConnectedComponentStatistics& component = (*statistics)[finalLabel[labelOffset[slab] + label] - 1];
+                component.numVoxels += slabComponent.numVoxels;
+                component.llf = tgt::min(component.llf, slabComponent.llf);
+                component.urb = tgt::max(component.urb, slabComponent.urb);
+                component.centroid += positionSums[label]; // Sum of positions until normalized below
+            }
+        }
+    }
+
+    if (statistics) {
+        for (ConnectedComponentStatistics& component : *statistics) {
+            component.centroid /= static_cast<double>(component.numVoxels);
+        }
+    }
+
+    return static_cast<uint32_t>(numComponents);
+}
+
+} // namespace voreen
@@ -124,6 +124,50 @@ void VolumeBase::addDerivedData(VolumeDerivedData* data) {
     derivedData_.insert(data);
     derivedDataMutex_.unlock();
 }
+
+bool VolumeBase::hasDerivedDataOfType(const VolumeDerivedData* data) const {
+    tgtAssert(data, "null pointer passed");
+    boost::lock_guard<boost::recursive_mutex> lock(derivedDataMutex_);
+    for (std::set<VolumeDerivedData*>::const_iterator it=derivedData_.begin(); it!=derivedData_.end(); ++it) {
+        if (typeid(**it) == typeid(*data))
+            return true;
+    }
+    return false;
+}
+
+bool VolumeBase::addDerivedDataIfMissing(VolumeDerivedData* data) const {
+    tgtAssert(data, "null pointer passed");
+    if (!addDerivedDataInternal(data, false))
+        return false;
+    enqueueDerivedDataNotification();
+    return true;
+}
+
+bool VolumeBase::addDerivedDataInternal(VolumeDerivedData* data, bool replaceExisting) const {
+    tgtAssert(data, "null pointer passed");
+    boost::lock_guard<boost::recursive_mutex> lock(derivedDataMutex_);
+    for (std::set<VolumeDerivedData*>::iterator it = derivedData_.begin(); it != derivedData_.end(); ++it) {
+        if (typeid(**it) == typeid(*data)) {
+            if (!replaceExisting)
+                return false;
+            delete *it;
+            derivedData_.erase(it);
+            break;
+        }
+    }
+    derivedData_.insert(data);
+    return true;
+}
+
+void VolumeBase::enqueueDerivedDataNotification() const {
+    if (!VoreenApplication::app())
+        return;
+    VoreenApplication::app()->getCommandQueue()->enqueue(this, LambdaFunctionCallback([this] {
+        std::vector<VolumeObserver*> observers = Observable<VolumeObserver>::getObservers();
+        for (size_t i = 0; i<observers.size(); ++i)
+            observers[i]->derivedDataThreadFinished(this);
+    }));
+}
 //---- data and representations
 
 VolumeRAM* VolumeBase::getSlice(size_t sliceNumber) const {
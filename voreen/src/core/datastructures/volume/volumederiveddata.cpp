@@ -31,4 +31,12 @@ namespace voreen {
 VolumeDerivedData::VolumeDerivedData() {
 }
 
+VolumeDerivedDataSweepAccumulator* VolumeDerivedData::createSweepAccumulator(const VolumeBase* /*handle*/) const {
+    return 0;
+}
+
+bool VolumeDerivedData::isSweepByproduct() const {
+    return true;
+}
+
 } // namespace voreen
@@ -0,0 +1,205 @@
+/***********************************************************************************
+ *                                                                                 *
+ * Voreen - The Volume Rendering Engine                                            *
+ *                                                                                 *
+ * Copyright (C) 2005-2024 University of Muenster, Germany,                        *
+ * Department of Computer Science.                                                 *
+ * For a list of authors please refer to the file "CREDITS.txt".                   *
+ *                                                                                 *
+ * This file is part of the Voreen software package. Voreen is free software:      *
+ * you can redistribute it and/or modify it under the terms of the GNU General     *
+ * Public License version 2 as published by the Free Software Foundation.          *
+ *                                                                                 *
+ * Voreen is distributed in the hope that it will be useful, but WITHOUT ANY       *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR   *
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.      *
+ *                                                                                 *
+ * You should have received a copy of the GNU General Public License in the file   *
+ * "LICENSE.txt" along with this file. If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                                 *
+ * For non-commercial academic use see the license exception specified in the file *
+ * "LICENSE-academic.txt". To get information about commercial licensing please    *
+ * contact the authors.                                                            *
+ *                                                                                 *
+ ***********************************************************************************/
+
+#include "voreen/core/datastructures/volume/volumederiveddatasweep.h"
+
+#include "voreen/core/datastructures/volume/volumebase.h"
+#include "voreen/core/datastructures/volume/volumedisk.h"
+#include "voreen/core/datastructures/volume/volumeram.h"
+#include "voreen/core/voreenapplication.h"
+
+#include <boost/thread.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+
+namespace voreen {
+
+const std::string VolumeDerivedDataSweep::loggerCat_("voreen.VolumeDerivedDataSweep");
+const size_t VolumeDerivedDataSweep::DEFAULT_MAX_SLAB_MEMORY = 64 << 20;
+
+VolumeDerivedDataSweep::VolumeDerivedDataSweep(const VolumeBase* volume, size_t maxSlabMemory)
+    : volume_(volume)
+    , volumeDisk_(0)
+    , slicesPerSlab_(1)
+{
+    tgtAssert(volume_, "no volume");
+    volumeDisk_ = volume_->getRepresentation<VolumeDisk>();
+    tgtAssert(volumeDisk_, "no disk representation");
+
+    tgt::svec3 dims = volumeDisk_->getDimensions();
+    size_t bytesPerSlice = std::max<size_t>(dims.x * dims.y * volumeDisk_->getBytesPerVoxel(), 1);
+    slicesPerSlab_ = tgt::clamp<size_t>(maxSlabMemory / bytesPerSlice, 1, std::max<size_t>(dims.z, 1));
+}
+
+VolumeDerivedDataSweep::~VolumeDerivedDataSweep() {
+    for (size_t i = 0; i < accumulators_.size(); i++)
+        delete accumulators_[i];
+}
+
+bool VolumeDerivedDataSweep::addDerivedData(const VolumeDerivedData* prototype) {
+    tgtAssert(prototype, "null pointer passed");
+    if (std::find(classNames_.begin(), classNames_.end(), prototype->getClassName()) != classNames_.end())
+        return false;
+
+    VolumeDerivedDataSweepAccumulator* accumulator = prototype->createSweepAccumulator(volume_);
+    if (!accumulator)
+        return false;
+
+    classNames_.push_back(prototype->getClassName());
+    accumulators_.push_back(accumulator);
+    return true;
+}
+
+void VolumeDerivedDataSweep::addMissingDerivedData() {
+    if (!VoreenApplication::app())
+        return;
+
+    std::vector<const VolumeDerivedData*> prototypes = VoreenApplication::app()->getSerializableTypes<VolumeDerivedData>();
+    for (size_t i = 0; i < prototypes.size(); i++) {
+        if (prototypes[i]->isSweepByproduct() && !volume_->hasDerivedDataOfType(prototypes[i]))
+            addDerivedData(prototypes[i]);
+    }
+}
+
+size_t VolumeDerivedDataSweep::getNumAccumulators() const {
+    return accumulators_.size();
+}
+
+std::vector<VolumeDerivedData*> VolumeDerivedDataSweep::run() {
+    size_t numSlices = volumeDisk_->getDimensions().z;
+    LDEBUG("Sweeping " << numSlices << " slices in slabs of " << slicesPerSlab_ << " for " << accumulators_.size() << " derived data item(s)");
+
+    std::unique_ptr<VolumeRAM> slab;
+    if (!accumulators_.empty() && numSlices > 0)
+        slab.reset(loadSlab(0));
+
+    for (size_t firstSlice = 0; slab && firstSlice < numSlices; firstSlice += slicesPerSlab_) {
+        boost::this_thread::interruption_point();
+
+        // load next slab in the background while the current one is processed
+        size_t nextSlice = firstSlice + slicesPerSlab_;
+        std::unique_ptr<VolumeRAM> nextSlab;
+        std::exception_ptr loadError;
+        boost::thread loader;
+        if (nextSlice < numSlices) {
+            loader = boost::thread([this, nextSlice, &nextSlab, &loadError] {
+                try {
+                    nextSlab.reset(loadSlab(nextSlice));
+                }
+                catch (...) {
+                    loadError = std::current_exception();
+                }
+            });
+        }
+
+        // feed the current slab to all accumulators, one thread per accumulator
+        std::vector<std::exception_ptr> processErrors(accumulators_.size());
+        {
+            // the worker threads access the slab and must therefore not outlive this scope
+            boost::this_thread::disable_interruption noInterruption;
+
+            const VolumeRAM* currentSlab = slab.get();
+            // exceptions must not escape the worker threads, they are rethrown after joining
+            auto process = [currentSlab, firstSlice](VolumeDerivedDataSweepAccumulator* accumulator, std::exception_ptr* error) {
+                try {
+                    accumulator->processSlab(currentSlab, firstSlice);
+                }
+                catch (...) {
+                    *error = std::current_exception();
+                }
+            };
+            std::vector<boost::thread> workers;
+            for (size_t i = 1; i < accumulators_.size(); i++)
+                workers.push_back(boost::thread(process, accumulators_[i], &processErrors[i]));
+            process(accumulators_.front(), &processErrors.front());
+
+            for (size_t i = 0; i < workers.size(); i++)
+                workers[i].join();
+            if (loader.joinable())
+                loader.join();
+        }
+
+        for (size_t i = 0; i < processErrors.size(); i++) {
+            if (processErrors[i])
+                std::rethrow_exception(processErrors[i]);
+        }
+        if (loadError) {
+            try {
+                std::rethrow_exception(loadError);
+            }
+            catch (std::exception& e) {
+                throw tgt::Exception("Failed to load slab from disk volume: " + std::string(e.what()));
+            }
+        }
+
+        slab = std::move(nextSlab);
+    }
+
+    std::vector<VolumeDerivedData*> results;
+    for (size_t i = 0; i < accumulators_.size(); i++)
+        results.push_back(accumulators_[i]->finalize());
+    return results;
+}
+
+VolumeDerivedData* VolumeDerivedDataSweep::computeWithByproducts(const VolumeBase* volume, const VolumeDerivedData* prototype) {
+    tgtAssert(volume, "no volume");
+    tgtAssert(prototype, "null pointer passed");
+
+    VolumeDerivedDataSweep sweep(volume);
+    if (!sweep.addDerivedData(prototype)) {
+        LWARNING(prototype->getClassName() << " cannot be computed by a sweep over the disk volume");
+        return 0;
+    }
+    sweep.addMissingDerivedData();
+
+    std::vector<VolumeDerivedData*> results;
+    try {
+        results = sweep.run();
+    }
+    catch (std::exception& e) {
+        LWARNING("Unable to compute " << prototype->getClassName() << ": " << e.what());
+        return 0;
+    }
+    tgtAssert(!results.empty(), "missing sweep result");
+
+    // the first accumulator belongs to the prototype, the remaining ones are by-products
+    for (size_t i = 1; i < results.size(); i++) {
+        if (results[i] && !volume->addDerivedDataIfMissing(results[i]))
+            delete results[i];
+    }
+    return results.front();
+}
+
+VolumeRAM* VolumeDerivedDataSweep::loadSlab(size_t firstSlice) const {
+    size_t lastSlice = std::min(firstSlice + slicesPerSlab_, volumeDisk_->getDimensions().z) - 1;
+    VolumeRAM* slab = volumeDisk_->loadSlices(firstSlice, lastSlice);
+    if (!slab)
+        throw tgt::Exception("VolumeDisk::loadSlices returned no volume");
+    return slab;
+}
+
+} // namespace voreen
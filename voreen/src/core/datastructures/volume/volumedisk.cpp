@@ -34,9 +34,19 @@
 #include "voreen/core/io/volumereader.h"
 #include "voreen/core/utils/hashing.h"
 
+#include "tgt/filesystem.h"
+
 #include <algorithm>
 #include <typeinfo>
 #include <fstream>
+#include <cstring>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#ifndef WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 using tgt::vec3;
 using tgt::bvec3;
@@ -78,6 +88,9 @@ VolumeDiskRaw::VolumeDiskRaw(const std::string& filename, const std::string& for
     , filename_(filename)
     , offset_(offset)
     , swapEndian_(swapEndian)
+    , mappedFileSize_(0)
+    , mappedFileTime_(0)
+    , mappingFailed_(false)
 {}
 
 VolumeDiskRaw::VolumeDiskRaw(const VolumeDiskRaw* diskrep)
@@ -85,6 +98,9 @@ VolumeDiskRaw::VolumeDiskRaw(const VolumeDiskRaw* diskrep)
     , filename_(diskrep->getFileName())
     , offset_(diskrep->getOffset())
     , swapEndian_(diskrep->getSwapEndian())
+    , mappedFileSize_(0)
+    , mappedFileTime_(0)
+    , mappingFailed_(false)
 {}
 
 VolumeDiskRaw::~VolumeDiskRaw() {
@@ -176,43 +192,14 @@ VolumeRAM* VolumeDiskRaw::loadSlices(const size_t firstSlice, const size_t lastS
     if (!vr)
         throw VoreenException("Failed to create VolumeRAM");
 
-    //open file
-    std::ifstream infile(getFileName().c_str(), std::ios::in | std::ios::binary);
-    if (infile.fail())
-        throw tgt::FileException("Failed to open file for reading: " + getFileName());
-
-    size_t bytesPerVoxel = static_cast<size_t>(vr->getBitsAllocated() / 8);
-    size_t numVoxels = getDimensions().x*getDimensions().y*(lastSlice-firstSlice+1);
-    size_t numBytes = numVoxels * bytesPerVoxel;
-
-    int64_t offset = getOffset();
-
-    if(offset < 0) {
-        //Assume data is aligned to end of file.
-
-        // get file size:
-        infile.seekg( 0, infile.end);
-        std::streampos fileSize = infile.tellg();
-        infile.seekg( 0, infile.beg);
-
-        //calculate real offset:
-        offset = static_cast<std::string::size_type>(fileSize) - hmul(getDimensions())*bytesPerVoxel;
-    }
-
-    //modify offset to start at first slice
-    offset += getDimensions().x*getDimensions().y*firstSlice*bytesPerVoxel;
-    infile.seekg(offset);
-
     //read into ram
-    infile.read(reinterpret_cast<char*>(vr->getData()),numBytes);
-
-    if (infile.fail()) {
-        //LERRORC("voreen.RepresentationConverterLoadFromDisk", "read() failed");
-        infile.close();
+    try {
+        readBrick(tgt::svec3(0, 0, firstSlice), vr->getDimensions(), reinterpret_cast<char*>(vr->getData()));
+    }
+    catch (tgt::Exception&) {
         delete vr;
-        throw tgt::FileException("Failed to read from file: " + getFileName());
+        throw;
     }
-    infile.close();
 
     //swap endian
     if(getSwapEndian()) {
@@ -234,20 +221,85 @@ VolumeRAM* VolumeDiskRaw::loadBrick(const tgt::svec3& brickOffset, const tgt::sv
 
     LDEBUG("Loading brick: offset=" << brickOffset << ", dim=" << brickDim);
 
-    // open file
-    std::ifstream infile(getFileName().c_str(), std::ios::in | std::ios::binary);
-    if (infile.fail())
-        throw tgt::FileException("Failed to open file for reading: " + getFileName());
-
     // create output VolumeRAM
     VolumeFactory vf;
     VolumeRAM* vr = vf.create(getFormat(), brickDim);
     if (!vr)
         throw VoreenException("Failed to create VolumeRAM");
 
-    size_t bytesPerVoxel = vr->getBytesPerVoxel();
-    size_t numVoxelsPerLine = brickDim.x;
-    size_t numBytesPerLine = numVoxelsPerLine * bytesPerVoxel;
+    // read lines into ram
+    try {
+        readBrick(brickOffset, brickDim, reinterpret_cast<char*>(vr->getData()));
+    }
+    catch (tgt::Exception&) {
+        delete vr;
+        throw;
+    }
+
+    //swap endian
+    if (getSwapEndian()) {
+        Volume* tempHandle = new Volume(vr, vec3(1.0f), vec3(0.0f));
+        VolumeOperatorSwapEndianness::APPLY_OP(tempHandle);
+        tempHandle->releaseAllRepresentations();
+        delete tempHandle;
+    }
+
+    return vr;
+}
+
+/// Hints the OS to read the given (mapped) memory range ahead.
+static void adviseWillNeed(const char* begin, size_t numBytes) {
+#ifndef WIN32
+    if (numBytes == 0)
+        return;
+    // madvise requires a page aligned address
+    const uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    const uintptr_t start = reinterpret_cast<uintptr_t>(begin) & ~(pageSize - 1);
+    const uintptr_t end = reinterpret_cast<uintptr_t>(begin) + numBytes;
+    madvise(reinterpret_cast<void*>(start), end - start, MADV_WILLNEED);
+#endif
+}
+
+void VolumeDiskRaw::readBrick(const tgt::svec3& brickOffset, const tgt::svec3& brickDim, char* dest) const {
+    const size_t bytesPerVoxel = getBytesPerVoxel();
+
+    // Merge rows (and slices) that are contiguous in the file into runs.
+    const bool fullRows = brickDim.x == dimensions_.x;
+    const bool fullSlices = fullRows && brickDim.y == dimensions_.y;
+    const size_t runsPerSlice = fullRows ? 1 : brickDim.y;
+    const size_t slicesPerRun = fullSlices ? brickDim.z : 1;
+    const size_t numRuns = (brickDim.z / slicesPerRun) * runsPerSlice;
+    const size_t runBytes = brickDim.x * (fullRows ? brickDim.y : 1) * slicesPerRun * bytesPerVoxel;
+
+    auto getVoxelFileOffset = [&] (size_t x, size_t y, size_t z) -> size_t {
+        return ((z*dimensions_.y + y)*dimensions_.x + x) * bytesPerVoxel;
+    };
+    auto getRunFileOffset = [&] (size_t run) -> size_t {
+        size_t z = brickOffset.z + (run / runsPerSlice) * slicesPerRun;
+        size_t y = brickOffset.y + run % runsPerSlice;
+        return getVoxelFileOffset(brickOffset.x, y, z);
+    };
+
+    std::shared_ptr<const boost::iostreams::mapped_file_source> mapping;
+    if (const char* data = getMappedData(mapping)) {
+        for (size_t run = 0; run < numRuns; run++)
+            std::memcpy(dest + run*runBytes, data + getRunFileOffset(run), runBytes);
+
+        // Readahead for slice sweeps: the brick below the current one is likely to be requested next.
+        size_t nextSlice = brickOffset.z + brickDim.z;
+        size_t lastNextSlice = std::min(nextSlice + brickDim.z, dimensions_.z);
+        for (size_t z = nextSlice; z < lastNextSlice; z += slicesPerRun) {
+            size_t begin = getVoxelFileOffset(brickOffset.x, brickOffset.y, z);
+            size_t end = getVoxelFileOffset(brickOffset.x + brickDim.x - 1, brickOffset.y + brickDim.y - 1, std::min(z + slicesPerRun, lastNextSlice) - 1) + bytesPerVoxel;
+            adviseWillNeed(data + begin, end - begin);
+        }
+        return;
+    }
+
+    // open file
+    std::ifstream infile(getFileName().c_str(), std::ios::in | std::ios::binary);
+    if (infile.fail())
+        throw tgt::FileException("Failed to open file for reading: " + getFileName());
 
     int64_t offset = getOffset();
     if (offset < 0) {
@@ -262,46 +314,53 @@ VolumeRAM* VolumeDiskRaw::loadBrick(const tgt::svec3& brickOffset, const tgt::sv
         offset = static_cast<std::string::size_type>(fileSize) - hmul(getDimensions())*bytesPerVoxel;
     }
 
-    // modify file offset to start at first slice
-    offset += (dimensions_.x*dimensions_.y*brickOffset.z + dimensions_.x*brickOffset.y + brickOffset.x)*bytesPerVoxel;
-    infile.seekg(offset);
-
-    // read lines into ram
-    size_t destOffset = 0;
-    char* destBuffer = reinterpret_cast<char*>(vr->getData());
-    for (size_t z = 0; z < brickDim.z; z++){
-        for (size_t y = 0; y < brickDim.y; y++) {
-
-            // read line into ram and write to dest buffer
-            infile.read(destBuffer+destOffset, numBytesPerLine);
-            if (infile.fail()) {
-                infile.close();
-                delete vr;
-                throw tgt::FileException("Failed to read from file: " + getFileName());
-            }
-            // move dest offset by one line
-            destOffset += numBytesPerLine;
-
-            // move file handle to next line
-            infile.seekg((dimensions_.x-brickDim.x)*bytesPerVoxel, std::ios_base::cur);
+    for (size_t run = 0; run < numRuns; run++) {
+        infile.seekg(offset + getRunFileOffset(run));
+        infile.read(dest + run*runBytes, runBytes);
+        if (infile.fail()) {
+            infile.close();
+            throw tgt::FileException("Failed to read from file: " + getFileName());
         }
+    }
+    infile.close();
+}
 
-        // move file offset to next slice
-        infile.seekg((dimensions_.y-brickDim.y)*dimensions_.x*bytesPerVoxel, std::ios_base::cur);
+const char* VolumeDiskRaw::getMappedData(std::shared_ptr<const boost::iostreams::mapped_file_source>& mapping) const {
+    boost::lock_guard<boost::mutex> lock(mappingMutex_);
+    if (mappingFailed_)
+        return 0;
 
+    // Accessing pages beyond the end of a truncated file raises SIGBUS, so remap the file if it has been
+    // modified since it was mapped. Readers still holding the old mapping keep it alive until they are done.
+    uint64_t fileSize = tgt::FileSystem::fileSize(getFileName());
+    time_t fileTime = tgt::FileSystem::fileTime(getFileName());
+    if (mappedFile_ && (fileSize != mappedFileSize_ || fileTime != mappedFileTime_)) {
+        LDEBUG(getFileName() << " has been modified, mapping it again");
+        mappedFile_.reset();
     }
 
-    infile.close();
-
-    //swap endian
-    if (getSwapEndian()) {
-        Volume* tempHandle = new Volume(vr, vec3(1.0f), vec3(0.0f));
-        VolumeOperatorSwapEndianness::APPLY_OP(tempHandle);
-        tempHandle->releaseAllRepresentations();
-        delete tempHandle;
+    if (!mappedFile_) {
+        try {
+            mappedFile_.reset(new boost::iostreams::mapped_file_source(getFileName()));
+            mappedFileSize_ = fileSize;
+            mappedFileTime_ = fileTime;
+        }
+        catch (std::exception& e) {
+            LDEBUG("Unable to map " << getFileName() << ", using stream access: " << e.what());
+            mappedFile_.reset();
+            mappingFailed_ = true;
+        }
     }
+    if (!mappedFile_)
+        return 0;
 
-    return vr;
+    size_t numBytes = hmul(getDimensions()) * getBytesPerVoxel();
+    int64_t offset = getOffset() < 0 ? static_cast<int64_t>(mappedFile_->size()) - static_cast<int64_t>(numBytes) : getOffset();
+    if (offset < 0 || offset + numBytes > mappedFile_->size())
+        throw tgt::FileException("Failed to read from file: " + getFileName());
+
+    mapping = mappedFile_;
+    return mappedFile_->data() + offset;
 }
 
 
@@ -27,12 +27,32 @@
 
 #include "voreen/core/datastructures/volume/volumedisk.h"
 #include "voreen/core/datastructures/volume/volumeram.h"
+#include "voreen/core/datastructures/volume/volumederiveddatasweep.h"
 #include "voreen/core/io/serialization/serialization.h"
 
 #include "voreen/core/utils/hashing.h"
 
 namespace voreen {
 
+namespace {
+
+/// Feeds the slabs of a VolumeDerivedDataSweep in z order into a VoreenChunkedHash.
+class VolumeChunkedHashSweepAccumulator : public VolumeDerivedDataSweepAccumulator {
+public:
+    virtual void processSlab(const VolumeRAM* slab, size_t /*firstSlice*/) {
+        hash_.update(slab->getData(), slab->getNumBytes());
+    }
+
+    virtual VolumeDerivedData* finalize() {
+        return new VolumeChunkedHash(hash_.getHash());
+    }
+
+private:
+    VoreenChunkedHash hash_;
+};
+
+} // namespace
+
 VolumeHash::VolumeHash() :
     VolumeDerivedData(),
     hash_("")
@@ -70,6 +90,60 @@ VolumeDerivedData* VolumeHash::createFrom(const VolumeBase* handle) const {
     }
 }
 
+//-------------------------------------------------------------------------------------------------
+
+VolumeChunkedHash::VolumeChunkedHash()
+    : VolumeDerivedData()
+    , hash_("")
+{}
+
+VolumeChunkedHash::VolumeChunkedHash(const std::string& hash)
+    : VolumeDerivedData()
+    , hash_(hash)
+{}
+
+VolumeDerivedData* VolumeChunkedHash::create() const {
+    return new VolumeChunkedHash();
+}
+
+VolumeDerivedData* VolumeChunkedHash::createFrom(const VolumeBase* handle) const {
+    tgtAssert(handle, "no volume");
+
+    // hash RAM representation, if present, otherwise stream the disk representation
+    if (handle->hasRepresentation<VolumeRAM>()) {
+        VolumeRAMRepresentationLock v(handle);
+        tgtAssert(*v, "no volume");
+        return new VolumeChunkedHash(VoreenHash::getChunkedHash(v->getData(), v->getNumBytes()));
+    }
+    else if (handle->hasRepresentation<VolumeDisk>()) {
+        if (VolumeDerivedData* result = VolumeDerivedDataSweep::computeWithByproducts(handle, this))
+            return result;
+    }
+    else {
+        LWARNING("Unable to compute volume hash: neither disk nor ram representation available");
+    }
+    return new VolumeChunkedHash("");
+}
+
+VolumeDerivedDataSweepAccumulator* VolumeChunkedHash::createSweepAccumulator(const VolumeBase* handle) const {
+    tgtAssert(handle, "no volume");
+    return new VolumeChunkedHashSweepAccumulator();
+}
+
+bool VolumeChunkedHash::isSweepByproduct() const {
+    return false;
+}
+
+void VolumeChunkedHash::serialize(Serializer& s) const {
+    s.serialize("hash", hash_);
+}
+
+void VolumeChunkedHash::deserialize(Deserializer& s) {
+    s.deserialize("hash", hash_);
+}
+
+//-------------------------------------------------------------------------------------------------
+
 void VolumeHash::serialize(Serializer& s) const  {
     s.serialize("hash", hash_);
 }
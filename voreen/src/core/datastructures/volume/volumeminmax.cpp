@@ -27,9 +27,46 @@
 
 #include "voreen/core/datastructures/volume/volumeram.h"
 #include "voreen/core/datastructures/volume/volumedisk.h"
+#include "voreen/core/datastructures/volume/volumederiveddatasweep.h"
 
 namespace voreen {
 
+namespace {
+
+/// Computes the per-channel min/max values slab by slab during a VolumeDerivedDataSweep.
+class VolumeMinMaxSweepAccumulator : public VolumeDerivedDataSweepAccumulator {
+public:
+    VolumeMinMaxSweepAccumulator(const VolumeBase* handle)
+        : rwm_(handle->getRealWorldMapping())
+        , minNormValues_(handle->getNumChannels(), FLT_MAX)
+        , maxNormValues_(handle->getNumChannels(), -FLT_MAX)
+    {}
+
+    virtual void processSlab(const VolumeRAM* slab, size_t /*firstSlice*/) {
+        for (size_t i = 0; i < minNormValues_.size(); i++) {
+            minNormValues_[i] = std::min(minNormValues_[i], slab->minNormalizedValue(i));
+            maxNormValues_[i] = std::max(maxNormValues_[i], slab->maxNormalizedValue(i));
+        }
+    }
+
+    virtual VolumeDerivedData* finalize() {
+        std::vector<float> minValues, maxValues;
+        for (size_t i = 0; i < minNormValues_.size(); i++) {
+            tgtAssert(minNormValues_[i] <= maxNormValues_[i], "invalid min/max values");
+            minValues.push_back(rwm_.normalizedToRealWorld(minNormValues_[i]));
+            maxValues.push_back(rwm_.normalizedToRealWorld(maxNormValues_[i]));
+        }
+        return new VolumeMinMax(minValues, maxValues, minNormValues_, maxNormValues_);
+    }
+
+private:
+    RealWorldMapping rwm_;
+    std::vector<float> minNormValues_;
+    std::vector<float> maxNormValues_;
+};
+
+} // namespace
+
 VolumeMinMax::VolumeMinMax()
     : VolumeDerivedData()
 {}
@@ -75,9 +112,15 @@ VolumeDerivedData* VolumeMinMax::createFrom(const VolumeBase* handle) const {
     std::vector<float> tMinNormValues;
     std::vector<float> tMaxNormValues;
 
+    // use RAM representation only if already present,
+    // otherwise sweep the disk representation, if available
+    if (!handle->hasRepresentation<VolumeRAM>() && handle->hasRepresentation<VolumeDisk>()) {
+        // compute min/max values of all channels (and other missing derived data) in a single pass
+        if (VolumeDerivedData* result = VolumeDerivedDataSweep::computeWithByproducts(handle, this))
+            return result;
+    }
+
     for (size_t i=0; i<handle->getNumChannels(); i++) {
-        // use RAM representation only if already present,
-        // otherwise use disk representation, if available
         float minNorm = 0.f;
         float maxNorm = 0.f;
         if (handle->hasRepresentation<VolumeRAM>()) {
@@ -87,35 +130,7 @@ VolumeDerivedData* VolumeMinMax::createFrom(const VolumeBase* handle) const {
             minNorm = v->minNormalizedValue(i);
             maxNorm = v->maxNormalizedValue(i);
         }
-        else if (handle->hasRepresentation<VolumeDisk>()) {
-            const VolumeDisk* volumeDisk = handle->getRepresentation<VolumeDisk>();
-            tgtAssert(volumeDisk, "no disk volume");
-
-            minNorm = FLT_MAX;
-            maxNorm = -FLT_MAX;
-
-            // compute min/max values slice-wise
-            size_t numSlices = handle->getDimensions().z;
-            tgtAssert(numSlices > 0, "empty volume");
-            for (size_t slice=0; slice<numSlices; slice++) {
-
-                // interruption point after each slice!
-                boost::this_thread::interruption_point();
-
-                // computation for the slice
-                try {
-                    VolumeRAM* sliceVolume = volumeDisk->loadSlices(slice, slice);
-                    minNorm = std::min(minNorm, sliceVolume->minNormalizedValue(i));
-                    maxNorm = std::max(maxNorm, sliceVolume->maxNormalizedValue(i));
-                    delete sliceVolume;
-                }
-                catch (tgt::Exception& e) {
-                    LWARNING("Unable to compute min/max values: failed to load slice from disk volume: " << e.what());
-                    break;
-                }
-            }
-        }
-        else {
+        else if (!handle->hasRepresentation<VolumeDisk>()) { //< sweep failure has already been reported
             LWARNING("Unable to compute min/max values: neither disk nor ram representation available");
         }
         tgtAssert(minNorm <= maxNorm, "invalid min/max values");
@@ -132,6 +147,11 @@ VolumeDerivedData* VolumeMinMax::createFrom(const VolumeBase* handle) const {
     return new VolumeMinMax(tMinValues, tMaxValues, tMinNormValues, tMaxNormValues);
 }
 
+VolumeDerivedDataSweepAccumulator* VolumeMinMax::createSweepAccumulator(const VolumeBase* handle) const {
+    tgtAssert(handle, "no volume");
+    return new VolumeMinMaxSweepAccumulator(handle);
+}
+
 size_t VolumeMinMax::getNumChannels() const {
     return minValues_.size();
 }
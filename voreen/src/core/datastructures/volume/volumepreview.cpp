@@ -25,10 +25,45 @@
 
 #include "voreen/core/datastructures/volume/volumepreview.h"
 #include "voreen/core/datastructures/volume/volumedisk.h"
+#include "voreen/core/datastructures/volume/volumederiveddatasweep.h"
 #include "voreen/core/datastructures/octree/volumeoctreebase.h"
 
 namespace voreen {
 
+namespace {
+
+/// Creates the preview from the center slice as soon as it is passed by a VolumeDerivedDataSweep.
+class VolumePreviewSweepAccumulator : public VolumeDerivedDataSweepAccumulator {
+public:
+    VolumePreviewSweepAccumulator(const VolumeBase* handle)
+        : handle_(handle)
+        , previewSlice_(VolumePreview::getPreviewSlice(handle))
+        , preview_(0)
+    {}
+
+    virtual ~VolumePreviewSweepAccumulator() {
+        delete preview_;
+    }
+
+    virtual void processSlab(const VolumeRAM* slab, size_t firstSlice) {
+        if (!preview_ && previewSlice_ >= firstSlice && previewSlice_ < firstSlice + slab->getDimensions().z)
+            preview_ = VolumePreview::createFromSlice(handle_, slab, previewSlice_ - firstSlice);
+    }
+
+    virtual VolumeDerivedData* finalize() {
+        VolumeDerivedData* result = preview_;
+        preview_ = 0;
+        return result;
+    }
+
+private:
+    const VolumeBase* handle_;
+    size_t previewSlice_;
+    VolumePreview* preview_;
+};
+
+} // namespace
+
 const std::string VolumePreview::loggerCat_("voreen.VolumePreview");
 
 VolumePreview::VolumePreview()
@@ -49,35 +84,6 @@ VolumeDerivedData* VolumePreview::create() const {
 VolumeDerivedData* VolumePreview::createFrom(const VolumeBase* handle) const {
     tgtAssert(handle, "no volume");
 
-    int internHeight = 64;
-
-    // gamma correction factor (amplifies low gray values)
-    const float GAMMA = 1.8f;
-
-    float xSpacing = handle->getSpacing()[0];
-    float ySpacing = handle->getSpacing()[1];
-    float xDimension = static_cast<float>(handle->getDimensions()[0]);
-    float yDimension = static_cast<float>(handle->getDimensions()[1]);
-
-    // determine offsets and scale factors for non-uniform aspect ratios
-    float aspectRatio = (yDimension * ySpacing) / (xDimension * xSpacing);
-    float xOffset, yOffset, xScale, yScale;
-    if (aspectRatio <= 1.f) {
-        xOffset = 0.f;
-        yOffset = ((internHeight - 1.f) * (1.f - aspectRatio)) / 2.f;
-        xScale = 1.f;
-        yScale = 1.f / aspectRatio;
-    }
-    else {
-        xOffset = ((internHeight -1.f) * (1.f - 1.f/aspectRatio)) / 2.f;
-        yOffset = 0.f;
-        xScale = aspectRatio;
-        yScale = 1.f;
-    }
-
-    float maxVal, minVal;
-    std::vector<float> prevData = std::vector<float>(internHeight * internHeight);
-
     std::unique_ptr<VolumeRAMRepresentationLock> lock;
     const VolumeRAM* volumeRam = nullptr;
     const VolumeDisk* volumeDisk = nullptr;
@@ -99,11 +105,11 @@ VolumeDerivedData* VolumePreview::createFrom(const VolumeBase* handle) const {
         volumeRamCreated = true;
     }
 
-    tgt::vec3 position;
-    int offset = static_cast<int>(handle->getDimensions().z - 1) / 2;
+    size_t offset = getPreviewSlice(handle);
+    size_t sliceZ = 0;
 
     if (volumeRam)
-        position.z = static_cast<float>(offset);
+        sliceZ = offset;
     else if (volumeDisk) {
         try {
             volumeRam = volumeDisk->loadSlices(offset, offset);
@@ -115,7 +121,6 @@ VolumeDerivedData* VolumePreview::createFrom(const VolumeBase* handle) const {
             LERROR("VolumeDisk::loadSlices failed to create a RAM volume");
             return 0;
         }
-        position.z = 0;
     }
     else if (volumeOctree) {
         try {
@@ -128,13 +133,67 @@ VolumeDerivedData* VolumePreview::createFrom(const VolumeBase* handle) const {
             LERROR("VolumeOctree::loadSlices failed to create a RAM volume");
             return 0;
         }
-        position.z = 0;
     }
     else {
         LERROR("Neither VolumeRAM nor VolumeDisk nor VolumeOctree available");
         return nullptr;
     }
 
+    VolumePreview* preview = createFromSlice(handle, volumeRam, sliceZ);
+
+    if (volumeRamCreated) {
+        delete volumeRam;
+        volumeRam = 0;
+    }
+
+    return preview;
+}
+
+VolumeDerivedDataSweepAccumulator* VolumePreview::createSweepAccumulator(const VolumeBase* handle) const {
+    tgtAssert(handle, "no volume");
+    return new VolumePreviewSweepAccumulator(handle);
+}
+
+size_t VolumePreview::getPreviewSlice(const VolumeBase* handle) {
+    return (std::max<size_t>(handle->getDimensions().z, 1) - 1) / 2;
+}
+
+VolumePreview* VolumePreview::createFromSlice(const VolumeBase* handle, const VolumeRAM* volumeRam, size_t sliceZ) {
+    tgtAssert(handle, "no volume");
+    tgtAssert(volumeRam, "no slice");
+
+    int internHeight = 64;
+
+    // gamma correction factor (amplifies low gray values)
+    const float GAMMA = 1.8f;
+
+    float xSpacing = handle->getSpacing()[0];
+    float ySpacing = handle->getSpacing()[1];
+    float xDimension = static_cast<float>(handle->getDimensions()[0]);
+    float yDimension = static_cast<float>(handle->getDimensions()[1]);
+
+    // determine offsets and scale factors for non-uniform aspect ratios
+    float aspectRatio = (yDimension * ySpacing) / (xDimension * xSpacing);
+    float xOffset, yOffset, xScale, yScale;
+    if (aspectRatio <= 1.f) {
+        xOffset = 0.f;
+        yOffset = ((internHeight - 1.f) * (1.f - aspectRatio)) / 2.f;
+        xScale = 1.f;
+        yScale = 1.f / aspectRatio;
+    }
+    else {
+        xOffset = ((internHeight -1.f) * (1.f - 1.f/aspectRatio)) / 2.f;
+        yOffset = 0.f;
+        xScale = aspectRatio;
+        yScale = 1.f;
+    }
+
+    float maxVal, minVal;
+    std::vector<float> prevData = std::vector<float>(internHeight * internHeight);
+
+    tgt::vec3 position;
+    position.z = static_cast<float>(sliceZ);
+
     // generate preview in float buffer
     minVal = volumeRam->elementRange().y;
     maxVal = volumeRam->elementRange().x;
@@ -152,11 +211,6 @@ VolumeDerivedData* VolumePreview::createFrom(const VolumeBase* handle) const {
         }
     }
 
-    if (volumeRamCreated) {
-        delete volumeRam;
-        volumeRam = 0;
-    }
-
     float valOffset = minVal;
     float valScale = maxVal - minVal;
     if (valScale > 0.f) {
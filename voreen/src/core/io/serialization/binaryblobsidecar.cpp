@@ -0,0 +1,184 @@
+/***********************************************************************************
+ *                                                                                 *
+ * Voreen - The Volume Rendering Engine                                            *
+ *                                                                                 *
+ * Copyright (C) 2005-2024 University of Muenster, Germany,                        *
+ * Department of Computer Science.                                                 *
+ * For a list of authors please refer to the file "CREDITS.txt".                   *
+ *                                                                                 *
+ * This file is part of the Voreen software package. Voreen is free software:      *
+ * you can redistribute it and/or modify it under the terms of the GNU General     *
+ * Public License version 2 as published by the Free Software Foundation.          *
+ *                                                                                 *
+ * Voreen is distributed in the hope that it will be useful, but WITHOUT ANY       *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR   *
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.      *
+ *                                                                                 *
+ * You should have received a copy of the GNU General Public License in the file   *
+ * "LICENSE.txt" along with this file. If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                                 *
+ * For non-commercial academic use see the license exception specified in the file *
+ * "LICENSE-academic.txt". To get information about commercial licensing please    *
+ * contact the authors.                                                            *
+ *                                                                                 *
+ ***********************************************************************************/
+
+#include "voreen/core/io/serialization/binaryblobsidecar.h"
+
+#include "voreen/core/io/serialization/deserializer.h"
+#include "voreen/core/io/serialization/serializationexceptions.h"
+
+#include "tgt/filesystem.h"
+
+#include <boost/iostreams/device/mapped_file.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/lock_guard.hpp>
+
+#include <cstdio>
+#include <ctime>
+#include <random>
+#include <vector>
+
+namespace voreen {
+
+const size_t BinaryBlobSidecar::ALIGNMENT = 64;
+const std::string BinaryBlobSidecar::OFFSET_KEY_SUFFIX = ".blobOffset";
+const std::string BinaryBlobSidecar::LENGTH_KEY_SUFFIX = ".blobLength";
+
+const std::string BinaryBlobSidecar::DOCUMENT_KEY = "BinaryBlobSidecar";
+
+static const std::string SIDECAR_EXTENSION = ".blobs";
+
+std::string BinaryBlobSidecar::createFilename(const std::string& documentFilename) {
+    static boost::mutex mutex;
+    static std::random_device device;
+    static std::mt19937_64 generator(device() ^ static_cast<uint64_t>(time(0)));
+
+    uint64_t id;
+    {
+        boost::lock_guard<boost::mutex> lock(mutex);
+        id = generator();
+    }
+
+    char idString[16 + 1];
+    sprintf(idString, "%016llx", static_cast<unsigned long long>(id));
+    return documentFilename + "." + idString + SIDECAR_EXTENSION;
+}
+
+std::string BinaryBlobSidecar::getReferencedFilename(Deserializer& d, const std::string& documentFilename) {
+    std::string sidecarName;
+    d.optionalDeserialize(DOCUMENT_KEY, sidecarName, std::string(""));
+    if (sidecarName.empty())
+        return "";
+
+    // only file names are recorded, the sidecar has to be located next to the document
+    if (sidecarName != tgt::FileSystem::fileName(sidecarName))
+        throw SerializationFormatException("Invalid binary blob file name: '" + sidecarName + "'.");
+
+    std::string dir = tgt::FileSystem::dirName(documentFilename);
+    return dir.empty() ? sidecarName : tgt::FileSystem::cleanupPath(dir + "/" + sidecarName);
+}
+
+void BinaryBlobSidecar::deleteFiles(const std::string& documentFilename, const std::string& keepFilename) {
+    std::string dir = tgt::FileSystem::dirName(documentFilename);
+    std::string prefix = tgt::FileSystem::fileName(documentFilename) + ".";
+    std::string keep = tgt::FileSystem::fileName(keepFilename);
+
+    std::vector<std::string> files = tgt::FileSystem::listFiles(dir.empty() ? "." : dir);
+    for (size_t i = 0; i < files.size(); i++) {
+        const std::string& file = files[i];
+        if (file == keep || file.size() <= prefix.size() + SIDECAR_EXTENSION.size()
+                || file.compare(0, prefix.size(), prefix) != 0
+                || file.compare(file.size() - SIDECAR_EXTENSION.size(), SIDECAR_EXTENSION.size(), SIDECAR_EXTENSION) != 0)
+            continue;
+
+        // only delete files named by createFilename()
+        std::string id = file.substr(prefix.size(), file.size() - prefix.size() - SIDECAR_EXTENSION.size());
+        if (id.size() != 16 || id.find_first_not_of("0123456789abcdef") != std::string::npos)
+            continue;
+        tgt::FileSystem::deleteFile(dir.empty() ? file : dir + "/" + file);
+    }
+}
+
+// ----------------------------------------------------------------------------
+
+BinaryBlobSidecarWriter::BinaryBlobSidecarWriter(const std::string& filename)
+    : filename_(filename)
+    , stream_(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc)
+    , size_(0)
+{
+    if (stream_.fail())
+        throw SerializationException("Failed to open binary blob file '" + filename + "' for writing.");
+}
+
+BinaryBlobSidecarWriter::~BinaryBlobSidecarWriter() {
+}
+
+size_t BinaryBlobSidecarWriter::append(const unsigned char* data, size_t length) {
+    tgtAssert(stream_.is_open(), "sidecar file already closed");
+
+    size_t padding = (BinaryBlobSidecar::ALIGNMENT - size_ % BinaryBlobSidecar::ALIGNMENT) % BinaryBlobSidecar::ALIGNMENT;
+    if (padding > 0) {
+        static const std::vector<char> zeros(BinaryBlobSidecar::ALIGNMENT, 0);
+        stream_.write(zeros.data(), padding);
+        size_ += padding;
+    }
+
+    size_t offset = size_;
+    if (length > 0)
+        stream_.write(reinterpret_cast<const char*>(data), length);
+    size_ += length;
+
+    if (stream_.fail())
+        throw SerializationException("Failed to write binary blob to file '" + filename_ + "'.");
+
+    return offset;
+}
+
+void BinaryBlobSidecarWriter::close() {
+    stream_.close();
+    if (stream_.fail())
+        throw SerializationException("Failed to write binary blob file '" + filename_ + "'.");
+}
+
+const std::string& BinaryBlobSidecarWriter::getFilename() const {
+    return filename_;
+}
+
+// ----------------------------------------------------------------------------
+
+BinaryBlobSidecarReader::BinaryBlobSidecarReader(const std::string& filename)
+    : filename_(filename)
+{
+    // Empty files cannot be mapped, but do not contain any blobs either.
+    if (tgt::FileSystem::fileSize(filename) == 0)
+        return;
+
+    try {
+        file_.reset(new boost::iostreams::mapped_file_source(filename));
+    }
+    catch (std::exception& e) {
+        throw SerializationException("Failed to map binary blob file '" + filename + "': " + e.what());
+    }
+}
+
+BinaryBlobSidecarReader::~BinaryBlobSidecarReader() {
+}
+
+const unsigned char* BinaryBlobSidecarReader::getData(size_t offset, size_t length) const {
+    static const unsigned char empty = 0;
+    if (length == 0)
+        return &empty;
+
+    size_t fileSize = file_ ? file_->size() : 0;
+    if (offset > fileSize || length > fileSize - offset)
+        throw SerializationFormatException("Binary blob exceeds the binary blob file '" + filename_ + "'.");
+
+    return reinterpret_cast<const unsigned char*>(file_->data()) + offset;
+}
+
+const std::string& BinaryBlobSidecarReader::getFilename() const {
+    return filename_;
+}
+
+} // namespace voreen
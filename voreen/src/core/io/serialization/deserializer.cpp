@@ -24,6 +24,7 @@
  ***********************************************************************************/
 
 #include "voreen/core/io/serialization/deserializer.h"
+#include "voreen/core/io/serialization/binaryblobsidecar.h"
 
 namespace voreen {
 
@@ -51,6 +52,14 @@ void Deserializer::setUsePointerContentSerialization(const bool& usePointerConte
     DISPATCH_TO_DESERIALIZER(setUsePointerContentSerialization(usePointerContentSerialization));
 }
 
+void Deserializer::setBinaryBlobSidecarReader(const BinaryBlobSidecarReader* reader) {
+    DISPATCH_TO_DESERIALIZER(setBinaryBlobSidecarReader(reader));
+}
+
+const BinaryBlobSidecarReader* Deserializer::getBinaryBlobSidecarReader() const {
+    DISPATCH_TO_DESERIALIZER_RET(getBinaryBlobSidecarReader());
+}
+
 void Deserializer::addError(const std::string& message) {
     DISPATCH_TO_DESERIALIZER(addError(message));
 }
@@ -125,7 +134,37 @@ static std::vector<unsigned char> base64Decode(const std::string& input) {
     return decodedBytes;
 }
 
+bool Deserializer::getSidecarBinaryBlob(const std::string& key, const unsigned char*& data, size_t& length) {
+    const BinaryBlobSidecarReader* sidecar = getBinaryBlobSidecarReader();
+    if (!sidecar)
+        return false;
+
+    size_t offset = 0;
+    try {
+        deserialize(key + BinaryBlobSidecar::OFFSET_KEY_SUFFIX, offset);
+    }
+    catch (SerializationNoSuchDataException&) {
+        // blob is embedded into the document
+        removeLastError();
+        return false;
+    }
+    deserialize(key + BinaryBlobSidecar::LENGTH_KEY_SUFFIX, length);
+
+    data = sidecar->getData(offset, length);
+    return true;
+}
+
 void Deserializer::deserializeBinaryBlob(const std::string& key, unsigned char* inputBuffer, size_t reservedMemory) {
+    const unsigned char* sidecarData = 0;
+    size_t sidecarLength = 0;
+    if (getSidecarBinaryBlob(key, sidecarData, sidecarLength)) {
+        if (sidecarLength != reservedMemory)
+            throw SerializationFormatException("Node with key '" + key + "' references a binary blob for which unsufficient memory has been reserved.");
+        if (reservedMemory > 0)
+            memcpy(inputBuffer, sidecarData, reservedMemory);
+        return;
+    }
+
     std::string tmp;
     deserialize(key, tmp);
     std::vector<unsigned char> dataVec = base64Decode(tmp);
@@ -139,6 +178,13 @@ void Deserializer::deserializeBinaryBlob(const std::string& key, unsigned char*
 }
 
 void Deserializer::deserializeBinaryBlob(const std::string& key, std::vector<unsigned char>& buffer) {
+    const unsigned char* sidecarData = 0;
+    size_t sidecarLength = 0;
+    if (getSidecarBinaryBlob(key, sidecarData, sidecarLength)) {
+        buffer.assign(sidecarData, sidecarData + sidecarLength);
+        return;
+    }
+
     std::string tmp;
     deserialize(key, tmp);
     buffer = base64Decode(tmp);
@@ -24,6 +24,7 @@
  ***********************************************************************************/
 
 #include "voreen/core/io/serialization/serializer.h"
+#include "voreen/core/io/serialization/binaryblobsidecar.h"
 
 namespace voreen {
 
@@ -51,6 +52,14 @@ void Serializer::setUsePointerContentSerialization(const bool& usePointerContent
     DISPATCH_TO_SERIALIZER(setUsePointerContentSerialization(usePointerContentSerialization));
 }
 
+void Serializer::setBinaryBlobSidecarWriter(BinaryBlobSidecarWriter* writer) {
+    DISPATCH_TO_SERIALIZER(setBinaryBlobSidecarWriter(writer));
+}
+
+BinaryBlobSidecarWriter* Serializer::getBinaryBlobSidecarWriter() const {
+    DISPATCH_TO_SERIALIZER_RET(getBinaryBlobSidecarWriter());
+}
+
 void Serializer::addError(const std::string& message) {
     DISPATCH_TO_SERIALIZER(addError(message));
 }
@@ -112,11 +121,20 @@ static std::string base64Encode(const std::vector<unsigned char>& inputBuffer) {
 }
 
 void Serializer::serializeBinaryBlob(const std::string& key, const unsigned char* data, size_t length) {
-    serialize(key, base64Encode(std::vector<unsigned char>(data, data + length)));
+    if (BinaryBlobSidecarWriter* sidecar = getBinaryBlobSidecarWriter()) {
+        // only the location of the blob within the sidecar file is stored in the document
+        serialize(key + BinaryBlobSidecar::OFFSET_KEY_SUFFIX, sidecar->append(data, length));
+        serialize(key + BinaryBlobSidecar::LENGTH_KEY_SUFFIX, length);
+    }
+    else
+        serialize(key, base64Encode(std::vector<unsigned char>(data, data + length)));
 }
 
 void Serializer::serializeBinaryBlob(const std::string& key, const std::vector<unsigned char>& data) {
-    serialize(key, base64Encode(data));
+    if (getBinaryBlobSidecarWriter())
+        serializeBinaryBlob(key, data.empty() ? 0 : &data[0], data.size());
+    else
+        serialize(key, base64Encode(data));
 }
 
 
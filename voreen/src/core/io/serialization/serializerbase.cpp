@@ -30,6 +30,8 @@ namespace voreen {
 SerializerBase::SerializerBase()
     : errors_()
     , usePointerContentSerialization_(false)
+    , binaryBlobSidecarWriter_(0)
+    , binaryBlobSidecarReader_(0)
 {
 }
 
@@ -41,6 +43,22 @@ bool SerializerBase::getUsePointerContentSerialization() const {
     return usePointerContentSerialization_;
 }
 
+void SerializerBase::setBinaryBlobSidecarWriter(BinaryBlobSidecarWriter* writer) {
+    binaryBlobSidecarWriter_ = writer;
+}
+
+BinaryBlobSidecarWriter* SerializerBase::getBinaryBlobSidecarWriter() const {
+    return binaryBlobSidecarWriter_;
+}
+
+void SerializerBase::setBinaryBlobSidecarReader(const BinaryBlobSidecarReader* reader) {
+    binaryBlobSidecarReader_ = reader;
+}
+
+const BinaryBlobSidecarReader* SerializerBase::getBinaryBlobSidecarReader() const {
+    return binaryBlobSidecarReader_;
+}
+
 void SerializerBase::addError(const std::string& message) {
     errors_.push_back(message);
 }
@@ -27,60 +27,128 @@
 
 #include "voreen/core/datastructures/volume/volume.h"
 #include "voreen/core/datastructures/volume/volumedecorator.h"
+#include "voreen/core/datastructures/volume/volumedisk.h"
 
 #include "voreen/core/voreenapplication.h"
 
 #include "tgt/gpucapabilities.h"
 
+#include <algorithm>
+#include <typeinfo>
+
 namespace voreen {
 
 VolumeMemoryManager::VolumeEntity::VolumeEntity(VolumeBase* volume)
     : volume_(volume)
     , numLockedUses_(0)
+    , lastUse_(0)
+    , prev_(0)
+    , next_(0)
 {
 }
 
+VolumeMemoryManager::Shard::Shard()
+    : head_(0)
+    , tail_(0)
+{
+}
+
+void VolumeMemoryManager::Shard::pushFront(VolumeEntity* entity) {
+    entity->prev_ = 0;
+    entity->next_ = head_;
+    if (head_)
+        head_->prev_ = entity;
+    head_ = entity;
+    if (!tail_)
+        tail_ = entity;
+}
+
+void VolumeMemoryManager::Shard::unlink(VolumeEntity* entity) {
+    if (entity->prev_)
+        entity->prev_->next_ = entity->next_;
+    else
+        head_ = entity->next_;
+    if (entity->next_)
+        entity->next_->prev_ = entity->prev_;
+    else
+        tail_ = entity->prev_;
+    entity->prev_ = 0;
+    entity->next_ = 0;
+}
+
 const std::string VolumeMemoryManager::loggerCat_("voreen.VolumeMemoryManager");
+const size_t VolumeMemoryManager::NUM_SHARDS;
+
+namespace {
+
+// relative costs of recreating a removed representation
+const float RELOAD_COST_DISK = 4.f;     ///< representation has to be read from disk again
+const float RELOAD_COST_DERIVED = 1.f;  ///< representation can be converted from another in-memory representation
+
+} // namespace
 
 VolumeMemoryManager::VolumeMemoryManager()
-    : availableMainMemory_(0)
+    : useCounter_(0)
+    , availableMainMemory_(0)
     , availableMainMemoryInvalid_(true)
     , availableGraphicsMemory_(0)
     , availableGraphicsMemoryInvalid_(true)
 { }
 
 VolumeMemoryManager::~VolumeMemoryManager() {
-    if (!registeredVolumes_.empty()) {
-        LERROR("List of registered volumes is not empty! " << registeredVolumes_.size() << " volume(s) not deregistered.");
+    size_t numRegisteredVolumes = 0;
+    for (size_t i = 0; i < NUM_SHARDS; i++) {
+        numRegisteredVolumes += shards_[i].index_.size();
+        for (auto it = shards_[i].index_.begin(); it != shards_[i].index_.end(); ++it)
+            delete it->second;
+        shards_[i].index_.clear();
+    }
+    if (numRegisteredVolumes > 0) {
+        LERROR("List of registered volumes is not empty! " << numRegisteredVolumes << " volume(s) not deregistered.");
     }
 }
 
 void VolumeMemoryManager::registerVolume(VolumeBase* v) {
-    boost::lock_guard<boost::recursive_mutex> lock(vmmMutex_);
+    Shard& shard = getShard(v);
+    {
+        boost::lock_guard<boost::mutex> lock(shard.mutex_);
 
-    if (findRegisteredVolumeEntity(v) != registeredVolumes_.end()) {
-        LERROR("Cannot register volume, volume has already been registered!");
-        return;
-    }
+        if (shard.index_.count(v)) {
+            LERROR("Cannot register volume, volume has already been registered!");
+            return;
+        }
 
-    // Now, we add the representation.
-    registeredVolumes_.push_front(v);
+        // Now, we add the representation.
+        VolumeEntity* entity = new VolumeEntity(v);
+        entity->lastUse_ = ++useCounter_;
+        shard.index_[v] = entity;
+        shard.pushFront(entity);
+    }
 
     updateMainMemory();
     updateGraphicsMemory();
 }
 
 void VolumeMemoryManager::deregisterVolume(VolumeBase* v) {
-    boost::lock_guard<boost::recursive_mutex> lock(vmmMutex_);
-    auto it = findRegisteredVolumeEntity(v);
+    // eviction accesses registered volumes while holding vmmMutex_, so they must not be deregistered (and destroyed) concurrently
+    boost::lock_guard<boost::recursive_mutex> vmmLock(vmmMutex_);
 
-    if (it == registeredVolumes_.end()) {
-        LERROR("Cannot deregister volume, not found in volume list!");
-        return;
-    }
+    Shard& shard = getShard(v);
+    {
+        boost::lock_guard<boost::mutex> lock(shard.mutex_);
+        auto it = shard.index_.find(v);
 
-    tgtAssert(it->numLockedUses_ == 0, "Volume Representation still has locked uses.");
-    registeredVolumes_.erase(it);
+        if (it == shard.index_.end()) {
+            LERROR("Cannot deregister volume, not found in volume list!");
+            return;
+        }
+
+        VolumeEntity* entity = it->second;
+        tgtAssert(entity->numLockedUses_ == 0, "Volume Representation still has locked uses.");
+        shard.unlink(entity);
+        shard.index_.erase(it);
+        delete entity;
+    }
 
     updateMainMemory();
     updateGraphicsMemory();
@@ -98,45 +166,8 @@ bool VolumeMemoryManager::requestMainMemory(const VolumeBase* v) {
 
     size_t requiredMemory = getMemoryRequirement(v);
 
-    // perform first check
-    bool memoryCheck = (requiredMemory <= getAvailableMainMemory());
-
-    // find the requested volume to avoid removing its representations
-    auto requestedVolume = findRegisteredVolumeEntity(v);
-    // start at least recently used volume to free memory
-    auto currentVolume = registeredVolumes_.end() - 1;
-
-    while (!memoryCheck) {
-        LDEBUG("Not enough resources... trying to free main memory.");
-        // do not remove representations from...
-        if (       currentVolume == requestedVolume // the original volume
-                || !(currentVolume->volume_->hasRepresentation<VolumeRAM>()) // ones that do not have a RAM representation
-                || currentVolume->numLockedUses_ > 0) { // ones whose RAM representation cannot be deleted currently.
-            // if every volume has been checked: break
-            if (currentVolume == registeredVolumes_.begin())
-                break;
-            else {
-                currentVolume--;
-                continue;
-            }
-        }
-
-        // check all representations of the current volume and see if there is one that can be converted to VolumeRAM before removing it
-        if (currentVolume->volume_->canConvertToRepresentation<VolumeRAM>()) {
-            currentVolume->volume_->removeRepresentation<VolumeRAM>();
-            LDEBUG("Removed one RAM representation");
-        }
-
-        // update check
-        memoryCheck = (requiredMemory <= getAvailableMainMemory());
-
-        // if we have checked every volume: break
-        if (currentVolume == registeredVolumes_.begin())
-            break;
-
-        // check the next volume
-        currentVolume--;
-    }
+    // do not remove representations from the requested volume
+    bool memoryCheck = evictRepresentations<VolumeRAM>(requiredMemory, v);
 
     LDEBUG("Main memory check result: " << memoryCheck);
 
@@ -151,43 +182,7 @@ bool VolumeMemoryManager::requestMainMemory(size_t requiredMemory) {
     if(VoreenApplication::app() && (VoreenApplication::app()->getCpuRamLimit() < requiredMemory))
         return false;
 
-    // perform first check
-    bool memoryCheck = (requiredMemory <= getAvailableMainMemory());
-
-    // start at least recently used volume to free memory
-    auto currentVolume = registeredVolumes_.end() - 1;
-
-    while (!memoryCheck) {
-        LDEBUG("Not enough resources... trying to free main memory.");
-        // do not remove representations from volumes that do not have the representation
-        if (
-                !(currentVolume->volume_->hasRepresentation<VolumeRAM>())
-                || currentVolume->numLockedUses_ > 0) { // ... or whose RAM representation cannot be deleted currently.
-            // if every volume has been checked: break
-            if (currentVolume == registeredVolumes_.begin())
-                break;
-            else {
-                currentVolume--;
-                continue;
-            }
-        }
-
-        // check all representations of the current volume and see if there is one that can be converted to VolumeRAM before removing it
-        if (currentVolume->volume_->canConvertToRepresentation<VolumeRAM>()) {
-            currentVolume->volume_->removeRepresentation<VolumeRAM>();
-            LDEBUG("Removed one RAM representation");
-        }
-
-        // update check
-        memoryCheck = (requiredMemory <= getAvailableMainMemory());
-
-        // if we have checked every volume: break
-        if (currentVolume == registeredVolumes_.begin())
-            break;
-
-        // check the next volume
-        currentVolume--;
-    }
+    bool memoryCheck = evictRepresentations<VolumeRAM>(requiredMemory, 0);
 
     LDEBUG("Main memory check result: " << memoryCheck);
 
@@ -230,42 +225,7 @@ bool VolumeMemoryManager::requestGraphicsMemory(const VolumeBase* v) {
         return false;
 
     // actual check: use proxy texture to check if the GPU allows the texture upload and check the available memory
-    bool memoryCheck = (requiredMemory <= getAvailableGraphicsMemory()) && checkProxyTexture(v);
-
-    // find the requested volume to avoid removing its representations
-    auto requestedVolume = findRegisteredVolumeEntity(v);
-    // start at least recently used volume to free memory
-    auto currentVolume = registeredVolumes_.end() - 1;
-
-    while (!memoryCheck) {
-        LDEBUG("Not enough resources... trying to free GPU memory.");
-        // do not remove representations from the request volumes or from volumes that do not have the representation
-        if (currentVolume == requestedVolume || !(currentVolume->volume_->hasRepresentation<VolumeGL>())) {
-            // if every volume has been checked: break
-            if (currentVolume == registeredVolumes_.begin())
-                break;
-            else {
-                currentVolume--;
-                continue;
-            }
-        }
-
-        // check all representations of the current volume and see if there is one that can be converted to VolumeGL before removing it
-        if (currentVolume->volume_->canConvertToRepresentation<VolumeGL>()) {
-            currentVolume->volume_->removeRepresentation<VolumeGL>();
-            LDEBUG("Removed one GL representation");
-        }
-
-        // update check
-        memoryCheck = (requiredMemory <= getAvailableGraphicsMemory()) && checkProxyTexture(v);
-
-        // if we have checked every volume: break
-        if (currentVolume == registeredVolumes_.begin())
-            break;
-
-        // check the next volume
-        currentVolume--;
-    }
+    bool memoryCheck = evictRepresentations<VolumeGL>(requiredMemory, v) && checkProxyTexture(v);
 
     LDEBUG("GPU Memory check result: " << memoryCheck);
 
@@ -274,42 +234,49 @@ bool VolumeMemoryManager::requestGraphicsMemory(const VolumeBase* v) {
 
 void VolumeMemoryManager::notifyUse(const VolumeBase* v, bool locked) {
     tgtAssert(v, "volume must not be null");
-    boost::lock_guard<boost::recursive_mutex> lock(vmmMutex_);
 
     v = getActualVolume(v);
 
-    auto it = findRegisteredVolumeEntity(v);
+    Shard& shard = getShard(v);
+    boost::lock_guard<boost::mutex> lock(shard.mutex_);
+
+    auto it = shard.index_.find(v);
 
-    if (it == registeredVolumes_.end()) {
+    if (it == shard.index_.end()) {
         LERROR("Notifying use for unregistered volume!");
         return;
     }
 
+    VolumeEntity* entity = it->second;
     if (locked) {
-        it->numLockedUses_++;
+        entity->numLockedUses_++;
     }
 
-    // remove and put to front
-    VolumeEntity entity = *it;    // Backup entity.
-    registeredVolumes_.erase(it); // Invalidates the iterator.
-    registeredVolumes_.push_front(entity);
+    // move to front
+    entity->lastUse_ = ++useCounter_;
+    if (shard.head_ != entity) {
+        shard.unlink(entity);
+        shard.pushFront(entity);
+    }
 }
 
 void VolumeMemoryManager::notifyLockedRelease(const VolumeBase* v) {
     tgtAssert(v, "volume must not be null");
-    boost::lock_guard<boost::recursive_mutex> lock(vmmMutex_);
 
     v = getActualVolume(v);
 
-    auto it = findRegisteredVolumeEntity(v);
+    Shard& shard = getShard(v);
+    boost::lock_guard<boost::mutex> lock(shard.mutex_);
 
-    if (it == registeredVolumes_.end()) {
+    auto it = shard.index_.find(v);
+
+    if (it == shard.index_.end()) {
         LERROR("Notifying locked release for unregistered volume!");
         return;
     }
 
-    tgtAssert(it->numLockedUses_ > 0, "No locked uses left");
-    it->numLockedUses_--;
+    tgtAssert(it->second->numLockedUses_ > 0, "No locked uses left");
+    it->second->numLockedUses_--;
 }
 
 void VolumeMemoryManager::updateMainMemory() {
@@ -332,9 +299,10 @@ size_t VolumeMemoryManager::getAvailableMainMemory() const {
     // iterate over volumes and add to used memory each time a VolumeRAM is found
     size_t usedMemory = 0;
 
-    for (auto it = registeredVolumes_.begin(); it != registeredVolumes_.end(); ++it) {
-        if (it->volume_->hasRepresentation<VolumeRAM>())
-            usedMemory += getMemoryRequirement(it->volume_);
+    std::vector<VolumeBase*> volumes = getRegisteredVolumes();
+    for (size_t i = 0; i < volumes.size(); i++) {
+        if (volumes[i]->hasRepresentation<VolumeRAM>())
+            usedMemory += getMemoryRequirement(volumes[i]);
     }
 
     if (usedMemory > totalMemory)   // may occur if the application settings have changed
@@ -363,9 +331,10 @@ size_t VolumeMemoryManager::getAvailableGraphicsMemory() const {
     // iterate over volumes and add to used memory each time a VolumeGL is found
     size_t usedMemory = 0;
 
-    for (auto it = registeredVolumes_.begin(); it != registeredVolumes_.end(); ++it) {
-        if (it->volume_->hasRepresentation<VolumeGL>()) {
-            size_t requiredMemory = getMemoryRequirement(it->volume_);
+    std::vector<VolumeBase*> volumes = getRegisteredVolumes();
+    for (size_t i = 0; i < volumes.size(); i++) {
+        if (volumes[i]->hasRepresentation<VolumeGL>()) {
+            size_t requiredMemory = getMemoryRequirement(volumes[i]);
             // FIXME: textures seem to take up some additional space (overhead)
             requiredMemory += requiredMemory / 10;
             usedMemory += requiredMemory;
@@ -412,10 +381,106 @@ const VolumeBase* VolumeMemoryManager::getActualVolume(const VolumeBase* v) {
     return dynamic_cast<const Volume*>(v);
 }
 
-std::deque<VolumeMemoryManager::VolumeEntity>::iterator VolumeMemoryManager::findRegisteredVolumeEntity(const VolumeBase* v) {
-    return std::find_if(registeredVolumes_.begin(), registeredVolumes_.end(), [v] (VolumeEntity& ref) {
-            return ref.volume_ == v;
+VolumeMemoryManager::Shard& VolumeMemoryManager::getShard(const VolumeBase* v) const {
+    // volumes are heap objects, so the lowest bits of their addresses carry no information
+    size_t hash = static_cast<size_t>(reinterpret_cast<uintptr_t>(v) >> 4);
+    hash ^= (hash >> 7);
+    return shards_[hash % NUM_SHARDS];
+}
+
+bool VolumeMemoryManager::isLocked(const VolumeBase* v) const {
+    Shard& shard = getShard(v);
+    boost::lock_guard<boost::mutex> lock(shard.mutex_);
+    auto it = shard.index_.find(v);
+    return it != shard.index_.end() && it->second->numLockedUses_ > 0;
+}
+
+std::vector<VolumeBase*> VolumeMemoryManager::getRegisteredVolumes() const {
+    std::vector<VolumeBase*> volumes;
+    for (size_t i = 0; i < NUM_SHARDS; i++) {
+        boost::lock_guard<boost::mutex> lock(shards_[i].mutex_);
+        for (VolumeEntity* entity = shards_[i].head_; entity; entity = entity->next_)
+            volumes.push_back(entity->volume_);
+    }
+    return volumes;
+}
+
+template<class T>
+float VolumeMemoryManager::getReloadCost(const VolumeBase* v) const {
+    // a GL representation can be uploaded from an existing RAM representation, a RAM representation from a GL texture
+    if (typeid(T) == typeid(VolumeGL) && v->hasRepresentation<VolumeRAM>())
+        return RELOAD_COST_DERIVED;
+    if (typeid(T) == typeid(VolumeRAM) && v->hasRepresentation<VolumeGL>())
+        return RELOAD_COST_DERIVED;
+    if (v->hasRepresentation<VolumeDisk>())
+        return RELOAD_COST_DISK;
+    return RELOAD_COST_DERIVED;
+}
+
+template<class T>
+std::vector<VolumeMemoryManager::EvictionCandidate> VolumeMemoryManager::getEvictionCandidates(const VolumeBase* excludedVolume) const {
+    // collect candidates shard by shard (only the shard mutex is held while traversing its LRU list)
+    std::vector<EvictionCandidate> candidates;
+    for (size_t i = 0; i < NUM_SHARDS; i++) {
+        boost::lock_guard<boost::mutex> lock(shards_[i].mutex_);
+        for (VolumeEntity* entity = shards_[i].tail_; entity; entity = entity->prev_) {
+            // RAM representations may not be removed as long as they are locked
+            if (entity->volume_ == excludedVolume || (typeid(T) == typeid(VolumeRAM) && entity->numLockedUses_ > 0))
+                continue;
+            EvictionCandidate candidate;
+            candidate.volume_ = entity->volume_;
+            candidate.lastUse_ = entity->lastUse_;
+            candidate.score_ = 0.0;
+            candidates.push_back(candidate);
+        }
+    }
+
+    // rank candidates: prefer representations that have not been used for a long time, free a lot of memory
+    // and are cheap to recreate
+    uint64_t now = useCounter_;
+    std::vector<EvictionCandidate> result;
+    for (size_t i = 0; i < candidates.size(); i++) {
+        EvictionCandidate& candidate = candidates[i];
+        if (!candidate.volume_->hasRepresentation<T>() || !candidate.volume_->canConvertToRepresentation<T>())
+            continue;
+        double age = static_cast<double>(now - std::min(now, candidate.lastUse_)) + 1.0;
+        double size = static_cast<double>(getMemoryRequirement(candidate.volume_)) + 1.0;
+        candidate.score_ = age * size / getReloadCost<T>(candidate.volume_);
+        result.push_back(candidate);
+    }
+    std::sort(result.begin(), result.end(), [] (const EvictionCandidate& a, const EvictionCandidate& b) {
+            return a.score_ > b.score_;
             });
+
+    return result;
+}
+
+template<class T>
+bool VolumeMemoryManager::evictRepresentations(size_t requiredMemory, const VolumeBase* excludedVolume) {
+    const bool isGL = (typeid(T) == typeid(VolumeGL));
+    size_t availableMemory = (isGL ? getAvailableGraphicsMemory() : getAvailableMainMemory());
+    if (requiredMemory <= availableMemory)
+        return true;
+
+    std::vector<EvictionCandidate> candidates = getEvictionCandidates<T>(excludedVolume);
+    for (size_t i = 0; i < candidates.size() && requiredMemory > availableMemory; i++) {
+        LDEBUG("Not enough resources... trying to free " << (isGL ? "GPU" : "main") << " memory.");
+
+        VolumeBase* volume = candidates[i].volume_;
+        // the RAM representation might have been locked since the candidates have been collected
+        if (!isGL && isLocked(volume))
+            continue;
+
+        volume->removeRepresentation<T>();
+        LDEBUG("Removed one " << (isGL ? "GL" : "RAM") << " representation");
+
+        size_t freedMemory = getMemoryRequirement(volume);
+        if (isGL)
+            freedMemory += freedMemory / 10;
+        availableMemory += freedMemory;
+    }
+
+    return requiredMemory <= availableMemory;
 }
 
 VolumeRAMRepresentationLock::VolumeRAMRepresentationLock(const VolumeBase* volume)
@@ -29,6 +29,10 @@
 #include "voreen/core/network/processornetwork.h"
 #include "voreen/core/interaction/idmanager.h"
 #include "voreen/core/network/networkgraph.h"
+#include "voreen/core/ports/coprocessorport.h"
+#include "voreen/core/ports/renderport.h"
+#include "voreen/core/processors/renderprocessor.h"
+#include "voreen/core/properties/link/propertylink.h"
 #include "voreen/core/utils/exception.h"
 
 #include "modules/core/processors/output/canvasrenderer.h" //< core module is always available
@@ -39,14 +43,58 @@
 #include "tgt/immediatemode/immediatemode.h"
 
 #include <vector>
+#include <deque>
+
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
 
 namespace voreen {
 
 const std::string NetworkEvaluator::loggerCat_("voreen.NetworkEvaluator");
 
+// Defined before ~NetworkEvaluator(), which deletes the worker pool and thereby joins the workers.
+struct NetworkEvaluator::ConcurrentEvaluationQueue {
+    /// Job finished by a worker thread.
+    struct Result {
+        size_t index_;                                      ///< index into the rendering order
+        ProcessingResult result_;
+        Processor::DeferredNotifications notifications_;    ///< to be sent on the evaluating thread
+    };
+
+    ConcurrentEvaluationQueue(NetworkEvaluator* evaluator, size_t numThreads)
+        : finished_(false)
+    {
+        for (size_t t = 0; t < numThreads; ++t)
+            workers_.create_thread(boost::bind(&NetworkEvaluator::processJobs, evaluator, this));
+    }
+
+    /// Stops the worker threads after the remaining jobs have been processed.
+    ~ConcurrentEvaluationQueue() {
+        {
+            boost::lock_guard<boost::mutex> lock(mutex_);
+            finished_ = true;
+        }
+        jobAvailable_.notify_all();
+        workers_.join_all();
+    }
+
+    boost::mutex mutex_;
+    boost::condition_variable jobAvailable_;
+    boost::condition_variable jobFinished_;
+
+    std::deque<size_t> jobs_;                   ///< indices into the rendering order
+    std::deque<Result> results_;                ///< finished jobs
+    bool finished_;
+
+    boost::thread_group workers_;
+};
+
 NetworkEvaluator::NetworkEvaluator(bool glMode)
     : network_(0)
     , glMode_(glMode)
+    , concurrentProcessing_(false)
+    , numWorkerThreads_(0)
+    , workerPool_(0)
     //, reuseRenderTargets_(false)
     , renderingOrder_()
     , networkChanged_(false)
@@ -60,6 +108,9 @@ NetworkEvaluator::NetworkEvaluator(bool glMode)
 }
 
 NetworkEvaluator::~NetworkEvaluator() {
+    delete workerPool_;
+    workerPool_ = 0;
+
 #ifdef VRN_DEBUG
     // delete CheckOpenGLStateObserver
     std::vector<NetworkEvaluatorObserver*> observers = getObservers();
@@ -294,164 +345,429 @@ void NetworkEvaluator::process() {
         observers[j]->beforeNetworkProcess();
     if (glMode_) { LGL_ERROR; }
 
-    // Iterate over processing in rendering order
-    for (size_t i = 0; i < renderingOrder_.size(); ++i) {
-        Processor* const currentProcessor = renderingOrder_[i];
+    // Iterate over processors in rendering order
+    Processor* invalidatedProcessor = 0;
+    EvaluationResult result;
+    if (concurrentProcessing_ && canProcessConcurrently())
+        result = processConcurrently(observers, invalidatedProcessor);
+    else
+        result = processSequentially(observers, invalidatedProcessor);
 
-        // all processors should have been initialized at this point
-        if (!currentProcessor->isInitialized()) {
-            LWARNING("process(): Skipping uninitialized processor '" << currentProcessor->getID()
-                     << "' (" << currentProcessor->getClassName() << ")");
-            continue;
-        }
+    if (result == EVALUATION_PORTS_INVALIDATED) {
+        tgtAssert(invalidatedProcessor, "no invalidated processor");
+        unlock();
 
-        // trigger property adjustment on on input change
-        for (size_t i = 0; i < currentProcessor->inports_.size(); i++) {
-            if (currentProcessor->inports_[i]->hasChanged()) {
-                currentProcessor->adjustPropertiesToInput();
-                break;
-            }
-        }
+        // notify observers
+        for (size_t j = 0; j < observers.size(); ++j)
+            observers[j]->afterNetworkProcess();
+        if (glMode_) { LGL_ERROR; }
 
-        bool needsProcessing = true;
-        if (currentProcessor->isValid())
-            needsProcessing = false;
+        onNetworkChange();
+        invalidatedProcessor->invalidate();
+        VoreenApplication::app()->scheduleNetworkProcessing();
+        return;
+    }
+    else if (result == EVALUATION_TOPOLOGY_CHANGED) {
+        // network topology has changed (due to changes in loop port configurations)
+        unlock();
 
-        // run the processor, if it needs processing and is ready
-        if (needsProcessing) {
-            if (currentProcessor->isReady()) {
+        // notify observers
+        for (size_t j = 0; j < observers.size(); ++j)
+            observers[j]->afterNetworkProcess();
+        if (glMode_) { LGL_ERROR; }
 
-                // increase iteration counters
-                for (size_t j=0; j<loopPortMap_[currentProcessor].size(); ++j) {
-                    Port* port = loopPortMap_[currentProcessor][j];
-                    // note: modulo is required for nested loops
-                    port->setLoopIteration((port->getLoopIteration()+1) % port->getNumLoopIterations());
-                }
+        onNetworkChange();
+        return;
+    }
 
-                // notify observers
-                for (size_t j=0; j < observers.size(); ++j)
-                    observers[j]->beforeProcess(currentProcessor);
-                if (glMode_) { LGL_ERROR; }
+    if (glMode_) { LGL_ERROR; }
 
-                try {
-                    currentProcessor->performanceRecord_.setName(currentProcessor->getID());
-                    currentProcessor->lockMutex();
+    // notify observers
+    for (size_t j = 0; j < observers.size(); ++j)
+        observers[j]->afterNetworkProcess();
+    if (glMode_) { LGL_ERROR; }
+
+    LDEBUG("Finished network evaluation");
 
-                    {
-                        ProfilingBlock block("beforeprocess", currentProcessor->performanceRecord_);
-                        currentProcessor->beforeProcess();
-                    }
-                    if (glMode_) { LGL_ERROR; }
+    unlock();
+
+    if (processPending_ && glMode_) {
+        // make sure that canvases are repainted, if their update has been blocked by the locked evaluator
+        processPending_ = false;
+        updateCanvases();
+        LGL_ERROR;
+    }
+
+    // TODO: find better solution, very ugly code!
+    for (std::vector<Processor*>::const_iterator iter = getProcessorNetwork()->getProcessors().begin(); iter != getProcessorNetwork()->getProcessors().end(); ++iter) {
+        if (((*iter)->isReady() && !(*iter)->isValid()) && (((*iter)->getClassName().compare("Canvas") != 0) && ((*iter)->getClassName().compare("StereoCanvas") != 0))){
+            tgtAssert(VoreenApplication::app(), "VoreenApplication not instantiated");
+            VoreenApplication::app()->scheduleNetworkProcessing();
+            break;
+        }
+    }
 
-                    if(currentProcessor->getInvalidationLevel() >= Processor::INVALID_PORTS) {
-                        currentProcessor->unlockMutex();
-                        unlock();
+    if (glMode_) { LGL_ERROR; }
+}
 
-                        if (glMode_) { LGL_ERROR; }
+NetworkEvaluator::EvaluationResult NetworkEvaluator::processSequentially(const std::vector<NetworkEvaluatorObserver*>& observers,
+                                                                         Processor*& invalidatedProcessor)
+{
+    for (size_t i = 0; i < renderingOrder_.size(); ++i) {
+        Processor* const currentProcessor = renderingOrder_[i];
 
-                        onNetworkChange();
-                        currentProcessor->invalidate();
-                        VoreenApplication::app()->scheduleNetworkProcessing();
-                        return;
-                    }
+        if (prepareProcessor(currentProcessor, observers)) {
+            ProcessingResult processingResult = executeProcessor(currentProcessor, glMode_);
 
-#ifdef VRN_PRINT_PROFILING
-                    currentProcessor->performanceRecord_.getLastSample()->print(0, currentProcessor->getID()+".");
-#endif
-                    if (!currentProcessor->isValid())
-                    {
-                        ProfilingBlock block("process", currentProcessor->performanceRecord_);
-                        tgt::GLConditionalContextStateGuard guard(glMode_);
-                        currentProcessor->process();
-                    }
-#ifdef VRN_PRINT_PROFILING
-                    currentProcessor->performanceRecord_.getLastSample()->print(0, currentProcessor->getID()+".");
-#endif
-                    if (glMode_) { LGL_ERROR; }
+            // notify observers
+            for (size_t j = 0; j < observers.size(); ++j)
+                observers[j]->afterProcess(currentProcessor);
+            if (glMode_) { LGL_ERROR; }
 
-                    {
-                        ProfilingBlock block("afterprocess", currentProcessor->performanceRecord_);
-                        currentProcessor->afterProcess();
-                    }
-#ifdef VRN_PRINT_PROFILING
-                    currentProcessor->performanceRecord_.getLastSample()->print(0, currentProcessor->getID()+".");
-#endif
-                    if (glMode_) { LGL_ERROR; }
+            if (processingResult == PROCESSING_PORTS_INVALIDATED) {
+                invalidatedProcessor = currentProcessor;
+                return EVALUATION_PORTS_INVALIDATED;
+            }
 
-                    currentProcessor->unlockMutex();
-                }
-                catch (VoreenException& e) {
-                    currentProcessor->unlockMutex();
-                    LERROR("process(): VoreenException from "
-                            << currentProcessor->getClassName()
-                            << " (" << currentProcessor->getID() << "): " << e.what());
-                }
-                catch (std::exception& e) {
-                    currentProcessor->unlockMutex();
-                    LERROR("process(): Exception from "
-                            << currentProcessor->getClassName()
-                            << " (" << currentProcessor->getID() << "): " << e.what());
-                }
+            // break loop if network topology has changed (due to changes in loop port configurations)
+            if (checkForInvalidPorts())
+                return EVALUATION_TOPOLOGY_CHANGED;
+        }
 
-                // notify observers
-                for (size_t j = 0; j < observers.size(); ++j)
-                    observers[j]->afterProcess(currentProcessor);
-                if (glMode_) { LGL_ERROR; }
+        currentProcessor->firstProcessAfterDeserialization_ = false;
+    }
 
-                // break loop if network topology has changed (due to changes in loop port configurations)
-                if (checkForInvalidPorts()) {
-                    unlock();
+    return EVALUATION_FINISHED;
+}
 
-                    // notify observers
-                    for (size_t j = 0; j < observers.size(); ++j)
-                        observers[j]->afterNetworkProcess();
-                    if (glMode_) { LGL_ERROR; }
+NetworkEvaluator::EvaluationResult NetworkEvaluator::processConcurrently(const std::vector<NetworkEvaluatorObserver*>& observers,
+                                                                         Processor*& invalidatedProcessor)
+{
+    tgtAssert(network_, "No processor network");
+    const size_t numProcessors = renderingOrder_.size();
+
+    std::map<Processor*, size_t> orderIndex;
+    for (size_t i = 0; i < numProcessors; ++i)
+        orderIndex[renderingOrder_[i]] = i;
+
+    // determine the direct predecessors of each processor: the processors connected to its (co-processor) inports ...
+    std::vector<std::set<size_t> > predecessors(numProcessors);
+    for (size_t i = 0; i < numProcessors; ++i) {
+        std::vector<Port*> inports = renderingOrder_[i]->getInports();
+        inports.insert(inports.end(), renderingOrder_[i]->getCoProcessorInports().begin(), renderingOrder_[i]->getCoProcessorInports().end());
+        for (size_t j = 0; j < inports.size(); ++j) {
+            const std::vector<const Port*> connected = inports[j]->getConnected();
+            for (size_t k = 0; k < connected.size(); ++k) {
+                std::map<Processor*, size_t>::const_iterator it = orderIndex.find(connected[k]->getProcessor());
+                if (it != orderIndex.end() && it->second < i)
+                    predecessors[i].insert(it->second);
+            }
+        }
+    }
 
-                    onNetworkChange();
-                    return;
+    // ... and the processors it shares a property link with, since linking is not thread-safe
+    const std::vector<PropertyLink*>& links = network_->getPropertyLinks();
+    for (size_t i = 0; i < links.size(); ++i) {
+        Processor* src = dynamic_cast<Processor*>(links[i]->getSourceProperty()->getOwner());
+        Processor* dst = dynamic_cast<Processor*>(links[i]->getDestinationProperty()->getOwner());
+        std::map<Processor*, size_t>::const_iterator srcIt = orderIndex.find(src);
+        std::map<Processor*, size_t>::const_iterator dstIt = orderIndex.find(dst);
+        if (srcIt == orderIndex.end() || dstIt == orderIndex.end() || srcIt->second == dstIt->second)
+            continue;
+        predecessors[std::max(srcIt->second, dstIt->second)].insert(std::min(srcIt->second, dstIt->second));
+    }
+
+    std::vector<std::vector<size_t> > successors(numProcessors);
+    std::vector<size_t> numPendingPredecessors(numProcessors);
+    std::set<size_t> readyProcessors; //< ordered by position in rendering order
+    for (size_t i = 0; i < numProcessors; ++i) {
+        numPendingPredecessors[i] = predecessors[i].size();
+        for (std::set<size_t>::const_iterator it = predecessors[i].begin(); it != predecessors[i].end(); ++it)
+            successors[*it].push_back(i);
+        if (predecessors[i].empty())
+            readyProcessors.insert(i);
+    }
+
+    std::deque<size_t> contextJobs;
+    size_t numRunningJobs = 0;
+    size_t numFinished = 0;
+    EvaluationResult result = EVALUATION_FINISHED;
+
+    while (numFinished < numProcessors) {
+
+        // dispatch all processors whose predecessors have finished, unless the evaluation is aborted
+        while (result == EVALUATION_FINISHED && !readyProcessors.empty()) {
+            size_t index = *readyProcessors.begin();
+            readyProcessors.erase(readyProcessors.begin());
+            Processor* processor = renderingOrder_[index];
+
+            if (!prepareProcessor(processor, observers)) {
+                processor->firstProcessAfterDeserialization_ = false;
+                ++numFinished;
+                for (size_t j = 0; j < successors[index].size(); ++j) {
+                    if (--numPendingPredecessors[successors[index][j]] == 0)
+                        readyProcessors.insert(successors[index][j]);
                 }
             }
+            else if (requiresContextThread(processor)) {
+                contextJobs.push_back(index);
+            }
             else {
-                // Processor isn't ready, clear outports:
-                currentProcessor->clearOutports();
-                // set Processor valid, as it should not be processed while not ready
-                // TODO: rename "invalid" to "needsProcessing"
-                //currentProcessor->setValid();
+                // the worker threads are kept across evaluations
+                if (!workerPool_) {
+                    size_t numThreads = numWorkerThreads_ > 0 ? numWorkerThreads_ : boost::thread::hardware_concurrency();
+                    workerPool_ = new ConcurrentEvaluationQueue(this, std::max<size_t>(numThreads, 1));
+                }
+                {
+                    boost::lock_guard<boost::mutex> lock(workerPool_->mutex_);
+                    workerPool_->jobs_.push_back(index);
+                }
+                workerPool_->jobAvailable_.notify_one();
+                ++numRunningJobs;
             }
-        } // needsProcessing
+        }
 
-        currentProcessor->firstProcessAfterDeserialization_ = false;
+        // run the next job bound to this thread, or wait for a worker to finish
+        ConcurrentEvaluationQueue::Result job;
+        if (result == EVALUATION_FINISHED && !contextJobs.empty()) {
+            job.index_ = contextJobs.front();
+            contextJobs.pop_front();
+            job.result_ = executeProcessor(renderingOrder_[job.index_], glMode_);
+        }
+        else if (numRunningJobs > 0) {
+            boost::unique_lock<boost::mutex> lock(workerPool_->mutex_);
+            while (workerPool_->results_.empty())
+                workerPool_->jobFinished_.wait(lock);
+            job = workerPool_->results_.front();
+            workerPool_->results_.pop_front();
+            --numRunningJobs;
+            lock.unlock();
+
+            // forward the invalidations and state changes issued on the worker thread
+            Processor::sendDeferredNotifications(job.notifications_);
+        }
+        else {
+            // evaluation aborted and all running jobs have finished
+            break;
+        }
+        ++numFinished;
+
+        // notify observers
+        Processor* processor = renderingOrder_[job.index_];
+        for (size_t j = 0; j < observers.size(); ++j)
+            observers[j]->afterProcess(processor);
+        if (glMode_) { LGL_ERROR; }
+
+        if (job.result_ == PROCESSING_PORTS_INVALIDATED) {
+            if (result == EVALUATION_FINISHED) {
+                invalidatedProcessor = processor;
+                result = EVALUATION_PORTS_INVALIDATED;
+            }
+            continue;
+        }
 
-    }   // for (rendering order)
+        if (result == EVALUATION_FINISHED && checkForInvalidPorts()) {
+            result = EVALUATION_TOPOLOGY_CHANGED;
+            continue;
+        }
 
-    if (glMode_) { LGL_ERROR; }
+        processor->firstProcessAfterDeserialization_ = false;
+        for (size_t j = 0; j < successors[job.index_].size(); ++j) {
+            if (--numPendingPredecessors[successors[job.index_][j]] == 0)
+                readyProcessors.insert(successors[job.index_][j]);
+        }
+    }
 
-    // notify observers
-    for (size_t j = 0; j < observers.size(); ++j)
-        observers[j]->afterNetworkProcess();
+    // processors that have been prepared, but not executed due to the abort
+    for (size_t i = 0; i < contextJobs.size(); ++i) {
+        for (size_t j = 0; j < observers.size(); ++j)
+            observers[j]->afterProcess(renderingOrder_[contextJobs[i]]);
+    }
     if (glMode_) { LGL_ERROR; }
 
-    LDEBUG("Finished network evaluation");
+    return result;
+}
 
-    unlock();
+bool NetworkEvaluator::canProcessConcurrently() const {
+    // loop unrolling duplicates processors in the rendering order
+    for (std::map<Processor*, std::vector<Port*> >::const_iterator it = loopPortMap_.begin(); it != loopPortMap_.end(); ++it) {
+        if (!it->second.empty())
+            return false;
+    }
+    return loopPortMap_.size() == renderingOrder_.size();
+}
 
-    if (processPending_ && glMode_) {
-        // make sure that canvases are repainted, if their update has been blocked by the locked evaluator
-        processPending_ = false;
-        updateCanvases();
-        LGL_ERROR;
+void NetworkEvaluator::processJobs(ConcurrentEvaluationQueue* queue) {
+    tgtAssert(queue, "null pointer passed");
+
+    boost::unique_lock<boost::mutex> lock(queue->mutex_);
+    while (true) {
+        while (queue->jobs_.empty() && !queue->finished_)
+            queue->jobAvailable_.wait(lock);
+        if (queue->jobs_.empty())
+            return;
+
+        ConcurrentEvaluationQueue::Result result;
+        result.index_ = queue->jobs_.front();
+        queue->jobs_.pop_front();
+        lock.unlock();
+
+        // observers must only be notified on the evaluating thread
+        result.notifications_.processor_ = renderingOrder_[result.index_];
+        Processor::setDeferredNotifications(&result.notifications_);
+        result.result_ = executeProcessor(renderingOrder_[result.index_], false);
+        Processor::setDeferredNotifications(0);
+
+        lock.lock();
+        queue->results_.push_back(result);
+        queue->jobFinished_.notify_one();
     }
+}
 
-    // TODO: find better solution, very ugly code!
-    for (std::vector<Processor*>::const_iterator iter = getProcessorNetwork()->getProcessors().begin(); iter != getProcessorNetwork()->getProcessors().end(); ++iter) {
-        if (((*iter)->isReady() && !(*iter)->isValid()) && (((*iter)->getClassName().compare("Canvas") != 0) && ((*iter)->getClassName().compare("StereoCanvas") != 0))){
-            tgtAssert(VoreenApplication::app(), "VoreenApplication not instantiated");
-            VoreenApplication::app()->scheduleNetworkProcessing();
+bool NetworkEvaluator::prepareProcessor(Processor* processor, const std::vector<NetworkEvaluatorObserver*>& observers) {
+    // all processors should have been initialized at this point
+    if (!processor->isInitialized()) {
+        LWARNING("process(): Skipping uninitialized processor '" << processor->getID()
+                 << "' (" << processor->getClassName() << ")");
+        return false;
+    }
+
+    // trigger property adjustment on on input change
+    for (size_t i = 0; i < processor->inports_.size(); i++) {
+        if (processor->inports_[i]->hasChanged()) {
+            processor->adjustPropertiesToInput();
             break;
         }
     }
 
+    // run the processor, if it needs processing and is ready
+    if (processor->isValid())
+        return false;
+
+    if (!processor->isReady()) {
+        // Processor isn't ready, clear outports:
+        processor->clearOutports();
+        // set Processor valid, as it should not be processed while not ready
+        // TODO: rename "invalid" to "needsProcessing"
+        //processor->setValid();
+        return false;
+    }
+
+    // increase iteration counters
+    for (size_t j=0; j<loopPortMap_[processor].size(); ++j) {
+        Port* port = loopPortMap_[processor][j];
+        // note: modulo is required for nested loops
+        port->setLoopIteration((port->getLoopIteration()+1) % port->getNumLoopIterations());
+    }
+
+    // notify observers
+    for (size_t j=0; j < observers.size(); ++j)
+        observers[j]->beforeProcess(processor);
     if (glMode_) { LGL_ERROR; }
+
+    return true;
+}
+
+NetworkEvaluator::ProcessingResult NetworkEvaluator::executeProcessor(Processor* processor, bool useGL) {
+    try {
+        processor->performanceRecord_.setName(processor->getID());
+        processor->lockMutex();
+
+        {
+            ProfilingBlock block("beforeprocess", processor->performanceRecord_);
+            processor->beforeProcess();
+        }
+        if (useGL) { LGL_ERROR; }
+
+        if (processor->getInvalidationLevel() >= Processor::INVALID_PORTS) {
+            processor->unlockMutex();
+            return PROCESSING_PORTS_INVALIDATED;
+        }
+
+#ifdef VRN_PRINT_PROFILING
+        processor->performanceRecord_.getLastSample()->print(0, processor->getID()+".");
+#endif
+        if (!processor->isValid())
+        {
+            ProfilingBlock block("process", processor->performanceRecord_);
+            tgt::GLConditionalContextStateGuard guard(useGL);
+            processor->process();
+        }
+#ifdef VRN_PRINT_PROFILING
+        processor->performanceRecord_.getLastSample()->print(0, processor->getID()+".");
+#endif
+        if (useGL) { LGL_ERROR; }
+
+        {
+            ProfilingBlock block("afterprocess", processor->performanceRecord_);
+            processor->afterProcess();
+        }
+#ifdef VRN_PRINT_PROFILING
+        processor->performanceRecord_.getLastSample()->print(0, processor->getID()+".");
+#endif
+        if (useGL) { LGL_ERROR; }
+
+        processor->unlockMutex();
+    }
+    catch (VoreenException& e) {
+        processor->unlockMutex();
+        LERROR("process(): VoreenException from "
+                << processor->getClassName()
+                << " (" << processor->getID() << "): " << e.what());
+    }
+    catch (std::exception& e) {
+        processor->unlockMutex();
+        LERROR("process(): Exception from "
+                << processor->getClassName()
+                << " (" << processor->getID() << "): " << e.what());
+    }
+
+    return PROCESSING_DONE;
+}
+
+bool NetworkEvaluator::requiresContextThread(Processor* processor) const {
+    tgtAssert(processor, "null pointer passed");
+
+    if (!processor->isThreadSafe())
+        return true;
+
+    // processor widgets may only be accessed from the GUI thread
+    if (dynamic_cast<RenderProcessor*>(processor) || processor->getProcessorWidget())
+        return true;
+
+    // the same holds for progress bars and property widgets, which are updated during process()
+    for (size_t i = 0; i < processor->progressBars_.size(); ++i) {
+        const Property* progressProperty = dynamic_cast<const Property*>(processor->progressBars_[i]);
+        if (!progressProperty || progressProperty->getOwner() != processor)
+            return true;
+    }
+    const std::vector<Property*>& properties = processor->getProperties();
+    for (size_t i = 0; i < properties.size(); ++i) {
+        if (!properties[i]->getPropertyWidgets().empty())
+            return true;
+    }
+
+    const std::vector<Port*> ports = processor->getPorts();
+    for (size_t i = 0; i < ports.size(); ++i) {
+        if (dynamic_cast<RenderPort*>(ports[i]))
+            return true;
+    }
+    return false;
+}
+
+void NetworkEvaluator::setConcurrentProcessing(bool enabled, size_t numThreads) {
+    tgtAssert(!isLocked(), "evaluator is locked");
+    if (!enabled || numThreads != numWorkerThreads_) {
+        // stop the worker threads, they are re-created on demand
+        delete workerPool_;
+        workerPool_ = 0;
+    }
+    concurrentProcessing_ = enabled;
+    numWorkerThreads_ = numThreads;
+}
+
+bool NetworkEvaluator::isConcurrentProcessing() const {
+    return concurrentProcessing_;
 }
 
 void NetworkEvaluator::setProcessorNetwork(ProcessorNetwork* network, bool deinitializeCurrent) {
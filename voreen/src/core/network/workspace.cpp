@@ -31,6 +31,7 @@
 #include "voreen/core/properties/link/linkevaluatorhelper.h"
 #include "voreen/core/animation/animatedprocessor.h"
 #include "voreen/core/utils/stringutils.h"
+#include "voreen/core/io/serialization/binaryblobsidecar.h"
 
 #include "tgt/filesystem.h"
 #include "tgt/glcanvas.h"
@@ -378,6 +379,7 @@ void Workspace::load(const std::string& filename, const std::string& workDir) {
     // read data stream into deserializer
     XmlDeserializer d(documentPath);
     d.setUseAttributes(true);
+
     NetworkSerializer ser;
     try {
         d.read(fileStream, &ser);
@@ -391,6 +393,20 @@ void Workspace::load(const std::string& filename, const std::string& workDir) {
                                      + filename + "' (unknown exception).");
     }
 
+    // binary blobs may be stored in a sidecar file referenced by the workspace, which is mapped during deserialization
+    std::unique_ptr<BinaryBlobSidecarReader> sidecar;
+    try {
+        Deserializer deserializer(d);
+        const std::string sidecarFilename = BinaryBlobSidecar::getReferencedFilename(deserializer, filename);
+        if (!sidecarFilename.empty()) {
+            sidecar.reset(new BinaryBlobSidecarReader(sidecarFilename));
+            d.setBinaryBlobSidecarReader(sidecar.get());
+        }
+    }
+    catch (SerializationException& e) {
+        throw SerializationException("Failed to open binary blob file of workspace file '" + filename + "': " + e.what());
+    }
+
     // deserialize workspace from data stream
     try {
         d.deserialize("Workspace", *this);
@@ -405,7 +421,31 @@ void Workspace::load(const std::string& filename, const std::string& workDir) {
     }
 }
 
-void Workspace::save(const std::string& filename, bool overwrite, const std::string& workDir) {
+// Moves the temporary file into place. It is important that this happens in-place,
+// without deleting the old file first.
+static void replaceWithTemporaryFile(const std::string& tmpfilename, const std::string& filename) {
+    bool success;
+#ifdef WIN32
+    // rename() does not replace existing files on Windows, so we have to use this
+    success = (MoveFileEx(tmpfilename.c_str(), filename.c_str(),
+                          MOVEFILE_REPLACE_EXISTING | MOVEFILE_COPY_ALLOWED) != 0);
+
+#else
+    // atomic replace
+    success = (rename(tmpfilename.c_str(), filename.c_str()) == 0);
+#endif
+    if (!success) {
+#ifdef WIN32
+        _unlink(tmpfilename.c_str()); // ignore failure here
+#else
+        unlink(tmpfilename.c_str()); // ignore failure here
+#endif
+        throw SerializationException("Failed to rename temporary file '" + tmpfilename + "' to '"
+                                     + filename + "'");
+    }
+}
+
+void Workspace::save(const std::string& filename, bool overwrite, const std::string& workDir, bool binaryBlobSidecar) {
     // check if file is already present
     if (!overwrite && tgt::FileSystem::fileExists(filename))
         throw SerializationException("File '" + filename + "' already exists.");
@@ -416,11 +456,23 @@ void Workspace::save(const std::string& filename, bool overwrite, const std::str
     else
         documentPath = filename;
 
+    // Binary blobs are written to a sidecar file with a new name, so that the sidecar
+    // referenced by the current workspace file stays intact until the new workspace file is in place.
+    std::unique_ptr<BinaryBlobSidecarWriter> sidecar;
+    if (binaryBlobSidecar)
+        sidecar.reset(new BinaryBlobSidecarWriter(BinaryBlobSidecar::createFilename(filename)));
+
     // serialize workspace
     XmlSerializer s(documentPath);
     s.setUseAttributes(true);
+    if (sidecar) {
+        s.serialize(BinaryBlobSidecar::DOCUMENT_KEY, tgt::FileSystem::fileName(sidecar->getFilename()));
+        s.setBinaryBlobSidecarWriter(sidecar.get());
+    }
     s.serialize("Workspace", *this);
     errorList_ = s.getErrors();
+    if (sidecar)
+        sidecar->close();
 
     // write serialization data to temporary string stream
     std::ostringstream textStream;
@@ -459,27 +511,10 @@ void Workspace::save(const std::string& filename, bool overwrite, const std::str
     }
     fileStream.close();
 
-    // Finally move the temporary file into place. It is important that this happens in-place,
-    // without deleting the old file first.
-    bool success;
-#ifdef WIN32
-    // rename() does not replace existing files on Windows, so we have to use this
-    success = (MoveFileEx(tmpfilename.c_str(), filename.c_str(),
-                          MOVEFILE_REPLACE_EXISTING | MOVEFILE_COPY_ALLOWED) != 0);
-
-#else
-    // atomic replace
-    success = (rename(tmpfilename.c_str(), filename.c_str()) == 0);
-#endif
-    if (!success) {
-#ifdef WIN32
-        _unlink(tmpfilename.c_str()); // ignore failure here
-#else
-        unlink(tmpfilename.c_str()); // ignore failure here
-#endif
-        throw SerializationException("Failed to rename temporary file '" + tmpfilename + "' to '"
-                                     + filename + "'");
-    }
+    // Finally move the temporary file into place. Only afterwards the sidecars of previous saves
+    // (or left over from interrupted saves) are not referenced anymore and can be removed.
+    replaceWithTemporaryFile(tmpfilename, filename);
+    BinaryBlobSidecar::deleteFiles(filename, sidecar ? sidecar->getFilename() : "");
 
     // saving successful
     setFilename(filename);
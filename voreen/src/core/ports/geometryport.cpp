@@ -41,6 +41,20 @@ bool GeometryPort::supportsCaching() const {
     return true;
 }
 
+size_t GeometryPort::getDataMemorySize() const {
+    if (hasData())
+        return getData()->getMemorySize();
+    else
+        return 0;
+}
+
+CachedPortData* GeometryPort::detachDataForCache() {
+    // the memory cache limit could not account for the geometry
+    if (hasData() && getDataMemorySize() == 0)
+        return 0;
+    return GenericPort<Geometry>::detachDataForCache();
+}
+
 std::string GeometryPort::getHash() const {
     if (!hasData())
         return "";
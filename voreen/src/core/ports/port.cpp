@@ -324,6 +324,10 @@ bool Port::isConnectedTo(const Port* port) const {
 }
 
 void Port::invalidatePort() {
+    // inports of other processors are invalidated on the evaluating thread, if called by a worker of the NetworkEvaluator
+    if (isInport() && Processor::deferPortInvalidation(this))
+        return;
+
     hasChanged_ = true;
     if (isOutport()) {
         for (size_t i = 0; i <  connectedPorts_.size(); ++i)
@@ -423,6 +427,22 @@ void Port::loadData(const std::string& /*path*/) {
     throw VoreenException("Port type does not support loading of its data.");
 }
 
+CachedPortData* Port::detachDataForCache() {
+    return 0;
+}
+
+void Port::restoreCachedData(const CachedPortData* /*data*/) {
+    throw VoreenException("Port type does not support in-memory caching of its data.");
+}
+
+bool Port::reclaimCachedData(CachedPortData* /*data*/) {
+    return false;
+}
+
+size_t Port::getDataMemorySize() const {
+    return 0;
+}
+
 void Port::distributeEvent(tgt::Event* e) {
     if (isOutport()) {
         if (!blockEvents_.get())
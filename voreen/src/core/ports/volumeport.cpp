@@ -199,6 +199,14 @@ bool VolumePort::supportsCaching() const {
     return true;
 }
 
+size_t VolumePort::getDataMemorySize() const {
+    // only data resident in RAM counts, disk representations are (re-)loaded on demand
+    if (hasData() && getData()->hasRepresentation<VolumeRAM>())
+        return getData()->getRepresentation<VolumeRAM>()->getNumBytes();
+    else
+        return 0;
+}
+
 std::string VolumePort::getHash() const {
     if (hasData())
         return getData()->getHash();
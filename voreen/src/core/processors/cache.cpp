@@ -27,9 +27,12 @@
 
 #include "voreen/core/properties/property.h"
 #include "voreen/core/ports/port.h"
+#include "voreen/core/ports/volumeport.h"
+#include "voreen/core/datastructures/volume/volumehash.h"
 
 #include "voreen/core/utils/stringutils.h"
 #include "voreen/core/utils/hashing.h"
+#include "voreen/core/voreenapplication.h"
 #include "tgt/filesystem.h"
 
 #include <stdio.h>
@@ -38,11 +41,32 @@
 namespace voreen {
 
 const std::string Cache::loggerCat_("voreen.Cache");
+std::list<Cache::MemoryCacheEntry*> Cache::memoryCacheEntries_;
+uint64_t Cache::memoryCacheSize_ = 0;
+boost::mutex Cache::memoryCacheMutex_;
+const size_t Cache::MAX_MEMORY_CACHE_ENTRIES = 32;
 
-Cache::Cache(Processor* proc) : processor_(proc), initialized_(false) {
+Cache::Cache(Processor* proc) : processor_(proc), initialized_(false), volumeHashType_(VOLUME_HASH_DEFAULT) {
     tgtAssert(proc, "Null processor!");
 }
 
+Cache::~Cache() {
+    // the processor's ports are already destructed at this point => just delete the data
+    boost::lock_guard<boost::mutex> lock(memoryCacheMutex_);
+    for (std::list<MemoryCacheEntry*>::iterator it = memoryCacheEntries_.begin(); it != memoryCacheEntries_.end(); ) {
+        MemoryCacheEntry* entry = *it;
+        if (entry->cache_ != this) {
+            ++it;
+            continue;
+        }
+        it = memoryCacheEntries_.erase(it);
+        for (size_t i=0; i<entry->data_.size(); i++)
+            delete entry->data_[i];
+        memoryCacheSize_ -= entry->size_;
+        delete entry;
+    }
+}
+
 void Cache::initialize() {
     std::string interfaceStr = getInterfaceString();
     std::string fname = processor_->getCachePath() + "/interfaceStr.txt";
@@ -183,6 +207,8 @@ void Cache::addAllProperties() {
             continue;
         if(properties[i]->getID() == "clearCache")
             continue;
+        if(properties[i]->getID() == "cacheVolumeHash")
+            continue;
 
         addProperty(properties[i]);
     }
@@ -192,7 +218,14 @@ std::string Cache::getAllInportHashes() {
     std::string s;
     for(size_t i=0; i<inports_.size(); i++) {
         Port* p = processor_->getPort(inports_[i]);
-        std::string hash = p->getHash();
+        std::string hash;
+        VolumePort* volumePort = dynamic_cast<VolumePort*>(p);
+        if (volumeHashType_ == VOLUME_HASH_CHUNKED && volumePort && volumePort->hasData()) {
+            const VolumeBase* volume = volumePort->getData();
+            hash = volume->getDerivedData<VolumeChunkedHash>()->getHash() + "-" + volume->getMetaDataHash();
+        }
+        else
+            hash = p->getHash();
         if (!hash.empty())
             s += "/" + hash;
         else
@@ -233,8 +266,162 @@ std::string Cache::getPropertyStateHash() {
     return VoreenHash::getHash(getPropertyState());
 }
 
+std::string Cache::getCacheKey() {
+    return getAllInportHashes() + "/" + getPropertyStateHash();
+}
+
 std::string Cache::getCurrentCacheDir() {
-    return processor_->getCachePath() + getAllInportHashes() + "/" + getPropertyStateHash() + "/";
+    return processor_->getCachePath() + getCacheKey() + "/";
+}
+
+bool Cache::restoreOutportsFromMemory(const std::string& key) {
+    if (!initialized_)
+        return false;
+
+    boost::lock_guard<boost::mutex> lock(memoryCacheMutex_);
+    std::list<MemoryCacheEntry*>::iterator it = findMemoryCacheEntry(key);
+    if (it == memoryCacheEntries_.end())
+        return false;
+
+    MemoryCacheEntry* entry = *it;
+    for (size_t i=0; i<outports_.size(); i++) {
+        Port* p = processor_->getPort(outports_[i]);
+        if (!p) {
+            LERROR("Could not find port " << outports_[i]);
+            return false;
+        }
+
+        try {
+            if (entry->data_[i])
+                p->restoreCachedData(entry->data_[i]);
+            else
+                p->clear();
+        }
+        catch (VoreenException& e) {
+            LERROR("Failed to restore data for port '" << p->getID() << "' from memory: " << e.what());
+            return false;
+        }
+    }
+
+    // mark as most recently used
+    memoryCacheEntries_.erase(it);
+    memoryCacheEntries_.push_front(entry);
+
+    return true;
+}
+
+bool Cache::storeOutportsToMemory(const std::string& key) {
+    if (!initialized_)
+        return false;
+
+    uint64_t limit = VoreenApplication::app() ? VoreenApplication::app()->getMemoryCacheLimit() : 0;
+    if (limit == 0) {
+        clearMemoryCache();
+        return false;
+    }
+
+    boost::lock_guard<boost::mutex> lock(memoryCacheMutex_);
+    std::list<MemoryCacheEntry*>::iterator it = findMemoryCacheEntry(key);
+    if (it != memoryCacheEntries_.end()) {
+        MemoryCacheEntry* entry = *it;
+        memoryCacheEntries_.erase(it);
+        memoryCacheEntries_.push_front(entry);
+        return true;
+    }
+
+    MemoryCacheEntry* entry = new MemoryCacheEntry();
+    entry->cache_ = this;
+    entry->key_ = key;
+    entry->size_ = 0;
+
+    bool success = true;
+    for (size_t i=0; i<outports_.size() && success; i++) {
+        Port* p = processor_->getPort(outports_[i]);
+        if (!p) {
+            LERROR("Could not find port " << outports_[i]);
+            success = false;
+        }
+        else if (!p->hasData()) {
+            entry->data_.push_back(0);
+        }
+        else {
+            entry->size_ += p->getDataMemorySize();
+            CachedPortData* data = p->detachDataForCache();
+            // data not owned by the port (or port type not supported) cannot be kept
+            success = (data != 0) && (entry->size_ <= limit);
+            entry->data_.push_back(data);
+        }
+    }
+
+    if (!success) {
+        deleteMemoryCacheEntry(entry);
+        return false;
+    }
+
+    memoryCacheEntries_.push_front(entry);
+    memoryCacheSize_ += entry->size_;
+    limitMemoryCache(limit, this);
+
+    return true;
+}
+
+void Cache::deleteMemoryCacheEntry(MemoryCacheEntry* entry) {
+    tgtAssert(entry, "null pointer passed");
+    for (size_t i=0; i<entry->data_.size(); i++) {
+        if (!entry->data_[i])
+            continue;
+
+        // hand ownership back to the port, if the data is still assigned to it
+        Port* p = entry->cache_->processor_->getPort(entry->cache_->outports_[i]);
+        if (p)
+            p->reclaimCachedData(entry->data_[i]);
+        delete entry->data_[i];
+    }
+    delete entry;
+}
+
+std::list<Cache::MemoryCacheEntry*>::iterator Cache::findMemoryCacheEntry(const std::string& key) {
+    std::list<MemoryCacheEntry*>::iterator it = memoryCacheEntries_.begin();
+    while (it != memoryCacheEntries_.end() && ((*it)->cache_ != this || (*it)->key_ != key))
+        ++it;
+    return it;
+}
+
+void Cache::limitMemoryCache(uint64_t limit, Cache* cache) {
+    // evicting an entry whose data is still assigned to an outport just hands the data back to the port
+    size_t numCacheEntries = 0;
+    for (std::list<MemoryCacheEntry*>::const_iterator it = memoryCacheEntries_.begin(); it != memoryCacheEntries_.end(); ++it) {
+        if ((*it)->cache_ == cache)
+            numCacheEntries++;
+    }
+
+    std::list<MemoryCacheEntry*>::iterator it = memoryCacheEntries_.end();
+    while (it != memoryCacheEntries_.begin() && (memoryCacheSize_ > limit || numCacheEntries > MAX_MEMORY_CACHE_ENTRIES)) {
+        --it;
+        MemoryCacheEntry* entry = *it;
+        // the size limit applies to all caches, the entry limit only to the passed one
+        if (memoryCacheSize_ <= limit && entry->cache_ != cache)
+            continue;
+        if (entry->cache_ == cache)
+            numCacheEntries--;
+        it = memoryCacheEntries_.erase(it);
+        memoryCacheSize_ -= entry->size_;
+        deleteMemoryCacheEntry(entry);
+    }
+}
+
+void Cache::clearMemoryCache() {
+    boost::lock_guard<boost::mutex> lock(memoryCacheMutex_);
+    for (std::list<MemoryCacheEntry*>::iterator it = memoryCacheEntries_.begin(); it != memoryCacheEntries_.end(); ) {
+        MemoryCacheEntry* entry = *it;
+        if (entry->cache_ != this) {
+            ++it;
+            continue;
+        }
+        it = memoryCacheEntries_.erase(it);
+        memoryCacheSize_ -= entry->size_;
+        deleteMemoryCacheEntry(entry);
+    }
 }
 
 bool Cache::restoreOutportsFromDir(const std::string& dir) {
@@ -374,7 +561,10 @@ bool Cache::store() {
     if(!initialized_)
         return false;
 
-    std::string dir = getCurrentCacheDir();
+    std::string key = getCacheKey();
+    storeOutportsToMemory(key);
+
+    std::string dir = processor_->getCachePath() + key + "/";
     if (!FileSys.dirExists(dir)) {
         if(!FileSys.createDirectoryRecursive(dir))
             return false;
@@ -440,8 +630,12 @@ bool Cache::restore() {
     if(!initialized_)
         return false;
 
+    std::string key = getCacheKey();
+    if (restoreOutportsFromMemory(key))
+        return true;
+
     //check for collisions
-    std::string dir = getCurrentCacheDir();
+    std::string dir = processor_->getCachePath() + key + "/";
     if(FileSys.dirExists(dir)) {
         std::string fname = dir + "/propertystate.txt";
 
@@ -452,6 +646,7 @@ bool Cache::restore() {
         if(stringEqualsFileContent(propertyState, fname)) {
             if(restoreOutportsFromDir(dir)) {
                 updateLastAccess(dir);
+                storeOutportsToMemory(key);
                 return true;
             }
             else
@@ -468,6 +663,8 @@ bool Cache::restore() {
 }
 
 void Cache::clearCache() {
+    clearMemoryCache();
+
     std::string dir = processor_->getCachePath();
     LINFO("Clearing cache path: " << dir);
 
@@ -56,6 +56,11 @@ using std::string;
 using std::map;
 using std::vector;
 
+namespace {
+    /// Processor::DeferredNotifications of the calling thread, if set (not a static member, since it is thread_local).
+    thread_local void* deferredNotifications = 0;
+}
+
 namespace voreen {
 
 const std::string Processor::loggerCat_("voreen.Processor");
@@ -414,8 +419,13 @@ void Processor::invalidate(int inv) {
 
         invalidationVisited_ = false;
 
-        tgtAssert(VoreenApplication::app(), "VoreenApplication not instantiated");
-        VoreenApplication::app()->scheduleNetworkProcessing();
+        if (deferredNotifications) {
+            static_cast<DeferredNotifications*>(deferredNotifications)->scheduleNetworkProcessing_ = true;
+        }
+        else {
+            tgtAssert(VoreenApplication::app(), "VoreenApplication not instantiated");
+            VoreenApplication::app()->scheduleNetworkProcessing();
+        }
     }
 }
 
@@ -692,6 +702,37 @@ bool Processor::usesExpensiveComputation() const {
     return false;
 }
 
+bool Processor::isThreadSafe() const {
+    return false;
+}
+
+void Processor::setDeferredNotifications(DeferredNotifications* notifications) {
+    deferredNotifications = notifications;
+}
+
+bool Processor::deferPortInvalidation(Port* inport) {
+    tgtAssert(inport && inport->isInport(), "no inport passed");
+    DeferredNotifications* notifications = static_cast<DeferredNotifications*>(deferredNotifications);
+    if (!notifications || inport->getProcessor() == notifications->processor_)
+        return false;
+    notifications->invalidatedPorts_.push_back(inport);
+    return true;
+}
+
+void Processor::sendDeferredNotifications(const DeferredNotifications& notifications) {
+    tgtAssert(!deferredNotifications, "notifications are deferred on this thread");
+    for (size_t i = 0; i < notifications.invalidatedPorts_.size(); ++i)
+        notifications.invalidatedPorts_[i]->invalidatePort();
+    for (size_t i = 0; i < notifications.portsChanged_.size(); ++i)
+        notifications.portsChanged_[i]->notifyPortsChanged();
+    for (size_t i = 0; i < notifications.stateChanged_.size(); ++i)
+        notifications.stateChanged_[i]->notifyStateChanged();
+    if (notifications.scheduleNetworkProcessing_) {
+        tgtAssert(VoreenApplication::app(), "VoreenApplication not instantiated");
+        VoreenApplication::app()->scheduleNetworkProcessing();
+    }
+}
+
 void Processor::setProgress(float progress) {
     for (size_t i=0; i<progressBars_.size(); i++)
         progressBars_.at(i)->setProgress(progress);
@@ -839,12 +880,20 @@ void Processor::deinitializePort(Port* port) {
 }
 
 void Processor::notifyPortsChanged() const {
+    if (deferredNotifications) {
+        static_cast<DeferredNotifications*>(deferredNotifications)->portsChanged_.push_back(this);
+        return;
+    }
     std::vector<ProcessorObserver*> procObservers = Observable<ProcessorObserver>::getObservers();
     for (size_t i = 0; i < procObservers.size(); ++i)
         procObservers[i]->portsChanged(this);
 }
 
 void Processor::notifyStateChanged() const {
+    if (deferredNotifications) {
+        static_cast<DeferredNotifications*>(deferredNotifications)->stateChanged_.push_back(this);
+        return;
+    }
     std::vector<ProcessorObserver*> procObservers = Observable<ProcessorObserver>::getObservers();
     for (size_t i = 0; i < procObservers.size(); ++i)
         procObservers[i]->stateChanged(this);
@@ -50,15 +50,21 @@ tgt::mat4 VolumeProcessor::computeConversionMatrix(const VolumeBase* originVolum
 CachingVolumeProcessor::CachingVolumeProcessor()
     : VolumeProcessor()
     , useCaching_("useCaching", "Use Cache", true, VALID)
+    , volumeHashType_("cacheVolumeHash", "Input Volume Hash", VALID, false, Property::LOD_ADVANCED)
     , clearCache_("clearCache", "Clear Cache", VALID)
     , cache_(this)
 {
     addProperty(useCaching_);
 
+    volumeHashType_.addOption("default", "Default", Cache::VOLUME_HASH_DEFAULT);
+    volumeHashType_.addOption("chunked", "Voxel Data (chunked)", Cache::VOLUME_HASH_CHUNKED);
+    addProperty(volumeHashType_);
+
     clearCache_.onChange(MemberFunctionCallback<CachingVolumeProcessor>(this, &CachingVolumeProcessor::clearCache));
     addProperty(clearCache_);
 
     useCaching_.setGroupID("caching");
+    volumeHashType_.setGroupID("caching");
     clearCache_.setGroupID("caching");
 }
 
@@ -68,6 +74,7 @@ void CachingVolumeProcessor::beforeProcess() {
     VolumeProcessor::beforeProcess();
 
     if (useCaching_.get() && VoreenApplication::app()->useCaching()) {
+        cache_.setVolumeHashType(volumeHashType_.getValue());
         if (cache_.restore()) {
             setValid();
         }
@@ -78,6 +85,7 @@ void CachingVolumeProcessor::afterProcess() {
     VolumeProcessor::afterProcess();
 
     if (useCaching_.get() && VoreenApplication::app()->useCaching()) {
+        cache_.setVolumeHashType(volumeHashType_.getValue());
         cache_.store();
     }
 }
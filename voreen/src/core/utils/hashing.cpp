@@ -28,8 +28,109 @@
 #include "voreen/core/utils/hashing.h"
 #include "md5/md5.h"
 
+#include <algorithm>
+#include <cstring>
+
+#ifdef VRN_MODULE_OPENMP
+#include "omp.h"
+#endif
+
 namespace voreen {
 
+namespace {
+
+// XXH64, see https://github.com/Cyan4973/xxHash
+const uint64_t XXH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+const uint64_t XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+const uint64_t XXH_PRIME64_3 = 0x165667B19E3779F9ULL;
+const uint64_t XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+const uint64_t XXH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t xxhRotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t xxhRead64(const unsigned char* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t xxhRead32(const unsigned char* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t xxhRound(uint64_t acc, uint64_t input) {
+    acc += input * XXH_PRIME64_2;
+    acc = xxhRotl(acc, 31);
+    return acc * XXH_PRIME64_1;
+}
+
+inline uint64_t xxhMergeRound(uint64_t acc, uint64_t val) {
+    acc ^= xxhRound(0, val);
+    return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+uint64_t xxh64(const void* data, size_t size, uint64_t seed) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const unsigned char* end = p + size;
+    uint64_t h;
+
+    if (size >= 32) {
+        const unsigned char* limit = end - 32;
+        uint64_t v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+        uint64_t v2 = seed + XXH_PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_PRIME64_1;
+        do {
+            v1 = xxhRound(v1, xxhRead64(p));
+            v2 = xxhRound(v2, xxhRead64(p + 8));
+            v3 = xxhRound(v3, xxhRead64(p + 16));
+            v4 = xxhRound(v4, xxhRead64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        h = xxhRotl(v1, 1) + xxhRotl(v2, 7) + xxhRotl(v3, 12) + xxhRotl(v4, 18);
+        h = xxhMergeRound(h, v1);
+        h = xxhMergeRound(h, v2);
+        h = xxhMergeRound(h, v3);
+        h = xxhMergeRound(h, v4);
+    }
+    else {
+        h = seed + XXH_PRIME64_5;
+    }
+
+    h += static_cast<uint64_t>(size);
+
+    while (p + 8 <= end) {
+        h ^= xxhRound(0, xxhRead64(p));
+        h = xxhRotl(h, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<uint64_t>(xxhRead32(p)) * XXH_PRIME64_1;
+        h = xxhRotl(h, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+        p += 4;
+    }
+    while (p < end) {
+        h ^= (*p) * XXH_PRIME64_5;
+        h = xxhRotl(h, 11) * XXH_PRIME64_1;
+        p++;
+    }
+
+    h ^= h >> 33;
+    h *= XXH_PRIME64_2;
+    h ^= h >> 29;
+    h *= XXH_PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+} // namespace
+
+
 std::string VoreenHash::getHash(const void* data, size_t size) {
     MD5_CTX ctx;
     MD5_Init(&ctx);
@@ -50,4 +151,64 @@ std::string VoreenHash::getHash(const std::string& s) {
     return getHash(s.c_str(), s.length());
 }
 
+std::string VoreenHash::getChunkedHash(const void* data, size_t size) {
+    VoreenChunkedHash hash;
+    hash.update(data, size);
+    return hash.getHash();
+}
+
+//-------------------------------------------------------------------------------------------------
+
+const size_t VoreenChunkedHash::CHUNK_SIZE = 1 << 20;
+
+VoreenChunkedHash::VoreenChunkedHash()
+    : size_(0)
+{}
+
+void VoreenChunkedHash::update(const void* data, size_t size) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    size_ += size;
+
+    // complete the pending chunk first
+    if (!pending_.empty()) {
+        size_t n = std::min(size, CHUNK_SIZE - pending_.size());
+        pending_.insert(pending_.end(), p, p + n);
+        p += n;
+        size -= n;
+        if (pending_.size() < CHUNK_SIZE)
+            return;
+        chunkDigests_.push_back(xxh64(&pending_[0], CHUNK_SIZE, 0));
+        pending_.clear();
+    }
+
+    // hash all complete chunks directly from the passed buffer
+    size_t numChunks = size / CHUNK_SIZE;
+    size_t firstChunk = chunkDigests_.size();
+    chunkDigests_.resize(firstChunk + numChunks);
+#ifdef VRN_MODULE_OPENMP
+    #pragma omp parallel for schedule(dynamic) if (numChunks > 1)
+#endif
+    for (long i = 0; i < static_cast<long>(numChunks); i++)
+        chunkDigests_[firstChunk + i] = xxh64(p + i * CHUNK_SIZE, CHUNK_SIZE, 0);
+
+    p += numChunks * CHUNK_SIZE;
+    size -= numChunks * CHUNK_SIZE;
+    pending_.assign(p, p + size);
+}
+
+std::string VoreenChunkedHash::getHash() const {
+    std::vector<uint64_t> digests(chunkDigests_);
+    if (!pending_.empty())
+        digests.push_back(xxh64(&pending_[0], pending_.size(), 0));
+
+    // combine chunk digests into a single 64 bit value, the stream size acts as seed
+    const void* digestData = digests.empty() ? static_cast<const void*>(&size_) : &digests[0];
+    uint64_t result = xxh64(digestData, digests.size() * sizeof(uint64_t), size_);
+
+    char output[16 + 1];
+    sprintf(output, "%016llx", static_cast<unsigned long long>(result));
+
+    return std::string(output);
+}
+
 } // namespace
@@ -28,12 +28,13 @@
 #include "float.h"
 
 #include <algorithm>
+#include <limits>
 
 namespace voreen {
 
 Statistics::Statistics(bool collectSamples)
    : min_(FLT_MAX)
-   , max_(FLT_MIN)
+   , max_(std::numeric_limits<float>::lowest())
    , runningMean_(0.0f)
    , m2_(0.0f)
    , sum_(0.0f)
@@ -42,9 +43,22 @@ Statistics::Statistics(bool collectSamples)
 {
 }
 
+Statistics Statistics::fromSummary(size_t numSamples, float min, float max, float sum, float mean, float variance) {
+    Statistics statistics(false);
+    if(numSamples > 0) {
+        statistics.numSamples_ = numSamples;
+        statistics.min_ = min;
+        statistics.max_ = max;
+        statistics.sum_ = sum;
+        statistics.runningMean_ = mean;
+        statistics.m2_ = static_cast<double>(variance) * numSamples;
+    }
+    return statistics;
+}
+
 void Statistics::reset() {
    min_ = FLT_MAX;
-   max_ = FLT_MIN;
+   max_ = std::numeric_limits<float>::lowest();
    runningMean_ = 0.0f;
    m2_ = 0.0f;
    sum_ = 0.0f;
@@ -24,87 +24,53 @@
  ***********************************************************************************/
 
 #include "voreen/core/utils/voreenblas/voreenblascpu.h"
+#include "voreen/core/utils/voreenblas/voreenblaskernels.h"
 #include "voreen/core/voreenapplication.h"
 
+#include <cmath>
+#include <cstring>
+
 namespace voreen {
 
 const std::string VoreenBlasCPU::loggerCat_("voreen.VoreenBlasCPU");
 
 void VoreenBlasCPU::sAXPY( size_t vecSize, const float* vecx, const float* vecy, float alpha, float* result ) const {
-    for (size_t i=0; i<vecSize; ++i) {
-        result[i] = alpha*vecx[i] + vecy[i];
-    }
+    VoreenBlasKernels::axpy(0, vecSize, vecx, vecy, alpha, result);
 }
 
 float VoreenBlasCPU::sDOT(size_t vecSize, const float* vecx, const float* vecy) const {
-    float result = 0.f;
-    for (size_t i=0; i<vecSize; i++) {
-        result += vecx[i]*vecy[i];
-    }
-    return result;
+    return static_cast<float>(VoreenBlasKernels::dot(0, vecSize, vecx, vecy));
 }
 
 float VoreenBlasCPU::sNRM2(size_t vecSize, const float* vecx) const {
-    float result = 0.f;
-    for (size_t i=0; i<vecSize; i++) {
-        result += vecx[i]*vecx[i];
-    }
-    return sqrt(result);
+    return static_cast<float>(std::sqrt(VoreenBlasKernels::dot(0, vecSize, vecx, vecx)));
 }
 
 void VoreenBlasCPU::sSpMVEll(const EllpackMatrix<float>& mat, const float* vec, float* result) const {
-
-    const size_t numRows = mat.getNumRows();
-    const size_t numColsPerRow = mat.getNumColsPerRow();
-
-    for (size_t row=0; row < numRows; ++row) {
-        result[row] = 0.f;
-        for (size_t colIndex=0; colIndex < numColsPerRow; ++colIndex) {
-            size_t col = mat.getColumn(row, colIndex);
-            if(col != -1) {
-                result[row] += mat.getValueByIndex(row, colIndex) * vec[col];
-            }
-        }
-    }
+    VoreenBlasKernels::spMVEll(mat, 0, mat.getNumRows(), vec, result, nullptr);
 }
-void VoreenBlasCPU::hSpMVEll(const EllpackMatrix<int16_t>& mat, const float* vec, float* result) const {
 
-    const float maxValue = static_cast<float>((1<<15) - 1);
-    const size_t numRows = mat.getNumRows();
-    const size_t numColsPerRow = mat.getNumColsPerRow();
-
-    for (size_t row=0; row < numRows; ++row) {
-        result[row] = 0.f;
-        for (size_t colIndex=0; colIndex < numColsPerRow; ++colIndex) {
-            size_t col = mat.getColumn(row, colIndex);
-            if(col != -1) {
-                result[row] += (mat.getValueByIndex(row, colIndex) * vec[col]) / maxValue;
-            }
-        }
-    }
+void VoreenBlasCPU::hSpMVEll(const EllpackMatrix<int16_t>& mat, const float* vec, float* result) const {
+    VoreenBlasKernels::spMVEll(mat, 0, mat.getNumRows(), vec, result, nullptr);
 }
 
 float VoreenBlasCPU::sSpInnerProductEll(const EllpackMatrix<float>& mat, const float* vecx, const float* vecy) const {
-
-    const size_t numRows = mat.getNumRows();
-    const size_t numColsPerRow = mat.getNumColsPerRow();
-
-    float result = 0.f;
-    for (size_t row=0; row < numRows; ++row) {
-        float dot = 0.f;
-        for (size_t colIndex=0; colIndex < numColsPerRow; ++colIndex) {
-            size_t col = mat.getColumn(row, colIndex);
-            if(col != -1) {
-                dot += mat.getValueByIndex(row, colIndex) * vecy[col];
-            }
-        }
-        result += dot*vecx[row];
-    }
-    return result;
+    return static_cast<float>(VoreenBlasKernels::spMVEll(mat, 0, mat.getNumRows(), vecy, nullptr, vecx));
 }
 
 int VoreenBlasCPU::sSpConjGradEll(const EllpackMatrix<float>& mat, const float* vec, float* result,
                         float* initial, ConjGradPreconditioner precond, float threshold, int maxIterations, ProgressReporter* progress) const {
+    return conjGradEll(mat, vec, result, initial, precond, threshold, maxIterations, progress);
+}
+
+int VoreenBlasCPU::hSpConjGradEll(const EllpackMatrix<int16_t>& mat, const float* vec, float* result,
+                                    float* initial, float threshold, int maxIterations) const {
+    return conjGradEll(mat, vec, result, initial, NoPreconditioner, threshold, maxIterations, nullptr);
+}
+
+template<typename T>
+int VoreenBlasCPU::conjGradEll(const EllpackMatrix<T>& mat, const float* vec, float* result,
+                               float* initial, ConjGradPreconditioner precond, float threshold, int maxIterations, ProgressReporter* progress) const {
 
     if (!mat.isSymmetric()) {
         LERROR("Symmetric matrix expected.");
@@ -125,42 +91,39 @@ int VoreenBlasCPU::sSpConjGradEll(const EllpackMatrix<float>& mat, const float*
     memcpy(xBuf, initial, sizeof(float)*vecSize);
 
     float* tmpBuf = initial;
-    memcpy(tmpBuf, vec, sizeof(float)*vecSize);
 
     float* rBuf = new float[vecSize];
     float* pBuf = new float[vecSize];
 
     float* zBuf = 0;
-
-    EllpackMatrix<float>* preconditioner = 0;
+    float* invDiag = 0;
     if (precond == Jacobi) {
-        preconditioner = new EllpackMatrix<float>(mat.getNumRows(), mat.getNumRows(), 1);
-        preconditioner->initializeBuffers();
-        for (size_t i=0; i<mat.getNumRows(); i++)
-            preconditioner->setValueByIndex(i, i, 0, 1.f / std::max(mat.getValue(i,i), 1e-6f));
+        invDiag = new float[vecSize];
+        for (size_t i=0; i<vecSize; i++)
+            invDiag[i] = 1.f / std::max(static_cast<float>(mat.getValue(i,i)), 1e-6f);
 
         zBuf = new float[vecSize];
     }
-
-    float nominator;
-    float denominator;
+    else {
+        // without preconditioner, z equals r
+        zBuf = rBuf;
+    }
 
     int iteration = 0;
 
-    // r <= A*x_0
-    sSpMVEll(mat, xBuf, rBuf);
-
-    // p <= -r + b
-    sAXPY(vecSize, rBuf, tmpBuf, -1.f, pBuf);
-
-    // r <= -r + b
-    sAXPY(vecSize, rBuf, tmpBuf, -1.f, rBuf);
+    // r <= b - A*x_0
+    VoreenBlasKernels::spMVEll(mat, 0, vecSize, xBuf, rBuf, nullptr);
+    VoreenBlasKernels::axpy(0, vecSize, rBuf, vec, -1.f, rBuf);
 
-    // preconditioning
-    if (precond == Jacobi) {
-        sSpMVEll(*preconditioner, rBuf, zBuf);
-        memcpy(pBuf, zBuf, vecSize * sizeof(float));
+    // z <= M^-1 * r
+    if (invDiag) {
+        for (size_t i=0; i<vecSize; ++i)
+            zBuf[i] = invDiag[i]*rBuf[i];
     }
+    double nominator = VoreenBlasKernels::dot(0, vecSize, rBuf, zBuf);
+
+    // p <= z
+    memcpy(pBuf, zBuf, vecSize * sizeof(float));
 
     try {
         while (iteration < maxIterations) {
@@ -168,58 +131,29 @@ int VoreenBlasCPU::sSpConjGradEll(const EllpackMatrix<float>& mat, const float*
 
             iteration++;
 
-            // norm(r_k)
-            nominator = sDOT(vecSize, rBuf, rBuf);
-
-            if (precond == Jacobi)
-                nominator = sDOT(vecSize, rBuf, zBuf);
-            else
-                nominator = sDOT(vecSize, rBuf, rBuf);
-
-            // tmp <= A * p_k
-            sSpMVEll(mat, pBuf, tmpBuf);
-
-            // dot(p_k^T, tmp)
-            denominator = sDOT(vecSize, pBuf, tmpBuf);
-
-            float alpha = nominator / denominator;
-
-            // x <= alpha*p + x
-            sAXPY(vecSize, pBuf, xBuf, alpha, xBuf);
-
-            // r <= -alpha*tmp + r
-            sAXPY(vecSize, tmpBuf, rBuf, -alpha, rBuf);
+            // tmp <= A * p_k, denominator <= dot(p_k, tmp)
+            double denominator = VoreenBlasKernels::spMVEll(mat, 0, vecSize, pBuf, tmpBuf, pBuf);
 
-            float beta;
+            float alpha = static_cast<float>(nominator / denominator);
 
-            // norm(r_k+1)
-            if (precond == Jacobi) {
-                sSpMVEll(*preconditioner, rBuf, zBuf);
-                beta = sDOT(vecSize, rBuf, zBuf);
-            }
-            else {
-                beta = sDOT(vecSize, rBuf, rBuf);
-            }
+            // x <= alpha*p + x, r <= -alpha*tmp + r, z <= M^-1 * r
+            double beta = VoreenBlasKernels::updateResidual(0, vecSize, alpha, pBuf, tmpBuf, xBuf, rBuf, invDiag, zBuf);
 
-            if (sqrt(beta) < threshold)
+            if (std::sqrt(beta) < threshold)
                 break;
 
-            beta /= nominator;
+            // p <= beta*p + z
+            VoreenBlasKernels::updateDirection(0, vecSize, static_cast<float>(beta / nominator), zBuf, pBuf);
 
-            // p <= beta*p + r
-            if (precond == Jacobi) {
-                sAXPY(vecSize, pBuf, zBuf, beta, pBuf);
-            }
-            else {
-                sAXPY(vecSize, pBuf, rBuf, beta, pBuf);
-            }
+            nominator = beta;
         }
         if(progress) { progress->setProgress(1.0f); }
     } catch(boost::thread_interrupted& e) {
         delete[] rBuf;
         delete[] pBuf;
-        delete[] zBuf;
-        delete preconditioner;
+        if (precond == Jacobi)
+            delete[] zBuf;
+        delete[] invDiag;
 
         if (initialAllocated)
             delete[] initial;
@@ -229,91 +163,9 @@ int VoreenBlasCPU::sSpConjGradEll(const EllpackMatrix<float>& mat, const float*
 
     delete[] rBuf;
     delete[] pBuf;
-    delete[] zBuf;
-    delete preconditioner;
-
-    if (initialAllocated)
-        delete[] initial;
-
-    return iteration;
-}
-
-int VoreenBlasCPU::hSpConjGradEll(const EllpackMatrix<int16_t>& mat, const float* vec, float* result,
-                                    float* initial, float threshold, int maxIterations) const {
-
-    if (!mat.isSymmetric()) {
-        LERROR("Symmetric matrix expected.");
-        return -1;
-    }
-
-    size_t vecSize = mat.getNumRows();
-
-    bool initialAllocated = false;
-    if (initial == 0) {
-        initial = new float[vecSize];
-        initialAllocated = true;
-        for (size_t i=0; i<vecSize; ++i)
-            initial[i] = 0.f;
-    }
-
-    float* xBuf = result;
-    memcpy(xBuf, initial, sizeof(float)*vecSize);
-
-    float* tmpBuf = initial;
-    memcpy(tmpBuf, vec, sizeof(float)*vecSize);
-
-    float* rBuf = new float[vecSize];
-    float* pBuf = new float[vecSize];
-
-    float nominator;
-    float denominator;
-
-    int iteration = 0;
-
-    // r <= A*x_0
-    hSpMVEll(mat, xBuf, rBuf);
-
-    // p <= -r + b
-    sAXPY(vecSize, rBuf, tmpBuf, -1.f, pBuf);
-
-    // r <= -r + b
-    sAXPY(vecSize, rBuf, tmpBuf, -1.f, rBuf);
-
-    while (iteration < maxIterations) {
-
-        iteration++;
-
-        // norm(r_k)
-        nominator = sDOT(vecSize, rBuf, rBuf);
-
-        // tmp <= A * p_k
-        hSpMVEll(mat, pBuf, tmpBuf);
-
-        // dot(p_k^T, tmp)
-        denominator = sDOT(vecSize, pBuf, tmpBuf);
-
-        float alpha = nominator / denominator;
-
-        // x <= alpha*p + x
-        sAXPY(vecSize, pBuf, xBuf, alpha, xBuf);
-
-        // r <= -alpha*tmp + r
-        sAXPY(vecSize, tmpBuf, rBuf, -alpha, rBuf);
-
-        // norm(r_k+1)
-        float beta = sDOT(vecSize, rBuf, rBuf);
-
-        if (sqrt(beta) < threshold)
-            break;
-
-        beta /= nominator;
-
-        // p <= beta*p + r
-        sAXPY(vecSize, pBuf, rBuf, beta, pBuf);
-    }
-
-    delete[] rBuf;
-    delete[] pBuf;
+    if (precond == Jacobi)
+        delete[] zBuf;
+    delete[] invDiag;
 
     if (initialAllocated)
         delete[] initial;
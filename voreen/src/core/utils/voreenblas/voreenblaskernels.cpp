@@ -0,0 +1,354 @@
+/***********************************************************************************
+ *                                                                                 *
+ * Voreen - The Volume Rendering Engine                                            *
+ *                                                                                 *
+ * Copyright (C) 2005-2024 University of Muenster, Germany,                        *
+ * Department of Computer Science.                                                 *
+ * For a list of authors please refer to the file "CREDITS.txt".                   *
+ *                                                                                 *
+ * This file is part of the Voreen software package. Voreen is free software:      *
+ * you can redistribute it and/or modify it under the terms of the GNU General     *
+ * Public License version 2 as published by the Free Software Foundation.          *
+ *                                                                                 *
+ * Voreen is distributed in the hope that it will be useful, but WITHOUT ANY       *
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR   *
+ * A PARTICULAR PURPOSE. See the GNU General Public License for more details.      *
+ *                                                                                 *
+ * You should have received a copy of the GNU General Public License in the file   *
+ * "LICENSE.txt" along with this file. If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                                 *
+ * For non-commercial academic use see the license exception specified in the file *
+ * "LICENSE-academic.txt". To get information about commercial licensing please    *
+ * contact the authors.                                                            *
+ *                                                                                 *
+ ***********************************************************************************/
+
+#include "voreen/core/utils/voreenblas/voreenblaskernels.h"
+
+// Runtime dispatched AVX2/AVX-512 kernels are only available for GCC compatible compilers targeting x86.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VRN_BLAS_X86_KERNELS
+#include <immintrin.h>
+#define VRN_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define VRN_TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#endif
+
+namespace voreen {
+
+const std::string VoreenBlasKernels::loggerCat_("voreen.VoreenBlasKernels");
+
+namespace {
+
+const size_t INVALID_COLUMN = static_cast<size_t>(-1);
+
+inline float entryScale(float) {
+    return 1.f;
+}
+
+inline float entryScale(int16_t) {
+    return 1.f / static_cast<float>((1<<15) - 1);
+}
+
+//-------------------------------------------------------------------------------------------------
+// Generic kernels, also used for the remainders of the vectorized ones
+
+double dotGeneric(size_t begin, size_t end, const float* x, const float* y) {
+    double result = 0.0;
+    for (size_t i=begin; i<end; ++i)
+        result += static_cast<double>(x[i]) * y[i];
+    return result;
+}
+
+void axpyGeneric(size_t begin, size_t end, const float* x, const float* y, float alpha, float* result) {
+    for (size_t i=begin; i<end; ++i)
+        result[i] = alpha*x[i] + y[i];
+}
+
+template<typename T>
+double spMVEllGeneric(const EllpackMatrix<T>& mat, size_t begin, size_t end, const float* vec, float* result, const float* dotVec) {
+    const T* values = mat.getMatrix();
+    const size_t* indices = mat.getIndices();
+    const size_t numColsPerRow = mat.getNumColsPerRow();
+    const float scale = entryScale(T());
+
+    double dot = 0.0;
+    for (size_t row=begin; row<end; ++row) {
+        float sum = 0.f;
+        for (size_t index = row*numColsPerRow; index < (row+1)*numColsPerRow; ++index) {
+            size_t col = indices[index];
+            if (col != INVALID_COLUMN)
+                sum += values[index] * vec[col];
+        }
+        sum *= scale;
+        if (result)
+            result[row] = sum;
+        if (dotVec)
+            dot += static_cast<double>(dotVec[row]) * sum;
+    }
+    return dot;
+}
+
+double updateResidualGeneric(size_t begin, size_t end, float alpha, const float* p, const float* Ap,
+                             float* x, float* r, const float* invDiag, float* z) {
+    double result = 0.0;
+    for (size_t i=begin; i<end; ++i) {
+        x[i] += alpha*p[i];
+        r[i] -= alpha*Ap[i];
+        if (invDiag) {
+            z[i] = invDiag[i]*r[i];
+            result += static_cast<double>(r[i]) * z[i];
+        }
+        else {
+            result += static_cast<double>(r[i]) * r[i];
+        }
+    }
+    return result;
+}
+
+void updateDirectionGeneric(size_t begin, size_t end, float beta, const float* z, float* p) {
+    for (size_t i=begin; i<end; ++i)
+        p[i] = z[i] + beta*p[i];
+}
+
+#ifdef VRN_BLAS_X86_KERNELS
+
+//-------------------------------------------------------------------------------------------------
+// AVX2 kernels: 8 floats per register, reductions use two registers of 4 doubles.
+
+VRN_TARGET_AVX2
+inline double horizontalSum(__m256d v) {
+    __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+}
+
+/// acc <= acc + a*b for the 8 floats of a and b, computed in double precision
+VRN_TARGET_AVX2
+inline void accumulateProduct(__m256 a, __m256 b, __m256d& accLow, __m256d& accHigh) {
+    accLow = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(a)), _mm256_cvtps_pd(_mm256_castps256_ps128(b)), accLow);
+    accHigh = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(a, 1)), _mm256_cvtps_pd(_mm256_extractf128_ps(b, 1)), accHigh);
+}
+
+VRN_TARGET_AVX2
+double dotAVX2(size_t begin, size_t end, const float* x, const float* y) {
+    __m256d accLow = _mm256_setzero_pd();
+    __m256d accHigh = _mm256_setzero_pd();
+    size_t i = begin;
+    for (; i+8 <= end; i += 8)
+        accumulateProduct(_mm256_loadu_ps(x+i), _mm256_loadu_ps(y+i), accLow, accHigh);
+    return horizontalSum(_mm256_add_pd(accLow, accHigh)) + dotGeneric(i, end, x, y);
+}
+
+VRN_TARGET_AVX2
+void axpyAVX2(size_t begin, size_t end, const float* x, const float* y, float alpha, float* result) {
+    const __m256 a = _mm256_set1_ps(alpha);
+    size_t i = begin;
+    for (; i+8 <= end; i += 8)
+        _mm256_storeu_ps(result+i, _mm256_fmadd_ps(a, _mm256_loadu_ps(x+i), _mm256_loadu_ps(y+i)));
+    axpyGeneric(i, end, x, y, alpha, result);
+}
+
+VRN_TARGET_AVX2
+double updateResidualAVX2(size_t begin, size_t end, float alpha, const float* p, const float* Ap,
+                          float* x, float* r, const float* invDiag, float* z) {
+    const __m256 a = _mm256_set1_ps(alpha);
+    __m256d accLow = _mm256_setzero_pd();
+    __m256d accHigh = _mm256_setzero_pd();
+    size_t i = begin;
+    for (; i+8 <= end; i += 8) {
+        _mm256_storeu_ps(x+i, _mm256_fmadd_ps(a, _mm256_loadu_ps(p+i), _mm256_loadu_ps(x+i)));
+        __m256 res = _mm256_fnmadd_ps(a, _mm256_loadu_ps(Ap+i), _mm256_loadu_ps(r+i));
+        _mm256_storeu_ps(r+i, res);
+        if (invDiag) {
+            __m256 pre = _mm256_mul_ps(_mm256_loadu_ps(invDiag+i), res);
+            _mm256_storeu_ps(z+i, pre);
+            accumulateProduct(res, pre, accLow, accHigh);
+        }
+        else {
+            accumulateProduct(res, res, accLow, accHigh);
+        }
+    }
+    return horizontalSum(_mm256_add_pd(accLow, accHigh)) + updateResidualGeneric(i, end, alpha, p, Ap, x, r, invDiag, z);
+}
+
+VRN_TARGET_AVX2
+void updateDirectionAVX2(size_t begin, size_t end, float beta, const float* z, float* p) {
+    const __m256 b = _mm256_set1_ps(beta);
+    size_t i = begin;
+    for (; i+8 <= end; i += 8)
+        _mm256_storeu_ps(p+i, _mm256_fmadd_ps(b, _mm256_loadu_ps(p+i), _mm256_loadu_ps(z+i)));
+    updateDirectionGeneric(i, end, beta, z, p);
+}
+
+//-------------------------------------------------------------------------------------------------
+// AVX-512 kernels: 16 floats per register, reductions use two registers of 8 doubles.
+
+// GCC 12 falsely reports the undefined source operands of the unmasked conversion intrinsics as uninitialized.
+// Clang does not know -Wmaybe-uninitialized and would warn about the pragma itself.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+VRN_TARGET_AVX512
+inline void accumulateProduct(__m512 a, __m512 b, __m512d& accLow, __m512d& accHigh) {
+    accLow = _mm512_fmadd_pd(_mm512_cvtps_pd(_mm512_castps512_ps256(a)), _mm512_cvtps_pd(_mm512_castps512_ps256(b)), accLow);
+    accHigh = _mm512_fmadd_pd(_mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(a), 1))),
+                              _mm512_cvtps_pd(_mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(b), 1))), accHigh);
+}
+
+VRN_TARGET_AVX512
+double dotAVX512(size_t begin, size_t end, const float* x, const float* y) {
+    __m512d accLow = _mm512_setzero_pd();
+    __m512d accHigh = _mm512_setzero_pd();
+    size_t i = begin;
+    for (; i+16 <= end; i += 16)
+        accumulateProduct(_mm512_loadu_ps(x+i), _mm512_loadu_ps(y+i), accLow, accHigh);
+    return _mm512_reduce_add_pd(_mm512_add_pd(accLow, accHigh)) + dotGeneric(i, end, x, y);
+}
+
+VRN_TARGET_AVX512
+void axpyAVX512(size_t begin, size_t end, const float* x, const float* y, float alpha, float* result) {
+    const __m512 a = _mm512_set1_ps(alpha);
+    size_t i = begin;
+    for (; i+16 <= end; i += 16)
+        _mm512_storeu_ps(result+i, _mm512_fmadd_ps(a, _mm512_loadu_ps(x+i), _mm512_loadu_ps(y+i)));
+    axpyGeneric(i, end, x, y, alpha, result);
+}
+
+VRN_TARGET_AVX512
+double updateResidualAVX512(size_t begin, size_t end, float alpha, const float* p, const float* Ap,
+                            float* x, float* r, const float* invDiag, float* z) {
+    const __m512 a = _mm512_set1_ps(alpha);
+    __m512d accLow = _mm512_setzero_pd();
+    __m512d accHigh = _mm512_setzero_pd();
+    size_t i = begin;
+    for (; i+16 <= end; i += 16) {
+        _mm512_storeu_ps(x+i, _mm512_fmadd_ps(a, _mm512_loadu_ps(p+i), _mm512_loadu_ps(x+i)));
+        __m512 res = _mm512_fnmadd_ps(a, _mm512_loadu_ps(Ap+i), _mm512_loadu_ps(r+i));
+        _mm512_storeu_ps(r+i, res);
+        if (invDiag) {
+            __m512 pre = _mm512_mul_ps(_mm512_loadu_ps(invDiag+i), res);
+            _mm512_storeu_ps(z+i, pre);
+            accumulateProduct(res, pre, accLow, accHigh);
+        }
+        else {
+            accumulateProduct(res, res, accLow, accHigh);
+        }
+    }
+    return _mm512_reduce_add_pd(_mm512_add_pd(accLow, accHigh)) + updateResidualGeneric(i, end, alpha, p, Ap, x, r, invDiag, z);
+}
+
+VRN_TARGET_AVX512
+void updateDirectionAVX512(size_t begin, size_t end, float beta, const float* z, float* p) {
+    const __m512 b = _mm512_set1_ps(beta);
+    size_t i = begin;
+    for (; i+16 <= end; i += 16)
+        _mm512_storeu_ps(p+i, _mm512_fmadd_ps(b, _mm512_loadu_ps(p+i), _mm512_loadu_ps(z+i)));
+    updateDirectionGeneric(i, end, beta, z, p);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // VRN_BLAS_X86_KERNELS
+
+//-------------------------------------------------------------------------------------------------
+// Dispatch
+
+struct KernelTable {
+    VoreenBlasKernels::InstructionSet instructionSet_;
+    double (*dot_)(size_t, size_t, const float*, const float*);
+    void (*axpy_)(size_t, size_t, const float*, const float*, float, float*);
+    double (*updateResidual_)(size_t, size_t, float, const float*, const float*, float*, float*, const float*, float*);
+    void (*updateDirection_)(size_t, size_t, float, const float*, float*);
+};
+
+KernelTable createKernelTable(VoreenBlasKernels::InstructionSet instructionSet) {
+    KernelTable table = { VoreenBlasKernels::GENERIC, &dotGeneric, &axpyGeneric,
+                          &updateResidualGeneric, &updateDirectionGeneric };
+#ifdef VRN_BLAS_X86_KERNELS
+    if (instructionSet == VoreenBlasKernels::AVX2) {
+        KernelTable avx2 = { VoreenBlasKernels::AVX2, &dotAVX2, &axpyAVX2,
+                             &updateResidualAVX2, &updateDirectionAVX2 };
+        table = avx2;
+    }
+    else if (instructionSet == VoreenBlasKernels::AVX512) {
+        KernelTable avx512 = { VoreenBlasKernels::AVX512, &dotAVX512, &axpyAVX512,
+                               &updateResidualAVX512, &updateDirectionAVX512 };
+        table = avx512;
+    }
+#endif
+    return table;
+}
+
+KernelTable& getKernelTable() {
+    static KernelTable table = createKernelTable(VoreenBlasKernels::getSupportedInstructionSet());
+    return table;
+}
+
+} // namespace anonymous
+
+VoreenBlasKernels::InstructionSet VoreenBlasKernels::getInstructionSet() {
+    return getKernelTable().instructionSet_;
+}
+
+VoreenBlasKernels::InstructionSet VoreenBlasKernels::getSupportedInstructionSet() {
+#ifdef VRN_BLAS_X86_KERNELS
+    // Also checks whether the OS saves the extended registers.
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return __builtin_cpu_supports("avx512f") ? AVX512 : AVX2;
+#endif
+    return GENERIC;
+}
+
+void VoreenBlasKernels::setInstructionSet(InstructionSet instructionSet) {
+    InstructionSet supported = getSupportedInstructionSet();
+    if (instructionSet > supported) {
+        LWARNING(getInstructionSetName(instructionSet) << " not supported by the CPU, using " << getInstructionSetName(supported));
+        instructionSet = supported;
+    }
+    getKernelTable() = createKernelTable(instructionSet);
+}
+
+std::string VoreenBlasKernels::getInstructionSetName(InstructionSet instructionSet) {
+    switch (instructionSet) {
+    case AVX2:
+        return "AVX2";
+    case AVX512:
+        return "AVX-512";
+    default:
+        return "generic";
+    }
+}
+
+double VoreenBlasKernels::dot(size_t begin, size_t end, const float* x, const float* y) {
+    return getKernelTable().dot_(begin, end, x, y);
+}
+
+void VoreenBlasKernels::axpy(size_t begin, size_t end, const float* x, const float* y, float alpha, float* result) {
+    getKernelTable().axpy_(begin, end, x, y, alpha, result);
+}
+
+// The matrix vector product is limited by the memory bandwidth required for the 64 bit column indices,
+// so a vectorized variant (which would have to gather the vector entries) does not pay off.
+double VoreenBlasKernels::spMVEll(const EllpackMatrix<float>& mat, size_t begin, size_t end, const float* vec, float* result, const float* dotVec) {
+    return spMVEllGeneric(mat, begin, end, vec, result, dotVec);
+}
+
+double VoreenBlasKernels::spMVEll(const EllpackMatrix<int16_t>& mat, size_t begin, size_t end, const float* vec, float* result, const float* dotVec) {
+    return spMVEllGeneric(mat, begin, end, vec, result, dotVec);
+}
+
+double VoreenBlasKernels::updateResidual(size_t begin, size_t end, float alpha, const float* p, const float* Ap,
+                                         float* x, float* r, const float* invDiag, float* z) {
+    return getKernelTable().updateResidual_(begin, end, alpha, p, Ap, x, r, invDiag, z);
+}
+
+void VoreenBlasKernels::updateDirection(size_t begin, size_t end, float beta, const float* z, float* p) {
+    getKernelTable().updateDirection_(begin, end, beta, z, p);
+}
+
+} // namespace
@@ -230,6 +230,7 @@ VoreenApplication::VoreenApplication(const std::string& binaryName, const std::s
     , useCaching_("useCaching", "Use Caching", true, Processor::INVALID_RESULT, Property::LOD_DEVELOPMENT)
     , volumeCacheLimit_("cacheLimit", "Volume Cache Size (GB)", 10, 0, 1000 /*1 TB*/, Processor::INVALID_RESULT, NumericProperty<int>::STATIC, Property::LOD_APPLICATION)
     , octreeCacheLimit_("octreeCacheLimit", "Octree Cache Size (GB)", 100, 0, 1000 /*1 TB*/, Processor::INVALID_RESULT, NumericProperty<int>::STATIC, Property::LOD_APPLICATION)
+    , memoryCacheLimit_("memoryCacheLimit", "In-Memory Result Cache Size (MB)", 0, 0, 128*1024 /*128 GB*/, Processor::INVALID_RESULT, NumericProperty<int>::STATIC, Property::LOD_APPLICATION)
     , cachePath_("cachePath", "Cache Directory", "Select Cache Directory...", "", "", FileDialogProperty::DIRECTORY, Processor::INVALID_RESULT, Property::LOD_APPLICATION, VoreenFileWatchListener::ALWAYS_OFF)
     , resetCachePath_("resetCachePath", "Reset Cache Path" , Processor::INVALID_RESULT, Property::LOD_APPLICATION)
     , deleteCache_("deleteCache", "Delete Cache", Processor::INVALID_RESULT, Property::LOD_APPLICATION)
@@ -247,6 +248,7 @@ VoreenApplication::VoreenApplication(const std::string& binaryName, const std::s
         "", "", FileDialogProperty::DIRECTORY, Processor::INVALID_RESULT, Property::LOD_DEVELOPMENT, VoreenFileWatchListener::ALWAYS_OFF)
     , showSplashScreen_("showSplashScreen", "Show Splash Screen", true, Processor::INVALID_RESULT, Property::LOD_DEVELOPMENT)
     , askForSave_("askForSave", "Notify Unsaved Changes", true, Processor::INVALID_RESULT, Property::LOD_DEVELOPMENT)
+    , saveBinaryBlobSidecar_("saveBinaryBlobSidecar", "Save Binary Workspace Data to Separate File", false, Processor::INVALID_RESULT, Property::LOD_DEVELOPMENT)
     //, loadLastWorkspaceOnStartup_("loadLastWorkspaceOnStartup", "Load Last Workspace on Startup", true, Processor::INVALID_RESULT, Property::LOD_DEVELOPMENT)
     , showStartupWizard_("showStartupWizard", "Show Startup Wizard", true, Processor::INVALID_RESULT)
     , useDoubleBuffering_(true)
@@ -298,12 +300,14 @@ VoreenApplication::VoreenApplication(const std::string& binaryName, const std::s
     addProperty(useCaching_);
     addProperty(volumeCacheLimit_);
     addProperty(octreeCacheLimit_);
+    addProperty(memoryCacheLimit_);
     addProperty(cachePath_);
     addProperty(resetCachePath_);
     addProperty(deleteCache_);
     useCaching_.setGroupID("caching");
     volumeCacheLimit_.setGroupID("caching");
     octreeCacheLimit_.setGroupID("caching");
+    memoryCacheLimit_.setGroupID("caching");
     cachePath_.setGroupID("caching");
     resetCachePath_.setGroupID("caching");
     deleteCache_.setGroupID("caching");
@@ -381,6 +385,8 @@ VoreenApplication::VoreenApplication(const std::string& binaryName, const std::s
     showSplashScreen_.setGroupID("user-interface");
     addProperty(askForSave_);
     askForSave_.setGroupID("user-interface");
+    addProperty(saveBinaryBlobSidecar_);
+    saveBinaryBlobSidecar_.setGroupID("user-interface");
     //addProperty(loadLastWorkspaceOnStartup_);
     //loadLastWorkspaceOnStartup_.setGroupID("user-interface");
     addProperty(showStartupWizard_);
@@ -461,6 +467,10 @@ bool VoreenApplication::getAskForSave() const {
     return askForSave_.get();
 }
 
+bool VoreenApplication::getSaveBinaryBlobSidecar() const {
+    return saveBinaryBlobSidecar_.get();
+}
+
 void VoreenApplication::setOverrideGLSLVersion(const std::string& version) {
     if (isInitialized()) {
         LERROR("Trying to override GLSL version after application initialization");
@@ -998,6 +1008,10 @@ size_t VoreenApplication::getCpuRamLimit() const {
         return static_cast<size_t>(static_cast<uint64_t>(cpuRamLimit_.getMaxValue()) << 20); //< use max value
 }
 
+size_t VoreenApplication::getMemoryCacheLimit() const {
+    return static_cast<size_t>(static_cast<uint64_t>(memoryCacheLimit_.get()) << 20); //< property specifies the limit in MB
+}
+
 size_t VoreenApplication::getGpuMemoryLimit() const {
     return static_cast<size_t>(static_cast<uint64_t>(gpuMemoryLimit_.get()) << 20); //< property specifies limit in MB
 }
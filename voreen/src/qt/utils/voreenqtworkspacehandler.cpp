@@ -310,7 +310,7 @@ bool VoreenQtWorkspaceHandler::saveWorkspace() {
 
     try {
         readOnlyWorkspace_ = false;
-        workspace_->save(filename.toStdString(), true, workDir.toStdString());
+        workspace_->save(filename.toStdString(), true, workDir.toStdString(), VoreenApplication::app()->getSaveBinaryBlobSidecar());
     }
     catch (SerializationException& e) {
         LERROR("Could not save workspace: " << e.what());